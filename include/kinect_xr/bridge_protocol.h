@@ -0,0 +1,46 @@
+/**
+ * @file bridge_protocol.h
+ * @brief Wire constants shared by the bridge server, transports and tools
+ *
+ * See specs/archive/008-WebSocketBridgeProtocol.md
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kinect_xr {
+
+// Stream types (matches protocol spec)
+constexpr uint16_t STREAM_TYPE_RGB = 0x0001;
+constexpr uint16_t STREAM_TYPE_DEPTH = 0x0002;
+constexpr uint16_t STREAM_TYPE_POINTCLOUD = 0x0003;  // Derived from depth, see point_cloud.h
+constexpr uint16_t STREAM_TYPE_MESH = 0x0004;        // Derived from depth, see depth_mesh.h
+constexpr uint16_t STREAM_TYPE_KEYED = 0x0005;       // Depth-keyed RGBA, see depth_key.h
+constexpr uint16_t STREAM_TYPE_CONTOURS = 0x0006;    // Silhouette polygons, see depth_contour.h
+constexpr uint16_t STREAM_TYPE_BUNDLE = 0x0007;      // Several of the above in one message, see frame_bundle.h
+constexpr uint16_t STREAM_TYPE_CONTROL = 0x0008;     // Binary control messages, see control_codec.h
+
+// Subscribable stream types are small integers, usable as array indices below this bound
+constexpr size_t STREAM_TYPE_COUNT = 7;
+
+// Binary frame header flags (bytes 6-7 of the 8-byte header)
+constexpr uint16_t FRAME_FLAG_HISTORY = 0x0001;  // Served from the history ring, not live
+constexpr uint16_t FRAME_FLAG_SCALE_MASK = 0x000C;  // log2 of the downscale factor (adaptive delivery)
+constexpr int FRAME_FLAG_SCALE_SHIFT = 2;
+constexpr uint16_t FRAME_FLAG_PIXEL_FORMAT_MASK = 0x0030;  // RGB pixel layout, see pixel_format.h
+constexpr int FRAME_FLAG_PIXEL_FORMAT_SHIFT = 4;
+constexpr uint16_t FRAME_FLAG_DEPTH_PACKING_MASK = 0x00C0;  // Depth bit packing, see depth_packing.h
+constexpr int FRAME_FLAG_DEPTH_PACKING_SHIFT = 6;
+constexpr uint16_t FRAME_FLAG_TILES = 0x0100;  // Dirty tiles only, see tile_update.h
+constexpr uint16_t FRAME_FLAG_TILE_KEY = 0x0200;  // Full tile reference; later deltas build on it
+constexpr uint16_t FRAME_FLAG_MEMFD = 0x8000;  // Unix socket: payload passed as a memfd (SCM_RIGHTS)
+
+// Frame dimensions
+constexpr uint32_t FRAME_WIDTH = 640;
+constexpr uint32_t FRAME_HEIGHT = 480;
+constexpr uint32_t RGB_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 3;    // 921600
+constexpr uint32_t DEPTH_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 2;  // 614400
+
+}  // namespace kinect_xr
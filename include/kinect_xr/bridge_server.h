@@ -7,47 +7,50 @@
 
 #pragma once
 
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/client_registry.h"
+#include "kinect_xr/control_codec.h"
+#include "kinect_xr/depth_contour.h"
+#include "kinect_xr/depth_key.h"
+#include "kinect_xr/depth_mesh.h"
+#include "kinect_xr/depth_packing.h"
+#include "kinect_xr/frame_bundle.h"
+#include "kinect_xr/frame_history.h"
+#include "kinect_xr/latency_trace.h"
+#include "kinect_xr/lock_stats.h"
+#include "kinect_xr/metrics.h"
+#include "kinect_xr/multicast.h"
+#include "kinect_xr/pixel_format.h"
+#include "kinect_xr/point_cloud.h"
+#include "kinect_xr/shm_ring.h"
+#include "kinect_xr/snapshot_encoder.h"
+#include "kinect_xr/tile_update.h"
+#include "kinect_xr/ws_client.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
-namespace ix {
-class WebSocketServer;
-class WebSocket;
-}  // namespace ix
-
 namespace kinect_xr {
 
 class KinectDevice;
 struct MotorStatus;
 
-// Stream types (matches protocol spec)
-constexpr uint16_t STREAM_TYPE_RGB = 0x0001;
-constexpr uint16_t STREAM_TYPE_DEPTH = 0x0002;
-
-// Frame dimensions
-constexpr uint32_t FRAME_WIDTH = 640;
-constexpr uint32_t FRAME_HEIGHT = 480;
-constexpr uint32_t RGB_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 3;    // 921600
-constexpr uint32_t DEPTH_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 2;  // 614400
-
-/**
- * @brief Client subscription state
- */
-struct ClientState {
-    bool subscribedRgb = false;
-    bool subscribedDepth = false;
-};
-
 /**
  * @brief Thread-safe frame cache for latest Kinect data
  */
 struct BridgeFrameCache {
-    std::mutex mutex;
+    NamedMutex mutex{"bridge_frame_cache"};
 
     std::vector<uint8_t> rgbData;
     uint32_t rgbTimestamp = 0;
@@ -56,6 +59,7 @@ struct BridgeFrameCache {
     std::vector<uint8_t> depthData;  // Stored as raw bytes (uint16 LE)
     uint32_t depthTimestamp = 0;
     bool depthValid = false;
+    std::chrono::steady_clock::time_point depthCapturedAt;  // Arrival of the frame that set frameId
 
     uint32_t frameId = 0;
 
@@ -81,6 +85,70 @@ public:
     BridgeServer(const BridgeServer&) = delete;
     BridgeServer& operator=(const BridgeServer&) = delete;
 
+    /**
+     * @brief Select the WebSocket transport (call before start)
+     * @param kind IXWebSocket (default) or the epoll/kqueue reactor
+     * @param ioThreads Number of reactor I/O threads
+     */
+    void setTransport(TransportKind kind, int ioThreads = 2) {
+        transportKind_ = kind;
+        ioThreads_ = ioThreads;
+    }
+
+    /**
+     * @brief How long queued frames may wait before they are dropped (call before start)
+     *
+     * Applies to the reactor and Unix socket transports; see send_queue.h.
+     */
+    void setSendDeadlines(const SendDeadlines& deadlines) { sendDeadlines_ = deadlines; }
+
+    /**
+     * @brief Also publish frames into a shared-memory ring (call before start)
+     * @param name POSIX shm name (e.g. "/kinect-xr"); empty disables
+     *
+     * While enabled, Kinect streams run for as long as the server does, since
+     * shared-memory readers are not visible to the server.
+     */
+    void setSharedMemory(const std::string& name) { shmName_ = name; }
+
+    /**
+     * @brief Also accept local clients on a Unix domain socket (call before start)
+     * @param path Socket path; empty disables
+     *
+     * Unix clients share the subscription model and framing of WebSocket
+     * clients; large frames are passed as memfds (see reactor_transport.h).
+     */
+    void setUnixSocket(const std::string& path) { unixPath_ = path; }
+
+    /**
+     * @brief Also send frames to a UDP multicast group (call before start)
+     *
+     * Like shared memory, multicast receivers are invisible to the server, so
+     * Kinect streams run for as long as the server does.
+     */
+    void setMulticast(const MulticastConfig& config) {
+        multicastConfig_ = config;
+        multicastEnabled_ = true;
+    }
+
+    /**
+     * @brief Re-serve an upstream bridge instead of a local Kinect (call before start)
+     * @param url Upstream bridge, e.g. "ws://capture-host:8765/kinect"; empty disables
+     *
+     * Upstream binary messages are forwarded byte-for-byte through the normal
+     * broadcast path, so relays can be chained for hierarchical fan-out.
+     */
+    void setRelay(const std::string& url) { relayUrl_ = url; }
+
+    /**
+     * @brief Keep a compressed history of recent frames (call before start)
+     * @param seconds History window; 0 disables
+     *
+     * Enables the history.get / history.replay messages and catch-up on
+     * subscribe (see FrameHistory).
+     */
+    void setHistory(double seconds) { historySeconds_ = seconds; }
+
     /**
      * @brief Start the bridge server
      * @param port Port to listen on (default: 8765)
@@ -120,31 +188,64 @@ public:
     uint32_t getFramesSent() const { return framesSent_; }
     uint32_t getDroppedFrames() const { return droppedFrames_; }
 
+    /**
+     * @brief Device, pipeline, encoder and transport metrics (GET /metrics, {"type":"stats"})
+     */
+    const MetricsRegistry& metrics() const { return metrics_; }
+
 private:
-    // WebSocket event handlers
-    void onConnection(ix::WebSocket* ws);
-    void onMessage(ix::WebSocket* ws, const std::string& message);
-    void onClose(ix::WebSocket* ws);
+    // Transport event handlers
+    void onConnection(const ClientPtr& client);
+    void onMessage(const ClientPtr& client, const std::string& message);
+    void onBinary(const ClientPtr& client, const uint8_t* data, size_t size);  // Binary control messages
+    void onClose(const ClientPtr& client);
+    bool onHttp(const ClientPtr& client, const std::string& target);
 
     // Message handlers
-    void handleSubscribe(ix::WebSocket* ws, const std::string& message);
-    void handleUnsubscribe(ix::WebSocket* ws);
-    void handleMotorSetTilt(ix::WebSocket* ws, const std::string& message);
-    void handleMotorSetLed(ix::WebSocket* ws, const std::string& message);
-    void handleMotorReset(ix::WebSocket* ws);
-    void handleMotorGetStatus(ix::WebSocket* ws);
+    // JSON messages are parsed once, in onMessage; motor and status
+    // requests arrive the same way from JSON and binary control messages
+    void handleSubscribe(const ClientPtr& client, const nlohmann::json& msg);
+    void handleUnsubscribe(const ClientPtr& client);
+    // Replies use the encoding the request arrived in
+    enum class ControlEncoding { Json, Binary };
+    void handleMotorSetTilt(const ClientPtr& client, ControlEncoding encoding, double angle);
+    void handleMotorSetLed(const ClientPtr& client, ControlEncoding encoding, LEDState state);
+    void handleMotorReset(const ClientPtr& client, ControlEncoding encoding);
+    void handleMotorGetStatus(const ClientPtr& client, ControlEncoding encoding);
+    void handleHistoryGet(const ClientPtr& client, const nlohmann::json& msg);
+    void handleHistoryReplay(const ClientPtr& client, const nlohmann::json& msg);
+    void handleKeyLearn(const ClientPtr& client, const nlohmann::json& msg);
+    void handleAck(const ClientPtr& client, const nlohmann::json& msg);
+    void handleTimeSync(const ClientPtr& client, const nlohmann::json& msg);
+    void sendStats(const ClientPtr& client);
+    void handleTrace(const ClientPtr& client, const nlohmann::json& msg);
+    void sendCatchUp(const ClientPtr& client, const ClientState& state);
 
     // Send helpers
-    void sendHello(ix::WebSocket* ws);
-    void sendError(ix::WebSocket* ws, const std::string& code,
+    void sendHello(const ClientPtr& client);
+    void sendError(const ClientPtr& client, const std::string& code,
                    const std::string& message, bool recoverable);
-    void sendStatus(ix::WebSocket* ws);
-    void sendMotorStatus(ix::WebSocket* ws, const MotorStatus& status);
-    void sendMotorError(ix::WebSocket* ws, const std::string& code, const std::string& message);
+    // Motor broadcasts use the encoding of the client's latest control request
+    void setBinaryControl(const ClientPtr& client, bool binary);
+    void sendStatus(const ClientPtr& client);
+    void sendBinaryStatus(const ClientPtr& client, const ClientEntry* entry);
+    void sendMotorStatus(const ClientPtr& client, ControlEncoding encoding, const MotorStatus& status,
+                         bool withAccelerometer = true);
+    void sendMotorError(const ClientPtr& client, ControlEncoding encoding, ControlError code,
+                        const std::string& message);
 
     // Frame broadcasting
     void broadcastLoop();
-    void broadcastFrame(uint16_t streamType, const std::vector<uint8_t>& data, uint32_t frameId);
+    void broadcastFrame(uint16_t streamType, const SharedFrame& frame);
+    void broadcastDerivedStreams(const SharedFrame& depthFrame, const SharedFrame& rgbFrame);
+    // Send a per-client encoding of one frame, encoding once per distinct key
+    void broadcastEncoded(uint16_t streamType, uint32_t frameId,
+                          const std::function<uint64_t(const ClientState&)>& keyOf,
+                          const std::function<SharedFrame(const ClientState&)>& encode);
+    void updateRateControl();  // Per-client throughput estimate and variant choice
+    // Send a frame to one client, or hold it for the client's bundle
+    void deliver(const ClientEntry& entry, const SharedFrame& frame);
+    void flushBundles(uint32_t frameId, uint64_t captureTimeMs);
 
     // Kinect callbacks
     void onDepthFrame(const void* data, uint32_t timestamp);
@@ -155,13 +256,87 @@ private:
     void generateMockDepthFrame(std::vector<uint8_t>& data, uint32_t frameId);
 
     // Server state
-    std::unique_ptr<ix::WebSocketServer> server_;
+    std::unique_ptr<BridgeTransport> transport_;
+    TransportKind transportKind_ = TransportKind::IXWebSocket;
+    int ioThreads_ = 2;
+    SendDeadlines sendDeadlines_;
     std::atomic<bool> running_{false};
     int port_ = 8765;
 
-    // Client management
-    mutable std::mutex clientsMutex_;
-    std::unordered_map<ix::WebSocket*, ClientState> clients_;
+    // Unix domain socket listener for same-host consumers
+    std::string unixPath_;
+    std::unique_ptr<BridgeTransport> unixTransport_;
+
+    // Shared-memory ring for same-host consumers
+    std::string shmName_;
+    std::unique_ptr<ShmRingWriter> shmRing_;
+    void publishShared(const SharedFrame& frame, uint16_t streamType);
+
+    // UDP multicast for LAN viewers
+    MulticastConfig multicastConfig_;
+    bool multicastEnabled_ = false;
+    std::unique_ptr<MulticastSender> multicast_;
+    void publishMulticast(const SharedFrame& frame, uint16_t streamType);
+
+    // Meshes for the mesh stream, built in parallel row bands
+    DepthMesher mesher_;
+
+    // Keyed and contours streams: color registration and the shared background model
+    DepthKeyer keyer_;
+    ContourTracer contourTracer_;
+
+    // Each bundling client's messages for the frame being broadcast (broadcasting thread only)
+    FrameBundler bundler_;
+
+    // Stage stamps of recent frames and latency histograms (latency_trace.h)
+    LatencyTracer tracer_;
+
+    // Reference images for dirty-tile updates; used by the broadcasting thread
+    TileEncoder rgbTiles_{STREAM_TYPE_RGB};
+    TileEncoder depthTiles_{STREAM_TYPE_DEPTH};
+
+    // Recent frames for rewind and late-joiner catch-up
+    double historySeconds_ = 0.0;
+    std::unique_ptr<FrameHistory> history_;
+
+    // HTTP snapshot and MJPEG endpoints (reactor transport only)
+    SnapshotCache snapshots_;
+    std::mutex mjpegMutex_;
+    std::vector<ClientPtr> mjpegViewers_;
+    std::atomic<size_t> mjpegViewerCount_{0};
+    uint32_t lastMjpegFrameId_ = 0;  // Broadcast thread only
+    void sendSnapshot(const ClientPtr& client, SnapshotFormat format);
+    void addMjpegViewer(const ClientPtr& client);
+    void publishMjpeg();
+
+    // Relay mode: upstream bridge feeding the broadcast path
+    struct RelayStats {
+        std::atomic<bool> connected{false};
+        std::atomic<uint64_t> framesForwarded{0};
+        std::atomic<uint64_t> reconnects{0};
+        // Receive → forward time on this hop, reset every stats window
+        std::atomic<uint64_t> hopSumNs{0};
+        std::atomic<uint64_t> hopCount{0};
+        std::atomic<uint64_t> hopMaxNs{0};
+        // Half the upstream status round trip (link latency estimate)
+        std::atomic<int64_t> linkLatencyUs{-1};
+    };
+    std::string relayUrl_;
+    RelayStats relayStats_;
+    std::string upstreamRelayStatus_;  // Upstream's "relay" status (JSON), guarded by statsMutex_
+    SharedFrame relayRgbFrame_;  // Newest upstream RGB, colors relayed point clouds (relay thread only)
+    void relayLoop();
+    void forwardUpstreamFrame(WsMessage message, std::chrono::steady_clock::time_point receivedAt);
+    void forwardUpstreamPart(const SharedFrame& frame);  // One stream's message
+
+    // Consumers the server cannot see, which keep the Kinect streams running
+    bool hasPassiveConsumers() const { return shmRing_ || multicast_; }
+
+    // Consumers other than WebSocket clients that need the Kinect streams
+    bool hasOtherConsumers() const { return hasPassiveConsumers() || mjpegViewerCount_ > 0; }
+
+    // Client management (snapshot reads are lock-free)
+    ClientRegistry clients_;
 
     // Frame cache
     BridgeFrameCache frameCache_;
@@ -181,6 +356,17 @@ private:
     std::atomic<uint32_t> framesSent_{0};
     std::atomic<uint32_t> droppedFrames_{0};
 
+    // Metrics; hot paths update the registered series without locking
+    void registerMetrics();
+    void registerLockMetrics();
+    MetricsRegistry metrics_;
+    size_t lockMetricsCount_ = 0;  // LockStats entries registered, guarded by statsMutex_
+    Counter* deviceFrames_[2] = {};  // RGB, depth
+    Counter* bytesQueued_ = nullptr;
+    Counter* broadcasts_ = nullptr;
+    std::array<LatencyHistogram*, STREAM_TYPE_COUNT> encodeTime_{};
+    std::array<Counter*, STREAM_TYPE_COUNT> encodes_{};
+
     // FPS tracking
     std::atomic<uint32_t> rgbFrameCount_{0};
     std::atomic<uint32_t> depthFrameCount_{0};
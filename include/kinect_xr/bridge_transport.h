@@ -0,0 +1,142 @@
+/**
+ * @file bridge_transport.h
+ * @brief Transport abstraction for the bridge server
+ *
+ * BridgeServer speaks the bridge protocol; a BridgeTransport owns the sockets
+ * and delivers connection events. Two WebSocket transports exist:
+ *   - IxTransport: IXWebSocket (one thread per connection)
+ *   - ReactorTransport: epoll/kqueue reactor with a fixed pool of I/O threads
+ *
+ * ReactorTransport also hands plain HTTP GET requests (no Upgrade header) to
+ * onHttp, so snapshot endpoints can share the WebSocket port.
+ */
+
+#pragma once
+
+#include "kinect_xr/send_queue.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace kinect_xr {
+
+/**
+ * @brief One connected client, independent of the transport behind it
+ *
+ * All methods are thread-safe and become no-ops once the connection closed.
+ */
+class ClientConnection {
+public:
+    virtual ~ClientConnection() = default;
+
+    /**
+     * @brief Queue a text (JSON) message
+     */
+    virtual void sendText(const std::string& text) = 0;
+
+    /**
+     * @brief Queue a pre-framed message shared with other clients
+     */
+    virtual void sendFrame(const SharedFrame& frame) = 0;
+
+    /**
+     * @brief Bytes queued for this client but not yet written to the socket
+     */
+    virtual size_t bufferedBytes() const = 0;
+
+    /**
+     * @brief Close the connection (onClose is still delivered)
+     *
+     * For HTTP connections this closes the socket once queued bytes are written.
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief False once the connection closed or is closing
+     */
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Per-priority queue state (scheduled is false without send scheduling)
+     */
+    virtual SendQueueStats sendStats() const { return {}; }
+};
+
+using ClientPtr = std::shared_ptr<ClientConnection>;
+
+/**
+ * @brief Connection events delivered by a transport
+ *
+ * Callbacks may run on any transport thread. onClose is delivered exactly
+ * once per opened WebSocket connection.
+ *
+ * onHttp receives the request target (path and query) of a plain HTTP GET.
+ * The handler writes a complete response with sendFrame(FramedMessage::raw())
+ * and either calls close() or keeps the connection for a streaming response.
+ * Returning false makes the transport answer 404; without onHttp, plain
+ * requests get 400 as before. HTTP connections never see
+ * onOpen/onClose; use isOpen() to notice when a streaming client went away.
+ *
+ * onBinary receives binary client messages (see control_codec.h); the data
+ * is only valid during the call.
+ */
+struct TransportCallbacks {
+    std::function<void(const ClientPtr&)> onOpen;
+    std::function<void(const ClientPtr&, const std::string&)> onMessage;
+    std::function<void(const ClientPtr&, const uint8_t*, size_t)> onBinary;
+    std::function<void(const ClientPtr&)> onClose;
+    std::function<bool(const ClientPtr&, const std::string&)> onHttp;
+};
+
+/**
+ * @brief Server-side socket transport
+ */
+class BridgeTransport {
+public:
+    virtual ~BridgeTransport() = default;
+
+    /**
+     * @brief Start listening
+     * @param port TCP port to bind on all interfaces
+     * @param callbacks Connection event handlers
+     * @return true if listening
+     */
+    virtual bool start(int port, const TransportCallbacks& callbacks) = 0;
+
+    /**
+     * @brief Stop listening and close all connections
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Short name for logs ("ix", "epoll")
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Deadlines for per-client send scheduling (call before start)
+     *
+     * Ignored by transports that send in arrival order (IXWebSocket).
+     */
+    virtual void setSendDeadlines(const SendDeadlines&) {}
+};
+
+/**
+ * @brief Selectable WebSocket transports
+ */
+enum class TransportKind {
+    IXWebSocket,
+    Reactor
+};
+
+/**
+ * @brief Create a WebSocket transport
+ * @param kind Transport implementation
+ * @param ioThreads Number of I/O threads (Reactor only)
+ */
+std::unique_ptr<BridgeTransport> createTransport(TransportKind kind, int ioThreads = 2);
+
+}  // namespace kinect_xr
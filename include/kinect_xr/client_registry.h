@@ -0,0 +1,173 @@
+/**
+ * @file client_registry.h
+ * @brief Copy-on-write registry of connected bridge clients
+ *
+ * Readers (frame and motor broadcasts, client counts) take an immutable
+ * snapshot with a single atomic load and iterate it without holding a lock.
+ * Writers (connect, disconnect, subscribe) build a new snapshot and publish
+ * it atomically, so a burst of connections never delays frame delivery.
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/clock_sync.h"
+#include "kinect_xr/depth_contour.h"
+#include "kinect_xr/depth_key.h"
+#include "kinect_xr/depth_mesh.h"
+#include "kinect_xr/depth_packing.h"
+#include "kinect_xr/latency_trace.h"
+#include "kinect_xr/lock_stats.h"
+#include "kinect_xr/pixel_format.h"
+#include "kinect_xr/point_cloud.h"
+#include "kinect_xr/rate_controller.h"
+#include "kinect_xr/tile_update.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kinect_xr {
+
+/**
+ * @brief Client subscription state
+ */
+struct ClientState {
+    bool subscribedRgb = false;
+    PixelFormat rgbFormat = PixelFormat::Rgb888;
+    bool subscribedDepth = false;
+    DepthPacking depthPacking = DepthPacking::None;
+    bool subscribedPointCloud = false;
+    PointCloudParams pointCloud;
+    bool subscribedMesh = false;
+    MeshParams mesh;
+    bool subscribedKeyed = false;
+    KeyParams keying;
+    bool subscribedContours = false;
+    ContourParams contours;
+    bool adaptive = false;  // Accepts downscaled frames (FRAME_FLAG_SCALE_MASK)
+    bool tiles = false;     // Accepts dirty-tile RGB and depth updates (FRAME_FLAG_TILES)
+    bool bundle = false;    // Gets each frame's messages as one bundle (STREAM_TYPE_BUNDLE)
+
+    /**
+     * @brief Whether frames of the given stream type go to this client
+     */
+    bool isSubscribed(uint16_t streamType) const {
+        switch (streamType) {
+            case STREAM_TYPE_RGB:
+                return subscribedRgb;
+            case STREAM_TYPE_DEPTH:
+                return subscribedDepth;
+            case STREAM_TYPE_POINTCLOUD:
+                return subscribedPointCloud;
+            case STREAM_TYPE_MESH:
+                return subscribedMesh;
+            case STREAM_TYPE_KEYED:
+                return subscribedKeyed;
+            case STREAM_TYPE_CONTOURS:
+                return subscribedContours;
+            default:
+                return false;
+        }
+    }
+};
+
+/**
+ * @brief Per-connection state that survives subscription changes
+ */
+struct ClientSession {
+    std::atomic<bool> binaryControl{false};  // Has sent binary control messages; gets binary replies
+    LatencyHistograms latency;               // Spans measured from this client's acks
+    ClockSync clock;                         // Offset and round trip from time.sync
+};
+
+/**
+ * @brief One client and its state as of a snapshot
+ */
+struct ClientEntry {
+    ClientPtr client;
+    ClientState state;
+    std::shared_ptr<RateController> rate;    // Mutable, shared by all snapshots of this client
+    std::shared_ptr<TileSync> tiles;         // Mutable, reset when the subscription changes
+    std::shared_ptr<ClientSession> session;  // Mutable, for the life of the connection
+};
+
+/**
+ * @brief Immutable view of all clients, indexed by subscribed stream
+ *
+ * Entries are never modified after publication; hold the shared_ptr for as
+ * long as the entries are in use.
+ */
+struct ClientSnapshot {
+    std::vector<ClientEntry> clients;
+    std::array<std::vector<const ClientEntry*>, STREAM_TYPE_COUNT> subscribers;
+
+    ClientSnapshot() = default;
+    ClientSnapshot(const ClientSnapshot&) = delete;  // subscribers point into clients
+    ClientSnapshot& operator=(const ClientSnapshot&) = delete;
+
+    /**
+     * @brief Clients subscribed to a stream type (empty for unknown types)
+     */
+    const std::vector<const ClientEntry*>& subscribersOf(uint16_t streamType) const;
+
+    /**
+     * @brief Find a client's entry, or nullptr
+     */
+    const ClientEntry* find(const ClientPtr& client) const;
+};
+
+using ClientSnapshotPtr = std::shared_ptr<const ClientSnapshot>;
+
+/**
+ * @brief Registry of connected clients with lock-free reads
+ *
+ * Usage:
+ *   registry.add(client);
+ *   auto snapshot = registry.snapshot();
+ *   for (auto* entry : snapshot->subscribersOf(STREAM_TYPE_DEPTH)) { ... }
+ */
+class ClientRegistry {
+public:
+    ClientRegistry();
+
+    /**
+     * @brief Current snapshot (never null)
+     */
+    ClientSnapshotPtr snapshot() const;
+
+    /**
+     * @brief Add a client with default state
+     * @return Client count after the change
+     */
+    size_t add(const ClientPtr& client);
+
+    /**
+     * @brief Remove a client
+     * @return Client count after the change
+     */
+    size_t remove(const ClientPtr& client);
+
+    /**
+     * @brief Replace a client's state
+     * @return false if the client is not registered
+     */
+    bool update(const ClientPtr& client, const ClientState& state);
+
+    /**
+     * @brief Number of registered clients
+     */
+    size_t size() const { return snapshot()->clients.size(); }
+
+private:
+    // Rebuild per-stream subscriber lists and publish; caller holds writeMutex_
+    void publish(std::vector<ClientEntry> clients);
+
+    NamedMutex writeMutex_{"clients"};  // Serializes writers only
+    ClientSnapshotPtr snapshot_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,103 @@
+/**
+ * @file clock_sync.h
+ * @brief NTP-style clock offset and round-trip estimation for one client
+ *
+ * Client timings (receive, render) could not be compared with bridge
+ * timestamps because the two clocks share no time base. Clients run a
+ * four-timestamp exchange over the bridge connection:
+ *
+ *   client → {"type":"time.sync","id":N,"t0":T0}
+ *   bridge → {"type":"time.sync","id":N,"t0":T0,"t1":T1,"t2":T2}
+ *   client → {"type":"time.sync","id":N+1,"t0":...,"prev_id":N,"prev_t3":T3}
+ *
+ * T0 and T3 are client wall-clock, T1 and T2 bridge wall-clock milliseconds
+ * since the Unix epoch (fractions allowed). The next request reports when
+ * the previous reply arrived, so both ends compute the same samples:
+ *
+ *   offset = ((T1 - T0) + (T2 - T3)) / 2   bridge clock minus client clock
+ *   rtt    = (T3 - T0) - (T2 - T1)
+ *
+ * Like NTP's clock filter, the offset is taken from the sample with the
+ * lowest round trip among the last WINDOW, since queueing delays the two
+ * directions unequally. The round trip is also smoothed with TCP-style
+ * SRTT/RTTVAR averages.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace kinect_xr {
+
+/**
+ * @brief Filtered clock estimate, microseconds
+ */
+struct ClockEstimate {
+    bool valid = false;        // At least one sample
+    int64_t offsetUs = 0;      // Bridge clock minus client clock
+    uint64_t minRttUs = 0;     // Lowest round trip in the window; the offset's sample
+    uint64_t smoothedRttUs = 0;
+    uint64_t jitterUs = 0;     // Mean deviation of the round trip
+    uint64_t samples = 0;
+};
+
+/**
+ * @brief Offset and round-trip filter for one client
+ *
+ * Thread-safe; the bridge records exchanges from the client's message
+ * handler and reads the estimate from the broadcast and status paths.
+ */
+class ClockSync {
+public:
+    static constexpr size_t WINDOW = 8;
+
+    /**
+     * @brief Add one exchange (all times in microseconds)
+     * @return false if the timestamps are inconsistent (negative round trip)
+     */
+    bool addSample(int64_t t0, int64_t t1, int64_t t2, int64_t t3);
+
+    /**
+     * @brief Remember the reply just sent, to be completed by prev_t3
+     */
+    void replied(uint32_t id, int64_t t0, int64_t t1, int64_t t2);
+
+    /**
+     * @brief Complete the last reply with the client's receive time
+     * @return false if id is not the last reply or the sample was rejected
+     */
+    bool complete(uint32_t id, int64_t t3);
+
+    ClockEstimate estimate() const;
+
+    /**
+     * @brief Client wall-clock time converted to the bridge clock
+     */
+    int64_t toBridgeUs(int64_t clientUs) const;
+
+private:
+    struct Sample {
+        int64_t offsetUs;
+        uint64_t rttUs;
+    };
+
+    struct Pending {
+        bool valid = false;
+        uint32_t id = 0;
+        int64_t t0 = 0;
+        int64_t t1 = 0;
+        int64_t t2 = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::array<Sample, WINDOW> window_{};
+    size_t samples_ = 0;
+    double smoothedRttUs_ = 0;
+    double jitterUs_ = 0;
+    Pending pending_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,175 @@
+/**
+ * @file control_codec.h
+ * @brief Compact binary encoding of motor, status and error messages
+ *
+ * Control messages are JSON by default. High-rate control clients (a
+ * joystick steering the tilt, stats polled every frame) can use this
+ * fixed-layout encoding instead: hello advertises it under
+ * capabilities.control. The encoding of a client's latest control request
+ * decides the encoding of its motor, status and error replies and of the
+ * motor status broadcasts it receives. Decoding reads the received bytes in
+ * place and allocates nothing; replies are built in a fixed buffer and cost
+ * one message allocation.
+ *
+ * A control message is a binary WebSocket message with the 8-byte bridge
+ * header (frame ID 0, stream type STREAM_TYPE_CONTROL, flags 0) followed by
+ * one or more records, all little-endian:
+ *
+ *   uint16 type, uint16 length, then length bytes of value
+ *
+ * Requests (client to server):
+ *   0x0001 motor.setTilt    int16 angle in tenths of a degree
+ *   0x0002 motor.setLed     uint8 LED state (off 0, green 1, red 2, yellow 3,
+ *                           blink_green 4, blink_red_yellow 6)
+ *   0x0003 motor.reset      empty
+ *   0x0004 motor.getStatus  empty
+ *   0x0005 status           empty
+ *
+ * Replies and events (server to client):
+ *   0x0101 motor.status  int16 angle in tenths of a degree (-32768 while
+ *                        moving), uint8 status (0 stopped, 1 at limit,
+ *                        4 moving), uint8 flags (0x01: accelerometer
+ *                        follows), then optionally 3 x int16 x/y/z in
+ *                        hundredths of m/s^2
+ *   0x0102 status        ControlStatus, CONTROL_STATUS_SIZE bytes
+ *   0x01FF error         uint16 ControlError, then a UTF-8 message
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/device.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kinect_xr {
+
+constexpr size_t CONTROL_RECORD_HEADER_SIZE = 4;
+constexpr size_t CONTROL_MAX_MESSAGE_SIZE = 256;  // Server replies; requests may be longer
+constexpr size_t CONTROL_STATUS_SIZE = 32;
+constexpr int16_t CONTROL_ANGLE_UNKNOWN = INT16_MIN;
+constexpr uint8_t CONTROL_MOTOR_FLAG_ACCEL = 0x01;
+
+enum class ControlType : uint16_t {
+    MotorSetTilt = 0x0001,
+    MotorSetLed = 0x0002,
+    MotorReset = 0x0003,
+    MotorGetStatus = 0x0004,
+    Status = 0x0005,
+    MotorStatus = 0x0101,
+    StatusReply = 0x0102,
+    Error = 0x01FF
+};
+
+/**
+ * @brief Control error codes; the JSON "code" is controlErrorName()
+ */
+enum class ControlError : uint16_t {
+    ProtocolError = 1,
+    DeviceNotConnected = 2,
+    RateLimited = 3,
+    MotorControlFailed = 4,
+    LedControlFailed = 5,
+    MotorStatusFailed = 6,
+    InvalidLedState = 7
+};
+
+/**
+ * @brief JSON code of an error ("RATE_LIMITED", ...)
+ */
+const char* controlErrorName(ControlError error);
+
+/**
+ * @brief The binary status reply: bridge counters and the client's own delivery
+ *
+ * Layout (offsets in bytes): 0 frame_id u32, 4 dropped_frames u32,
+ * 8 clients_connected u16, 10 kinect_connected u8, 11 reserved,
+ * 12 scale u8, 13 frame_divider u8, 14 reserved u16, 16 estimated_kbps u32,
+ * 20 queued_bytes u32, 24 queue_ms u32, 28 frames_skipped u32.
+ * The JSON status message carries the full report (history, relay, ...).
+ */
+struct ControlStatus {
+    uint32_t frameId = 0;
+    uint32_t droppedFrames = 0;
+    uint16_t clientsConnected = 0;
+    bool kinectConnected = false;
+    uint8_t scale = 1;
+    uint8_t frameDivider = 1;
+    uint32_t estimatedKbps = 0;
+    uint32_t queuedBytes = 0;
+    uint32_t queueMs = 0;
+    uint32_t framesSkipped = 0;
+};
+
+/**
+ * @brief One record of a received control message; value points into it
+ */
+struct ControlRecord {
+    ControlType type = ControlType::Status;
+    const uint8_t* value = nullptr;
+    uint16_t length = 0;
+
+    // Value readers; false if the record is too short
+    bool readInt16(int16_t& out) const;
+    bool readUint8(uint8_t& out) const;
+};
+
+/**
+ * @brief Iterates the records of a received control message in place
+ *
+ * Usage:
+ *   ControlReader reader(data, size);
+ *   ControlRecord record;
+ *   while (reader.next(record)) { ... }
+ *   if (reader.failed()) { malformed }
+ */
+class ControlReader {
+public:
+    ControlReader(const uint8_t* message, size_t size);
+
+    bool next(ControlRecord& record);
+
+    /**
+     * @brief Not a control message, or a record overruns the message
+     */
+    bool failed() const { return failed_; }
+
+private:
+    const uint8_t* cursor_;
+    const uint8_t* end_;
+    bool failed_ = false;
+};
+
+/**
+ * @brief Builds a server control message in a fixed buffer
+ */
+class ControlWriter {
+public:
+    ControlWriter();
+
+    /**
+     * @brief Append a record; false (message unchanged) if it does not fit
+     */
+    bool add(ControlType type, const uint8_t* value, size_t length);
+
+    bool addMotorStatus(const MotorStatus& status, bool withAccelerometer);
+    bool addStatus(const ControlStatus& status);
+    bool addError(ControlError error, const std::string& message);
+
+    bool empty() const { return size_ == FRAME_HEADER_SIZE; }
+
+    /**
+     * @brief The message so far, ready to send
+     */
+    SharedFrame frame() const;
+
+private:
+    std::array<uint8_t, CONTROL_MAX_MESSAGE_SIZE> buffer_{};
+    size_t size_;
+};
+
+}  // namespace kinect_xr
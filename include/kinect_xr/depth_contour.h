@@ -0,0 +1,143 @@
+/**
+ * @file depth_contour.h
+ * @brief Silhouette polygons traced from depth masks (contours stream)
+ *
+ * Clients that only draw outlines do not need pixels. The depth image is
+ * keyed into a binary mask exactly like the keyed stream (depth range or
+ * learned background, see depth_key.h), marching squares traces the mask
+ * boundaries into closed polygons and Douglas-Peucker simplification
+ * removes points that lie within a tolerance of a straight line. A frame of
+ * outlines is typically a few kilobytes.
+ *
+ * Payload after the 8-byte bridge header (all little-endian):
+ *
+ *   offset 0   uint16  polygon count P
+ *   offset 2   uint8   grid step in pixels
+ *   offset 3   uint8   flags (KEY_FLAG_LEARNING)
+ *   offset 4   uint32  total point count
+ *   offset 8   P polygons, each:
+ *                uint16  point count N
+ *                uint16  flags (CONTOUR_FLAG_HOLE)
+ *                N * 2   int16 x, y in half pixels
+ *
+ * Coordinates are in depth image pixels times two; pixel centres are at
+ * whole pixels, so the value 2u is the centre of column u. Polygons are
+ * closed (the last point connects to the first). Outer boundaries run
+ * clockwise on screen and holes counter-clockwise, so either a non-zero or
+ * an even-odd fill draws the silhouettes.
+ */
+
+#pragma once
+
+#include "kinect_xr/depth_key.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr size_t CONTOUR_HEADER_SIZE = 8;  // Follows the bridge frame header
+constexpr uint16_t CONTOUR_FLAG_HOLE = 0x0001;  // Polygon bounds a hole in a silhouette
+constexpr uint32_t CONTOUR_MAX_POLYGON_POINTS = 0xFFFF;
+constexpr uint16_t CONTOUR_MAX_DEPTH_MM = 0x3FFF;  // Depth limits fit the key() packing
+constexpr uint16_t CONTOUR_MAX_TOLERANCE_MM = 0xFFF;
+constexpr uint16_t CONTOUR_MAX_EPSILON_TENTHS = 127;  // 12.7 px
+constexpr uint16_t CONTOUR_MAX_AREA_PX = 0x3FFF;
+
+/**
+ * @brief Per-client contour options (from the subscribe message)
+ */
+struct ContourParams {
+    KeyMode mode = KeyMode::Range;
+    uint16_t minDepthMm = 500;       // Range limits; also applied in background mode
+    uint16_t maxDepthMm = 1500;      // 0 = no limit
+    uint16_t toleranceMm = 100;      // Background: kept when at least this much nearer
+    uint8_t step = 2;                // Mask grid spacing in pixels: 1, 2, 4 or 8
+    uint8_t epsilonTenthsPx = 15;    // Douglas-Peucker tolerance, tenths of a pixel
+    uint16_t minAreaPx = 64;         // Drop polygons enclosing less, in square pixels
+
+    /**
+     * @brief The mask half of the options, in the keyer's terms
+     */
+    KeyParams keying() const;
+
+    /**
+     * @brief Identifies the parameter set, so equal requests share one frame
+     *
+     * Fields are packed assuming the limits above, which the subscribe
+     * parser enforces.
+     */
+    uint64_t key() const {
+        uint64_t stepBits = step >= 8 ? 3 : step >= 4 ? 2 : step >= 2 ? 1 : 0;
+        return static_cast<uint64_t>(mode) | (stepBits << 1) |
+               (static_cast<uint64_t>(epsilonTenthsPx & 0x7F) << 3) |
+               (static_cast<uint64_t>(minDepthMm & 0x3FFF) << 10) |
+               (static_cast<uint64_t>(maxDepthMm & 0x3FFF) << 24) |
+               (static_cast<uint64_t>(toleranceMm & 0xFFF) << 38) |
+               (static_cast<uint64_t>(minAreaPx & 0x3FFF) << 50);
+    }
+
+    /**
+     * @brief Payload size used for the rate control budget (typical upper estimate)
+     */
+    size_t maxPayloadBytes() const;
+};
+
+/**
+ * @brief Whether a contour grid step is supported
+ */
+inline bool isValidContourStep(uint32_t step) {
+    return step == 1 || step == 2 || step == 4 || step == 8;
+}
+
+/**
+ * @brief Traces and simplifies mask boundaries into contour frames
+ *
+ * Thread-safe; calls are serialized so scratch buffers are reused.
+ *
+ * Usage:
+ *   ContourTracer tracer;
+ *   keyer.keyMask(depth, params.keying(), params.step, mask);
+ *   SharedFrame outlines = tracer.encode(frameId, mask, params, 0);
+ */
+class ContourTracer {
+public:
+    ContourTracer() = default;
+
+    ContourTracer(const ContourTracer&) = delete;
+    ContourTracer& operator=(const ContourTracer&) = delete;
+
+    /**
+     * @brief Build a contours bridge frame from a binary mask
+     * @param mask (640 / step) x (480 / step) row-major, non-zero = inside
+     * @param flags Header flags to pass through (KEY_FLAG_LEARNING)
+     * @return Bridge binary message with stream type STREAM_TYPE_CONTOURS
+     */
+    SharedFrame encode(uint32_t frameId, const std::vector<uint8_t>& mask, const ContourParams& params,
+                       uint8_t flags);
+
+private:
+    struct Point {
+        int16_t x;
+        int16_t y;
+    };
+
+    // Douglas-Peucker on the closed ring in ring_, appending kept points to out
+    void simplify(int64_t epsilonSquared, std::vector<Point>& out);
+
+    std::mutex mutex_;
+    std::vector<uint8_t> padded_;   // Mask with a one-sample empty border, so every ring closes
+    std::vector<uint8_t> cases_;    // Marching-squares case per cell of the padded grid
+    std::vector<uint8_t> visited_;  // Entry edges already traced, one bit per edge
+    std::vector<Point> ring_;
+    std::vector<uint8_t> keep_;
+    std::vector<std::pair<uint32_t, uint32_t>> stack_;
+    std::vector<Point> simplified_;
+    std::vector<std::pair<uint16_t, uint16_t>> polygons_;  // Point count and flags
+};
+
+}  // namespace kinect_xr
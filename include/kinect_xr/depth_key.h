@@ -0,0 +1,189 @@
+/**
+ * @file depth_key.h
+ * @brief Depth-keyed RGBA frames on the bridge (keyed stream)
+ *
+ * A "green screen" without the green: the RGB image is registered to the
+ * depth image and every pixel gets an alpha from its depth, either inside a
+ * configured range or nearer than a learned static background. Thin
+ * clients draw the result straight onto a canvas or texture and never see
+ * depth at all.
+ *
+ * Payload after the 8-byte bridge header (all little-endian):
+ *
+ *   offset 0   uint8   format (KeyFormat)
+ *   offset 1   uint8   flags (KEY_FLAG_LEARNING)
+ *   offset 2   uint16  width
+ *   offset 4   uint16  height
+ *   offset 6   uint16  reserved (0)
+ *   offset 8   uint32  color byte count C
+ *   offset 12  C       Rgba: width * height * 4 straight-alpha RGBA
+ *                      JpegMask: baseline JPEG of the registered RGB
+ *   then       JpegMask only: zlib-deflated width * height 8-bit alpha mask
+ *
+ * Pixels are in the depth camera's image grid.
+ */
+
+#pragma once
+
+#include "kinect_xr/snapshot_encoder.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr size_t KEY_HEADER_SIZE = 12;  // Follows the bridge frame header
+constexpr uint8_t KEY_FLAG_LEARNING = 0x01;  // Background model is still being learned
+constexpr uint32_t KEY_MAX_FEATHER = 8;  // Largest feather radius, in pixels
+constexpr uint32_t KEY_DEFAULT_LEARN_FRAMES = 30;  // ~1 s at 30 Hz
+constexpr uint32_t KEY_MAX_LEARN_FRAMES = 300;
+
+/**
+ * @brief Where the alpha comes from
+ */
+enum class KeyMode : uint8_t {
+    Range = 0,       // Opaque where depth is within [minDepthMm, maxDepthMm]
+    Background = 1,  // Opaque where depth is nearer than the learned background
+};
+
+/**
+ * @brief Keyed frame encodings
+ */
+enum class KeyFormat : uint8_t {
+    Rgba = 0,      // Raw RGBA, ready for ImageData or a texture upload
+    JpegMask = 1,  // JPEG color plus a deflated alpha mask (~10x smaller)
+};
+
+/**
+ * @brief Per-client keying options (from the subscribe message)
+ */
+struct KeyParams {
+    KeyMode mode = KeyMode::Range;
+    KeyFormat format = KeyFormat::Rgba;
+    uint16_t minDepthMm = 500;    // Range limits; also applied in background mode
+    uint16_t maxDepthMm = 1500;   // 0 = no limit
+    uint16_t toleranceMm = 100;   // Background: keyed when at least this much nearer
+    uint8_t featherPx = 0;        // Box-blur radius applied to alpha, 0 to KEY_MAX_FEATHER
+    uint8_t quality = 80;         // JpegMask: JPEG quality (1-100)
+
+    /**
+     * @brief Identifies the parameter set, so equal requests share one frame
+     */
+    uint64_t key() const {
+        return static_cast<uint64_t>(mode) | (static_cast<uint64_t>(format) << 1) |
+               (static_cast<uint64_t>(featherPx & 0xF) << 2) |
+               (static_cast<uint64_t>(quality & 0x7F) << 6) |
+               (static_cast<uint64_t>(minDepthMm) << 13) | (static_cast<uint64_t>(maxDepthMm) << 29) |
+               (static_cast<uint64_t>(toleranceMm & 0x7FFF) << 45);
+    }
+
+    /**
+     * @brief Payload size used for the rate control budget
+     *
+     * Exact for Rgba; for JpegMask a typical upper estimate, since JPEG and
+     * deflate sizes depend on the scene.
+     */
+    size_t maxPayloadBytes() const;
+};
+
+/**
+ * @brief Geometry used to look up the RGB pixel behind each depth pixel
+ *
+ * The Kinect v1 RGB camera sits about 25 mm to the right of the IR camera,
+ * so the offset between the images shrinks with distance. Factory defaults
+ * are close enough for keying; per-device calibration is not read.
+ */
+struct ColorRegistration {
+    DepthIntrinsics depth;
+    DepthIntrinsics rgb;
+    float baselineMm;  // RGB camera position along +X of the depth camera
+
+    static ColorRegistration kinectDefault();
+};
+
+/**
+ * @brief Builds keyed frames and owns the shared background model
+ *
+ * Thread-safe; calls are serialized. The background model is shared by all
+ * clients, so observe() runs once per depth frame, not once per client.
+ *
+ * Usage:
+ *   DepthKeyer keyer;
+ *   keyer.observe(depth);  // Only needed for KeyMode::Background
+ *   SharedFrame keyed = keyer.encode(frameId, depth, rgb, params);
+ */
+class DepthKeyer {
+public:
+    explicit DepthKeyer(const ColorRegistration& registration = ColorRegistration::kinectDefault());
+
+    DepthKeyer(const DepthKeyer&) = delete;
+    DepthKeyer& operator=(const DepthKeyer&) = delete;
+
+    /**
+     * @brief Forget the background and learn it again from the next frames
+     * @param frames Depth frames to learn from (1 to KEY_MAX_LEARN_FRAMES)
+     *
+     * The scene should be empty while learning: every pixel keeps the
+     * farthest reading it sees.
+     */
+    void learnBackground(uint32_t frames = KEY_DEFAULT_LEARN_FRAMES);
+
+    /**
+     * @brief Fold a depth frame into the background model while learning
+     *
+     * The first call ever starts learning with the default frame count.
+     */
+    void observe(const uint8_t* depth);
+
+    /**
+     * @brief Whether a background has been learned
+     */
+    bool backgroundReady() const;
+
+    /**
+     * @brief Build a keyed bridge frame from full-size depth and RGB images
+     * @param depth 640x480 uint16 little-endian depth in millimetres (0 = no reading)
+     * @param rgb 640x480 packed RGB
+     * @return Bridge binary message with stream type STREAM_TYPE_KEYED, or
+     *         nullptr if the JPEG encoder failed
+     */
+    SharedFrame encode(uint32_t frameId, const uint8_t* depth, const uint8_t* rgb,
+                       const KeyParams& params);
+
+    /**
+     * @brief Key depth alone, without color, on a subsampled grid
+     *
+     * Uses the mode, depth range and tolerance of params (the output options
+     * are ignored), so other streams key exactly like the keyed stream.
+     *
+     * @param step Sample every step pixels; mask is (640 / step) x (480 / step)
+     * @param mask Receives 1 for kept samples, 0 otherwise, row-major
+     */
+    void keyMask(const uint8_t* depth, const KeyParams& params, uint32_t step,
+                 std::vector<uint8_t>& mask);
+
+private:
+    // Box-blur one alpha channel in place; stride is the distance between alphas
+    void featherAlpha(uint8_t* alpha, size_t stride, uint32_t radius);
+
+    // Registration tables, in 1/16 pixel: rgb column = colBase[u] - parallax[z]
+    std::vector<int32_t> colBase_;
+    std::vector<int32_t> parallax_;
+    std::vector<int32_t> rgbRow_;  // -1 where the row falls outside the RGB image
+
+    mutable std::mutex mutex_;
+    std::vector<uint16_t> background_;  // Farthest reading per pixel, 0 = none
+    uint32_t learnFramesLeft_ = 0;
+    bool learned_ = false;
+    bool learning_ = false;
+
+    // Scratch, reused across frames
+    std::vector<uint8_t> colorPlane_;
+    std::vector<uint8_t> alphaPlane_;
+    std::vector<uint8_t> blurPlane_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,139 @@
+/**
+ * @file depth_mesh.h
+ * @brief Triangle meshes built from depth on the bridge (mesh stream)
+ *
+ * AR occlusion in the browser needs a surface, not points. The depth image
+ * is an organized point cloud, so neighbouring grid samples are joined into
+ * triangles directly. Triangles that span a depth discontinuity (an object
+ * edge against the background) are dropped instead of being stretched into
+ * a curtain. Optionally, flat regions are merged quadtree-style into larger
+ * cells, so triangles concentrate near edges and curved surfaces.
+ *
+ * Payload after the 8-byte bridge header (all little-endian):
+ *
+ *   offset 0   uint32  vertex count V
+ *   offset 4   uint32  index count I (3 per triangle)
+ *   offset 8   uint8   flags (MESH_FLAG_INDEX32)
+ *   offset 9   uint8   grid step in pixels
+ *   offset 10  uint16  reserved (0)
+ *   offset 12  V * 3   int16 positions x, y, z in millimetres
+ *   then       0 or 2 padding bytes, so 32-bit indices are 4-byte aligned
+ *   then       I       uint16 indices, or uint32 with MESH_FLAG_INDEX32
+ *
+ * Positions use the Kinect sensor frame like the pointcloud stream (+X
+ * right, +Y up, +Z forward). Vertices are in row-major pixel order.
+ * Triangles are (top-left, bottom-left, top-right) and (top-right,
+ * bottom-left, bottom-right) of each cell in image coordinates; render
+ * double-sided if the winding matters.
+ *
+ * Adaptive cells are not stitched to smaller neighbours, so hairline
+ * cracks can appear along T-junctions. They are far below what occlusion
+ * testing notices.
+ */
+
+#pragma once
+
+#include "kinect_xr/snapshot_encoder.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr size_t MESH_HEADER_SIZE = 12;  // Follows the bridge frame header
+constexpr uint8_t MESH_FLAG_INDEX32 = 0x01;
+constexpr uint32_t MESH_MAX_CELL = 32;  // Largest adaptive cell, in pixels
+
+/**
+ * @brief Per-client mesh options (from the subscribe message)
+ */
+struct MeshParams {
+    uint8_t step = 4;                   // Grid spacing in pixels: 1, 2, 4, 8 or 16
+    bool adaptive = false;              // Merge flat regions into cells up to MESH_MAX_CELL
+    uint16_t discontinuityPermille = 20;  // Max depth jump per pixel of edge, per mille of the nearer depth
+    uint16_t flatnessPermille = 5;      // Adaptive: max deviation from a flat cell, per mille of depth
+    uint16_t minDepthMm = 0;            // Samples outside [min, max] are holes; 0 = no limit
+    uint16_t maxDepthMm = 0;
+
+    /**
+     * @brief Identifies the parameter set, so equal requests share one mesh
+     */
+    uint64_t key() const {
+        return static_cast<uint64_t>(step) | (static_cast<uint64_t>(adaptive) << 8) |
+               (static_cast<uint64_t>(discontinuityPermille & 0x3FF) << 9) |
+               (static_cast<uint64_t>(flatnessPermille & 0x3FF) << 19) |
+               (static_cast<uint64_t>(minDepthMm) << 29) | (static_cast<uint64_t>(maxDepthMm) << 45);
+    }
+
+    /**
+     * @brief Payload size of a fully triangulated grid (rate control budget)
+     */
+    size_t maxPayloadBytes() const;
+};
+
+/**
+ * @brief Whether a mesh grid step is supported
+ */
+inline bool isValidMeshStep(uint32_t step) {
+    return step == 1 || step == 2 || step == 4 || step == 8 || step == 16;
+}
+
+/**
+ * @brief Builds mesh frames, splitting each frame into row bands processed in parallel
+ *
+ * Worker threads start on the first encode and are reused for every frame.
+ * encode() may be called from any thread; calls are serialized.
+ *
+ * Usage:
+ *   DepthMesher mesher;
+ *   SharedFrame mesh = mesher.encode(frameId, depth, DepthIntrinsics::kinectDefault(), params);
+ */
+class DepthMesher {
+public:
+    /**
+     * @param threads Row bands per frame (0 = hardware concurrency, at most 4)
+     */
+    explicit DepthMesher(size_t threads = 0);
+    ~DepthMesher();
+
+    DepthMesher(const DepthMesher&) = delete;
+    DepthMesher& operator=(const DepthMesher&) = delete;
+
+    /**
+     * @brief Build a mesh bridge frame from a full-size depth image
+     * @param depth 640x480 uint16 little-endian depth in millimetres (0 = no reading)
+     * @return Bridge binary message with stream type STREAM_TYPE_MESH
+     */
+    SharedFrame encode(uint32_t frameId, const uint8_t* depth, const DepthIntrinsics& intrinsics,
+                       const MeshParams& params);
+
+    /**
+     * @brief Number of row bands each frame is split into
+     */
+    size_t bands() const { return bands_; }
+
+private:
+    // Run work(band) for every band; the calling thread takes band 0
+    void runBands(const std::function<void(size_t)>& work);
+    void workerLoop(size_t band);
+
+    size_t bands_;
+    std::mutex encodeMutex_;  // One frame at a time: the bands share the workers
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t pending_ = 0;
+    bool stopping_ = false;
+};
+
+}  // namespace kinect_xr
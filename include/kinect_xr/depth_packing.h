@@ -0,0 +1,97 @@
+/**
+ * @file depth_packing.h
+ * @brief Bit-packed depth transport formats
+ *
+ * Depth arrives as uint16 millimetres, but the useful range of a Kinect v1
+ * needs only 12 or 13 bits. Clients that do not want an entropy codec can
+ * subscribe to a packed layout and save a fixed 25% (12 bits) or 19%
+ * (13 bits) of the depth bandwidth.
+ *
+ * Packed payloads are a little-endian bit stream: sample i occupies bits
+ * [i * B, i * B + B) counting from bit 0 of byte 0, row-major, with no row
+ * padding. The payload is ceil(width * height * B / 8) bytes. Readings that
+ * do not fit in B bits are sent as 0 (no reading): 12 bits covers 0-4095 mm,
+ * which includes the sensor's rated 0.8-4.0 m range; 13 bits covers
+ * 0-8191 mm, everything the driver reports in practice.
+ *
+ * The packing of a frame is recorded in the header flags
+ * (FRAME_FLAG_DEPTH_PACKING_MASK).
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kinect_xr {
+
+/**
+ * @brief Depth sample layout on the wire
+ */
+enum class DepthPacking : uint8_t {
+    None = 0,    // uint16 little-endian, as captured
+    Bits12 = 1,  // 12-bit samples, 0-4095 mm
+    Bits13 = 2,  // 13-bit samples, 0-8191 mm
+};
+
+constexpr size_t DEPTH_PACKING_COUNT = 3;
+
+/**
+ * @brief Bits per sample of a packing (16 for None)
+ */
+inline uint32_t depthPackingBits(DepthPacking packing) {
+    switch (packing) {
+        case DepthPacking::Bits12:
+            return 12;
+        case DepthPacking::Bits13:
+            return 13;
+        case DepthPacking::None:
+        default:
+            return 16;
+    }
+}
+
+/**
+ * @brief Payload bytes for count samples
+ */
+inline size_t packedDepthSize(size_t count, DepthPacking packing) {
+    return (count * depthPackingBits(packing) + 7) / 8;
+}
+
+/**
+ * @brief Wire name of a packing ("uint16", "packed12", "packed13")
+ */
+const char* depthPackingName(DepthPacking packing);
+
+/**
+ * @brief Parse a wire name
+ * @return false if the name is not a supported packing
+ */
+bool parseDepthPacking(const std::string& name, DepthPacking& packing);
+
+/**
+ * @brief Pack uint16 little-endian depth samples
+ * @param depth count * 2 bytes
+ * @param out packedDepthSize(count, packing) bytes
+ */
+void packDepth(const uint8_t* depth, size_t count, DepthPacking packing, uint8_t* out);
+
+/**
+ * @brief Unpack samples written by packDepth()
+ * @param packed packedDepthSize(count, packing) bytes
+ */
+void unpackDepth(const uint8_t* packed, size_t count, DepthPacking packing, uint16_t* out);
+
+/**
+ * @brief Packed copy of a uint16 depth bridge frame
+ * @return New frame with the packing recorded in the header flags, or nullptr
+ *         if the frame is not an unpacked depth frame or packing is None
+ *
+ * Any scale flags are kept, so full-size and downscaled frames both pack.
+ */
+SharedFrame packDepthFrame(const SharedFrame& frame, DepthPacking packing);
+
+}  // namespace kinect_xr
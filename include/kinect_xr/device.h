@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "kinect_xr/lock_stats.h"
+
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -198,7 +200,7 @@ class KinectDevice {
   VideoCallback video_callback_;
 
   // Thread safety for motor/LED control
-  mutable std::mutex deviceMutex_;
+  mutable NamedMutex deviceMutex_{"device"};
 
   // Static C callback functions for libfreenect
   static void depthCallback(freenect_device* dev, void* depth, uint32_t timestamp);
@@ -0,0 +1,96 @@
+/**
+ * @file frame_bundle.h
+ * @brief Several streams of one frame in a single binary message
+ *
+ * Each stream normally goes out as its own WebSocket message, and clients
+ * pair RGB with depth by frame ID. Clients that opt in ("bundle": true) get
+ * every message of a frame in one bundle instead: one send per frame, and
+ * the streams arrive together or not at all.
+ *
+ * Bundles have stream type STREAM_TYPE_BUNDLE. Payload after the 8-byte
+ * bridge header (all little-endian):
+ *
+ *   offset 0   uint16  part count N
+ *   offset 2   uint16  reserved (0)
+ *   offset 4   uint32  reserved (0)
+ *   offset 8   uint64  capture time, ms since the Unix epoch (0 if unknown)
+ *   offset 16  N x { uint32 offset, uint32 size } of each part, counted from
+ *              the start of the message (bridge header included)
+ *   then       the parts: complete bridge binary messages (8-byte header +
+ *              data) exactly as they would have been sent alone, each
+ *              starting at a multiple of BUNDLE_ALIGNMENT
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr size_t BUNDLE_HEADER_SIZE = 16;      // Follows the bridge frame header
+constexpr size_t BUNDLE_ENTRY_SIZE = 8;        // Offset table entry
+constexpr size_t BUNDLE_ALIGNMENT = 8;         // Parts can be viewed as any typed array
+constexpr size_t BUNDLE_MAX_PARTS = STREAM_TYPE_COUNT;
+
+/**
+ * @brief Byte range of one part inside a bundle message
+ */
+struct BundlePart {
+    const uint8_t* data = nullptr;  // Bridge header of the part
+    size_t size = 0;
+};
+
+/**
+ * @brief Build a bundle from complete binary bridge messages
+ * @return nullptr if parts is empty, too long, or holds a non-binary message
+ */
+SharedFrame bundleFrames(uint32_t frameId, uint64_t captureTimeMs, const std::vector<SharedFrame>& parts);
+
+/**
+ * @brief Locate the parts of a bundle message (payload as received)
+ * @return false if the message is not a well-formed bundle
+ */
+bool splitBundle(const uint8_t* message, size_t size, std::vector<BundlePart>& parts,
+                 uint64_t* captureTimeMs = nullptr);
+
+/**
+ * @brief Collects each bundling client's messages during one frame's broadcast
+ *
+ * Used by the broadcasting thread only. Clients that end up with the same
+ * messages share one bundle; a client with a single message gets it as is.
+ *
+ * Usage:
+ *   bundler.add(client, rgbFrame);
+ *   bundler.add(client, depthFrame);
+ *   bundler.flush(frameId, nowMs, [](const ClientPtr& c, const SharedFrame& f) { c->sendFrame(f); });
+ */
+class FrameBundler {
+public:
+    using SendFn = std::function<void(const ClientPtr&, const SharedFrame&)>;
+
+    void add(const ClientPtr& client, const SharedFrame& frame);
+
+    /**
+     * @brief Send every client's bundle and start over
+     * @return Messages sent
+     */
+    size_t flush(uint32_t frameId, uint64_t captureTimeMs, const SendFn& send);
+
+    bool empty() const { return pending_.empty(); }
+
+private:
+    struct Pending {
+        ClientPtr client;
+        std::vector<SharedFrame> parts;
+    };
+    std::vector<Pending> pending_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,147 @@
+/**
+ * @file frame_history.h
+ * @brief Bounded, compressed history of recent bridge frames
+ *
+ * Keeps the last few seconds of every stream so clients can fetch a frame
+ * they missed (by ID or timestamp), replay a short burst, or catch up
+ * immediately after subscribing. Frames are deflated on a worker thread so
+ * the broadcast loop only pays for queueing a SharedFrame reference.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kinect_xr {
+
+/**
+ * @brief History occupancy and throughput counters
+ */
+struct FrameHistoryStats {
+    size_t frames = 0;
+    size_t rawBytes = 0;         // Uncompressed size of stored frames
+    size_t compressedBytes = 0;  // Memory actually held
+    uint64_t dropped = 0;        // Frames skipped because compression fell behind
+};
+
+/**
+ * @brief Compressed frame ring keyed by stream, frame ID and timestamp
+ *
+ * Returned frames are rebuilt bridge messages with FRAME_FLAG_HISTORY set in
+ * the header, so clients can tell them apart from live frames.
+ *
+ * Usage:
+ *   FrameHistory history(5.0);
+ *   history.push(STREAM_TYPE_DEPTH, frame, nowMs);
+ *   SharedFrame old = history.get(STREAM_TYPE_DEPTH, frameId);
+ */
+class FrameHistory {
+public:
+    /**
+     * @param seconds Time window kept per stream
+     * @param maxBytes Upper bound on compressed memory across all streams
+     */
+    explicit FrameHistory(double seconds, size_t maxBytes = 256u << 20);
+    ~FrameHistory();
+
+    FrameHistory(const FrameHistory&) = delete;
+    FrameHistory& operator=(const FrameHistory&) = delete;
+
+    /**
+     * @brief Queue a live frame for storage
+     * @param frame Bridge binary message (8-byte header + payload)
+     * @param timestampMs Capture time, milliseconds since the Unix epoch
+     *
+     * Repeats of the newest frame ID of a stream are ignored.
+     */
+    void push(uint16_t streamType, const SharedFrame& frame, uint64_t timestampMs);
+
+    /**
+     * @brief Frame by ID, or nullptr if it is not (or no longer) stored
+     */
+    SharedFrame get(uint16_t streamType, uint32_t frameId);
+
+    /**
+     * @brief Newest frame captured at or before timestampMs, or nullptr
+     */
+    SharedFrame getAt(uint16_t streamType, uint64_t timestampMs);
+
+    /**
+     * @brief Newest frame of a stream, or nullptr
+     */
+    SharedFrame latest(uint16_t streamType);
+
+    /**
+     * @brief Up to count most recent frames, oldest first
+     */
+    std::vector<SharedFrame> recent(uint16_t streamType, size_t count);
+
+    /**
+     * @brief All frames captured at or after timestampMs, oldest first
+     */
+    std::vector<SharedFrame> since(uint16_t streamType, uint64_t timestampMs);
+
+    /**
+     * @brief Block until every queued frame has been stored
+     */
+    void flush();
+
+    FrameHistoryStats stats() const;
+    double seconds() const { return windowMs_ / 1000.0; }
+
+private:
+    struct Entry {
+        uint32_t frameId = 0;
+        uint16_t flags = 0;
+        uint64_t timestampMs = 0;
+        size_t rawSize = 0;
+        std::vector<uint8_t> compressed;
+    };
+
+    struct Pending {
+        uint16_t streamType;
+        SharedFrame frame;
+        uint64_t timestampMs;
+    };
+
+    void workerLoop();
+    void store(const Pending& pending);
+    void evict(uint64_t newestMs);
+    SharedFrame inflate(uint16_t streamType, const Entry& entry);
+
+    uint64_t windowMs_;
+    size_t maxBytes_;
+
+    // Stored frames (oldest first per stream)
+    mutable std::mutex mutex_;
+    std::map<uint16_t, std::deque<Entry>> streams_;
+    size_t rawBytes_ = 0;
+    size_t compressedBytes_ = 0;
+
+    // Last frame handed out, so late joiners arriving together share one inflate
+    uint16_t servedType_ = 0;
+    uint32_t servedId_ = 0;
+    SharedFrame served_;
+
+    // Compression queue
+    mutable std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::condition_variable idleCv_;
+    std::deque<Pending> queue_;
+    std::map<uint16_t, uint32_t> lastQueued_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    uint64_t dropped_ = 0;
+    std::thread worker_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,48 @@
+/**
+ * @file ix_transport.h
+ * @brief IXWebSocket-backed bridge transport
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_transport.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ix {
+class WebSocketServer;
+class WebSocket;
+}  // namespace ix
+
+namespace kinect_xr {
+
+class IxConnection;
+
+/**
+ * @brief WebSocket transport on top of ix::WebSocketServer
+ *
+ * IXWebSocket runs one thread per connection and frames every send itself,
+ * so shared frames are passed as a view of their payload.
+ */
+class IxTransport : public BridgeTransport {
+public:
+    IxTransport();
+    ~IxTransport() override;
+
+    bool start(int port, const TransportCallbacks& callbacks) override;
+    void stop() override;
+    const char* name() const override { return "ix"; }
+
+private:
+    std::shared_ptr<IxConnection> findConnection(ix::WebSocket* ws);
+
+    std::unique_ptr<ix::WebSocketServer> server_;
+    TransportCallbacks callbacks_;
+
+    std::mutex connectionsMutex_;
+    std::unordered_map<ix::WebSocket*, std::shared_ptr<IxConnection>> connections_;
+};
+
+}  // namespace kinect_xr
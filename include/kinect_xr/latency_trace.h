@@ -0,0 +1,209 @@
+/**
+ * @file latency_trace.h
+ * @brief Per-frame stage timestamps, client acks and latency histograms
+ *
+ * Every frame the bridge broadcasts is stamped as it moves through the
+ * server (steady clock):
+ *
+ *   captured   device callback (relay: upstream message received)
+ *   dequeued   broadcast loop takes the frame from the cache
+ *   framed     bridge messages built
+ *   enqueued   every stream, derived stream and bundle handed to the
+ *              client send queues
+ *
+ * Socket writes are measured per client by its send queue (send_queue.h).
+ * Clients may acknowledge frames with their own receive and render times:
+ *
+ *   {"type":"ack","frame_id":N,"received_ms":T1,"rendered_ms":T2}
+ *
+ * T1 and T2 are client wall-clock milliseconds since the Unix epoch
+ * (fractions allowed; rendered_ms is optional). For clients that run
+ * time.sync (clock_sync.h) they are moved onto the bridge clock first;
+ * otherwise spans that compare the two clocks are only as accurate as the
+ * clocks agree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace kinect_xr {
+
+/**
+ * @brief Distribution summary, microseconds
+ */
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t meanUs = 0;
+    uint64_t p50Us = 0;
+    uint64_t p90Us = 0;
+    uint64_t p99Us = 0;
+    uint64_t maxUs = 0;
+};
+
+/**
+ * @brief Lock-free latency histogram with ~12% relative resolution
+ *
+ * Log-linear buckets: 8 per power of two, exact below 8 us, up to 2^32 us.
+ * record() is a few relaxed atomic adds and may be called from any thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t BUCKET_COUNT = 30 * SUB_BUCKETS;
+    static constexpr uint64_t MAX_US = (uint64_t{1} << 32) - 1;
+
+    void record(uint64_t us);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sumUs() const { return sumUs_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Samples in buckets that end at or below us (cumulative, for export)
+     */
+    uint64_t countAtOrBelow(uint64_t us) const;
+
+    /**
+     * @brief Value at quantile q (0..1), as the midpoint of its bucket
+     */
+    uint64_t percentileUs(double q) const;
+
+    LatencySummary summary() const;
+
+    // Bucket mapping, exposed for tests
+    static size_t bucketOf(uint64_t us);
+    static uint64_t bucketLow(size_t bucket);
+    static uint64_t bucketHigh(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sumUs_{0};
+    std::atomic<uint64_t> maxUs_{0};
+};
+
+/**
+ * @brief Server stages stamped on each frame
+ */
+enum class TraceStage : uint8_t {
+    Captured = 0,
+    Dequeued,
+    Framed,
+    Enqueued,
+    Count
+};
+
+/**
+ * @brief Measured intervals
+ *
+ * Server spans (bridge clock): Cache = captured→dequeued,
+ * Framing = dequeued→framed, Fanout = framed→enqueued,
+ * Server = captured→enqueued.
+ * Ack spans: ToReceive = capture→client receive and ToRender =
+ * capture→client render (across clocks), Render = receive→render (client
+ * clock), ToAck = captured→ack arrival (bridge clock, includes the return
+ * trip).
+ */
+enum class LatencySpan : uint8_t {
+    Cache = 0,
+    Framing,
+    Fanout,
+    Server,
+    ToReceive,
+    Render,
+    ToRender,
+    ToAck,
+    Count
+};
+
+constexpr size_t LATENCY_SPAN_COUNT = static_cast<size_t>(LatencySpan::Count);
+
+/**
+ * @brief snake_case span name for stats ("cache", "to_render", ...)
+ */
+const char* latencySpanName(LatencySpan span);
+
+/**
+ * @brief One histogram per span
+ */
+struct LatencyHistograms {
+    std::array<LatencyHistogram, LATENCY_SPAN_COUNT> spans;
+
+    LatencyHistogram& operator[](LatencySpan span) { return spans[static_cast<size_t>(span)]; }
+    const LatencyHistogram& operator[](LatencySpan span) const { return spans[static_cast<size_t>(span)]; }
+};
+
+/**
+ * @brief Stage stamps of recent frames and bridge-wide span histograms
+ *
+ * The broadcasting thread calls begin/stamp/finish; ack() may be called from
+ * any thread. Stamps are kept for the last TRACE_FRAMES frame IDs.
+ *
+ * Usage:
+ *   tracer.begin(frameId, capturedAt, captureWallUs);
+ *   tracer.stamp(frameId, TraceStage::Dequeued, dequeuedAt);
+ *   ...
+ *   tracer.finish(frameId);  // Stamps Enqueued, records server spans
+ *   tracer.ack(frameId, receivedWallUs, renderedWallUs, now, &clientHistograms);
+ */
+class LatencyTracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t TRACE_FRAMES = 128;  // ~4 s at 30 fps
+
+    /**
+     * @param capturedAt Capture time on the bridge clock
+     * @param captureWallUs The same instant in wall-clock microseconds since the epoch
+     * @return false if the frame is already traced (sent again, or one of several parts)
+     */
+    bool begin(uint32_t frameId, Clock::time_point capturedAt, uint64_t captureWallUs);
+
+    void stamp(uint32_t frameId, TraceStage stage, Clock::time_point at = Clock::now());
+
+    /**
+     * @brief Stamp Enqueued and record the server spans of a frame
+     */
+    void finish(uint32_t frameId, Clock::time_point at = Clock::now());
+
+    /**
+     * @brief Record a client ack into the bridge-wide and the client's histograms
+     * @param renderedWallUs 0 if the client did not report a render time
+     * @return false if the frame is no longer (or was never) traced
+     */
+    bool ack(uint32_t frameId, uint64_t receivedWallUs, uint64_t renderedWallUs,
+             Clock::time_point arrivedAt, LatencyHistograms* client);
+
+    const LatencyHistograms& histograms() const { return histograms_; }
+
+    uint64_t framesTraced() const { return framesTraced_.load(); }
+    uint64_t acks() const { return acks_.load(); }
+
+private:
+    struct FrameTrace {
+        uint32_t frameId = 0;
+        bool valid = false;
+        uint64_t captureWallUs = 0;
+        std::array<Clock::time_point, static_cast<size_t>(TraceStage::Count)> stages{};
+    };
+
+    FrameTrace* findLocked(uint32_t frameId);
+
+    std::mutex mutex_;
+    std::array<FrameTrace, TRACE_FRAMES> frames_{};
+    LatencyHistograms histograms_;
+    std::atomic<uint64_t> framesTraced_{0};
+    std::atomic<uint64_t> acks_{0};
+};
+
+/**
+ * @brief Wall-clock microseconds since the Unix epoch of a steady-clock instant
+ */
+uint64_t wallClockUs(std::chrono::steady_clock::time_point at);
+
+}  // namespace kinect_xr
@@ -0,0 +1,140 @@
+/**
+ * @file lock_stats.h
+ * @brief Mutex wrapper that records wait time, hold time and contention per named lock
+ *
+ * The frame path is guarded by a handful of mutexes (frame caches, the
+ * client registry's writer lock, the runtime's session and swapchain maps,
+ * libfreenect's device lock). InstrumentedMutex times every acquisition:
+ * how long the caller waited, whether it had to wait at all, and how long
+ * the lock was held. Locks with the same name share one LockStats entry,
+ * so every session's frame cache adds up under one name.
+ *
+ * The hot locks are declared as NamedMutex. Built with KINECT_XR_LOCK_STATS
+ * (cmake -DKINECT_XR_LOCK_STATS=ON) it is an InstrumentedMutex; otherwise
+ * it is a plain std::mutex and the name is discarded. Instrumented, an
+ * acquisition costs two clock reads and a few relaxed atomic adds.
+ *
+ * Usage:
+ *   NamedMutex mutex{"bridge_frame_cache"};
+ *   std::lock_guard<NamedMutex> lock(mutex);
+ *   for (const LockStats* stats : LockStats::all()) { ... }
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef KINECT_XR_LOCK_STATS
+#define KINECT_XR_LOCK_STATS 0
+#endif
+
+namespace kinect_xr {
+
+/**
+ * @brief Counters for every lock sharing one name; never destroyed
+ */
+struct LockStats {
+    explicit LockStats(std::string lockName) : name(std::move(lockName)) {}
+
+    const std::string name;
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};  ///< Acquisitions that had to wait
+    std::atomic<uint64_t> waitNs{0};
+    std::atomic<uint64_t> maxWaitNs{0};
+    std::atomic<uint64_t> holdNs{0};
+    std::atomic<uint64_t> maxHoldNs{0};
+
+    void onAcquired(uint64_t waitedNs, bool wasContended);
+    void onReleased(uint64_t heldNs);
+
+    /**
+     * @brief Entry for `name`, created on first use
+     */
+    static LockStats& named(const char* name);
+
+    /**
+     * @brief Every entry, in creation order (the list only grows)
+     */
+    static std::vector<const LockStats*> all();
+};
+
+/**
+ * @brief std::mutex that reports to LockStats; usable with std::lock_guard
+ *        and std::unique_lock
+ */
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const char* name) : stats_(&LockStats::named(name)) {}
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock() {
+        if (mutex_.try_lock()) {
+            acquiredNs_ = nowNs();
+            stats_->onAcquired(0, false);
+            return;
+        }
+        uint64_t startNs = nowNs();
+        mutex_.lock();
+        acquiredNs_ = nowNs();
+        stats_->onAcquired(acquiredNs_ - startNs, true);
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        acquiredNs_ = nowNs();
+        stats_->onAcquired(0, false);
+        return true;
+    }
+
+    void unlock() {
+        uint64_t heldNs = nowNs() - acquiredNs_;
+        mutex_.unlock();
+        stats_->onReleased(heldNs);
+    }
+
+    const LockStats& stats() const { return *stats_; }
+
+private:
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    std::mutex mutex_;
+    LockStats* stats_;
+    uint64_t acquiredNs_ = 0;  // Written and read by the holder only
+};
+
+#if KINECT_XR_LOCK_STATS
+using NamedMutex = InstrumentedMutex;
+#else
+/**
+ * @brief Plain std::mutex; the name only matters in KINECT_XR_LOCK_STATS builds
+ */
+class NamedMutex {
+public:
+    explicit NamedMutex(const char*) {}
+
+    NamedMutex(const NamedMutex&) = delete;
+    NamedMutex& operator=(const NamedMutex&) = delete;
+
+    void lock() { mutex_.lock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+
+private:
+    std::mutex mutex_;
+};
+#endif
+
+}  // namespace kinect_xr
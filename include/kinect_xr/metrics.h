@@ -0,0 +1,133 @@
+/**
+ * @file metrics.h
+ * @brief Lock-free metrics registry with Prometheus text and JSON export
+ *
+ * Bridge statistics used to be a std::cout line every 10 seconds. The
+ * bridge now registers its metrics once at startup; the hot paths then only
+ * touch atomics (Counter::add, Gauge::set, LatencyHistogram::record) and
+ * never take a lock. Values the bridge already keeps elsewhere (client
+ * counts, tracer histograms) are registered as sampled series that are read
+ * when the metrics are exported.
+ *
+ * Exported over HTTP as Prometheus text (GET /metrics) and as the JSON
+ * reply to {"type":"stats"}. Histograms are log-linear LatencyHistograms,
+ * exported in seconds with power-of-two bucket bounds from 64 us to 16.8 s.
+ */
+
+#pragma once
+
+#include "kinect_xr/latency_trace.h"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kinect_xr {
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+enum class MetricType : uint8_t {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+/**
+ * @brief Monotonic count
+ */
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Value that goes up and down
+ */
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief Named metric series, grouped into families by name
+ *
+ * Registration and export take a lock; updating a registered metric does
+ * not. Registered metrics live as long as the registry. Sampled series and
+ * histogram views must stay valid until the registry is destroyed.
+ *
+ * Usage:
+ *   Counter& frames = registry.counter("kinect_frames_total", "Frames", {{"stream", "rgb"}});
+ *   frames.add();
+ *   std::string text = registry.prometheusText();
+ */
+class MetricsRegistry {
+public:
+    Counter& counter(const std::string& name, const std::string& help, MetricLabels labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, MetricLabels labels = {});
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, MetricLabels labels = {});
+
+    /**
+     * @brief Counter or gauge whose value is read from `sample` on export
+     */
+    void sampled(MetricType type, const std::string& name, const std::string& help, MetricLabels labels,
+                 std::function<double()> sample);
+
+    /**
+     * @brief Export a histogram owned elsewhere
+     */
+    void histogramView(const std::string& name, const std::string& help, MetricLabels labels,
+                       const LatencyHistogram& histogram);
+
+    /**
+     * @brief Prometheus text exposition format (version 0.0.4)
+     */
+    std::string prometheusText() const;
+
+    /**
+     * @brief {name: [{"labels": {...}, "value": N}]}; histograms give a
+     *        latency summary in microseconds instead of a value
+     */
+    nlohmann::json toJson() const;
+
+private:
+    struct Series {
+        MetricLabels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+        const LatencyHistogram* view = nullptr;
+        std::function<double()> sample;
+
+        double value() const;
+        const LatencyHistogram* histogramOf() const { return histogram ? histogram.get() : view; }
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        MetricType type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    Series& add(MetricType type, const std::string& name, const std::string& help, MetricLabels labels);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+};
+
+}  // namespace kinect_xr
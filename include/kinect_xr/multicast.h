@@ -0,0 +1,202 @@
+/**
+ * @file multicast.h
+ * @brief UDP multicast frame distribution for LAN viewers
+ *
+ * Each frame is split into datagrams that fit the path MTU. Every datagram
+ * carries a fragment header, so receivers can reassemble out of order and
+ * tell exactly what was lost. Optional FEC adds one XOR parity datagram per
+ * group of N fragments, which repairs any single loss within the group.
+ *
+ * Fragment header (28 bytes, little-endian):
+ *   0  u16 magic ("KM")     12 u16 streamType     24 u16 fragmentSize
+ *   2  u8  version          14 u16 frame flags    26 u8  fecGroup (0 = none)
+ *   3  u8  kind (data/parity) 16 u32 frameSize    27 u8  reserved
+ *   4  u32 frameId          20 u32 offset
+ *   8  u32 sequence (per stream, for loss detection)
+ *
+ * For parity datagrams, offset is that of the group's first fragment and the
+ * payload is the XOR of the group's fragments, each zero-padded to
+ * fragmentSize.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr uint16_t MULTICAST_MAGIC = 0x4D4B;  // "KM"
+constexpr uint8_t MULTICAST_VERSION = 1;
+constexpr size_t MULTICAST_HEADER_SIZE = 28;
+constexpr size_t MULTICAST_DEFAULT_DATAGRAM = 1472;  // 1500 MTU - IPv4 - UDP
+
+/**
+ * @brief Multicast group and fragmentation settings
+ */
+struct MulticastConfig {
+    std::string group = "239.255.42.99";
+    int port = 5004;
+    std::string interfaceAddr;  // Empty = default route; "127.0.0.1" for loopback
+    int ttl = 1;                // Stay on the local segment
+    size_t datagramSize = MULTICAST_DEFAULT_DATAGRAM;
+    int fecGroup = 0;           // Fragments per parity datagram (0 = no FEC)
+};
+
+/**
+ * @brief Split one frame into datagrams (header + payload)
+ * @param emit Called once per datagram, in send order
+ * @return Number of datagrams emitted (0 if the settings are invalid)
+ */
+size_t fragmentFrame(const MulticastConfig& config, uint16_t streamType, uint32_t frameId,
+                     uint32_t sequence, const uint8_t* data, size_t size, uint16_t flags,
+                     const std::function<void(const uint8_t*, size_t)>& emit);
+
+/**
+ * @brief Sends frames to a multicast group
+ *
+ * Usage:
+ *   MulticastSender sender;
+ *   sender.open(config);
+ *   sender.send(STREAM_TYPE_DEPTH, frameId, data, size);
+ */
+class MulticastSender {
+public:
+    MulticastSender() = default;
+    ~MulticastSender();
+
+    MulticastSender(const MulticastSender&) = delete;
+    MulticastSender& operator=(const MulticastSender&) = delete;
+
+    bool open(const MulticastConfig& config);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Fragment and send one frame
+     * @return false if any datagram could not be sent
+     */
+    bool send(uint16_t streamType, uint32_t frameId, const uint8_t* data, size_t size,
+              uint16_t flags = 0);
+
+    uint64_t datagramsSent() const { return datagramsSent_; }
+
+private:
+    int fd_ = -1;
+    MulticastConfig config_;
+    std::map<uint16_t, uint32_t> sequences_;
+    uint64_t datagramsSent_ = 0;
+};
+
+/**
+ * @brief One reassembled frame
+ */
+struct MulticastFrame {
+    uint16_t streamType = 0;
+    uint16_t flags = 0;
+    uint32_t frameId = 0;
+    uint32_t sequence = 0;
+    bool repaired = false;  // At least one fragment was rebuilt from parity
+    std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Receiver-side loss accounting
+ */
+struct MulticastStats {
+    uint64_t datagrams = 0;
+    uint64_t malformed = 0;
+    uint64_t framesCompleted = 0;
+    uint64_t framesLost = 0;           // Sequence gaps between delivered frames
+    uint64_t fragmentsLost = 0;        // Missing from frames that were abandoned
+    uint64_t fragmentsRecovered = 0;   // Rebuilt from parity
+};
+
+/**
+ * @brief Reassembles frames from fragment datagrams
+ *
+ * Transport-independent: feed datagrams with ingest(), collect frames with
+ * pop(). MulticastReceiver wraps this around a socket.
+ */
+class FrameReassembler {
+public:
+    /**
+     * @param maxPending Incomplete frames kept per stream before the oldest is abandoned
+     */
+    explicit FrameReassembler(size_t maxPending = 3) : maxPending_(maxPending) {}
+
+    void ingest(const uint8_t* datagram, size_t size);
+    bool pop(MulticastFrame& frame);
+
+    const MulticastStats& stats() const { return stats_; }
+
+private:
+    struct Pending {
+        MulticastFrame frame;
+        uint32_t frameSize = 0;
+        uint16_t fragmentSize = 0;
+        uint8_t fecGroup = 0;
+        size_t fragmentCount = 0;
+        size_t received = 0;
+        std::vector<bool> have;
+        std::map<size_t, std::vector<uint8_t>> parity;  // Group index → parity payload
+    };
+
+    struct StreamState {
+        std::map<uint32_t, Pending> pending;  // By sequence
+        bool delivered = false;
+        uint32_t lastDelivered = 0;
+    };
+
+    void tryRecover(Pending& pending, size_t group);
+    void complete(StreamState& stream, uint32_t sequence);
+    void abandonOlderThan(StreamState& stream, uint32_t sequence);
+
+    size_t maxPending_;
+    std::map<uint16_t, StreamState> streams_;
+    std::deque<MulticastFrame> ready_;
+    MulticastStats stats_;
+};
+
+/**
+ * @brief Joins a multicast group and yields reassembled frames
+ *
+ * Usage:
+ *   MulticastReceiver receiver;
+ *   receiver.open(config);
+ *   MulticastFrame frame;
+ *   while (receiver.next(frame, 1000)) { ... }
+ *   receiver.stats().framesLost;
+ */
+class MulticastReceiver {
+public:
+    MulticastReceiver() = default;
+    ~MulticastReceiver();
+
+    MulticastReceiver(const MulticastReceiver&) = delete;
+    MulticastReceiver& operator=(const MulticastReceiver&) = delete;
+
+    bool open(const MulticastConfig& config);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Wait for the next complete frame
+     * @return false on timeout
+     */
+    bool next(MulticastFrame& frame, int timeoutMs);
+
+    const MulticastStats& stats() const { return reassembler_.stats(); }
+
+private:
+    int fd_ = -1;
+    FrameReassembler reassembler_;
+    std::vector<uint8_t> buffer_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,74 @@
+/**
+ * @file pixel_format.h
+ * @brief RGB stream pixel formats and the server-side conversion
+ *
+ * The Kinect delivers packed RGB888, but browsers and GPU uploads want four
+ * bytes per pixel. Clients name the layout they want in the subscribe
+ * message; the bridge converts each RGB frame once per requested format and
+ * shares the result, instead of every browser repacking every frame in
+ * JavaScript.
+ *
+ * The format of a frame is recorded in the header flags
+ * (FRAME_FLAG_PIXEL_FORMAT_MASK), so history and downscaled frames are
+ * self-describing.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kinect_xr {
+
+/**
+ * @brief Byte layout of RGB stream pixels
+ */
+enum class PixelFormat : uint8_t {
+    Rgb888 = 0,    // R, G, B: the camera's native layout
+    Rgba8888 = 1,  // R, G, B, 255: canvas ImageData, WebGL RGBA textures
+    Bgra8888 = 2,  // B, G, R, 255: Metal / Direct3D / CoreVideo textures
+};
+
+constexpr size_t PIXEL_FORMAT_COUNT = 3;
+
+/**
+ * @brief Bytes per pixel of a format
+ */
+inline size_t bytesPerPixel(PixelFormat format) {
+    return format == PixelFormat::Rgb888 ? 3 : 4;
+}
+
+/**
+ * @brief Wire name of a format ("RGB888", "RGBA8888", "BGRA8888")
+ */
+const char* pixelFormatName(PixelFormat format);
+
+/**
+ * @brief Parse a wire name
+ * @return false if the name is not a supported format
+ */
+bool parsePixelFormat(const std::string& name, PixelFormat& format);
+
+/**
+ * @brief Repack RGB888 pixels into a four-byte format
+ * @param rgb count * 3 bytes
+ * @param out count * 4 bytes; must not overlap rgb
+ *
+ * Uses a byte-shuffle kernel (SSSE3 or NEON) when the target has one.
+ */
+void convertRgbPixels(const uint8_t* rgb, size_t count, PixelFormat format, uint8_t* out);
+
+/**
+ * @brief Copy of an RGB888 bridge frame in another pixel format
+ * @return New frame with the format recorded in the header flags, or nullptr
+ *         if the frame is not an RGB888 frame of whole pixels or format is
+ *         Rgb888
+ *
+ * Any scale flags are kept, so full-size and downscaled frames both convert.
+ */
+SharedFrame convertRgbFrame(const SharedFrame& frame, PixelFormat format);
+
+}  // namespace kinect_xr
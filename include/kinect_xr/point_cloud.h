@@ -0,0 +1,101 @@
+/**
+ * @file point_cloud.h
+ * @brief Compact point-cloud frames built from depth on the bridge
+ *
+ * Browsers used to receive the full depth image and back-project every
+ * pixel in JavaScript. The pointcloud stream does that work once per frame
+ * on the server: only valid (non-zero, in-range) samples are kept, and
+ * coordinates are quantized so the payload can be uploaded to a GPU vertex
+ * buffer without any per-point processing on the client.
+ *
+ * Payload after the 8-byte bridge header (all little-endian):
+ *
+ *   offset 0   uint32  point count N
+ *   offset 4   uint8   PointFormat
+ *   offset 5   uint8   decimation (pixel step in x and y)
+ *   offset 6   uint8   flags (POINT_CLOUD_FLAG_COLOR)
+ *   offset 7   uint8   reserved (0)
+ *   offset 8   N * 3   positions (x, y, z), int16 or float16 each
+ *   then       N * 3   uint8 r, g, b (only with POINT_CLOUD_FLAG_COLOR)
+ *
+ * Positions use the Kinect sensor frame, like the PLY snapshot: +X right,
+ * +Y up, +Z forward. Points are in row-major pixel order.
+ */
+
+#pragma once
+
+#include "kinect_xr/snapshot_encoder.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kinect_xr {
+
+/**
+ * @brief Position encoding of a point-cloud frame
+ */
+enum class PointFormat : uint8_t {
+    Int16Mm = 0,       // Signed millimetres, exact for Kinect depth
+    Float16Metres = 1  // IEEE half floats in metres (~4 mm steps at 4 m)
+};
+
+constexpr size_t POINT_CLOUD_HEADER_SIZE = 8;  // Follows the bridge frame header
+constexpr uint8_t POINT_CLOUD_FLAG_COLOR = 0x01;
+
+/**
+ * @brief Per-client point-cloud options (from the subscribe message)
+ */
+struct PointCloudParams {
+    uint8_t decimation = 2;  // Pixel step in x and y: 1, 2, 4 or 8
+    PointFormat format = PointFormat::Int16Mm;
+    bool color = false;       // Append RGB sampled from the color image
+    uint16_t minDepthMm = 0;  // Samples outside [min, max] are dropped; 0 = no limit
+    uint16_t maxDepthMm = 0;
+
+    /**
+     * @brief Identifies the parameter set, so equal requests share one encode
+     */
+    uint64_t key() const {
+        return static_cast<uint64_t>(decimation) | (static_cast<uint64_t>(format) << 8) |
+               (static_cast<uint64_t>(color) << 16) | (static_cast<uint64_t>(minDepthMm) << 24) |
+               (static_cast<uint64_t>(maxDepthMm) << 40);
+    }
+
+    /**
+     * @brief Payload size with every sampled pixel valid (rate control budget)
+     */
+    size_t maxPayloadBytes() const;
+};
+
+/**
+ * @brief Whether a decimation step is supported
+ */
+inline bool isValidDecimation(uint32_t step) {
+    return step == 1 || step == 2 || step == 4 || step == 8;
+}
+
+/**
+ * @brief Convert to IEEE 754 half precision (round to nearest)
+ *
+ * Values beyond the half range become infinity; tiny values become
+ * subnormals or zero.
+ */
+uint16_t floatToHalf(float value);
+
+/**
+ * @brief Convert IEEE 754 half precision to float
+ */
+float halfToFloat(uint16_t half);
+
+/**
+ * @brief Build a pointcloud bridge frame from a full-size depth image
+ * @param depth 640x480 uint16 little-endian depth in millimetres (0 = no reading)
+ * @param rgb Matching 640x480 RGB image for colors, or null; without it the
+ *            frame carries no colors even if params.color is set
+ * @return Bridge binary message with stream type STREAM_TYPE_POINTCLOUD
+ */
+SharedFrame encodePointCloud(uint32_t frameId, const uint8_t* depth, const uint8_t* rgb,
+                             const DepthIntrinsics& intrinsics, const PointCloudParams& params);
+
+}  // namespace kinect_xr
@@ -0,0 +1,166 @@
+/**
+ * @file rate_controller.h
+ * @brief Per-client bandwidth estimation and delivery variant selection
+ *
+ * A client on a slow link used to fall behind silently: frames piled up in
+ * its send queue while the server kept sending at full rate. Each client now
+ * has a RateController that estimates the link throughput from how fast its
+ * send queue drains and moves the client along a ladder of cheaper delivery
+ * variants (frame-rate dividers, and downscaled resolution for clients that
+ * opted in) to keep the queue short.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kinect_xr {
+
+/**
+ * @brief One delivery setting
+ */
+struct DeliveryVariant {
+    uint8_t scaleShift;    // Width and height divided by (1 << scaleShift)
+    uint8_t frameDivider;  // Only every Nth frame ID is sent
+
+    /**
+     * @brief Fraction of full-rate bytes this variant sends
+     */
+    double costFactor() const {
+        return 1.0 / (static_cast<double>(1u << (2 * scaleShift)) * frameDivider);
+    }
+
+    /**
+     * @brief Whether a frame ID is delivered at this variant
+     */
+    bool sends(uint32_t frameId) const { return frameId % frameDivider == 0; }
+
+    /**
+     * @brief Short label, e.g. "320x240@15"
+     */
+    std::string name() const;
+};
+
+/**
+ * @brief Variant ladder for a client, most expensive first
+ * @param downscale Include reduced resolutions (client understands the scale
+ *                  flag); otherwise only frame-rate dividers are used
+ */
+const DeliveryVariant* deliveryLadder(bool downscale, size_t& count);
+
+/**
+ * @brief Downscaled copy of a full-size RGB or depth bridge frame
+ * @return New frame with the scale recorded in the header flags, or nullptr
+ *         if the frame is not a full-size RGB or depth frame
+ *
+ * RGB is box-filtered. Depth takes the first valid sample of each block, so
+ * no depth values are invented across object edges.
+ */
+SharedFrame downscaleFrame(const SharedFrame& frame, uint8_t scaleShift);
+
+/**
+ * @brief Throughput estimator and variant controller for one client
+ *
+ * onQueued() and update() are called by the broadcast thread only; the
+ * accessors are safe from any thread (status requests).
+ *
+ * Estimation: every window (~100 ms) the bytes drained from the send queue
+ * are divided by the window length. A sample taken while the queue stayed
+ * backlogged measures the link and is averaged into the estimate; a sample
+ * from an idle queue only shows what was sent, so it can raise the
+ * estimate but never lower it.
+ *
+ * Control: when the queue holds more than QUEUE_HIGH_MS of data at the
+ * estimated rate, the client drops to the best variant that fits in 85% of
+ * the estimate. After the queue stayed short for a hold period it probes one
+ * step up; a probe that backs up the queue doubles the next hold, and a
+ * probe that holds resets it.
+ *
+ * Round trips from clock sync (onRoundTrip) add a second signal: the smoothed
+ * round trip above the lowest one is data queued past the bridge, in kernel
+ * buffers and the network, and counts like send-queue time.
+ */
+class RateController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RateController();
+
+    /**
+     * @brief Account bytes queued for the client since the last update
+     */
+    void onQueued(size_t bytes) { queuedSinceUpdate_ += bytes; }
+
+    /**
+     * @brief Sample the queue and possibly change variant
+     * @param bufferedBytes Client's current send-queue size
+     * @param fullRateBytesPerSec Bytes per second the client's subscriptions
+     *                            cost at full resolution and frame rate
+     * @param downscale Client accepts reduced-resolution frames
+     */
+    void update(size_t bufferedBytes, double fullRateBytesPerSec, bool downscale,
+                Clock::time_point now);
+
+    /**
+     * @brief Current delivery variant
+     */
+    DeliveryVariant variant() const;
+
+    /**
+     * @brief Estimated throughput in bytes per second (0 until measured)
+     */
+    uint64_t estimatedBytesPerSecond() const { return estimate_.load(); }
+
+    /**
+     * @brief Frames not sent because of the frame-rate divider
+     */
+    uint64_t framesSkipped() const { return skipped_.load(); }
+    void onSkipped() { skipped_++; }
+
+    /**
+     * @brief Report the client's filtered round trip (any thread)
+     */
+    void onRoundTrip(uint64_t smoothedRttUs, uint64_t minRttUs, Clock::time_point now);
+
+    /**
+     * @brief Queueing delay beyond the send queue from the last round trip, 0 if none
+     */
+    uint64_t networkDelayUs() const { return networkDelayUs_.load(); }
+
+    /**
+     * @brief Number of variant changes so far
+     */
+    uint64_t switches() const { return switches_.load(); }
+
+private:
+    void select(size_t index, Clock::time_point now);
+
+    // Broadcast-thread state
+    Clock::time_point windowStart_;
+    size_t windowStartBuffered_ = 0;
+    size_t queuedSinceUpdate_ = 0;
+    bool backloggedWindow_ = true;  // Queue never emptied during the window
+    Clock::time_point calmSince_;   // Queue short since this time
+    Clock::time_point lastUpgrade_;
+    Clock::time_point lastDowngrade_;
+    std::chrono::milliseconds probeHold_;
+
+    // Shared with status readers
+    std::atomic<bool> downscale_{false};
+    std::atomic<size_t> index_{0};
+    std::atomic<uint64_t> estimate_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> switches_{0};
+
+    // Written by the client's message handler
+    std::atomic<uint64_t> networkDelayUs_{0};
+    std::atomic<Clock::rep> roundTripAt_{0};
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,106 @@
+/**
+ * @file reactor_transport.h
+ * @brief Event-reactor WebSocket transport for high fan-out streaming
+ *
+ * A small reactor (epoll on Linux, kqueue on macOS) with non-blocking sockets
+ * and a fixed number of I/O threads. Each connection keeps a queue of shared
+ * pre-framed messages which is drained with writev(), so a broadcast costs one
+ * queue push per client and the payload is never copied.
+ *
+ * The same reactor can listen on a Unix domain socket instead of TCP. Local
+ * clients skip the HTTP upgrade and speak WebSocket framing directly (client
+ * frames need not be masked). Binary frames of UNIX_MEMFD_THRESHOLD bytes or
+ * more are not copied through the socket: the payload is written once into a
+ * sealed memfd shared by all local clients, and each client receives a small
+ * descriptor frame (FRAME_FLAG_MEMFD) with the fd attached via SCM_RIGHTS.
+ *
+ * Connection queues are SendQueues: control messages, then depth, then RGB,
+ * with frames past their deadline dropped (see send_queue.h).
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_transport.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace kinect_xr {
+
+class Reactor;
+class ReactorConnection;
+class MemfdCache;
+
+// Binary frames at least this large go to Unix socket clients as memfds
+constexpr size_t UNIX_MEMFD_THRESHOLD = 64 * 1024;
+
+/**
+ * @brief WebSocket transport driven by a pool of event reactors
+ *
+ * Usage:
+ *   ReactorTransport transport(2);  // 2 I/O threads
+ *   transport.start(8765, callbacks);
+ *
+ *   ReactorTransport local(1, "/tmp/kinect-xr.sock");
+ *   local.start(0, callbacks);  // port ignored
+ */
+class ReactorTransport : public BridgeTransport {
+public:
+    /**
+     * @param ioThreads Number of reactor threads
+     * @param unixPath Listen on this Unix socket path instead of TCP
+     */
+    explicit ReactorTransport(int ioThreads = 2, const std::string& unixPath = "");
+    ~ReactorTransport() override;
+
+    bool start(int port, const TransportCallbacks& callbacks) override;
+    void stop() override;
+    const char* name() const override { return unixPath_.empty() ? "epoll" : "unix"; }
+    void setSendDeadlines(const SendDeadlines& deadlines) override { deadlines_ = deadlines; }
+
+    /**
+     * @brief Port actually bound (useful when started with port 0)
+     */
+    int port() const { return boundPort_; }
+
+    /**
+     * @brief Unix socket path (empty when listening on TCP)
+     */
+    const std::string& unixPath() const { return unixPath_; }
+
+private:
+    friend class Reactor;
+    friend class ReactorConnection;
+
+    bool listenTcp(int port);
+    bool listenUnix();
+
+    // Called by the reactor that owns the listening socket
+    void acceptConnections();
+
+    /**
+     * @brief Accept and close one pending connection when out of fds
+     * @return false if none could be taken (stop accepting until the next wakeup)
+     */
+    bool rejectWithReserveFd();
+
+    int ioThreads_;
+    std::string unixPath_;
+    std::unique_ptr<MemfdCache> memfds_;
+    int listenFd_ = -1;
+    int reserveFd_ = -1;  // Kept open so an fd can be freed to reject connections on EMFILE
+    int boundPort_ = 0;
+    uint64_t rejectedConnections_ = 0;
+    std::chrono::steady_clock::time_point lastRejectLog_;
+    TransportCallbacks callbacks_;
+    SendDeadlines deadlines_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::atomic<bool> running_{false};
+    size_t nextReactor_ = 0;
+};
+
+}  // namespace kinect_xr
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <queue>
 #include "kinect_xr/device.h"
+#include "kinect_xr/lock_stats.h"
 
 namespace kinect_xr {
 
@@ -91,7 +92,7 @@ struct FrameState {
 // Frame cache for Kinect RGB + depth data
 // Thread-safe storage for latest frames from Kinect callbacks
 struct FrameCache {
-    std::mutex mutex;  // Protects all fields below
+    NamedMutex mutex{"runtime_frame_cache"};  // Protects all fields below
 
     // RGB frame (640x480, RGB888 format)
     std::vector<uint8_t> rgbData;  // 640 * 480 * 3 = 921600 bytes
@@ -248,7 +249,7 @@ private:
     uint64_t nextInstanceId_ = 1;
     uint64_t nextSystemId_ = 1;
 
-    mutable std::mutex sessionMutex_;
+    mutable NamedMutex sessionMutex_{"session"};
     std::unordered_map<XrSession, std::unique_ptr<SessionData>> sessions_;
     uint64_t nextSessionId_ = 1;
 
@@ -256,7 +257,7 @@ private:
     std::unordered_map<XrSpace, std::unique_ptr<SpaceData>> spaces_;
     uint64_t nextSpaceId_ = 1;
 
-    mutable std::mutex swapchainMutex_;
+    mutable NamedMutex swapchainMutex_{"swapchain"};
     std::unordered_map<XrSwapchain, std::unique_ptr<SwapchainData>> swapchains_;
     uint64_t nextSwapchainId_ = 1;
 };
@@ -0,0 +1,210 @@
+/**
+ * @file send_queue.h
+ * @brief Per-client send scheduling by stream priority and deadline
+ *
+ * A saturated link used to drain a client's queue in arrival order, so a
+ * 1.2 MB RGB frame held back the small depth and JSON messages behind it.
+ * Each connection now keeps one FIFO per priority and always writes from
+ * the most urgent non-empty one:
+ *
+ *   Control  JSON messages, binary control replies, WebSocket control frames
+ *   Depth    depth and the streams derived from it, bundles
+ *   Video    RGB and keyed frames, HTTP responses
+ *
+ * A frame that waited longer than its priority's deadline is dropped when
+ * its turn comes instead of being sent late. Messages whose loss the client
+ * could not recover from (JSON, history replays, tile deltas, HTTP bytes,
+ * the close frame) are never dropped. A message already being written is
+ * always finished first, so frames are never interleaved on the wire.
+ */
+
+#pragma once
+
+#include "kinect_xr/latency_trace.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace kinect_xr {
+
+enum class SendPriority : uint8_t {
+    Control = 0,
+    Depth = 1,
+    Video = 2
+};
+
+constexpr size_t SEND_PRIORITY_COUNT = 3;
+
+/**
+ * @brief Lowercase name ("control", "depth", "video")
+ */
+const char* sendPriorityName(SendPriority priority);
+
+/**
+ * @brief How a queued message is scheduled
+ */
+struct SendClass {
+    SendPriority priority = SendPriority::Control;
+    bool droppable = false;  // May be skipped once past its deadline
+};
+
+/**
+ * @brief Classify an outgoing message by its opcode and bridge header
+ */
+SendClass classifyFrame(const FramedMessage& frame);
+
+/**
+ * @brief Maximum queueing time per priority in milliseconds (0 = never drop)
+ */
+struct SendDeadlines {
+    std::array<uint32_t, SEND_PRIORITY_COUNT> ms{0, 100, 100};
+};
+
+/**
+ * @brief Queue state of one priority
+ */
+struct SendPriorityStats {
+    size_t queued = 0;         // Messages waiting (including one being written)
+    size_t queuedBytes = 0;
+    uint64_t oldestMs = 0;     // Age of the oldest waiting message
+    uint64_t sent = 0;         // Messages fully written
+    uint64_t dropped = 0;      // Skipped past their deadline
+    LatencySummary wait;       // Queued until fully written to the socket
+};
+
+struct SendQueueStats {
+    bool scheduled = false;  // False for transports that keep their own FIFO
+    std::array<SendPriorityStats, SEND_PRIORITY_COUNT> priorities{};
+};
+
+/**
+ * @brief Priority queues of one connection
+ *
+ * Item is the transport's queue entry and must have members
+ * `SharedFrame frame` and `size_t offset` (wire bytes already written).
+ * Not thread-safe; the connection's lock guards it.
+ *
+ * Usage:
+ *   queue.push(item, now);
+ *   while (Item* item = queue.front(now, deadlines, droppedBytes)) {
+ *       write; if complete: queue.pop(now); else break;
+ *   }
+ */
+template <typename Item>
+class SendQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void push(Item item, Clock::time_point now) {
+        SendClass sendClass = classifyFrame(*item.frame);
+        auto& lane = lanes_[static_cast<size_t>(sendClass.priority)];
+        lane.items.push_back({std::move(item), now, sendClass.droppable});
+        lane.bytes += lane.items.back().item.frame->wireSize();
+        size_++;
+    }
+
+    /**
+     * @brief The message to write next, or nullptr if the queue is empty
+     * @param droppedBytes Incremented by the unwritten bytes of dropped messages
+     */
+    Item* front(Clock::time_point now, const SendDeadlines& deadlines, size_t& droppedBytes) {
+        // A partly written message goes first
+        for (size_t p = 0; p < SEND_PRIORITY_COUNT; p++) {
+            if (!lanes_[p].items.empty() && lanes_[p].items.front().item.offset > 0) {
+                current_ = p;
+                return &lanes_[p].items.front().item;
+            }
+        }
+        for (size_t p = 0; p < SEND_PRIORITY_COUNT; p++) {
+            auto& lane = lanes_[p];
+            while (!lane.items.empty()) {
+                Queued& queued = lane.items.front();
+                uint64_t waitMs = elapsedMs(queued.queuedAt, now);
+                if (queued.droppable && deadlines.ms[p] > 0 && waitMs > deadlines.ms[p]) {
+                    droppedBytes += queued.item.frame->wireSize();
+                    lane.stats.dropped++;
+                    popLane(lane);
+                    continue;
+                }
+                current_ = p;
+                return &queued.item;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Remove the message returned by front() once it is fully written
+     */
+    void pop(Clock::time_point now) {
+        auto& lane = lanes_[current_];
+        if (lane.items.empty()) {
+            return;
+        }
+        lane.stats.sent++;
+        auto queuedAt = lane.items.front().queuedAt;
+        lane.wait.record(now <= queuedAt ? 0 : static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - queuedAt).count()));
+        popLane(lane);
+    }
+
+    void clear() {
+        for (auto& lane : lanes_) {
+            lane.items.clear();
+            lane.bytes = 0;
+        }
+        size_ = 0;
+    }
+
+    bool empty() const { return size_ == 0; }
+
+    SendQueueStats stats(Clock::time_point now) const {
+        SendQueueStats out;
+        out.scheduled = true;
+        for (size_t p = 0; p < SEND_PRIORITY_COUNT; p++) {
+            const auto& lane = lanes_[p];
+            SendPriorityStats& stats = out.priorities[p];
+            stats = lane.stats;
+            stats.queued = lane.items.size();
+            stats.queuedBytes = lane.bytes;
+            stats.oldestMs = lane.items.empty() ? 0 : elapsedMs(lane.items.front().queuedAt, now);
+            stats.wait = lane.wait.summary();
+        }
+        return out;
+    }
+
+private:
+    struct Queued {
+        Item item;
+        Clock::time_point queuedAt;
+        bool droppable;
+    };
+
+    struct Lane {
+        std::deque<Queued> items;
+        size_t bytes = 0;
+        SendPriorityStats stats;
+        LatencyHistogram wait;
+    };
+
+    static uint64_t elapsedMs(Clock::time_point from, Clock::time_point to) {
+        if (to <= from) return 0;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count());
+    }
+
+    void popLane(Lane& lane) {
+        lane.bytes -= lane.items.front().item.frame->wireSize();
+        lane.items.pop_front();
+        size_--;
+    }
+
+    std::array<Lane, SEND_PRIORITY_COUNT> lanes_;
+    size_t size_ = 0;
+    size_t current_ = 0;  // Lane of the message last returned by front()
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,203 @@
+/**
+ * @file shm_ring.h
+ * @brief POSIX shared-memory frame ring for same-host consumers
+ *
+ * The bridge publishes every frame once into a named shared-memory region;
+ * local consumers (native visualizers, the OpenXR runtime) map it read-only
+ * and read frames in place, without sockets or copies.
+ *
+ * Layout (all offsets from the start of the mapping):
+ *   ShmRingHeader                    ring geometry, publish counter, wake word
+ *   ShmSlot[slotCount]               per-slot seqlock + frame metadata
+ *   data[slotCount][slotStride]      frame payloads (page aligned)
+ *
+ * Each slot is guarded by a seqlock: the writer makes the sequence odd while
+ * it copies a frame in and even again when done. Readers check the sequence
+ * before and after touching the data and discard torn reads. Waiting readers
+ * sleep on a futex in the header (Linux) or poll (other platforms).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x3152584B;  // "KXR1"
+constexpr uint32_t SHM_RING_VERSION = 1;
+constexpr const char* SHM_RING_DEFAULT_NAME = "/kinect-xr";
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory ring requires lock-free 64-bit atomics");
+
+/**
+ * @brief Ring header at offset 0 of the mapping
+ */
+struct alignas(64) ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;     // Maximum payload bytes per slot
+    uint64_t slotStride;   // Distance between slot payloads
+    uint64_t dataOffset;   // Offset of slot 0 payload
+    uint64_t mappedSize;
+
+    alignas(64) std::atomic<uint64_t> published;  // Frames published so far
+    std::atomic<uint32_t> wakeWord;               // Bumped on every publish (futex word)
+};
+
+/**
+ * @brief Per-slot seqlock and frame metadata
+ */
+struct alignas(64) ShmSlot {
+    std::atomic<uint32_t> lock;  // Odd while the writer is inside the slot
+    std::atomic<uint16_t> streamType;
+    std::atomic<uint16_t> flags;
+    std::atomic<uint32_t> frameId;
+    std::atomic<uint32_t> size;
+    std::atomic<uint64_t> sequence;     // Publish sequence held by this slot
+    std::atomic<uint64_t> timestampNs;  // steady_clock at publish
+};
+
+/**
+ * @brief Producer side: creates the region and publishes frames
+ *
+ * Usage:
+ *   ShmRingWriter writer;
+ *   writer.create("/kinect-xr", 8, RGB_FRAME_SIZE);
+ *   writer.publish(STREAM_TYPE_DEPTH, frameId, data, size);
+ */
+class ShmRingWriter {
+public:
+    ShmRingWriter() = default;
+    ~ShmRingWriter();
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    /**
+     * @brief Create (or replace) the named region
+     * @param name POSIX shm name, starting with '/'
+     * @param slotCount Frames retained in the ring
+     * @param slotSize Largest payload accepted by publish()
+     * @return true on success
+     */
+    bool create(const std::string& name, uint32_t slotCount, uint32_t slotSize);
+
+    /**
+     * @brief Unmap and unlink the region
+     */
+    void destroy();
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    /**
+     * @brief Copy one frame into the next slot and wake readers
+     * @return false if the ring is closed or the frame exceeds slotSize
+     */
+    bool publish(uint16_t streamType, uint32_t frameId, const uint8_t* data, size_t size,
+                 uint16_t flags = 0);
+
+private:
+    std::string name_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    ShmRingHeader* header_ = nullptr;
+    uint64_t nextSequence_ = 0;
+};
+
+/**
+ * @brief Zero-copy view of one frame inside the ring
+ *
+ * The data stays valid only until the writer wraps around to this slot;
+ * call ShmRingReader::stillValid() after consuming it.
+ */
+struct ShmFrameView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    uint16_t streamType = 0;
+    uint16_t flags = 0;
+    uint32_t frameId = 0;
+    uint64_t sequence = 0;
+    uint64_t timestampNs = 0;
+
+    // Seqlock value observed when the view was taken
+    uint32_t slot = 0;
+    uint32_t lockValue = 0;
+};
+
+/**
+ * @brief Consumer side: maps the region read-only
+ *
+ * Usage:
+ *   ShmRingReader reader;
+ *   reader.open("/kinect-xr");
+ *   ShmFrameView frame;
+ *   while (reader.wait(100)) {
+ *       while (reader.next(frame)) { ...; reader.stillValid(frame); }
+ *   }
+ */
+class ShmRingReader {
+public:
+    ShmRingReader() = default;
+    ~ShmRingReader();
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    /**
+     * @brief Map an existing region; reading starts at the newest frame
+     * @return false if the region is missing or has an incompatible layout
+     */
+    bool open(const std::string& name);
+
+    void close();
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    /**
+     * @brief Block until a frame newer than the last one read is available
+     * @param timeoutMs Maximum wait in milliseconds
+     * @return true if next() has a frame
+     */
+    bool wait(int timeoutMs);
+
+    /**
+     * @brief Take a view of the next unread frame
+     *
+     * If the reader fell more than one ring behind, the frames it missed are
+     * added to droppedFrames() and reading resumes at the oldest intact slot.
+     *
+     * @return false if no unread frame is available
+     */
+    bool next(ShmFrameView& view);
+
+    /**
+     * @brief Whether a view's data was left untouched by the writer
+     */
+    bool stillValid(const ShmFrameView& view) const;
+
+    /**
+     * @brief Copy the next unread frame, retrying torn reads
+     */
+    bool copyNext(ShmFrameView& view, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Frames overwritten before this reader got to them
+     */
+    uint64_t droppedFrames() const { return dropped_; }
+
+private:
+    int fd_ = -1;
+    const uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    const ShmRingHeader* header_ = nullptr;
+    uint64_t nextSequence_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}  // namespace kinect_xr
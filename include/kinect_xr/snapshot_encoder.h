@@ -0,0 +1,147 @@
+/**
+ * @file snapshot_encoder.h
+ * @brief Still-image encodings of the newest frames for HTTP consumers
+ *
+ * Tools that only want "the current frame" fetch it over plain HTTP instead
+ * of speaking the WebSocket protocol. The bridge hands every live frame to a
+ * SnapshotCache by reference; encoding happens lazily on the first request
+ * for a format and the result is reused until a newer frame arrives, so any
+ * number of pollers cost at most one encode per frame and format.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kinect_xr {
+
+/**
+ * @brief Encodings served by the snapshot endpoints
+ */
+enum class SnapshotFormat {
+    RgbJpeg,        // 8-bit RGB, baseline JPEG
+    RgbPng,         // 8-bit RGB PNG
+    DepthPng,       // 16-bit grayscale PNG, millimetres
+    DepthRaw,       // uint16 little-endian, row-major (the frame payload)
+    PointCloudPly,  // binary little-endian PLY, metres, colored when RGB is available
+};
+
+constexpr size_t SNAPSHOT_FORMAT_COUNT = 5;
+
+/**
+ * @brief MIME type for a snapshot format
+ */
+const char* snapshotContentType(SnapshotFormat format);
+
+/**
+ * @brief Pinhole model used to unproject depth pixels
+ *
+ * Defaults match the Kinect v1 depth camera (57° x 43° field of view) and
+ * the web examples.
+ */
+struct DepthIntrinsics {
+    float fx;
+    float fy;
+    float cx;
+    float cy;
+
+    static DepthIntrinsics kinectDefault();
+};
+
+/**
+ * @brief Encode packed 8-bit RGB as JPEG
+ * @param quality libjpeg quality (1-100)
+ * @return false if libjpeg reported an error
+ */
+bool encodeJpeg(const uint8_t* rgb, uint32_t width, uint32_t height, int quality,
+                std::vector<uint8_t>& out);
+
+/**
+ * @brief Encode packed 8-bit RGB as PNG
+ */
+bool encodeRgbPng(const uint8_t* rgb, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+
+/**
+ * @brief Encode little-endian uint16 depth as a 16-bit grayscale PNG
+ */
+bool encodeDepthPng(const uint8_t* depth, uint32_t width, uint32_t height,
+                    std::vector<uint8_t>& out);
+
+/**
+ * @brief Unproject depth (mm, 0 = no reading) into a binary PLY point cloud
+ * @param rgb Optional same-size RGB image used for vertex colors (may be null)
+ *
+ * Points use the Kinect sensor frame: +X right, +Y up, +Z forward, in metres.
+ */
+void encodePly(const uint8_t* depth, const uint8_t* rgb, uint32_t width, uint32_t height,
+               const DepthIntrinsics& intrinsics, std::vector<uint8_t>& out);
+
+/**
+ * @brief Lazily encoded snapshots of the newest RGB and depth frames
+ *
+ * Thread-safe. update() only swaps a SharedFrame reference, so it is cheap
+ * enough to call from the broadcast loop for every frame. Encoded results
+ * are returned as raw (unframed) SharedFrames so an HTTP response can queue
+ * the same body bytes for every poller without copying.
+ *
+ * Usage:
+ *   SnapshotCache snapshots;
+ *   snapshots.update(STREAM_TYPE_RGB, frame);
+ *   uint32_t frameId;
+ *   SharedFrame jpeg = snapshots.get(SnapshotFormat::RgbJpeg, &frameId);
+ */
+class SnapshotCache {
+public:
+    explicit SnapshotCache(int jpegQuality = 80);
+
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache& operator=(const SnapshotCache&) = delete;
+
+    /**
+     * @brief Remember the newest live frame of a stream
+     * @param frame Bridge binary message (8-byte header + full-size payload)
+     */
+    void update(uint16_t streamType, const SharedFrame& frame);
+
+    /**
+     * @brief Encoded body for the newest frame, or nullptr if none is available
+     * @param frameId Receives the source frame ID (optional)
+     *
+     * Concurrent callers for the same format wait for a single encode.
+     */
+    SharedFrame get(SnapshotFormat format, uint32_t* frameId = nullptr);
+
+    /**
+     * @brief Number of encodes performed (for tests and stats)
+     */
+    uint64_t encodes() const { return encodes_.load(); }
+
+private:
+    struct Slot {
+        std::mutex mutex;  // Held while encoding, so waiters share the result
+        uint64_t sourceKey = 0;  // Source frame ID(s) the body was encoded from
+        SharedFrame body;
+    };
+
+    bool encode(SnapshotFormat format, const SharedFrame& rgb, const SharedFrame& depth,
+                std::vector<uint8_t>& out) const;
+
+    int jpegQuality_;
+    DepthIntrinsics intrinsics_;
+
+    std::mutex framesMutex_;
+    SharedFrame rgb_;
+    SharedFrame depth_;
+
+    std::array<Slot, SNAPSHOT_FORMAT_COUNT> slots_;
+    std::atomic<uint64_t> encodes_{0};
+};
+
+}  // namespace kinect_xr
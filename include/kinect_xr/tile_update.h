@@ -0,0 +1,139 @@
+/**
+ * @file tile_update.h
+ * @brief Dirty-tile partial updates for the RGB and depth streams
+ *
+ * Fixed installations see mostly static scenes, yet every frame used to go
+ * out whole. Clients that opt in ("tiles": true) get only the 32x32 tiles
+ * that changed since the previous frame, and patch a persistent buffer.
+ *
+ * The bridge keeps one reference image per stream: what every in-sync
+ * client currently shows. Each frame, tiles that differ from the reference
+ * by more than a threshold are copied into it and sent; small changes
+ * (sensor noise) are held back, and a periodic refresh sends every tile so
+ * the reference never drifts from the camera for long. A client that missed
+ * an update (new subscription, skipped frame, downscaled variant) is sent
+ * the reference itself as an ordinary full frame and is in sync again.
+ *
+ * Tile frames carry FRAME_FLAG_TILES; payload after the 8-byte bridge
+ * header (all little-endian):
+ *
+ *   offset 0   uint8   tile size in pixels (TILE_SIZE)
+ *   offset 1   uint8   reserved (0)
+ *   offset 2   uint16  dirty tile count N
+ *   offset 4   TILE_BITMAP_BYTES, bit t (LSB first) set if tile t follows;
+ *              tiles are numbered row-major, TILE_COLUMNS per row
+ *   offset 44  N tiles in increasing tile order, each TILE_SIZE rows of
+ *              TILE_SIZE pixels in the frame's pixel layout (RGB pixel
+ *              format flags apply; depth is uint16)
+ */
+
+#pragma once
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/pixel_format.h"
+#include "kinect_xr/ws_frame.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kinect_xr {
+
+constexpr uint32_t TILE_SIZE = 32;
+constexpr uint32_t TILE_COLUMNS = FRAME_WIDTH / TILE_SIZE;  // 20
+constexpr uint32_t TILE_ROWS = FRAME_HEIGHT / TILE_SIZE;    // 15
+constexpr uint32_t TILE_COUNT = TILE_COLUMNS * TILE_ROWS;   // 300
+constexpr size_t TILE_BITMAP_BYTES = (TILE_COUNT + 7) / 8;  // 38
+constexpr size_t TILE_HEADER_SIZE = 44;  // Follows the bridge frame header; tiles start 4-byte aligned
+
+/**
+ * @brief Change detection and refresh settings (bridge-wide)
+ */
+struct TileParams {
+    uint32_t refreshFrames = 60;     // Send every tile once per this many updates (~2 s)
+    uint8_t rgbThreshold = 24;       // RGB: dirty if any channel moved more than this
+    uint16_t depthThresholdMm = 20;  // Depth: dirty if any sample moved more than this or gained/lost a reading
+};
+
+/**
+ * @brief Per-client position in each stream's update sequence
+ *
+ * Shared by all snapshots of a client and touched only by the thread that
+ * broadcasts frames.
+ */
+struct TileSync {
+    std::array<uint64_t, 2> version{};  // Reference version last delivered: RGB, depth
+};
+
+/**
+ * @brief Reference image and tile frames for one stream
+ *
+ * Thread-safe; calls are serialized.
+ *
+ * Usage:
+ *   TileEncoder tiles(STREAM_TYPE_DEPTH);
+ *   tiles.update(depthFrame);  // Once per frame
+ *   SharedFrame out = held + 1 == tiles.version() ? tiles.delta() : tiles.keyFrame();
+ */
+class TileEncoder {
+public:
+    explicit TileEncoder(uint16_t streamType, const TileParams& params = TileParams{});
+
+    TileEncoder(const TileEncoder&) = delete;
+    TileEncoder& operator=(const TileEncoder&) = delete;
+
+    /**
+     * @brief Fold a frame into the reference and find the dirty tiles
+     * @param frame Full-size, native-layout (RGB888 / uint16) frame of this stream
+     * @return false if the frame does not qualify; the reference is unchanged
+     *
+     * Calling again with the same frame does nothing and returns true.
+     */
+    bool update(const SharedFrame& frame);
+
+    /**
+     * @brief Number of updates so far; a client holding version() - 1 can
+     *        apply delta(), anyone else needs keyFrame()
+     */
+    uint64_t version() const;
+
+    /**
+     * @brief Tiles changed by the last update
+     * @param format RGB pixel layout of the tile data (ignored for depth)
+     */
+    SharedFrame delta(PixelFormat format = PixelFormat::Rgb888);
+
+    /**
+     * @brief The reference as an ordinary full frame in the native layout,
+     *        flagged FRAME_FLAG_TILE_KEY so send queues never drop it
+     */
+    SharedFrame keyFrame();
+
+    /**
+     * @brief Dirty tiles in the last update
+     */
+    uint32_t dirtyCount() const;
+
+private:
+    // Whether tile t of frame differs from the reference beyond the threshold
+    bool tileChanged(const uint8_t* frame, uint32_t tile) const;
+
+    const uint16_t streamType_;
+    const TileParams params_;
+    const size_t pixelSize_;
+
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> reference_;
+    uint64_t version_ = 0;
+    uint32_t frameId_ = 0;
+    SharedFrame lastFrame_;        // Makes update() idempotent per frame
+    std::vector<uint16_t> dirty_;  // Tile numbers, increasing
+
+    // Built on first request after each update
+    std::array<SharedFrame, PIXEL_FORMAT_COUNT> deltas_;
+    SharedFrame key_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,88 @@
+/**
+ * @file unix_client.h
+ * @brief Client for the bridge's Unix domain socket transport
+ *
+ * Speaks the same protocol as the WebSocket clients (JSON control messages,
+ * binary frames with the 8-byte bridge header) without the HTTP upgrade.
+ * Large frames arrive as memfds (FRAME_FLAG_MEMFD), which this client maps
+ * read-only so the payload is never copied through the socket.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace kinect_xr {
+
+/**
+ * @brief One message received from the bridge
+ *
+ * For binary frames, data points either into the received message or into a
+ * mapped memfd; it stays valid until the next call to next() or close().
+ */
+struct LocalMessage {
+    WsOpcode opcode = WsOpcode::Text;
+    std::string text;  // Text messages only
+
+    uint32_t frameId = 0;
+    uint16_t streamType = 0;
+    uint16_t flags = 0;  // Without FRAME_FLAG_MEMFD
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;  // Payload came from a memfd
+};
+
+/**
+ * @brief Blocking Unix socket client
+ *
+ * Usage:
+ *   UnixFrameClient client;
+ *   client.connect("/tmp/kinect-xr.sock");
+ *   client.sendText(R"({"type":"subscribe","streams":["depth"]})");
+ *   LocalMessage message;
+ *   while (client.next(message, 1000)) { ... }
+ */
+class UnixFrameClient {
+public:
+    UnixFrameClient() = default;
+    ~UnixFrameClient();
+
+    UnixFrameClient(const UnixFrameClient&) = delete;
+    UnixFrameClient& operator=(const UnixFrameClient&) = delete;
+
+    bool connect(const std::string& path);
+    void close();
+    bool isConnected() const { return fd_ >= 0; }
+
+    /**
+     * @brief Send a JSON control message
+     */
+    bool sendText(const std::string& text);
+
+    /**
+     * @brief Wait for the next message
+     * @param timeoutMs Maximum wait; -1 blocks
+     * @return false on timeout, disconnect or protocol error
+     */
+    bool next(LocalMessage& message, int timeoutMs);
+
+private:
+    bool receive(int timeoutMs);
+    bool decode(LocalMessage& message);
+    void releaseMapping();
+
+    int fd_ = -1;
+    WsFrameParser parser_{false, 64 << 20};
+    WsMessage current_;
+    std::deque<int> passedFds_;  // In arrival order
+
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,93 @@
+/**
+ * @file ws_client.h
+ * @brief Minimal blocking WebSocket client for bridge-to-bridge links
+ *
+ * Used by relay mode to subscribe to an upstream bridge. Incoming binary
+ * messages are returned exactly as received, so a relay can re-serve them
+ * without touching the 8-byte frame header or the payload.
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace kinect_xr {
+
+/**
+ * @brief Parsed ws:// URL
+ */
+struct WsUrl {
+    std::string host;
+    int port = 80;
+    std::string path = "/";
+
+    /**
+     * @brief Parse "ws://host[:port][/path]"
+     * @return false for other schemes or malformed URLs (wss:// is not supported)
+     */
+    static bool parse(const std::string& url, WsUrl& out);
+};
+
+/**
+ * @brief Blocking WebSocket client
+ *
+ * Usage:
+ *   WsClient client;
+ *   client.connect("ws://capture-host:8765/");
+ *   client.sendText(R"({"type":"subscribe","streams":["rgb","depth"]})");
+ *   WsMessage message;
+ *   while (client.next(message, 1000)) { ... }
+ */
+class WsClient {
+public:
+    WsClient();
+    ~WsClient();
+
+    WsClient(const WsClient&) = delete;
+    WsClient& operator=(const WsClient&) = delete;
+
+    /**
+     * @brief Connect and complete the HTTP upgrade
+     * @param timeoutMs Upper bound for connect and handshake
+     */
+    bool connect(const std::string& url, int timeoutMs = 2000);
+    void close();
+    bool isConnected() const { return fd_ >= 0; }
+
+    /**
+     * @brief Send a masked text message
+     */
+    bool sendText(const std::string& text);
+
+    /**
+     * @brief Send a masked binary message
+     */
+    bool sendBinary(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Wait for the next text or binary message
+     *
+     * Pings are answered internally. A close frame or socket error closes the
+     * client.
+     *
+     * @return false on timeout, disconnect or protocol error
+     */
+    bool next(WsMessage& message, int timeoutMs);
+
+private:
+    bool sendFrame(WsOpcode opcode, const uint8_t* data, size_t size);
+    bool writeAll(const uint8_t* data, size_t size);
+    bool receive(int timeoutMs);
+
+    int fd_ = -1;
+    WsFrameParser parser_{false, 64 << 20};
+    std::mt19937 maskRng_;
+    std::vector<uint8_t> readBuffer_;
+};
+
+}  // namespace kinect_xr
@@ -0,0 +1,207 @@
+/**
+ * @file ws_frame.h
+ * @brief Pre-framed WebSocket messages shared across bridge clients
+ *
+ * A FramedMessage holds the complete server → client WebSocket frame
+ * (RFC 6455 header + payload). It is serialized once per frame variant and the
+ * same bytes are handed to every client connection, so per-client work is
+ * reduced to a write.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace kinect_xr {
+
+/**
+ * @brief WebSocket opcodes (RFC 6455 section 5.2)
+ */
+enum class WsOpcode : uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA
+};
+
+// Server frames are never masked, so the header is at most 2 + 8 bytes
+constexpr size_t WS_MAX_HEADER_SIZE = 10;
+
+// Bridge binary frame header: frame ID (4) + stream type (2) + flags (2)
+constexpr size_t FRAME_HEADER_SIZE = 8;
+
+/**
+ * @brief Encode an unmasked, final WebSocket frame header
+ * @param out Destination buffer (at least WS_MAX_HEADER_SIZE bytes)
+ * @param opcode Frame opcode
+ * @param payloadSize Payload length in bytes
+ * @return Number of header bytes written (2, 4 or 10)
+ */
+size_t encodeWsHeader(uint8_t* out, WsOpcode opcode, uint64_t payloadSize);
+
+/**
+ * @brief Write the 8-byte bridge frame header (little-endian)
+ */
+void encodeFrameHeader(uint8_t* out, uint32_t frameId, uint16_t streamType, uint16_t flags = 0);
+
+/**
+ * @brief Immutable, fully framed server → client WebSocket message
+ *
+ * Instances are only handed out as SharedFrame so that every connection
+ * references the same bytes until the last write completes.
+ */
+class FramedMessage {
+public:
+    /**
+     * @brief Build a bridge binary frame (8-byte header + data) in one allocation
+     */
+    static std::shared_ptr<const FramedMessage> binaryFrame(uint16_t streamType, uint32_t frameId,
+                                                            const uint8_t* data, size_t size,
+                                                            uint16_t flags = 0);
+
+    /**
+     * @brief Wrap an already-built binary payload
+     */
+    static std::shared_ptr<const FramedMessage> binary(std::vector<uint8_t> payload);
+
+    /**
+     * @brief Binary message over bytes of a buffer that `owner` keeps alive
+     *
+     * No copy: a relay forwards received messages, or the parts of one
+     * received bundle, straight from the receive buffer.
+     */
+    static std::shared_ptr<const FramedMessage> binaryView(std::shared_ptr<const void> owner,
+                                                           const uint8_t* data, size_t size);
+
+    /**
+     * @brief Wrap a text (JSON) payload
+     */
+    static std::shared_ptr<const FramedMessage> text(const std::string& payload);
+
+    /**
+     * @brief Build a control frame (ping, pong, close); payload must be <= 125 bytes
+     */
+    static std::shared_ptr<const FramedMessage> control(WsOpcode opcode,
+                                                        std::vector<uint8_t> payload = {});
+
+    /**
+     * @brief Bytes written verbatim with no WebSocket header (HTTP responses)
+     */
+    static std::shared_ptr<const FramedMessage> raw(std::vector<uint8_t> bytes);
+
+    WsOpcode opcode() const { return opcode_; }
+    bool isBinary() const { return opcode_ == WsOpcode::Binary; }
+
+    const uint8_t* header() const { return header_.data(); }
+    size_t headerSize() const { return headerSize_; }
+
+    const uint8_t* payload() const { return data_; }
+    size_t payloadSize() const { return size_; }
+
+    /**
+     * @brief Total bytes on the wire (header + payload)
+     */
+    size_t wireSize() const { return headerSize_ + size_; }
+
+private:
+    FramedMessage(WsOpcode opcode, std::vector<uint8_t> payload, bool framed = true);
+    FramedMessage(std::shared_ptr<const void> owner, const uint8_t* data, size_t size);
+
+    WsOpcode opcode_;
+    std::array<uint8_t, WS_MAX_HEADER_SIZE> header_{};
+    size_t headerSize_ = 0;
+    std::vector<uint8_t> payload_;  // Owned bytes; empty for views
+    std::shared_ptr<const void> owner_;  // Keeps a view's buffer alive
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+using SharedFrame = std::shared_ptr<const FramedMessage>;
+
+/**
+ * @brief Write a framed message to a socket with a single writev()
+ * @param fd Connected (typically non-blocking) socket
+ * @param message Message to write
+ * @param offset Bytes of the wire representation already written
+ * @param passFd Descriptor to attach as SCM_RIGHTS (Unix sockets only, -1 for
+ *               none); sent with the first byte of the message
+ * @return Bytes written, 0 if the socket would block, -1 on error
+ *
+ * Header and payload go out as two iovecs, so the shared payload is never
+ * copied into a per-connection buffer.
+ */
+ssize_t writeFramedMessage(int fd, const FramedMessage& message, size_t offset,
+                           int passFd = -1);
+
+/**
+ * @brief Standard (padded) base64 encoding
+ */
+std::string base64Encode(const uint8_t* data, size_t size);
+
+/**
+ * @brief Compute Sec-WebSocket-Accept for a client's Sec-WebSocket-Key
+ */
+std::string computeWsAcceptKey(const std::string& clientKey);
+
+/**
+ * @brief A complete (defragmented) WebSocket message
+ */
+struct WsMessage {
+    WsOpcode opcode = WsOpcode::Text;
+    std::string payload;
+};
+
+/**
+ * @brief Incremental WebSocket frame parser for incoming data
+ *
+ * Reassembles fragmented messages and unmasks client payloads. Control frames
+ * (ping/pong/close) are returned as soon as they are complete, even in the
+ * middle of a fragmented data message.
+ *
+ * Usage:
+ *   parser.append(buf, n);
+ *   WsMessage msg;
+ *   while (parser.next(msg)) { ... }
+ *   if (parser.failed()) { close connection }
+ */
+class WsFrameParser {
+public:
+    /**
+     * @param expectMasked True when parsing client → server frames (RFC 6455 requires masking)
+     * @param maxMessageSize Upper bound for a reassembled message in bytes
+     */
+    explicit WsFrameParser(bool expectMasked = true, size_t maxMessageSize = 1 << 20);
+
+    void append(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Extract the next complete message
+     * @return true if a message was written to out
+     */
+    bool next(WsMessage& out);
+
+    bool failed() const { return failed_; }
+
+private:
+    bool expectMasked_;
+    size_t maxMessageSize_;
+    bool failed_ = false;
+
+    std::vector<uint8_t> buffer_;
+    size_t readPos_ = 0;
+
+    bool fragmenting_ = false;
+    WsOpcode fragmentOpcode_ = WsOpcode::Text;
+    std::string fragments_;
+};
+
+}  // namespace kinect_xr
@@ -5,12 +5,16 @@
 
 #include "kinect_xr/bridge_server.h"
 #include "kinect_xr/device.h"
+#include "kinect_xr/reactor_transport.h"
+#include "kinect_xr/trace_event.h"
 
-#include <ixwebsocket/IXWebSocketServer.h>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
@@ -23,10 +27,427 @@ namespace {
 constexpr int FRAME_INTERVAL_MS = 33;  // ~30 Hz
 constexpr const char* PROTOCOL_VERSION = "1.0";
 constexpr const char* SERVER_NAME = "kinect-xr-bridge";
+constexpr uint32_t SHM_SLOT_COUNT = 8;  // ~130 ms of RGB + depth
+
+uint32_t readFrameId(const uint8_t* header) {
+    return static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+           (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+}
+
+// History requests
+constexpr size_t MAX_REPLAY_FRAMES = 150;  // ~5 s per stream at 30 Hz
+constexpr size_t DEFAULT_REPLAY_FRAMES = 30;
+
+int64_t wallClockUsNow() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Client wall-clock times are epoch milliseconds. Anything outside this window
+// is refused, which keeps conversions and clock offsets far from int64 overflow.
+constexpr double MAX_CLIENT_TIME_MS = 1e13;  // Year 2286
+
+// Client milliseconds (with fractions) to microseconds
+bool readClientMs(const json& value, int64_t& us) {
+    if (!value.is_number()) {
+        return false;
+    }
+    double ms = value.get<double>();
+    if (!std::isfinite(ms) || ms < 0.0 || ms > MAX_CLIENT_TIME_MS) {
+        return false;
+    }
+    us = static_cast<int64_t>(std::llround(ms * 1000.0));
+    return true;
+}
+
+uint64_t wallClockMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+json latencyJson(const LatencySummary& summary) {
+    return {
+        {"count", summary.count},
+        {"mean_us", summary.meanUs},
+        {"p50_us", summary.p50Us},
+        {"p90_us", summary.p90Us},
+        {"p99_us", summary.p99Us},
+        {"max_us", summary.maxUs}
+    };
+}
+
+// Spans with at least one sample
+json latencySpansJson(const LatencyHistograms& histograms) {
+    json spans = json::object();
+    for (size_t i = 0; i < LATENCY_SPAN_COUNT; i++) {
+        LatencySummary summary = histograms.spans[i].summary();
+        if (summary.count > 0) {
+            spans[latencySpanName(static_cast<LatencySpan>(i))] = latencyJson(summary);
+        }
+    }
+    return spans;
+}
+
+bool parseLedState(const std::string& name, LEDState& state) {
+    static const std::pair<const char*, LEDState> NAMES[] = {
+        {"off", LEDState::Off},
+        {"green", LEDState::Green},
+        {"red", LEDState::Red},
+        {"yellow", LEDState::Yellow},
+        {"blink_green", LEDState::BlinkGreen},
+        {"blink_red_yellow", LEDState::BlinkRedYellow},
+    };
+    for (const auto& entry : NAMES) {
+        if (name == entry.first) {
+            state = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Binary control messages carry the LEDState value itself; 5 is unused
+bool ledStateFromWire(uint8_t value) {
+    return value <= static_cast<uint8_t>(LEDState::BlinkRedYellow) && value != 5;
+}
+
+const char* tiltStatusName(TiltStatus status) {
+    switch (status) {
+        case TiltStatus::Stopped:
+            return "STOPPED";
+        case TiltStatus::Moving:
+            return "MOVING";
+        case TiltStatus::AtLimit:
+            return "LIMIT";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+uint16_t streamTypeFromName(const std::string& name) {
+    if (name == "rgb") return STREAM_TYPE_RGB;
+    if (name == "depth") return STREAM_TYPE_DEPTH;
+    return 0;
+}
+
+// Wire layouts: the RGB pixel format or depth packing a client asked for,
+// as an index where 0 is the layout as captured
+constexpr size_t FRAME_LAYOUT_COUNT = std::max(PIXEL_FORMAT_COUNT, DEPTH_PACKING_COUNT);
+
+uint8_t layoutFor(uint16_t streamType, const ClientState& state) {
+    if (streamType == STREAM_TYPE_RGB) return static_cast<uint8_t>(state.rgbFormat);
+    if (streamType == STREAM_TYPE_DEPTH) return static_cast<uint8_t>(state.depthPacking);
+    return 0;
+}
+
+// Frame in the given layout; frames that cannot be converted pass through
+SharedFrame inLayout(const SharedFrame& frame, uint16_t streamType, uint8_t layout) {
+    if (layout == 0) {
+        return frame;
+    }
+    SharedFrame converted;
+    if (streamType == STREAM_TYPE_RGB) {
+        converted = convertRgbFrame(frame, static_cast<PixelFormat>(layout));
+    } else if (streamType == STREAM_TYPE_DEPTH) {
+        converted = packDepthFrame(frame, static_cast<DepthPacking>(layout));
+    }
+    return converted ? converted : frame;
+}
+
+// Read a non-negative integer field no larger than `max`; negatives and floats
+// are refused rather than wrapped or converted out of range
+bool readUnsigned(const json& value, uint64_t max, uint64_t& out) {
+    if (!value.is_number_unsigned() || value.get<uint64_t>() > max) {
+        return false;
+    }
+    out = value.get<uint64_t>();
+    return true;
+}
+
+// Read "rgb_format" / "depth_format" of subscribe, or "format" of history requests
+bool readLayout(const json& value, uint16_t streamType, uint8_t& layout) {
+    if (!value.is_string()) {
+        return false;
+    }
+    if (streamType == STREAM_TYPE_RGB) {
+        PixelFormat format;
+        if (!parsePixelFormat(value.get<std::string>(), format)) return false;
+        layout = static_cast<uint8_t>(format);
+        return true;
+    }
+    DepthPacking packing;
+    if (!parseDepthPacking(value.get<std::string>(), packing)) return false;
+    layout = static_cast<uint8_t>(packing);
+    return true;
+}
+
+// Read the "pointcloud" object of a subscribe message
+bool readPointCloudParams(const json& options, PointCloudParams& params, std::string& error) {
+    if (!options.is_object()) {
+        error = "pointcloud options must be an object";
+        return false;
+    }
+    uint32_t decimation = options.value("decimation", static_cast<uint32_t>(params.decimation));
+    if (!isValidDecimation(decimation)) {
+        error = "pointcloud decimation must be 1, 2, 4 or 8";
+        return false;
+    }
+    params.decimation = static_cast<uint8_t>(decimation);
+
+    std::string format = options.value("format", "int16");
+    if (format == "int16") {
+        params.format = PointFormat::Int16Mm;
+    } else if (format == "float16") {
+        params.format = PointFormat::Float16Metres;
+    } else {
+        error = "pointcloud format must be \"int16\" or \"float16\"";
+        return false;
+    }
+
+    params.color = options.value("color", params.color);
+    params.minDepthMm = options.value("min_depth_mm", params.minDepthMm);
+    params.maxDepthMm = options.value("max_depth_mm", params.maxDepthMm);
+    return true;
+}
+
+// Read the "mesh" object of a subscribe message
+bool readMeshParams(const json& options, MeshParams& params, std::string& error) {
+    if (!options.is_object()) {
+        error = "mesh options must be an object";
+        return false;
+    }
+    uint32_t step = options.value("step", static_cast<uint32_t>(params.step));
+    if (!isValidMeshStep(step)) {
+        error = "mesh step must be 1, 2, 4, 8 or 16";
+        return false;
+    }
+    params.step = static_cast<uint8_t>(step);
+    params.adaptive = options.value("adaptive", params.adaptive);
+
+    // Ratios travel as floats; the mesher works in per mille
+    double discontinuity = options.value("discontinuity", params.discontinuityPermille / 1000.0);
+    double flatness = options.value("flatness", params.flatnessPermille / 1000.0);
+    if (discontinuity <= 0.0 || discontinuity > 1.0 || flatness < 0.0 || flatness > 1.0) {
+        error = "mesh discontinuity must be in (0, 1] and flatness in [0, 1]";
+        return false;
+    }
+    params.discontinuityPermille = static_cast<uint16_t>(std::lround(discontinuity * 1000.0));
+    params.flatnessPermille = static_cast<uint16_t>(std::lround(flatness * 1000.0));
+
+    params.minDepthMm = options.value("min_depth_mm", params.minDepthMm);
+    params.maxDepthMm = options.value("max_depth_mm", params.maxDepthMm);
+    return true;
+}
+
+// Read the "key" object of a subscribe message
+bool readKeyParams(const json& options, KeyParams& params, std::string& error) {
+    if (!options.is_object()) {
+        error = "key options must be an object";
+        return false;
+    }
+    std::string mode = options.value("mode", "range");
+    if (mode == "range") {
+        params.mode = KeyMode::Range;
+    } else if (mode == "background") {
+        params.mode = KeyMode::Background;
+        params.maxDepthMm = 0;  // The background is the far limit unless one is given
+    } else {
+        error = "key mode must be \"range\" or \"background\"";
+        return false;
+    }
+
+    std::string format = options.value("format", "rgba");
+    if (format == "rgba") {
+        params.format = KeyFormat::Rgba;
+    } else if (format == "jpeg") {
+        params.format = KeyFormat::JpegMask;
+    } else {
+        error = "key format must be \"rgba\" or \"jpeg\"";
+        return false;
+    }
+
+    uint32_t feather = options.value("feather", static_cast<uint32_t>(params.featherPx));
+    uint32_t quality = options.value("quality", static_cast<uint32_t>(params.quality));
+    if (feather > KEY_MAX_FEATHER || quality < 1 || quality > 100) {
+        error = "key feather must be 0 to " + std::to_string(KEY_MAX_FEATHER) +
+                " and quality 1 to 100";
+        return false;
+    }
+    params.featherPx = static_cast<uint8_t>(feather);
+    params.quality = static_cast<uint8_t>(quality);
+
+    params.minDepthMm = options.value("min_depth_mm", params.minDepthMm);
+    params.maxDepthMm = options.value("max_depth_mm", params.maxDepthMm);
+    params.toleranceMm = options.value("tolerance_mm", params.toleranceMm);
+    return true;
+}
+
+// Read the "contours" object of a subscribe message
+bool readContourParams(const json& options, ContourParams& params, std::string& error) {
+    if (!options.is_object()) {
+        error = "contours options must be an object";
+        return false;
+    }
+    std::string mode = options.value("mode", "range");
+    if (mode == "range") {
+        params.mode = KeyMode::Range;
+    } else if (mode == "background") {
+        params.mode = KeyMode::Background;
+        params.maxDepthMm = 0;  // The background is the far limit unless one is given
+    } else {
+        error = "contours mode must be \"range\" or \"background\"";
+        return false;
+    }
+
+    uint32_t step = options.value("step", static_cast<uint32_t>(params.step));
+    if (!isValidContourStep(step)) {
+        error = "contours step must be 1, 2, 4 or 8";
+        return false;
+    }
+    params.step = static_cast<uint8_t>(step);
+
+    // The tolerance travels in pixels; the tracer works in tenths
+    double epsilon = options.value("epsilon", params.epsilonTenthsPx / 10.0);
+    uint32_t minArea = options.value("min_area", static_cast<uint32_t>(params.minAreaPx));
+    uint32_t minDepth = options.value("min_depth_mm", static_cast<uint32_t>(params.minDepthMm));
+    uint32_t maxDepth = options.value("max_depth_mm", static_cast<uint32_t>(params.maxDepthMm));
+    uint32_t tolerance = options.value("tolerance_mm", static_cast<uint32_t>(params.toleranceMm));
+    if (epsilon < 0.0 || epsilon * 10.0 > CONTOUR_MAX_EPSILON_TENTHS + 0.5 || minArea > CONTOUR_MAX_AREA_PX ||
+        minDepth > CONTOUR_MAX_DEPTH_MM || maxDepth > CONTOUR_MAX_DEPTH_MM ||
+        tolerance > CONTOUR_MAX_TOLERANCE_MM) {
+        error = "contours epsilon must be 0 to 12.7, min_area at most " + std::to_string(CONTOUR_MAX_AREA_PX) +
+                ", depths at most " + std::to_string(CONTOUR_MAX_DEPTH_MM) + " and tolerance_mm at most " +
+                std::to_string(CONTOUR_MAX_TOLERANCE_MM);
+        return false;
+    }
+    params.epsilonTenthsPx = static_cast<uint8_t>(std::lround(epsilon * 10.0));
+    params.minAreaPx = static_cast<uint16_t>(minArea);
+    params.minDepthMm = static_cast<uint16_t>(minDepth);
+    params.maxDepthMm = static_cast<uint16_t>(maxDepth);
+    params.toleranceMm = static_cast<uint16_t>(tolerance);
+    return true;
+}
+
+// HTTP endpoints
+constexpr const char* MJPEG_PATH = "/rgb.mjpeg";
+constexpr const char* MJPEG_BOUNDARY = "kinectframe";
+constexpr const char* METRICS_PATH = "/metrics";
+constexpr const char* TRACE_PATH = "/trace";
+constexpr size_t MJPEG_MAX_BUFFERED = 256 * 1024;  // Skip frames for viewers this far behind
+
+struct SnapshotRoute {
+    const char* path;
+    SnapshotFormat format;
+};
+
+constexpr SnapshotRoute SNAPSHOT_ROUTES[] = {
+    {"/rgb.jpg", SnapshotFormat::RgbJpeg},
+    {"/rgb.png", SnapshotFormat::RgbPng},
+    {"/depth.png", SnapshotFormat::DepthPng},
+    {"/depth.raw", SnapshotFormat::DepthRaw},
+    {"/pointcloud.ply", SnapshotFormat::PointCloudPly},
+};
+
+SharedFrame rawText(const std::string& text) {
+    return FramedMessage::raw(std::vector<uint8_t>(text.begin(), text.end()));
+}
 }  // namespace
 
 BridgeServer::BridgeServer()
-    : lastStatsTime_(std::chrono::steady_clock::now()) {}
+    : lastStatsTime_(std::chrono::steady_clock::now()) {
+    registerMetrics();
+}
+
+void BridgeServer::registerMetrics() {
+    // Device
+    deviceFrames_[0] = &metrics_.counter("kinect_device_frames_total", "Frames captured (or generated in mock mode)",
+                                         {{"stream", "rgb"}});
+    deviceFrames_[1] = &metrics_.counter("kinect_device_frames_total", "Frames captured (or generated in mock mode)",
+                                         {{"stream", "depth"}});
+    metrics_.sampled(MetricType::Gauge, "kinect_device_connected", "Kinect (or mock source) connected", {},
+                     [this] { return (kinectConnected_ || mockMode_) ? 1.0 : 0.0; });
+
+    // Pipeline
+    broadcasts_ = &metrics_.counter("kinect_broadcasts_total", "Frames taken from the cache and broadcast");
+    metrics_.sampled(MetricType::Counter, "kinect_frames_sent_total", "Messages queued to clients", {},
+                     [this] { return static_cast<double>(framesSent_.load()); });
+    metrics_.sampled(MetricType::Counter, "kinect_frames_dropped_total", "Broadcast ticks skipped behind schedule",
+                     {}, [this] { return static_cast<double>(droppedFrames_.load()); });
+    for (size_t i = 0; i < LATENCY_SPAN_COUNT; i++) {
+        auto span = static_cast<LatencySpan>(i);
+        metrics_.histogramView("kinect_frame_latency_seconds", "Frame latency by span (see latency_trace.h)",
+                               {{"span", latencySpanName(span)}}, tracer_.histograms()[span]);
+    }
+
+    // Encoders: derived streams are encoded once per parameter set and frame
+    const std::pair<uint16_t, const char*> encoded[] = {
+        {STREAM_TYPE_POINTCLOUD, "pointcloud"},
+        {STREAM_TYPE_MESH, "mesh"},
+        {STREAM_TYPE_KEYED, "keyed"},
+        {STREAM_TYPE_CONTOURS, "contours"},
+    };
+    for (const auto& [streamType, name] : encoded) {
+        encodes_[streamType] = &metrics_.counter("kinect_encodes_total", "Derived stream encodes",
+                                                 {{"stream", name}});
+        encodeTime_[streamType] = &metrics_.histogram("kinect_encode_seconds", "Derived stream encode time",
+                                                      {{"stream", name}});
+    }
+    metrics_.sampled(MetricType::Counter, "kinect_snapshot_encodes_total", "HTTP snapshot encodes", {},
+                     [this] { return static_cast<double>(snapshots_.encodes()); });
+
+    // Transport
+    metrics_.sampled(MetricType::Gauge, "kinect_clients", "Connected WebSocket and Unix socket clients", {},
+                     [this] { return static_cast<double>(getClientCount()); });
+    metrics_.sampled(MetricType::Gauge, "kinect_mjpeg_viewers", "Connected MJPEG viewers", {},
+                     [this] { return static_cast<double>(mjpegViewerCount_.load()); });
+    bytesQueued_ = &metrics_.counter("kinect_bytes_queued_total", "Frame bytes queued to clients");
+    for (size_t p = 0; p < SEND_PRIORITY_COUNT; p++) {
+        MetricLabels labels = {{"priority", sendPriorityName(static_cast<SendPriority>(p))}};
+        auto sum = [this, p](auto field) {
+            return [this, p, field] {
+                double total = 0;
+                auto snapshot = clients_.snapshot();
+                for (const auto& entry : snapshot->clients) {
+                    total += static_cast<double>(entry.client->sendStats().priorities[p].*field);
+                }
+                return total;
+            };
+        };
+        metrics_.sampled(MetricType::Gauge, "kinect_send_queue_messages", "Messages waiting in client send queues",
+                         labels, sum(&SendPriorityStats::queued));
+        metrics_.sampled(MetricType::Gauge, "kinect_send_queue_bytes", "Bytes waiting in client send queues",
+                         labels, sum(&SendPriorityStats::queuedBytes));
+    }
+
+    registerLockMetrics();
+}
+
+void BridgeServer::registerLockMetrics() {
+    // Locks register their stats when first constructed (a session's frame
+    // cache, a device opened after the server), so catch up before each export
+    auto locks = LockStats::all();
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    for (size_t i = lockMetricsCount_; i < locks.size(); i++) {
+        const LockStats* stats = locks[i];
+        MetricLabels labels = {{"lock", stats->name}};
+        auto seconds = [](const std::atomic<uint64_t>& ns) {
+            return [&ns] { return static_cast<double>(ns.load(std::memory_order_relaxed)) / 1e9; };
+        };
+        metrics_.sampled(MetricType::Counter, "kinect_lock_acquisitions_total", "Lock acquisitions", labels,
+                         [stats] { return static_cast<double>(stats->acquisitions.load()); });
+        metrics_.sampled(MetricType::Counter, "kinect_lock_contended_total", "Lock acquisitions that had to wait",
+                         labels, [stats] { return static_cast<double>(stats->contended.load()); });
+        metrics_.sampled(MetricType::Counter, "kinect_lock_wait_seconds_total", "Time spent waiting for the lock",
+                         labels, seconds(stats->waitNs));
+        metrics_.sampled(MetricType::Gauge, "kinect_lock_wait_max_seconds", "Longest wait for the lock", labels,
+                         seconds(stats->maxWaitNs));
+        metrics_.sampled(MetricType::Counter, "kinect_lock_hold_seconds_total", "Time the lock was held", labels,
+                         seconds(stats->holdNs));
+        metrics_.sampled(MetricType::Gauge, "kinect_lock_hold_max_seconds", "Longest time the lock was held",
+                         labels, seconds(stats->maxHoldNs));
+    }
+    lockMetricsCount_ = locks.size();
+}
 
 BridgeServer::~BridgeServer() {
     stop();
@@ -39,53 +460,101 @@ bool BridgeServer::start(int port) {
 
     port_ = port;
 
-    // Create WebSocket server
-    server_ = std::make_unique<ix::WebSocketServer>(port, "0.0.0.0");
+    // Create transport
+    transport_ = createTransport(transportKind_, ioThreads_);
+    transport_->setSendDeadlines(sendDeadlines_);
 
-    // Set up connection handler
-    server_->setOnClientMessageCallback(
-        [this](std::shared_ptr<ix::ConnectionState> connectionState,
-               ix::WebSocket& webSocket,
-               const ix::WebSocketMessagePtr& msg) {
-            // Store raw pointer for client tracking (safe within callback scope)
-            ix::WebSocket* wsPtr = &webSocket;
+    TransportCallbacks callbacks;
+    callbacks.onOpen = [this](const ClientPtr& client) { onConnection(client); };
+    callbacks.onBinary = [this](const ClientPtr& client, const uint8_t* data, size_t size) {
+        onBinary(client, data, size);
+    };
+    callbacks.onMessage = [this](const ClientPtr& client, const std::string& message) {
+        onMessage(client, message);
+    };
+    callbacks.onClose = [this](const ClientPtr& client) { onClose(client); };
+    callbacks.onHttp = [this](const ClientPtr& client, const std::string& target) {
+        return onHttp(client, target);
+    };
 
-            switch (msg->type) {
-                case ix::WebSocketMessageType::Open:
-                    onConnection(wsPtr);
-                    break;
-                case ix::WebSocketMessageType::Close:
-                    onClose(wsPtr);
-                    break;
-                case ix::WebSocketMessageType::Message:
-                    if (!msg->binary) {
-                        onMessage(wsPtr, msg->str);
-                    }
-                    break;
-                case ix::WebSocketMessageType::Error:
-                    std::cerr << "WebSocket error: " << msg->errorInfo.reason << std::endl;
-                    break;
-                default:
-                    break;
-            }
-        });
+    // Shared-memory ring (optional)
+    if (!shmName_.empty()) {
+        shmRing_ = std::make_unique<ShmRingWriter>();
+        if (!shmRing_->create(shmName_, SHM_SLOT_COUNT, RGB_FRAME_SIZE)) {
+            shmRing_.reset();
+            transport_.reset();
+            return false;
+        }
+        std::cout << "Publishing frames to shared memory " << shmName_ << std::endl;
+    }
+
+    // Frame history (optional)
+    if (historySeconds_ > 0) {
+        history_ = std::make_unique<FrameHistory>(historySeconds_);
+        std::cout << "Keeping " << historySeconds_ << " s of compressed frame history" << std::endl;
+    }
+
+    // UDP multicast (optional)
+    if (multicastEnabled_) {
+        multicast_ = std::make_unique<MulticastSender>();
+        if (!multicast_->open(multicastConfig_)) {
+            multicast_.reset();
+            history_.reset();
+            shmRing_.reset();
+            transport_.reset();
+            return false;
+        }
+        std::cout << "Multicasting frames to " << multicastConfig_.group << ":"
+                  << multicastConfig_.port;
+        if (multicastConfig_.fecGroup > 0) {
+            std::cout << " (FEC 1/" << multicastConfig_.fecGroup << ")";
+        }
+        std::cout << std::endl;
+    }
 
     // Start listening
-    auto res = server_->listen();
-    if (!res.first) {
-        std::cerr << "Failed to start server: " << res.second << std::endl;
+    if (!transport_->start(port, callbacks)) {
+        transport_.reset();
+        shmRing_.reset();
+        history_.reset();
+        multicast_.reset();
         return false;
     }
 
-    // Start server in background
-    server_->start();
+    if (!unixPath_.empty()) {
+        unixTransport_ = std::make_unique<ReactorTransport>(1, unixPath_);
+        unixTransport_->setSendDeadlines(sendDeadlines_);
+        if (!unixTransport_->start(0, callbacks)) {
+            unixTransport_.reset();
+            transport_->stop();
+            transport_.reset();
+            shmRing_.reset();
+            history_.reset();
+            multicast_.reset();
+            return false;
+        }
+        std::cout << "Accepting local clients on " << unixPath_ << std::endl;
+    }
     running_ = true;
 
-    // Start broadcast loop
+    // Shared-memory and multicast readers are invisible to us, so keep the streams running
+    if (hasPassiveConsumers() && kinectDevice_ && !mockMode_) {
+        auto error = kinectDevice_->startStreams();
+        if (error != DeviceError::None) {
+            std::cerr << "Failed to start Kinect streams: " << errorToString(error) << std::endl;
+        }
+    }
+
+    // Start broadcast loop (fed by the upstream bridge in relay mode)
     broadcastRunning_ = true;
-    broadcastThread_ = std::thread(&BridgeServer::broadcastLoop, this);
+    if (relayUrl_.empty()) {
+        broadcastThread_ = std::thread(&BridgeServer::broadcastLoop, this);
+    } else {
+        broadcastThread_ = std::thread(&BridgeServer::relayLoop, this);
+    }
 
-    std::cout << "Bridge server started on port " << port << std::endl;
+    std::cout << "Bridge server started on port " << port
+              << " (transport: " << transport_->name() << ")" << std::endl;
     return true;
 }
 
@@ -100,10 +569,33 @@ void BridgeServer::stop() {
         broadcastThread_.join();
     }
 
-    // Stop server
-    server_->stop();
+    // Stop transports
+    transport_->stop();
+    if (unixTransport_) {
+        unixTransport_->stop();
+        unixTransport_.reset();
+    }
     running_ = false;
 
+    {
+        std::lock_guard<std::mutex> lock(mjpegMutex_);
+        if (!mjpegViewers_.empty() && getClientCount() == 0 && !hasPassiveConsumers() &&
+            kinectDevice_ && !mockMode_) {
+            kinectDevice_->stopStreams();
+        }
+        mjpegViewers_.clear();
+        mjpegViewerCount_ = 0;
+    }
+
+    if (hasPassiveConsumers()) {
+        if (kinectDevice_ && !mockMode_) {
+            kinectDevice_->stopStreams();
+        }
+        shmRing_.reset();
+        multicast_.reset();
+    }
+    history_.reset();
+
     std::cout << "Bridge server stopped" << std::endl;
 }
 
@@ -127,25 +619,19 @@ void BridgeServer::setKinectDevice(KinectDevice* device) {
 }
 
 size_t BridgeServer::getClientCount() const {
-    std::lock_guard<std::mutex> lock(clientsMutex_);
     return clients_.size();
 }
 
-void BridgeServer::onConnection(ix::WebSocket* ws) {
-    if (!ws) return;
+void BridgeServer::onConnection(const ClientPtr& client) {
+    if (!client) return;
 
     std::cout << "Client connected" << std::endl;
 
-    // Add to clients map
-    size_t clientCount;
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex_);
-        clients_[ws] = ClientState{};
-        clientCount = clients_.size();
-    }
+    // Add to client registry
+    size_t clientCount = clients_.add(client);
 
     // Start Kinect streams when first client connects
-    if (clientCount == 1 && kinectDevice_ && !mockMode_) {
+    if (clientCount == 1 && kinectDevice_ && !mockMode_ && !hasOtherConsumers()) {
         std::cout << "Starting Kinect streams (first client connected)" << std::endl;
         auto error = kinectDevice_->startStreams();
         if (error != DeviceError::None) {
@@ -154,218 +640,678 @@ void BridgeServer::onConnection(ix::WebSocket* ws) {
     }
 
     // Send hello
-    sendHello(ws);
+    sendHello(client);
 }
 
-void BridgeServer::onMessage(ix::WebSocket* ws, const std::string& message) {
-    if (!ws) return;
+void BridgeServer::onMessage(const ClientPtr& client, const std::string& message) {
+    if (!client) return;
+
+    auto msg = json::parse(message, nullptr, false);
+    if (msg.is_discarded()) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid JSON", true);
+        return;
+    }
 
+    std::string type;
     try {
-        auto msg = json::parse(message);
-        std::string type = msg.value("type", "");
+        type = msg.value("type", "");
 
         if (type == "subscribe") {
-            handleSubscribe(ws, message);
+            handleSubscribe(client, msg);
         } else if (type == "unsubscribe") {
-            handleUnsubscribe(ws);
+            handleUnsubscribe(client);
         } else if (type == "motor.setTilt") {
-            handleMotorSetTilt(ws, message);
+            setBinaryControl(client, false);
+            handleMotorSetTilt(client, ControlEncoding::Json, msg.value("angle", 0.0));
         } else if (type == "motor.setLed") {
-            handleMotorSetLed(ws, message);
+            setBinaryControl(client, false);
+            LEDState state;
+            if (!parseLedState(msg.value("state", ""), state)) {
+                sendMotorError(client, ControlEncoding::Json, ControlError::InvalidLedState,
+                    "Valid states: off, green, red, yellow, blink_green, blink_red_yellow");
+                return;
+            }
+            handleMotorSetLed(client, ControlEncoding::Json, state);
         } else if (type == "motor.reset") {
-            handleMotorReset(ws);
+            setBinaryControl(client, false);
+            handleMotorReset(client, ControlEncoding::Json);
         } else if (type == "motor.getStatus") {
-            handleMotorGetStatus(ws);
+            setBinaryControl(client, false);
+            handleMotorGetStatus(client, ControlEncoding::Json);
+        } else if (type == "status") {
+            setBinaryControl(client, false);
+            sendStatus(client);
+        } else if (type == "history.get") {
+            handleHistoryGet(client, msg);
+        } else if (type == "history.replay") {
+            handleHistoryReplay(client, msg);
+        } else if (type == "key.learn") {
+            handleKeyLearn(client, msg);
+        } else if (type == "ack") {
+            handleAck(client, msg);
+        } else if (type == "time.sync") {
+            handleTimeSync(client, msg);
+        } else if (type == "stats") {
+            sendStats(client);
+        } else if (type == "trace") {
+            handleTrace(client, msg);
         } else {
-            sendError(ws, "PROTOCOL_ERROR", "Unknown message type: " + type, true);
+            sendError(client, "PROTOCOL_ERROR", "Unknown message type: " + type, true);
         }
-    } catch (const json::parse_error& e) {
-        sendError(ws, "PROTOCOL_ERROR", "Invalid JSON: " + std::string(e.what()), true);
+    } catch (const json::exception& e) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid " + (type.empty() ? "message" : type + " message") +
+                  ": " + e.what(), true);
     }
 }
 
-void BridgeServer::onClose(ix::WebSocket* ws) {
-    if (!ws) return;
+void BridgeServer::onBinary(const ClientPtr& client, const uint8_t* data, size_t size) {
+    if (!client) return;
+
+    // Records are read in place; nothing here allocates except the replies.
+    // One registry lookup marks the client binary (for broadcasts) and
+    // serves the status records.
+    const ControlEncoding encoding = ControlEncoding::Binary;
+    auto snapshot = clients_.snapshot();
+    const ClientEntry* entry = snapshot->find(client);
+    if (entry) {
+        entry->session->binaryControl = true;
+    }
+    ControlReader reader(data, size);
+    ControlRecord record;
+    while (reader.next(record)) {
+        int16_t tenths = 0;
+        uint8_t led = 0;
+        switch (record.type) {
+            case ControlType::MotorSetTilt:
+                if (!record.readInt16(tenths)) {
+                    sendMotorError(client, encoding, ControlError::ProtocolError, "motor.setTilt needs an int16 angle");
+                    break;
+                }
+                handleMotorSetTilt(client, encoding, tenths / 10.0);
+                break;
+            case ControlType::MotorSetLed:
+                if (!record.readUint8(led) || !ledStateFromWire(led)) {
+                    sendMotorError(client, encoding, ControlError::InvalidLedState, "Valid states: 0-4, 6");
+                    break;
+                }
+                handleMotorSetLed(client, encoding, static_cast<LEDState>(led));
+                break;
+            case ControlType::MotorReset:
+                handleMotorReset(client, encoding);
+                break;
+            case ControlType::MotorGetStatus:
+                handleMotorGetStatus(client, encoding);
+                break;
+            case ControlType::Status:
+                sendBinaryStatus(client, entry);
+                break;
+            default:
+                sendMotorError(client, encoding, ControlError::ProtocolError, "Unknown control record");
+                break;
+        }
+    }
+    if (reader.failed()) {
+        sendMotorError(client, encoding, ControlError::ProtocolError, "Malformed control message");
+    }
+}
+
+void BridgeServer::onClose(const ClientPtr& client) {
+    if (!client) return;
 
     std::cout << "Client disconnected" << std::endl;
 
-    size_t clientCount;
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex_);
-        clients_.erase(ws);
-        clientCount = clients_.size();
+    size_t clientCount = clients_.remove(client);
+
+    // Stop Kinect streams when last client disconnects
+    if (clientCount == 0 && kinectDevice_ && !mockMode_ && !hasOtherConsumers()) {
+        std::cout << "Stopping Kinect streams (no clients connected)" << std::endl;
+        auto error = kinectDevice_->stopStreams();
+        if (error != DeviceError::None) {
+            std::cerr << "Failed to stop Kinect streams: " << errorToString(error) << std::endl;
+        }
+    }
+}
+
+bool BridgeServer::onHttp(const ClientPtr& client, const std::string& target) {
+    if (!client) return false;
+
+    std::string path = target.substr(0, target.find('?'));
+    for (const auto& route : SNAPSHOT_ROUTES) {
+        if (path == route.path) {
+            sendSnapshot(client, route.format);
+            return true;
+        }
+    }
+    if (path == MJPEG_PATH) {
+        addMjpegViewer(client);
+        return true;
+    }
+    if (path == METRICS_PATH) {
+        registerLockMetrics();
+        std::string body = metrics_.prometheusText();
+        client->sendFrame(rawText(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Cache-Control: no-store\r\n"
+            "Connection: close\r\n\r\n" + body));
+        client->close();
+        return true;
+    }
+    if (path == TRACE_PATH) {
+        std::string body = TraceRecorder::instance().chromeJson();
+        client->sendFrame(rawText(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Content-Disposition: attachment; filename=\"kinect-bridge-trace.json\"\r\n"
+            "Cache-Control: no-store\r\n"
+            "Connection: close\r\n\r\n" + body));
+        client->close();
+        return true;
+    }
+    return false;
+}
+
+void BridgeServer::sendSnapshot(const ClientPtr& client, SnapshotFormat format) {
+    // Encoded at most once per frame; every poller queues the same body bytes
+    uint32_t frameId = 0;
+    SharedFrame body = snapshots_.get(format, &frameId);
+    if (!body) {
+        client->sendFrame(rawText(
+            "HTTP/1.1 503 Service Unavailable\r\n"
+            "Content-Length: 0\r\n"
+            "Retry-After: 1\r\n"
+            "Connection: close\r\n\r\n"));
+        client->close();
+        return;
+    }
+
+    client->sendFrame(rawText(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: " + std::string(snapshotContentType(format)) + "\r\n"
+        "Content-Length: " + std::to_string(body->payloadSize()) + "\r\n"
+        "Cache-Control: no-store\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "X-Frame-Id: " + std::to_string(frameId) + "\r\n"
+        "Connection: close\r\n\r\n"));
+    client->sendFrame(body);
+    client->close();
+}
+
+void BridgeServer::addMjpegViewer(const ClientPtr& client) {
+    client->sendFrame(rawText(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: multipart/x-mixed-replace; boundary=" + std::string(MJPEG_BOUNDARY) + "\r\n"
+        "Cache-Control: no-store\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: close\r\n\r\n"));
+
+    std::cout << "MJPEG viewer connected" << std::endl;
+
+    // MJPEG viewers keep the Kinect streams running like WebSocket clients
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mjpegMutex_);
+        first = mjpegViewers_.empty();
+        mjpegViewers_.push_back(client);
+        mjpegViewerCount_ = mjpegViewers_.size();
+    }
+    if (first && getClientCount() == 0 && kinectDevice_ && !mockMode_ && !hasPassiveConsumers()) {
+        auto error = kinectDevice_->startStreams();
+        if (error != DeviceError::None) {
+            std::cerr << "Failed to start Kinect streams: " << errorToString(error) << std::endl;
+        }
+    }
+}
+
+void BridgeServer::publishMjpeg() {
+    KINECT_XR_TRACE_SCOPE("bridge", "publishMjpeg");
+    uint32_t frameId = 0;
+    SharedFrame jpeg = snapshots_.get(SnapshotFormat::RgbJpeg, &frameId);
+    bool fresh = jpeg && frameId != lastMjpegFrameId_;
+    lastMjpegFrameId_ = frameId;
+
+    // One part header per frame, shared like the JPEG body
+    SharedFrame partHeader;
+    static const SharedFrame partTrailer = rawText("\r\n");
+    if (fresh) {
+        partHeader = rawText(
+            "--" + std::string(MJPEG_BOUNDARY) + "\r\n"
+            "Content-Type: image/jpeg\r\n"
+            "Content-Length: " + std::to_string(jpeg->payloadSize()) + "\r\n"
+            "X-Frame-Id: " + std::to_string(frameId) + "\r\n\r\n");
+    }
+
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(mjpegMutex_);
+        size_t before = mjpegViewers_.size();
+        mjpegViewers_.erase(std::remove_if(mjpegViewers_.begin(), mjpegViewers_.end(),
+                                           [](const ClientPtr& viewer) { return !viewer->isOpen(); }),
+                            mjpegViewers_.end());
+        mjpegViewerCount_ = mjpegViewers_.size();
+        last = before > 0 && mjpegViewers_.empty();
+
+        for (const auto& viewer : mjpegViewers_) {
+            // Slow viewers skip frames instead of growing their queue
+            if (fresh && viewer->bufferedBytes() < MJPEG_MAX_BUFFERED) {
+                viewer->sendFrame(partHeader);
+                viewer->sendFrame(jpeg);
+                viewer->sendFrame(partTrailer);
+            }
+        }
+    }
+
+    if (last) {
+        std::cout << "MJPEG viewers disconnected" << std::endl;
+        if (getClientCount() == 0 && kinectDevice_ && !mockMode_ && !hasPassiveConsumers()) {
+            auto error = kinectDevice_->stopStreams();
+            if (error != DeviceError::None) {
+                std::cerr << "Failed to stop Kinect streams: " << errorToString(error) << std::endl;
+            }
+        }
+    }
+}
+
+void BridgeServer::handleSubscribe(const ClientPtr& client, const json& msg) {
+    if (!client) return;
+
+    try {
+        auto streams = msg.value("streams", std::vector<std::string>{});
+
+        ClientState state;
+        for (const auto& stream : streams) {
+            if (stream == "rgb") {
+                state.subscribedRgb = true;
+            } else if (stream == "depth") {
+                state.subscribedDepth = true;
+            } else if (stream == "pointcloud") {
+                state.subscribedPointCloud = true;
+            } else if (stream == "mesh") {
+                state.subscribedMesh = true;
+            } else if (stream == "keyed") {
+                state.subscribedKeyed = true;
+            } else if (stream == "contours") {
+                state.subscribedContours = true;
+            }
+        }
+        state.adaptive = msg.value("adaptive", false);
+        state.tiles = msg.value("tiles", false);
+        state.bundle = msg.value("bundle", false);
+
+        uint8_t layout = 0;
+        if (msg.contains("rgb_format")) {
+            if (!readLayout(msg["rgb_format"], STREAM_TYPE_RGB, layout)) {
+                sendError(client, "PROTOCOL_ERROR", "rgb_format must be \"RGB888\", \"RGBA8888\" or \"BGRA8888\"", true);
+                return;
+            }
+            state.rgbFormat = static_cast<PixelFormat>(layout);
+        }
+        if (msg.contains("depth_format")) {
+            if (!readLayout(msg["depth_format"], STREAM_TYPE_DEPTH, layout)) {
+                sendError(client, "PROTOCOL_ERROR", "depth_format must be \"uint16\", \"packed12\" or \"packed13\"", true);
+                return;
+            }
+            state.depthPacking = static_cast<DepthPacking>(layout);
+        }
+        if (state.tiles && state.depthPacking != DepthPacking::None) {
+            sendError(client, "PROTOCOL_ERROR", "tiles cannot be combined with a packed depth_format", true);
+            return;
+        }
+
+        if (msg.contains("pointcloud")) {
+            std::string error;
+            if (!readPointCloudParams(msg["pointcloud"], state.pointCloud, error)) {
+                sendError(client, "PROTOCOL_ERROR", error, true);
+                return;
+            }
+        }
+        if (msg.contains("mesh")) {
+            std::string error;
+            if (!readMeshParams(msg["mesh"], state.mesh, error)) {
+                sendError(client, "PROTOCOL_ERROR", error, true);
+                return;
+            }
+        }
+        if (msg.contains("key")) {
+            std::string error;
+            if (!readKeyParams(msg["key"], state.keying, error)) {
+                sendError(client, "PROTOCOL_ERROR", error, true);
+                return;
+            }
+        }
+        if (msg.contains("contours")) {
+            std::string error;
+            if (!readContourParams(msg["contours"], state.contours, error)) {
+                sendError(client, "PROTOCOL_ERROR", error, true);
+                return;
+            }
+        }
+
+        // Late joiners can ask for the newest stored frame instead of waiting.
+        // Queue it before the subscription takes effect so no live frame
+        // overtakes it.
+        if (msg.value("catch_up", false)) {
+            sendCatchUp(client, state);
+        }
+
+        if (clients_.update(client, state)) {
+            std::cout << "Client subscribed to: ";
+            if (state.subscribedRgb) std::cout << "rgb(" << pixelFormatName(state.rgbFormat) << ") ";
+            if (state.subscribedDepth) std::cout << "depth(" << depthPackingName(state.depthPacking) << ") ";
+            if (state.subscribedPointCloud) std::cout << "pointcloud ";
+            if (state.subscribedMesh) std::cout << "mesh ";
+            if (state.subscribedKeyed) std::cout << "keyed ";
+            if (state.subscribedContours) std::cout << "contours ";
+            std::cout << std::endl;
+        }
+    } catch (const json::exception& e) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid subscribe message", true);
+    }
+}
+
+void BridgeServer::handleUnsubscribe(const ClientPtr& client) {
+    if (!client) return;
+
+    clients_.update(client, ClientState{});
+
+    std::cout << "Client unsubscribed" << std::endl;
+}
+
+void BridgeServer::handleHistoryGet(const ClientPtr& client, const json& msg) {
+    if (!client) return;
+
+    if (!history_) {
+        sendError(client, "HISTORY_DISABLED", "Frame history is not enabled on this bridge", true);
+        return;
+    }
+
+    try {
+        uint16_t streamType = streamTypeFromName(msg.value("stream", ""));
+        if (streamType == 0) {
+            sendError(client, "PROTOCOL_ERROR", "history.get needs stream \"rgb\" or \"depth\"", true);
+            return;
+        }
+
+        uint8_t layout = 0;
+        if (msg.contains("format") && !readLayout(msg["format"], streamType, layout)) {
+            sendError(client, "PROTOCOL_ERROR", "history.get format is not a format of this stream", true);
+            return;
+        }
+
+        auto invalid = [&](const char* field) {
+            sendError(client, "PROTOCOL_ERROR", std::string("history.get ") + field + " must be a non-negative integer",
+                      true);
+        };
+
+        SharedFrame frame;
+        uint64_t value = 0;
+        if (msg.contains("frame_id")) {
+            if (!readUnsigned(msg["frame_id"], UINT32_MAX, value)) return invalid("frame_id");
+            frame = history_->get(streamType, static_cast<uint32_t>(value));
+        } else if (msg.contains("timestamp_ms")) {
+            if (!readUnsigned(msg["timestamp_ms"], UINT64_MAX, value)) return invalid("timestamp_ms");
+            frame = history_->getAt(streamType, value);
+        } else if (msg.contains("ago_ms")) {
+            if (!readUnsigned(msg["ago_ms"], UINT64_MAX, value)) return invalid("ago_ms");
+            uint64_t ago = value;
+            uint64_t now = wallClockMs();
+            frame = history_->getAt(streamType, now > ago ? now - ago : 0);
+        } else {
+            frame = history_->latest(streamType);
+        }
+
+        if (!frame) {
+            sendError(client, "HISTORY_MISS", "Requested frame is not in history", true);
+            return;
+        }
+        client->sendFrame(inLayout(frame, streamType, layout));
+    } catch (const json::exception& e) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid history.get message", true);
+    }
+}
+
+void BridgeServer::handleHistoryReplay(const ClientPtr& client, const json& msg) {
+    if (!client) return;
+
+    if (!history_) {
+        sendError(client, "HISTORY_DISABLED", "Frame history is not enabled on this bridge", true);
+        return;
+    }
+
+    try {
+        std::string streamName = msg.value("stream", "");
+        uint16_t streamType = streamTypeFromName(streamName);
+        if (streamType == 0) {
+            sendError(client, "PROTOCOL_ERROR", "history.replay needs stream \"rgb\" or \"depth\"", true);
+            return;
+        }
+
+        uint8_t layout = 0;
+        if (msg.contains("format") && !readLayout(msg["format"], streamType, layout)) {
+            sendError(client, "PROTOCOL_ERROR", "history.replay format is not a format of this stream", true);
+            return;
+        }
+
+        std::vector<SharedFrame> frames;
+        if (msg.contains("seconds")) {
+            double seconds = msg["seconds"].get<double>();
+            if (!std::isfinite(seconds) || seconds <= 0.0 || seconds > history_->seconds()) {
+                sendError(client, "PROTOCOL_ERROR", "history.replay seconds must be within the history window", true);
+                return;
+            }
+            auto span = static_cast<uint64_t>(seconds * 1000.0);
+            uint64_t now = wallClockMs();
+            frames = history_->since(streamType, now > span ? now - span : 0);
+            if (frames.size() > MAX_REPLAY_FRAMES) {
+                frames.erase(frames.begin(), frames.end() - MAX_REPLAY_FRAMES);
+            }
+        } else {
+            uint64_t count = DEFAULT_REPLAY_FRAMES;
+            if (msg.contains("count") && !readUnsigned(msg["count"], UINT64_MAX, count)) {
+                sendError(client, "PROTOCOL_ERROR", "history.replay count must be a non-negative integer", true);
+                return;
+            }
+            count = std::min<uint64_t>(count, MAX_REPLAY_FRAMES);
+            frames = history_->recent(streamType, static_cast<size_t>(count));
+        }
+
+        // Announce the burst so the client knows how many flagged frames follow
+        json reply = {
+            {"type", "history.replay"},
+            {"stream", streamName},
+            {"frames", frames.size()}
+        };
+        client->sendText(reply.dump());
+        for (const auto& frame : frames) {
+            client->sendFrame(inLayout(frame, streamType, layout));
+        }
+    } catch (const json::exception& e) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid history.replay message", true);
+    }
+}
+
+void BridgeServer::handleAck(const ClientPtr& client, const json& msg) {
+    if (!client) return;
+
+    int64_t receivedUs = 0;
+    int64_t renderedUs = 0;
+    if ((msg.contains("received_ms") && !readClientMs(msg["received_ms"], receivedUs)) ||
+        (msg.contains("rendered_ms") && !readClientMs(msg["rendered_ms"], renderedUs))) {
+        sendError(client, "PROTOCOL_ERROR", "ack times must be epoch milliseconds", true);
+        return;
+    }
+
+    // Acks are best effort: unknown clients and expired frames are ignored
+    auto arrivedAt = std::chrono::steady_clock::now();
+    auto snapshot = clients_.snapshot();
+    const ClientEntry* entry = snapshot->find(client);
+    if (!entry) {
+        return;
+    }
+    // Client times move onto the bridge clock once time.sync has an estimate
+    const ClockSync& clock = entry->session->clock;
+    bool synced = clock.estimate().valid;
+    auto toUs = [&](int64_t us) -> uint64_t {
+        if (us <= 0) return 0;
+        return static_cast<uint64_t>(std::max<int64_t>(1, synced ? clock.toBridgeUs(us) : us));
+    };
+    tracer_.ack(msg.at("frame_id").get<uint32_t>(), toUs(receivedUs), toUs(renderedUs), arrivedAt,
+                &entry->session->latency);
+}
+
+void BridgeServer::handleTimeSync(const ClientPtr& client, const json& msg) {
+    if (!client) return;
+
+    int64_t t1 = wallClockUsNow();
+    int64_t t0Us = 0;
+    int64_t t3Us = 0;
+    bool completes = msg.contains("prev_id");
+    if (!readClientMs(msg.at("t0"), t0Us) || (completes && !readClientMs(msg.at("prev_t3"), t3Us))) {
+        sendError(client, "PROTOCOL_ERROR", "time.sync times must be epoch milliseconds", true);
+        return;
+    }
+
+    auto snapshot = clients_.snapshot();
+    const ClientEntry* entry = snapshot->find(client);
+    if (!entry) {
+        return;
     }
+    ClockSync& clock = entry->session->clock;
 
-    // Stop Kinect streams when last client disconnects
-    if (clientCount == 0 && kinectDevice_ && !mockMode_) {
-        std::cout << "Stopping Kinect streams (no clients connected)" << std::endl;
-        auto error = kinectDevice_->stopStreams();
-        if (error != DeviceError::None) {
-            std::cerr << "Failed to stop Kinect streams: " << errorToString(error) << std::endl;
-        }
+    // The previous exchange completes with the time its reply arrived
+    if (completes && clock.complete(msg.at("prev_id").get<uint32_t>(), t3Us)) {
+        ClockEstimate estimate = clock.estimate();
+        entry->rate->onRoundTrip(estimate.smoothedRttUs, estimate.minRttUs, std::chrono::steady_clock::now());
     }
+
+    uint32_t id = msg.at("id").get<uint32_t>();
+    double t0 = msg.at("t0").get<double>();
+    int64_t t2 = wallClockUsNow();
+    json reply = {
+        {"type", "time.sync"},
+        {"id", id},
+        {"t0", t0},
+        {"t1", t1 / 1000.0},
+        {"t2", t2 / 1000.0}
+    };
+    clock.replied(id, t0Us, t1, t2);
+    client->sendText(reply.dump());
 }
 
-void BridgeServer::handleSubscribe(ix::WebSocket* ws, const std::string& message) {
-    if (!ws) return;
+void BridgeServer::handleKeyLearn(const ClientPtr& client, const json& msg) {
+    if (!client) return;
 
     try {
-        auto msg = json::parse(message);
-        auto streams = msg.value("streams", std::vector<std::string>{});
-
-        std::lock_guard<std::mutex> lock(clientsMutex_);
-        auto it = clients_.find(ws);
-        if (it != clients_.end()) {
-            it->second.subscribedRgb = false;
-            it->second.subscribedDepth = false;
-
-            for (const auto& stream : streams) {
-                if (stream == "rgb") {
-                    it->second.subscribedRgb = true;
-                } else if (stream == "depth") {
-                    it->second.subscribedDepth = true;
-                }
-            }
-
-            std::cout << "Client subscribed to: ";
-            if (it->second.subscribedRgb) std::cout << "rgb ";
-            if (it->second.subscribedDepth) std::cout << "depth ";
-            std::cout << std::endl;
+        uint32_t frames = msg.value("frames", KEY_DEFAULT_LEARN_FRAMES);
+        if (frames < 1 || frames > KEY_MAX_LEARN_FRAMES) {
+            sendError(client, "PROTOCOL_ERROR", "key.learn frames must be 1 to " +
+                      std::to_string(KEY_MAX_LEARN_FRAMES), true);
+            return;
         }
-    } catch (const json::parse_error& e) {
-        sendError(ws, "PROTOCOL_ERROR", "Invalid subscribe message", true);
+        keyer_.learnBackground(frames);
+        std::cout << "Learning keying background from " << frames << " frames" << std::endl;
+
+        json reply = {
+            {"type", "key.learn"},
+            {"frames", frames}
+        };
+        client->sendText(reply.dump());
+    } catch (const json::exception& e) {
+        sendError(client, "PROTOCOL_ERROR", "Invalid key.learn message", true);
     }
 }
 
-void BridgeServer::handleUnsubscribe(ix::WebSocket* ws) {
-    if (!ws) return;
+void BridgeServer::sendCatchUp(const ClientPtr& client, const ClientState& state) {
+    if (!history_) return;
 
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    auto it = clients_.find(ws);
-    if (it != clients_.end()) {
-        it->second.subscribedRgb = false;
-        it->second.subscribedDepth = false;
+    for (uint16_t streamType : {STREAM_TYPE_RGB, STREAM_TYPE_DEPTH}) {
+        if (state.isSubscribed(streamType)) {
+            if (auto frame = history_->latest(streamType)) {
+                client->sendFrame(inLayout(frame, streamType, layoutFor(streamType, state)));
+            }
+        }
     }
-
-    std::cout << "Client unsubscribed" << std::endl;
 }
 
-void BridgeServer::handleMotorSetTilt(ix::WebSocket* ws, const std::string& message) {
-    if (!ws) return;
+void BridgeServer::handleMotorSetTilt(const ClientPtr& client, ControlEncoding encoding, double angle) {
+    if (!client) return;
 
     // Check if Kinect device is available
     if (!kinectDevice_) {
-        sendMotorError(ws, "DEVICE_NOT_CONNECTED", "Kinect device not connected");
+        sendMotorError(client, encoding, ControlError::DeviceNotConnected, "Kinect device not connected");
         return;
     }
 
-    try {
-        auto msg = json::parse(message);
-        double angle = msg.value("angle", 0.0);
-
-        // Rate limiting: 500ms minimum interval
-        {
-            std::lock_guard<std::mutex> lock(motorMutex_);
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - lastMotorCommand_).count();
-
-            if (elapsed < 500) {
-                sendMotorError(ws, "RATE_LIMITED",
-                    "Minimum 500ms between tilt commands");
-                return;
-            }
-
-            lastMotorCommand_ = now;
-        }
+    // Rate limiting: 500ms minimum interval
+    {
+        std::lock_guard<std::mutex> lock(motorMutex_);
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - lastMotorCommand_).count();
 
-        // Set tilt angle (device will clamp to [-27, 27])
-        auto error = kinectDevice_->setTiltAngle(angle);
-        if (error != DeviceError::None) {
-            sendMotorError(ws, "MOTOR_CONTROL_FAILED", errorToString(error));
+        if (elapsed < 500) {
+            sendMotorError(client, encoding, ControlError::RateLimited,
+                "Minimum 500ms between tilt commands");
             return;
         }
 
-        // After sending tilt command, the motor is now MOVING.
-        // We cannot read accurate position until the motor stops.
-        // The device's state register takes time to update after receiving a command.
-        // Start polling for motor completion - accurate position will be sent when motor stops.
-        motorMoving_ = true;
-        {
-            std::lock_guard<std::mutex> lock(motorMutex_);
-            lastMotorStatusCheck_ = std::chrono::steady_clock::now();
-        }
+        lastMotorCommand_ = now;
+    }
 
-        // Send immediate acknowledgment with MOVING status (no angle - it's unknown while moving)
-        json ack = {
-            {"type", "motor.status"},
-            {"status", "MOVING"}
-        };
-        ws->send(ack.dump());
+    // Set tilt angle (device will clamp to [-27, 27])
+    auto error = kinectDevice_->setTiltAngle(angle);
+    if (error != DeviceError::None) {
+        sendMotorError(client, encoding, ControlError::MotorControlFailed, errorToString(error));
+        return;
+    }
 
-    } catch (const json::parse_error& e) {
-        sendMotorError(ws, "PROTOCOL_ERROR", "Invalid motor.setTilt message");
+    // After sending tilt command, the motor is now MOVING.
+    // We cannot read accurate position until the motor stops.
+    // The device's state register takes time to update after receiving a command.
+    // Start polling for motor completion - accurate position will be sent when motor stops.
+    motorMoving_ = true;
+    {
+        std::lock_guard<std::mutex> lock(motorMutex_);
+        lastMotorStatusCheck_ = std::chrono::steady_clock::now();
     }
+
+    // Send immediate acknowledgment with MOVING status (no angle - it's unknown while moving)
+    MotorStatus moving{std::nan(""), TiltStatus::Moving, 0.0, 0.0, 0.0};
+    sendMotorStatus(client, encoding, moving, false);
 }
 
-void BridgeServer::handleMotorSetLed(ix::WebSocket* ws, const std::string& message) {
-    if (!ws) return;
+void BridgeServer::handleMotorSetLed(const ClientPtr& client, ControlEncoding encoding, LEDState state) {
+    if (!client) return;
 
     // Check if Kinect device is available
     if (!kinectDevice_) {
-        sendMotorError(ws, "DEVICE_NOT_CONNECTED", "Kinect device not connected");
+        sendMotorError(client, encoding, ControlError::DeviceNotConnected, "Kinect device not connected");
         return;
     }
 
-    try {
-        auto msg = json::parse(message);
-        std::string stateStr = msg.value("state", "");
-
-        // Map string to LEDState enum
-        LEDState state;
-        if (stateStr == "off") {
-            state = LEDState::Off;
-        } else if (stateStr == "green") {
-            state = LEDState::Green;
-        } else if (stateStr == "red") {
-            state = LEDState::Red;
-        } else if (stateStr == "yellow") {
-            state = LEDState::Yellow;
-        } else if (stateStr == "blink_green") {
-            state = LEDState::BlinkGreen;
-        } else if (stateStr == "blink_red_yellow") {
-            state = LEDState::BlinkRedYellow;
-        } else {
-            sendMotorError(ws, "INVALID_LED_STATE",
-                "Valid states: off, green, red, yellow, blink_green, blink_red_yellow");
-            return;
-        }
-
-        // Set LED state
-        auto error = kinectDevice_->setLED(state);
-        if (error != DeviceError::None) {
-            sendMotorError(ws, "LED_CONTROL_FAILED", errorToString(error));
-            return;
-        }
-
-        // Send success response (motor.status with current state)
-        MotorStatus status;
-        error = kinectDevice_->getMotorStatus(status);
-        if (error == DeviceError::None) {
-            sendMotorStatus(ws, status);
-        }
+    // Set LED state
+    auto error = kinectDevice_->setLED(state);
+    if (error != DeviceError::None) {
+        sendMotorError(client, encoding, ControlError::LedControlFailed, errorToString(error));
+        return;
+    }
 
-    } catch (const json::parse_error& e) {
-        sendMotorError(ws, "PROTOCOL_ERROR", "Invalid motor.setLed message");
+    // Send success response (motor.status with current state)
+    MotorStatus status;
+    error = kinectDevice_->getMotorStatus(status);
+    if (error == DeviceError::None) {
+        sendMotorStatus(client, encoding, status);
     }
 }
 
-void BridgeServer::handleMotorReset(ix::WebSocket* ws) {
-    if (!ws) return;
+void BridgeServer::handleMotorReset(const ClientPtr& client, ControlEncoding encoding) {
+    if (!client) return;
 
     // Check if Kinect device is available
     if (!kinectDevice_) {
-        sendMotorError(ws, "DEVICE_NOT_CONNECTED", "Kinect device not connected");
+        sendMotorError(client, encoding, ControlError::DeviceNotConnected, "Kinect device not connected");
         return;
     }
 
@@ -377,7 +1323,7 @@ void BridgeServer::handleMotorReset(ix::WebSocket* ws) {
             now - lastMotorCommand_).count();
 
         if (elapsed < 500) {
-            sendMotorError(ws, "RATE_LIMITED",
+            sendMotorError(client, encoding, ControlError::RateLimited,
                 "Minimum 500ms between motor commands");
             return;
         }
@@ -388,7 +1334,7 @@ void BridgeServer::handleMotorReset(ix::WebSocket* ws) {
     // Reset to 0 degrees (level position)
     auto error = kinectDevice_->setTiltAngle(0.0);
     if (error != DeviceError::None) {
-        sendMotorError(ws, "MOTOR_CONTROL_FAILED", errorToString(error));
+        sendMotorError(client, encoding, ControlError::MotorControlFailed, errorToString(error));
         return;
     }
 
@@ -396,7 +1342,7 @@ void BridgeServer::handleMotorReset(ix::WebSocket* ws) {
     MotorStatus status;
     error = kinectDevice_->getMotorStatus(status);
     if (error != DeviceError::None) {
-        sendMotorError(ws, "MOTOR_STATUS_FAILED", errorToString(error));
+        sendMotorError(client, encoding, ControlError::MotorStatusFailed, errorToString(error));
         return;
     }
 
@@ -409,15 +1355,15 @@ void BridgeServer::handleMotorReset(ix::WebSocket* ws) {
         }
     }
 
-    sendMotorStatus(ws, status);
+    sendMotorStatus(client, encoding, status);
 }
 
-void BridgeServer::handleMotorGetStatus(ix::WebSocket* ws) {
-    if (!ws) return;
+void BridgeServer::handleMotorGetStatus(const ClientPtr& client, ControlEncoding encoding) {
+    if (!client) return;
 
     // Check if Kinect device is available
     if (!kinectDevice_) {
-        sendMotorError(ws, "DEVICE_NOT_CONNECTED", "Kinect device not connected");
+        sendMotorError(client, encoding, ControlError::DeviceNotConnected, "Kinect device not connected");
         return;
     }
 
@@ -425,30 +1371,32 @@ void BridgeServer::handleMotorGetStatus(ix::WebSocket* ws) {
     MotorStatus status;
     auto error = kinectDevice_->getMotorStatus(status);
     if (error != DeviceError::None) {
-        sendMotorError(ws, "MOTOR_STATUS_FAILED", errorToString(error));
+        sendMotorError(client, encoding, ControlError::MotorStatusFailed, errorToString(error));
         return;
     }
 
-    sendMotorStatus(ws, status);
+    sendMotorStatus(client, encoding, status);
 }
 
-void BridgeServer::sendHello(ix::WebSocket* ws) {
+void BridgeServer::sendHello(const ClientPtr& client) {
     json hello = {
         {"type", "hello"},
         {"protocol_version", PROTOCOL_VERSION},
         {"server", SERVER_NAME},
         {"capabilities", {
-            {"streams", {"rgb", "depth"}},
+            {"streams", {"rgb", "depth", "pointcloud", "mesh", "keyed", "contours"}},
             {"rgb", {
                 {"width", FRAME_WIDTH},
                 {"height", FRAME_HEIGHT},
                 {"format", "RGB888"},
+                {"formats", {"RGB888", "RGBA8888", "BGRA8888"}},
                 {"bytes_per_frame", RGB_FRAME_SIZE}
             }},
             {"depth", {
                 {"width", FRAME_WIDTH},
                 {"height", FRAME_HEIGHT},
                 {"format", "UINT16"},
+                {"formats", {"uint16", "packed12", "packed13"}},
                 {"bits_per_pixel", 16},
                 {"bytes_per_frame", DEPTH_FRAME_SIZE},
                 {"min_depth_mm", 800},
@@ -463,10 +1411,111 @@ void BridgeServer::sendHello(ix::WebSocket* ws) {
         }}
     };
 
-    ws->send(hello.dump());
+    DepthIntrinsics intrinsics = DepthIntrinsics::kinectDefault();
+    hello["capabilities"]["pointcloud"] = {
+        {"formats", {"int16", "float16"}},
+        {"decimation", {1, 2, 4, 8}},
+        {"header_bytes", POINT_CLOUD_HEADER_SIZE},
+        {"intrinsics", {{"fx", intrinsics.fx}, {"fy", intrinsics.fy},
+                        {"cx", intrinsics.cx}, {"cy", intrinsics.cy}}}
+    };
+    hello["capabilities"]["mesh"] = {
+        {"steps", {1, 2, 4, 8, 16}},
+        {"max_adaptive_cell", MESH_MAX_CELL},
+        {"header_bytes", MESH_HEADER_SIZE}
+    };
+    hello["capabilities"]["keyed"] = {
+        {"modes", {"range", "background"}},
+        {"formats", {"rgba", "jpeg"}},
+        {"max_feather", KEY_MAX_FEATHER},
+        {"header_bytes", KEY_HEADER_SIZE}
+    };
+    hello["capabilities"]["contours"] = {
+        {"modes", {"range", "background"}},
+        {"steps", {1, 2, 4, 8}},
+        {"header_bytes", CONTOUR_HEADER_SIZE}
+    };
+
+    if (history_) {
+        hello["capabilities"]["history"] = {{"seconds", history_->seconds()}};
+    }
+
+    size_t variantCount = 0;
+    const DeliveryVariant* ladder = deliveryLadder(true, variantCount);
+    json variants = json::array();
+    for (size_t i = 0; i < variantCount; i++) {
+        variants.push_back(ladder[i].name());
+    }
+    hello["capabilities"]["adaptive"] = {{"variants", variants}};
+    hello["capabilities"]["tiles"] = {
+        {"size", TILE_SIZE},
+        {"refresh_frames", TileParams{}.refreshFrames},
+        {"header_bytes", TILE_HEADER_SIZE}
+    };
+    hello["capabilities"]["bundle"] = {
+        {"stream_type", STREAM_TYPE_BUNDLE},
+        {"header_bytes", BUNDLE_HEADER_SIZE},
+        {"alignment", BUNDLE_ALIGNMENT}
+    };
+    hello["capabilities"]["control"] = {
+        {"encodings", {"json", "binary"}},
+        {"stream_type", STREAM_TYPE_CONTROL},
+        {"max_reply_bytes", CONTROL_MAX_MESSAGE_SIZE}
+    };
+    hello["capabilities"]["latency"] = {
+        {"ack", true},
+        {"trace_frames", LatencyTracer::TRACE_FRAMES}
+    };
+    hello["capabilities"]["time_sync"] = {{"window", ClockSync::WINDOW}};
+    hello["capabilities"]["trace"] = {{"compiled", KINECT_XR_TRACING != 0}, {"path", TRACE_PATH}};
+
+    client->sendText(hello.dump());
+}
+
+void BridgeServer::sendStats(const ClientPtr& client) {
+    registerLockMetrics();
+    json stats = {
+        {"type", "stats"},
+        {"metrics", metrics_.toJson()}
+    };
+    client->sendText(stats.dump());
+}
+
+void BridgeServer::handleTrace(const ClientPtr& client, const json& msg) {
+    TraceRecorder& tracer = TraceRecorder::instance();
+    std::string action = msg.value("action", "status");
+    if (action == "start") {
+        if (!KINECT_XR_TRACING) {
+            sendError(client, "TRACE_UNAVAILABLE", "Built without KINECT_XR_TRACING", true);
+            return;
+        }
+        int every = msg.value("sample_every", 1);
+        if (every < 1) {
+            sendError(client, "INVALID_PARAMS", "sample_every must be at least 1", true);
+            return;
+        }
+        tracer.start(static_cast<uint32_t>(every));
+    } else if (action == "stop") {
+        tracer.stop();
+    } else if (action == "clear") {
+        tracer.clear();
+    } else if (action != "status") {
+        sendError(client, "INVALID_PARAMS", "Valid actions: start, stop, clear, status", true);
+        return;
+    }
+
+    json reply = {
+        {"type", "trace"},
+        {"enabled", tracer.enabled()},
+        {"sample_every", tracer.sampleEvery()},
+        {"events", tracer.eventCount()},
+        {"dropped", tracer.droppedCount()},
+        {"path", TRACE_PATH}
+    };
+    client->sendText(reply.dump());
 }
 
-void BridgeServer::sendError(ix::WebSocket* ws, const std::string& code,
+void BridgeServer::sendError(const ClientPtr& client, const std::string& code,
                               const std::string& message, bool recoverable) {
     json error = {
         {"type", "error"},
@@ -475,10 +1524,10 @@ void BridgeServer::sendError(ix::WebSocket* ws, const std::string& code,
         {"recoverable", recoverable}
     };
 
-    ws->send(error.dump());
+    client->sendText(error.dump());
 }
 
-void BridgeServer::sendStatus(ix::WebSocket* ws) {
+void BridgeServer::sendStatus(const ClientPtr& client) {
     json status = {
         {"type", "status"},
         {"kinect_connected", kinectConnected_ || mockMode_},
@@ -487,76 +1536,196 @@ void BridgeServer::sendStatus(ix::WebSocket* ws) {
         {"clients_connected", getClientCount()}
     };
 
-    ws->send(status.dump());
+    if (history_) {
+        auto stats = history_->stats();
+        status["history"] = {
+            {"seconds", history_->seconds()},
+            {"frames", stats.frames},
+            {"raw_bytes", stats.rawBytes},
+            {"compressed_bytes", stats.compressedBytes},
+            {"dropped", stats.dropped}
+        };
+    }
+
+    // Per-client delivery: current variant and estimated link throughput
+    json clients = json::array();
+    auto snapshot = clients_.snapshot();
+    for (const auto& entry : snapshot->clients) {
+        DeliveryVariant variant = entry.rate->variant();
+        uint64_t estimate = entry.rate->estimatedBytesPerSecond();
+        size_t buffered = entry.client->bufferedBytes();
+        clients.push_back({
+            {"self", entry.client == client},
+            {"adaptive", entry.state.adaptive},
+            {"variant", variant.name()},
+            {"scale", 1 << variant.scaleShift},
+            {"frame_divider", variant.frameDivider},
+            {"estimated_kbps", estimate * 8 / 1000},
+            {"queued_bytes", buffered},
+            {"queue_ms", estimate ? buffered * 1000 / estimate : 0},
+            {"frames_skipped", entry.rate->framesSkipped()},
+            {"variant_switches", entry.rate->switches()}
+        });
+
+        // Queue age and deadline drops per send priority
+        SendQueueStats sendStats = entry.client->sendStats();
+        if (sendStats.scheduled) {
+            json queues = json::object();
+            for (size_t p = 0; p < SEND_PRIORITY_COUNT; p++) {
+                const SendPriorityStats& stats = sendStats.priorities[p];
+                queues[sendPriorityName(static_cast<SendPriority>(p))] = {
+                    {"queued", stats.queued},
+                    {"queued_bytes", stats.queuedBytes},
+                    {"oldest_ms", stats.oldestMs},
+                    {"avg_wait_ms", stats.wait.meanUs / 1000},
+                    {"max_wait_ms", stats.wait.maxUs / 1000},
+                    {"sent", stats.sent},
+                    {"dropped", stats.dropped},
+                    {"wait", latencyJson(stats.wait)}
+                };
+            }
+            clients.back()["send_queue"] = queues;
+        }
+
+        ClockEstimate clock = entry.session->clock.estimate();
+        if (clock.valid) {
+            clients.back()["clock"] = {
+                {"offset_ms", clock.offsetUs / 1000.0},
+                {"rtt_ms", clock.smoothedRttUs / 1000.0},
+                {"min_rtt_ms", clock.minRttUs / 1000.0},
+                {"jitter_ms", clock.jitterUs / 1000.0},
+                {"network_delay_ms", entry.rate->networkDelayUs() / 1000.0},
+                {"samples", clock.samples}
+            };
+        }
+
+        json ackSpans = latencySpansJson(entry.session->latency);
+        if (!ackSpans.empty()) {
+            clients.back()["latency"] = ackSpans;
+        }
+    }
+    status["clients"] = clients;
+
+    status["latency"] = {
+        {"frames_traced", tracer_.framesTraced()},
+        {"acks", tracer_.acks()},
+        {"spans", latencySpansJson(tracer_.histograms())}
+    };
+
+    status["http"] = {
+        {"snapshot_encodes", snapshots_.encodes()},
+        {"mjpeg_viewers", mjpegViewerCount_.load()}
+    };
+
+    if (!relayUrl_.empty()) {
+        uint64_t hopCount = relayStats_.hopCount.load();
+        json relay = {
+            {"upstream", relayUrl_},
+            {"connected", relayStats_.connected.load()},
+            {"frames_forwarded", relayStats_.framesForwarded.load()},
+            {"reconnects", relayStats_.reconnects.load()},
+            {"hop_latency_us", {
+                {"avg", hopCount ? relayStats_.hopSumNs.load() / hopCount / 1000 : 0},
+                {"max", relayStats_.hopMaxNs.load() / 1000}
+            }},
+            {"link_latency_us", relayStats_.linkLatencyUs.load()}
+        };
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            if (!upstreamRelayStatus_.empty()) {
+                relay["upstream_relay"] = json::parse(upstreamRelayStatus_, nullptr, false);
+            }
+        }
+        status["kinect_connected"] = relayStats_.connected.load();
+        status["relay"] = relay;
+    }
+
+    client->sendText(status.dump());
 }
 
-void BridgeServer::sendMotorStatus(ix::WebSocket* ws, const MotorStatus& status) {
-    // Map TiltStatus enum to string
-    std::string statusStr;
-    switch (status.status) {
-        case TiltStatus::Stopped:
-            statusStr = "STOPPED";
-            break;
-        case TiltStatus::Moving:
-            statusStr = "MOVING";
-            break;
-        case TiltStatus::AtLimit:
-            statusStr = "LIMIT";
-            break;
-        default:
-            statusStr = "UNKNOWN";
-            break;
+void BridgeServer::sendBinaryStatus(const ClientPtr& client, const ClientEntry* entry) {
+    // The compact subset: bridge counters and this client's own delivery
+    ControlStatus status;
+    status.frameId = frameCache_.frameId;
+    status.droppedFrames = static_cast<uint32_t>(droppedFrames_.load());
+    status.clientsConnected = static_cast<uint16_t>(getClientCount());
+    status.kinectConnected = relayUrl_.empty() ? (kinectConnected_ || mockMode_) : relayStats_.connected.load();
+
+    if (entry) {
+        DeliveryVariant variant = entry->rate->variant();
+        uint64_t estimate = entry->rate->estimatedBytesPerSecond();
+        size_t buffered = client->bufferedBytes();
+        status.scale = static_cast<uint8_t>(1 << variant.scaleShift);
+        status.frameDivider = static_cast<uint8_t>(variant.frameDivider);
+        status.estimatedKbps = static_cast<uint32_t>(estimate * 8 / 1000);
+        status.queuedBytes = static_cast<uint32_t>(buffered);
+        status.queueMs = static_cast<uint32_t>(estimate ? buffered * 1000 / estimate : 0);
+        status.framesSkipped = static_cast<uint32_t>(entry->rate->framesSkipped());
+    }
+
+    ControlWriter writer;
+    writer.addStatus(status);
+    client->sendFrame(writer.frame());
+}
+
+void BridgeServer::setBinaryControl(const ClientPtr& client, bool binary) {
+    auto snapshot = clients_.snapshot();
+    if (const ClientEntry* entry = snapshot->find(client)) {
+        entry->session->binaryControl = binary;
+    }
+}
+
+void BridgeServer::sendMotorStatus(const ClientPtr& client, ControlEncoding encoding, const MotorStatus& status,
+                                   bool withAccelerometer) {
+    if (encoding == ControlEncoding::Binary) {
+        ControlWriter writer;
+        writer.addMotorStatus(status, withAccelerometer);
+        client->sendFrame(writer.frame());
+        return;
     }
 
     json msg = {
         {"type", "motor.status"},
-        {"status", statusStr},
-        {"accelerometer", {
+        {"status", tiltStatusName(status.status)}
+    };
+    if (withAccelerometer) {
+        msg["accelerometer"] = {
             {"x", status.accelX},
             {"y", status.accelY},
             {"z", status.accelZ}
-        }}
-    };
+        };
+    }
 
     // Only include angle if it's valid (not NaN - which means motor is moving)
     if (!std::isnan(status.tiltAngle)) {
         msg["angle"] = status.tiltAngle;
     }
 
-    ws->send(msg.dump());
+    client->sendText(msg.dump());
 }
 
-void BridgeServer::sendMotorError(ix::WebSocket* ws, const std::string& code, const std::string& message) {
+void BridgeServer::sendMotorError(const ClientPtr& client, ControlEncoding encoding, ControlError code,
+                                  const std::string& message) {
+    if (encoding == ControlEncoding::Binary) {
+        ControlWriter writer;
+        writer.addError(code, message);
+        client->sendFrame(writer.frame());
+        return;
+    }
+
     json error = {
         {"type", "motor.error"},
-        {"code", code},
+        {"code", controlErrorName(code)},
         {"message", message}
     };
 
-    ws->send(error.dump());
+    client->sendText(error.dump());
 }
 
 void BridgeServer::broadcastMotorStatus(const MotorStatus& status) {
-    // Map TiltStatus enum to string
-    std::string statusStr;
-    switch (status.status) {
-        case TiltStatus::Stopped:
-            statusStr = "STOPPED";
-            break;
-        case TiltStatus::Moving:
-            statusStr = "MOVING";
-            break;
-        case TiltStatus::AtLimit:
-            statusStr = "LIMIT";
-            break;
-        default:
-            statusStr = "UNKNOWN";
-            break;
-    }
-
     json msg = {
         {"type", "motor.status"},
-        {"status", statusStr}
+        {"status", tiltStatusName(status.status)}
         // Note: Omit accelerometer from polling events to reduce message size
         // Accelerometer data available via motor.getStatus command
     };
@@ -567,16 +1736,24 @@ void BridgeServer::broadcastMotorStatus(const MotorStatus& status) {
     }
 
     std::string msgStr = msg.dump();
-
-    // Broadcast to all connected clients
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    for (auto& [wsPtr, state] : clients_) {
-        wsPtr->send(msgStr);
+    ControlWriter writer;
+    writer.addMotorStatus(status, false);
+    SharedFrame binary = writer.frame();
+
+    // Broadcast to all connected clients, each in its control encoding
+    auto snapshot = clients_.snapshot();
+    for (const auto& entry : snapshot->clients) {
+        if (entry.session->binaryControl) {
+            entry.client->sendFrame(binary);
+        } else {
+            entry.client->sendText(msgStr);
+        }
     }
 }
 
 void BridgeServer::broadcastLoop() {
     using namespace std::chrono;
+    KINECT_XR_TRACE_THREAD("broadcast");
 
     auto nextFrameTime = steady_clock::now();
     auto nextStatsTime = steady_clock::now() + seconds(10);
@@ -641,45 +1818,89 @@ void BridgeServer::broadcastLoop() {
         }
 
         if (now >= nextFrameTime) {
-            // Time to send a frame
-            std::vector<uint8_t> rgbData;
-            std::vector<uint8_t> depthData;
-            uint32_t frameId;
-            bool hasRgb = false;
-            bool hasDepth = false;
-
-            // Get frame data
+            // Time to send a frame. Each stream is framed once, straight from
+            // the cache, and the same message is shared by all subscribers.
+            KINECT_XR_TRACE_SCOPE("bridge", "frame");
+            SharedFrame rgbFrame;
+            SharedFrame depthFrame;
+            uint32_t frameId = 0;
+            steady_clock::time_point capturedAt;
+            auto dequeuedAt = steady_clock::now();
+
             {
-                std::lock_guard<std::mutex> lock(frameCache_.mutex);
+                KINECT_XR_TRACE_SCOPE("bridge", "readCache");
+                std::lock_guard<NamedMutex> lock(frameCache_.mutex);
 
                 if (mockMode_) {
                     // Generate mock data
                     frameCache_.frameId++;
+                    frameCache_.depthCapturedAt = steady_clock::now();
                     generateMockRgbFrame(frameCache_.rgbData, frameCache_.frameId);
                     generateMockDepthFrame(frameCache_.depthData, frameCache_.frameId);
                     frameCache_.rgbValid = true;
                     frameCache_.depthValid = true;
+                    deviceFrames_[0]->add();
+                    deviceFrames_[1]->add();
                 }
 
                 frameId = frameCache_.frameId;
+                capturedAt = frameCache_.depthCapturedAt;
 
                 if (frameCache_.rgbValid) {
-                    rgbData = frameCache_.rgbData;
-                    hasRgb = true;
+                    rgbFrame = FramedMessage::binaryFrame(STREAM_TYPE_RGB, frameId,
+                                                          frameCache_.rgbData.data(),
+                                                          frameCache_.rgbData.size());
                 }
 
                 if (frameCache_.depthValid) {
-                    depthData = frameCache_.depthData;
-                    hasDepth = true;
+                    depthFrame = FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, frameId,
+                                                            frameCache_.depthData.data(),
+                                                            frameCache_.depthData.size());
                 }
             }
 
-            // Broadcast to subscribed clients
-            if (hasRgb) {
-                broadcastFrame(STREAM_TYPE_RGB, rgbData, frameId);
+            // A frame is traced once, the first time it is broadcast
+            bool traced = depthFrame && tracer_.begin(frameId, capturedAt, wallClockUs(capturedAt));
+            if (traced) {
+                broadcasts_->add();
+                tracer_.stamp(frameId, TraceStage::Dequeued, dequeuedAt);
+                tracer_.stamp(frameId, TraceStage::Framed);
+            }
+
+            snapshots_.update(STREAM_TYPE_RGB, rgbFrame);
+            snapshots_.update(STREAM_TYPE_DEPTH, depthFrame);
+            updateRateControl();
+
+            // Publish for same-host and LAN consumers, then broadcast to subscribed clients
+            if (shmRing_) {
+                KINECT_XR_TRACE_SCOPE("bridge", "publishShared");
+                publishShared(rgbFrame, STREAM_TYPE_RGB);
+                publishShared(depthFrame, STREAM_TYPE_DEPTH);
+            }
+            if (multicast_) {
+                KINECT_XR_TRACE_SCOPE("bridge", "publishMulticast");
+                publishMulticast(rgbFrame, STREAM_TYPE_RGB);
+                publishMulticast(depthFrame, STREAM_TYPE_DEPTH);
+            }
+            if (rgbFrame) {
+                broadcastFrame(STREAM_TYPE_RGB, rgbFrame);
+            }
+            if (depthFrame) {
+                broadcastFrame(STREAM_TYPE_DEPTH, depthFrame);
+                broadcastDerivedStreams(depthFrame, rgbFrame);
+            }
+            uint64_t timestampMs = wallClockMs();
+            flushBundles(frameId, timestampMs);
+            if (traced) {
+                tracer_.finish(frameId);
             }
-            if (hasDepth) {
-                broadcastFrame(STREAM_TYPE_DEPTH, depthData, frameId);
+            if (history_) {
+                KINECT_XR_TRACE_SCOPE("bridge", "history");
+                history_->push(STREAM_TYPE_RGB, rgbFrame, timestampMs);
+                history_->push(STREAM_TYPE_DEPTH, depthFrame, timestampMs);
+            }
+            if (mjpegViewerCount_ > 0) {
+                publishMjpeg();
             }
 
             // Schedule next frame
@@ -698,53 +1919,422 @@ void BridgeServer::broadcastLoop() {
     }
 }
 
-void BridgeServer::broadcastFrame(uint16_t streamType, const std::vector<uint8_t>& data, uint32_t frameId) {
-    // Build binary message: 8-byte header + pixel data
-    std::vector<uint8_t> message(8 + data.size());
+void BridgeServer::broadcastFrame(uint16_t streamType, const SharedFrame& frame) {
+    KINECT_XR_TRACE_SCOPE_ARG("bridge", "broadcastFrame", "stream", streamType);
+    uint32_t frameId = readFrameId(frame->payload());
+
+    // Each downscaled variant and wire layout is built at most once per
+    // frame and shared; conversion runs on the downscaled pixels
+    std::array<std::array<SharedFrame, FRAME_LAYOUT_COUNT>, 3> variants{};
+    variants[0][0] = frame;
+    uint32_t sent = 0;
+
+    // Tile clients at full size get the dirty tiles, or the reference image
+    // when they missed an update; the reference advances once per frame
+    TileEncoder* tiles = streamType == STREAM_TYPE_RGB     ? &rgbTiles_
+                         : streamType == STREAM_TYPE_DEPTH ? &depthTiles_
+                                                           : nullptr;
+    const size_t tileStream = streamType == STREAM_TYPE_RGB ? 0 : 1;
+    bool tilesTried = false;
+    bool tilesReady = false;
+    std::array<SharedFrame, FRAME_LAYOUT_COUNT> tileKeys{};
+
+    // Broadcast to subscribed clients (lock-free snapshot)
+    auto snapshot = clients_.snapshot();
+    const auto& subscribers = snapshot->subscribersOf(streamType);
+    for (const ClientEntry* entry : subscribers) {
+        DeliveryVariant variant = entry->rate->variant();
+        if (!variant.sends(frameId)) {
+            entry->rate->onSkipped();
+            continue;
+        }
+
+        auto& scaled = variants[std::min<size_t>(variant.scaleShift, variants.size() - 1)];
+        if (!scaled[0]) {
+            scaled[0] = downscaleFrame(frame, variant.scaleShift);
+            if (!scaled[0]) {
+                scaled[0] = frame;  // Not a full-size frame (e.g. relayed variant): send as is
+            }
+        }
+        uint8_t layout = layoutFor(streamType, entry->state);
+        if (tiles && entry->state.tiles && variant.scaleShift == 0) {
+            if (!tilesTried) {
+                tilesTried = true;
+                tilesReady = tiles->update(frame);
+            }
+            if (tilesReady) {
+                uint64_t& held = entry->tiles->version[tileStream];
+                uint64_t current = tiles->version();
+                SharedFrame out;
+                if (held + 1 == current) {
+                    out = tiles->delta(entry->state.rgbFormat);
+                } else {
+                    SharedFrame& key = tileKeys[layout];
+                    if (!key) {
+                        key = inLayout(tiles->keyFrame(), streamType, layout);
+                    }
+                    out = key;
+                }
+                held = current;
+                deliver(*entry, out);
+                sent++;
+                continue;
+            }
+        }
+
+        SharedFrame& out = scaled[layout];
+        if (!out) {
+            out = inLayout(scaled[0], streamType, layout);
+        }
+        deliver(*entry, out);
+        sent++;
+    }
+    framesSent_ += sent;
+}
+
+void BridgeServer::broadcastDerivedStreams(const SharedFrame& depthFrame, const SharedFrame& rgbFrame) {
+    KINECT_XR_TRACE_SCOPE("bridge", "broadcastDerivedStreams");
+    // Derived streams are built from full-size depth only
+    if (depthFrame->payloadSize() != FRAME_HEADER_SIZE + DEPTH_FRAME_SIZE) {
+        return;
+    }
+
+    uint32_t frameId = readFrameId(depthFrame->payload());
+    const uint8_t* depth = depthFrame->payload() + FRAME_HEADER_SIZE;
+    const uint8_t* rgb = nullptr;
+    if (rgbFrame && rgbFrame->payloadSize() == FRAME_HEADER_SIZE + RGB_FRAME_SIZE) {
+        rgb = rgbFrame->payload() + FRAME_HEADER_SIZE;
+    }
+    const DepthIntrinsics intrinsics = DepthIntrinsics::kinectDefault();
+
+    broadcastEncoded(STREAM_TYPE_POINTCLOUD, frameId,
+                     [](const ClientState& state) { return state.pointCloud.key(); },
+                     [&](const ClientState& state) {
+                         return encodePointCloud(frameId, depth, rgb, intrinsics, state.pointCloud);
+                     });
+    broadcastEncoded(STREAM_TYPE_MESH, frameId,
+                     [](const ClientState& state) { return state.mesh.key(); },
+                     [&](const ClientState& state) {
+                         return mesher_.encode(frameId, depth, intrinsics, state.mesh);
+                     });
+
+    // The background model is shared: learn from each frame once, not per client
+    auto snapshot = clients_.snapshot();
+    const auto& keyed = snapshot->subscribersOf(STREAM_TYPE_KEYED);
+    const auto& outlined = snapshot->subscribersOf(STREAM_TYPE_CONTOURS);
+    bool learnsBackground =
+        std::any_of(keyed.begin(), keyed.end(), [](const ClientEntry* entry) {
+            return entry->state.keying.mode == KeyMode::Background;
+        }) ||
+        std::any_of(outlined.begin(), outlined.end(), [](const ClientEntry* entry) {
+            return entry->state.contours.mode == KeyMode::Background;
+        });
+    if (learnsBackground) {
+        keyer_.observe(depth);
+    }
+
+    broadcastEncoded(STREAM_TYPE_CONTOURS, frameId,
+                     [](const ClientState& state) { return state.contours.key(); },
+                     [&](const ClientState& state) {
+                         const ContourParams& params = state.contours;
+                         std::vector<uint8_t> mask;
+                         keyer_.keyMask(depth, params.keying(), params.step, mask);
+                         uint8_t flags = (params.mode == KeyMode::Background && !keyer_.backgroundReady())
+                                             ? KEY_FLAG_LEARNING : 0;
+                         return contourTracer_.encode(frameId, mask, params, flags);
+                     });
+
+    // Keyed frames also need full-size RGB
+    if (!rgb) {
+        return;
+    }
+    broadcastEncoded(STREAM_TYPE_KEYED, frameId,
+                     [](const ClientState& state) { return state.keying.key(); },
+                     [&](const ClientState& state) {
+                         return keyer_.encode(frameId, depth, rgb, state.keying);
+                     });
+}
+
+void BridgeServer::broadcastEncoded(uint16_t streamType, uint32_t frameId,
+                                    const std::function<uint64_t(const ClientState&)>& keyOf,
+                                    const std::function<SharedFrame(const ClientState&)>& encode) {
+    auto snapshot = clients_.snapshot();
+    const auto& subscribers = snapshot->subscribersOf(streamType);
+
+    // One encode per distinct parameter set, shared by every client that asked for it
+    std::vector<std::pair<uint64_t, SharedFrame>> encoded;
+    uint32_t sent = 0;
+    for (const ClientEntry* entry : subscribers) {
+        if (!entry->rate->variant().sends(frameId)) {
+            entry->rate->onSkipped();
+            continue;
+        }
+
+        uint64_t key = keyOf(entry->state);
+        auto it = std::find_if(encoded.begin(), encoded.end(),
+                               [key](const auto& cached) { return cached.first == key; });
+        if (it == encoded.end()) {
+            KINECT_XR_TRACE_SCOPE_ARG("bridge", "encode", "stream", streamType);
+            auto started = std::chrono::steady_clock::now();
+            encoded.emplace_back(key, encode(entry->state));
+            it = encoded.end() - 1;
+            if (encodeTime_[streamType]) {
+                auto elapsed = std::chrono::steady_clock::now() - started;
+                encodeTime_[streamType]->record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+                encodes_[streamType]->add();
+            }
+        }
+        if (!it->second) {
+            continue;  // Encoder failed and logged; nothing to send this frame
+        }
+        deliver(*entry, it->second);
+        sent++;
+    }
+    framesSent_ += sent;
+}
+
+void BridgeServer::deliver(const ClientEntry& entry, const SharedFrame& frame) {
+    if (entry.state.bundle) {
+        bundler_.add(entry.client, frame);
+    } else {
+        entry.client->sendFrame(frame);
+    }
+    entry.rate->onQueued(frame->wireSize());
+    bytesQueued_->add(frame->wireSize());
+}
+
+void BridgeServer::flushBundles(uint32_t frameId, uint64_t captureTimeMs) {
+    KINECT_XR_TRACE_SCOPE("bridge", "flushBundles");
+    if (bundler_.empty()) {
+        return;
+    }
+    bundler_.flush(frameId, captureTimeMs, [](const ClientPtr& client, const SharedFrame& bundle) {
+        client->sendFrame(bundle);
+    });
+}
+
+void BridgeServer::updateRateControl() {
+    auto now = std::chrono::steady_clock::now();
+    auto snapshot = clients_.snapshot();
+    for (const auto& entry : snapshot->clients) {
+        size_t rgbBytes = FRAME_WIDTH * FRAME_HEIGHT * bytesPerPixel(entry.state.rgbFormat);
+        size_t depthBytes = packedDepthSize(FRAME_WIDTH * FRAME_HEIGHT, entry.state.depthPacking);
+        size_t frameBytes = (entry.state.subscribedRgb ? rgbBytes : 0) +
+                            (entry.state.subscribedDepth ? depthBytes : 0) +
+                            (entry.state.subscribedPointCloud ? entry.state.pointCloud.maxPayloadBytes() : 0) +
+                            (entry.state.subscribedMesh ? entry.state.mesh.maxPayloadBytes() : 0) +
+                            (entry.state.subscribedKeyed ? entry.state.keying.maxPayloadBytes() : 0) +
+                            (entry.state.subscribedContours ? entry.state.contours.maxPayloadBytes() : 0);
+        double fullRate = frameBytes * (1000.0 / FRAME_INTERVAL_MS);
+        entry.rate->update(entry.client->bufferedBytes(), fullRate, entry.state.adaptive, now);
+    }
+}
+
+void BridgeServer::publishShared(const SharedFrame& frame, uint16_t streamType) {
+    if (!frame) return;
+
+    // Strip the 8-byte bridge header; the ring stores ID and type per slot
+    const uint8_t* payload = frame->payload();
+    shmRing_->publish(streamType, readFrameId(payload), payload + FRAME_HEADER_SIZE,
+                      frame->payloadSize() - FRAME_HEADER_SIZE);
+}
+
+void BridgeServer::publishMulticast(const SharedFrame& frame, uint16_t streamType) {
+    if (!frame) return;
+
+    // Fragment headers carry ID and type, so send the payload without the bridge header
+    const uint8_t* payload = frame->payload();
+    multicast_->send(streamType, readFrameId(payload), payload + FRAME_HEADER_SIZE,
+                     frame->payloadSize() - FRAME_HEADER_SIZE);
+}
+
+void BridgeServer::relayLoop() {
+    using namespace std::chrono;
+    KINECT_XR_TRACE_THREAD("relay");
+
+    WsClient upstream;
+    auto retryDelay = milliseconds(250);
+    auto nextStatusTime = steady_clock::now();
+    auto statusRequestedAt = steady_clock::time_point{};
+    auto nextStatsTime = steady_clock::now() + seconds(10);
+
+    while (broadcastRunning_) {
+        auto now = steady_clock::now();
+
+        if (!upstream.isConnected()) {
+            if (relayStats_.connected.exchange(false)) {
+                std::cerr << "Lost upstream " << relayUrl_ << ", reconnecting" << std::endl;
+                relayStats_.reconnects++;
+            }
+            if (!upstream.connect(relayUrl_) ||
+                !upstream.sendText(R"({"type":"subscribe","streams":["rgb","depth"],"bundle":true})")) {
+                upstream.close();
+                auto retryAt = steady_clock::now() + retryDelay;
+                while (broadcastRunning_ && steady_clock::now() < retryAt) {
+                    std::this_thread::sleep_for(milliseconds(50));
+                }
+                retryDelay = std::min(retryDelay * 2, milliseconds(5000));
+                continue;
+            }
+            std::cout << "Relaying from " << relayUrl_ << std::endl;
+            relayStats_.connected = true;
+            retryDelay = milliseconds(250);
+            nextStatusTime = now;
+        }
+
+        // Poll the upstream's status to estimate link latency and collect its hop stats
+        if (now >= nextStatusTime) {
+            upstream.sendText(R"({"type":"status"})");
+            statusRequestedAt = now;
+            nextStatusTime = now + seconds(5);
+        }
+
+        // Print hop stats every 10 seconds, then start a new window
+        if (now >= nextStatsTime) {
+            uint64_t hopCount = relayStats_.hopCount.exchange(0);
+            uint64_t hopSum = relayStats_.hopSumNs.exchange(0);
+            uint64_t hopMax = relayStats_.hopMaxNs.exchange(0);
+            std::cout << "Relay: "
+                      << "Clients=" << getClientCount() << " "
+                      << "Forwarded=" << relayStats_.framesForwarded.load() << " "
+                      << "Hop=" << (hopCount ? hopSum / hopCount / 1000 : 0) << "us avg/"
+                      << hopMax / 1000 << "us max "
+                      << "Link=" << relayStats_.linkLatencyUs.load() << "us"
+                      << std::endl;
+            nextStatsTime = now + seconds(10);
+        }
+
+        WsMessage message;
+        if (!upstream.next(message, 100)) {
+            continue;
+        }
+        auto receivedAt = steady_clock::now();
+
+        if (message.opcode == WsOpcode::Binary) {
+            forwardUpstreamFrame(std::move(message), receivedAt);
+            continue;
+        }
+
+        // Text from upstream: only status replies are of interest
+        auto msg = json::parse(message.payload, nullptr, false);
+        if (msg.is_object() && msg.value("type", "") == "status") {
+            if (statusRequestedAt != steady_clock::time_point{}) {
+                relayStats_.linkLatencyUs =
+                    duration_cast<microseconds>(receivedAt - statusRequestedAt).count() / 2;
+                statusRequestedAt = steady_clock::time_point{};
+            }
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            upstreamRelayStatus_ = msg.contains("relay") ? msg["relay"].dump() : "";
+        }
+    }
 
-    // Header (little-endian)
-    message[0] = frameId & 0xFF;
-    message[1] = (frameId >> 8) & 0xFF;
-    message[2] = (frameId >> 16) & 0xFF;
-    message[3] = (frameId >> 24) & 0xFF;
-    message[4] = streamType & 0xFF;
-    message[5] = (streamType >> 8) & 0xFF;
-    message[6] = 0;  // Reserved
-    message[7] = 0;  // Reserved
+    relayStats_.connected = false;
+}
 
-    // Pixel data
-    std::memcpy(message.data() + 8, data.data(), data.size());
+void BridgeServer::forwardUpstreamFrame(WsMessage message,
+                                        std::chrono::steady_clock::time_point receivedAt) {
+    KINECT_XR_TRACE_SCOPE("bridge", "forwardUpstreamFrame");
+    if (message.payload.size() < FRAME_HEADER_SIZE) return;
+
+    // The upstream bundles each frame's RGB and depth; forward them one by
+    // one, then rebundle for local clients that asked for bundles. Every
+    // forwarded frame views the one receive buffer.
+    auto received = std::make_shared<const std::string>(std::move(message.payload));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(received->data());
+    uint16_t streamType = static_cast<uint16_t>(bytes[4] | (bytes[5] << 8));
+    uint32_t frameId = readFrameId(bytes);
+    uint64_t captureTimeMs = 0;
+    std::vector<BundlePart> parts;
+    if (streamType == STREAM_TYPE_BUNDLE &&
+        !splitBundle(bytes, received->size(), parts, &captureTimeMs)) {
+        std::cerr << "Dropping malformed bundle from upstream" << std::endl;
+        return;
+    }
 
-    // Broadcast to subscribed clients
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    for (auto& [wsPtr, state] : clients_) {
-        bool shouldSend = (streamType == STREAM_TYPE_RGB && state.subscribedRgb) ||
-                          (streamType == STREAM_TYPE_DEPTH && state.subscribedDepth);
+    // Traced from the upstream receive; acks still compare against the
+    // original capture time when the upstream bundles it
+    uint64_t captureWallUs = captureTimeMs ? captureTimeMs * 1000 : wallClockUs(receivedAt);
+    bool traced = tracer_.begin(frameId, receivedAt, captureWallUs);
+    if (traced) {
+        broadcasts_->add();
+        tracer_.stamp(frameId, TraceStage::Framed);
+    }
 
-        if (shouldSend) {
-            // Note: IXWebSocket needs the raw pointer for sending
-            // This is safe because we're under the clients mutex
-            wsPtr->sendBinary(std::string(reinterpret_cast<char*>(message.data()), message.size()));
-            framesSent_++;
+    updateRateControl();
+    if (streamType == STREAM_TYPE_BUNDLE) {
+        for (const BundlePart& part : parts) {
+            forwardUpstreamPart(FramedMessage::binaryView(received, part.data, part.size));
         }
+    } else {
+        forwardUpstreamPart(FramedMessage::binaryView(received, bytes, received->size()));
+    }
+    flushBundles(frameId, captureTimeMs ? captureTimeMs : wallClockMs());
+    if (traced) {
+        tracer_.finish(frameId);
+    }
+
+    // Stamp the hop: upstream receive → handed to every local transport
+    uint64_t hopNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - receivedAt).count());
+    relayStats_.hopSumNs += hopNs;
+    relayStats_.hopCount++;
+    uint64_t hopMax = relayStats_.hopMaxNs.load();
+    while (hopNs > hopMax && !relayStats_.hopMaxNs.compare_exchange_weak(hopMax, hopNs)) {
+    }
+    relayStats_.framesForwarded++;
+
+    {
+        std::lock_guard<NamedMutex> lock(frameCache_.mutex);
+        frameCache_.frameId = frameId;
+    }
+}
+
+void BridgeServer::forwardUpstreamPart(const SharedFrame& frame) {
+    // Header and payload pass through unchanged; only the stream type is read for routing
+    const uint8_t* bytes = frame->payload();
+    uint16_t streamType = static_cast<uint16_t>(bytes[4] | (bytes[5] << 8));
+
+    snapshots_.update(streamType, frame);
+    if (shmRing_) {
+        publishShared(frame, streamType);
+    }
+    if (multicast_) {
+        publishMulticast(frame, streamType);
+    }
+    broadcastFrame(streamType, frame);
+    if (streamType == STREAM_TYPE_RGB) {
+        relayRgbFrame_ = frame;
+    } else if (streamType == STREAM_TYPE_DEPTH) {
+        broadcastDerivedStreams(frame, relayRgbFrame_);
+    }
+    if (history_) {
+        history_->push(streamType, frame, wallClockMs());
+    }
+    if (streamType == STREAM_TYPE_RGB && mjpegViewerCount_ > 0) {
+        publishMjpeg();
     }
 }
 
 void BridgeServer::onDepthFrame(const void* data, uint32_t timestamp) {
-    std::lock_guard<std::mutex> lock(frameCache_.mutex);
+    KINECT_XR_TRACE_SCOPE("bridge", "cacheDepth");
+    std::lock_guard<NamedMutex> lock(frameCache_.mutex);
 
     // Copy depth data (640x480 uint16_t = 614400 bytes)
     std::memcpy(frameCache_.depthData.data(), data, DEPTH_FRAME_SIZE);
     frameCache_.depthTimestamp = timestamp;
     frameCache_.depthValid = true;
+    frameCache_.depthCapturedAt = std::chrono::steady_clock::now();
     frameCache_.frameId++;
 
     // Track FPS
     depthFrameCount_++;
+    deviceFrames_[1]->add();
 }
 
 void BridgeServer::onVideoFrame(const void* data, uint32_t timestamp) {
-    std::lock_guard<std::mutex> lock(frameCache_.mutex);
+    KINECT_XR_TRACE_SCOPE("bridge", "cacheRgb");
+    std::lock_guard<NamedMutex> lock(frameCache_.mutex);
 
     // Copy RGB data (640x480x3 = 921600 bytes)
     std::memcpy(frameCache_.rgbData.data(), data, RGB_FRAME_SIZE);
@@ -753,6 +2343,7 @@ void BridgeServer::onVideoFrame(const void* data, uint32_t timestamp) {
 
     // Track FPS
     rgbFrameCount_++;
+    deviceFrames_[0]->add();
 }
 
 void BridgeServer::generateMockRgbFrame(std::vector<uint8_t>& data, uint32_t frameId) {
@@ -0,0 +1,22 @@
+/**
+ * @file bridge_transport.cpp
+ * @brief Transport factory
+ */
+
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/ix_transport.h"
+#include "kinect_xr/reactor_transport.h"
+
+namespace kinect_xr {
+
+std::unique_ptr<BridgeTransport> createTransport(TransportKind kind, int ioThreads) {
+    switch (kind) {
+        case TransportKind::Reactor:
+            return std::make_unique<ReactorTransport>(ioThreads);
+        case TransportKind::IXWebSocket:
+        default:
+            return std::make_unique<IxTransport>();
+    }
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,107 @@
+/**
+ * @file client_registry.cpp
+ * @brief Copy-on-write client registry implementation
+ */
+
+#include "kinect_xr/client_registry.h"
+
+#include <atomic>
+
+namespace kinect_xr {
+
+namespace {
+const std::vector<const ClientEntry*> NO_SUBSCRIBERS;
+}  // namespace
+
+const std::vector<const ClientEntry*>& ClientSnapshot::subscribersOf(uint16_t streamType) const {
+    if (streamType >= subscribers.size()) {
+        return NO_SUBSCRIBERS;
+    }
+    return subscribers[streamType];
+}
+
+const ClientEntry* ClientSnapshot::find(const ClientPtr& client) const {
+    for (const auto& entry : clients) {
+        if (entry.client == client) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+ClientRegistry::ClientRegistry()
+    : snapshot_(std::make_shared<const ClientSnapshot>()) {}
+
+ClientSnapshotPtr ClientRegistry::snapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+size_t ClientRegistry::add(const ClientPtr& client) {
+    std::lock_guard<NamedMutex> lock(writeMutex_);
+    auto current = std::atomic_load(&snapshot_);
+    if (current->find(client)) {
+        return current->clients.size();
+    }
+
+    std::vector<ClientEntry> clients = current->clients;
+    clients.push_back(ClientEntry{client, ClientState{}, std::make_shared<RateController>(),
+                                  std::make_shared<TileSync>(), std::make_shared<ClientSession>()});
+    size_t count = clients.size();
+    publish(std::move(clients));
+    return count;
+}
+
+size_t ClientRegistry::remove(const ClientPtr& client) {
+    std::lock_guard<NamedMutex> lock(writeMutex_);
+    auto current = std::atomic_load(&snapshot_);
+
+    std::vector<ClientEntry> clients;
+    clients.reserve(current->clients.size());
+    for (const auto& entry : current->clients) {
+        if (entry.client != client) {
+            clients.push_back(entry);
+        }
+    }
+    if (clients.size() == current->clients.size()) {
+        return clients.size();
+    }
+
+    size_t count = clients.size();
+    publish(std::move(clients));
+    return count;
+}
+
+bool ClientRegistry::update(const ClientPtr& client, const ClientState& state) {
+    std::lock_guard<NamedMutex> lock(writeMutex_);
+    auto current = std::atomic_load(&snapshot_);
+    if (!current->find(client)) {
+        return false;
+    }
+
+    std::vector<ClientEntry> clients = current->clients;
+    for (auto& entry : clients) {
+        if (entry.client == client) {
+            entry.state = state;
+            entry.tiles = std::make_shared<TileSync>();  // The client starts over from a full frame
+        }
+    }
+    publish(std::move(clients));
+    return true;
+}
+
+void ClientRegistry::publish(std::vector<ClientEntry> clients) {
+    auto next = std::make_shared<ClientSnapshot>();
+    next->clients = std::move(clients);
+
+    for (const auto& entry : next->clients) {
+        for (uint16_t streamType = 0; streamType < STREAM_TYPE_COUNT; streamType++) {
+            if (entry.state.isSubscribed(streamType)) {
+                next->subscribers[streamType].push_back(&entry);
+            }
+        }
+    }
+
+    std::atomic_store(&snapshot_, ClientSnapshotPtr(std::move(next)));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,79 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Client clock offset and round-trip filter
+ */
+
+#include "kinect_xr/clock_sync.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kinect_xr {
+
+namespace {
+constexpr double RTT_WEIGHT = 1.0 / 8;     // RFC 6298 alpha
+constexpr double JITTER_WEIGHT = 1.0 / 4;  // RFC 6298 beta
+}  // namespace
+
+bool ClockSync::addSample(int64_t t0, int64_t t1, int64_t t2, int64_t t3) {
+    int64_t rtt = (t3 - t0) - (t2 - t1);
+    if (rtt < 0 || t2 < t1) {
+        return false;
+    }
+    Sample sample{((t1 - t0) + (t2 - t3)) / 2, static_cast<uint64_t>(rtt)};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_[samples_ % WINDOW] = sample;
+    double value = static_cast<double>(sample.rttUs);
+    if (samples_ == 0) {
+        smoothedRttUs_ = value;
+        jitterUs_ = value / 2;
+    } else {
+        jitterUs_ += JITTER_WEIGHT * (std::fabs(smoothedRttUs_ - value) - jitterUs_);
+        smoothedRttUs_ += RTT_WEIGHT * (value - smoothedRttUs_);
+    }
+    samples_++;
+    return true;
+}
+
+void ClockSync::replied(uint32_t id, int64_t t0, int64_t t1, int64_t t2) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = {true, id, t0, t1, t2};
+}
+
+bool ClockSync::complete(uint32_t id, int64_t t3) {
+    Pending pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_.valid || pending_.id != id) {
+            return false;
+        }
+        pending = pending_;
+        pending_.valid = false;
+    }
+    return addSample(pending.t0, pending.t1, pending.t2, t3);
+}
+
+ClockEstimate ClockSync::estimate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClockEstimate out;
+    if (samples_ == 0) {
+        return out;
+    }
+    size_t count = std::min(samples_, WINDOW);
+    auto best = std::min_element(window_.begin(), window_.begin() + count,
+                                 [](const Sample& a, const Sample& b) { return a.rttUs < b.rttUs; });
+    out.valid = true;
+    out.offsetUs = best->offsetUs;
+    out.minRttUs = best->rttUs;
+    out.smoothedRttUs = static_cast<uint64_t>(smoothedRttUs_);
+    out.jitterUs = static_cast<uint64_t>(jitterUs_);
+    out.samples = samples_;
+    return out;
+}
+
+int64_t ClockSync::toBridgeUs(int64_t clientUs) const {
+    return clientUs + estimate().offsetUs;
+}
+
+}  // namespace kinect_xr
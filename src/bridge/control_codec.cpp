@@ -0,0 +1,154 @@
+/**
+ * @file control_codec.cpp
+ * @brief Binary control message reading and writing
+ */
+
+#include "kinect_xr/control_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace kinect_xr {
+
+namespace {
+void writeLe(uint8_t* out, uint64_t value, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint16_t readLe16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+// Fixed-point value, clamped to int16
+int16_t toFixed(double value, double scale) {
+    double scaled = std::round(value * scale);
+    return static_cast<int16_t>(std::clamp(scaled, -32767.0, 32767.0));
+}
+}  // namespace
+
+const char* controlErrorName(ControlError error) {
+    switch (error) {
+        case ControlError::DeviceNotConnected:
+            return "DEVICE_NOT_CONNECTED";
+        case ControlError::RateLimited:
+            return "RATE_LIMITED";
+        case ControlError::MotorControlFailed:
+            return "MOTOR_CONTROL_FAILED";
+        case ControlError::LedControlFailed:
+            return "LED_CONTROL_FAILED";
+        case ControlError::MotorStatusFailed:
+            return "MOTOR_STATUS_FAILED";
+        case ControlError::InvalidLedState:
+            return "INVALID_LED_STATE";
+        case ControlError::ProtocolError:
+        default:
+            return "PROTOCOL_ERROR";
+    }
+}
+
+bool ControlRecord::readInt16(int16_t& out) const {
+    if (length < 2) return false;
+    out = static_cast<int16_t>(readLe16(value));
+    return true;
+}
+
+bool ControlRecord::readUint8(uint8_t& out) const {
+    if (length < 1) return false;
+    out = value[0];
+    return true;
+}
+
+ControlReader::ControlReader(const uint8_t* message, size_t size)
+    : cursor_(message + FRAME_HEADER_SIZE), end_(message + size) {
+    if (size < FRAME_HEADER_SIZE + CONTROL_RECORD_HEADER_SIZE || readLe16(message + 4) != STREAM_TYPE_CONTROL) {
+        failed_ = true;
+    }
+}
+
+bool ControlReader::next(ControlRecord& record) {
+    if (failed_ || cursor_ == end_) {
+        return false;
+    }
+    if (static_cast<size_t>(end_ - cursor_) < CONTROL_RECORD_HEADER_SIZE) {
+        failed_ = true;
+        return false;
+    }
+    uint16_t length = readLe16(cursor_ + 2);
+    if (static_cast<size_t>(end_ - cursor_) - CONTROL_RECORD_HEADER_SIZE < length) {
+        failed_ = true;
+        return false;
+    }
+    record.type = static_cast<ControlType>(readLe16(cursor_));
+    record.value = cursor_ + CONTROL_RECORD_HEADER_SIZE;
+    record.length = length;
+    cursor_ += CONTROL_RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+ControlWriter::ControlWriter() : size_(FRAME_HEADER_SIZE) {
+    encodeFrameHeader(buffer_.data(), 0, STREAM_TYPE_CONTROL);
+}
+
+bool ControlWriter::add(ControlType type, const uint8_t* value, size_t length) {
+    if (buffer_.size() - size_ < CONTROL_RECORD_HEADER_SIZE + length) {
+        return false;
+    }
+    uint8_t* out = buffer_.data() + size_;
+    writeLe(out, static_cast<uint16_t>(type), 2);
+    writeLe(out + 2, length, 2);
+    if (length > 0) {
+        std::memcpy(out + CONTROL_RECORD_HEADER_SIZE, value, length);
+    }
+    size_ += CONTROL_RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+bool ControlWriter::addMotorStatus(const MotorStatus& status, bool withAccelerometer) {
+    uint8_t value[10] = {};
+    int16_t angle = std::isnan(status.tiltAngle) ? CONTROL_ANGLE_UNKNOWN : toFixed(status.tiltAngle, 10.0);
+    writeLe(value, static_cast<uint16_t>(angle), 2);
+    value[2] = static_cast<uint8_t>(status.status);
+    value[3] = withAccelerometer ? CONTROL_MOTOR_FLAG_ACCEL : 0;
+    if (!withAccelerometer) {
+        return add(ControlType::MotorStatus, value, 4);
+    }
+    writeLe(value + 4, static_cast<uint16_t>(toFixed(status.accelX, 100.0)), 2);
+    writeLe(value + 6, static_cast<uint16_t>(toFixed(status.accelY, 100.0)), 2);
+    writeLe(value + 8, static_cast<uint16_t>(toFixed(status.accelZ, 100.0)), 2);
+    return add(ControlType::MotorStatus, value, sizeof(value));
+}
+
+bool ControlWriter::addStatus(const ControlStatus& status) {
+    uint8_t value[CONTROL_STATUS_SIZE] = {};
+    writeLe(value, status.frameId, 4);
+    writeLe(value + 4, status.droppedFrames, 4);
+    writeLe(value + 8, status.clientsConnected, 2);
+    value[10] = status.kinectConnected ? 1 : 0;
+    value[12] = status.scale;
+    value[13] = status.frameDivider;
+    writeLe(value + 16, status.estimatedKbps, 4);
+    writeLe(value + 20, status.queuedBytes, 4);
+    writeLe(value + 24, status.queueMs, 4);
+    writeLe(value + 28, status.framesSkipped, 4);
+    return add(ControlType::StatusReply, value, sizeof(value));
+}
+
+bool ControlWriter::addError(ControlError error, const std::string& message) {
+    // Long messages are cut to fit the reply buffer
+    uint8_t value[CONTROL_MAX_MESSAGE_SIZE];
+    size_t room = buffer_.size() - std::min(buffer_.size(), size_ + CONTROL_RECORD_HEADER_SIZE + 2);
+    size_t length = std::min(message.size(), room);
+    writeLe(value, static_cast<uint16_t>(error), 2);
+    std::memcpy(value + 2, message.data(), length);
+    return add(ControlType::Error, value, 2 + length);
+}
+
+SharedFrame ControlWriter::frame() const {
+    return FramedMessage::binary(std::vector<uint8_t>(buffer_.begin(), buffer_.begin() + size_));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,302 @@
+/**
+ * @file depth_contour.cpp
+ * @brief Marching-squares contour tracing and Douglas-Peucker simplification
+ */
+
+#include "kinect_xr/depth_contour.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kinect_xr {
+
+namespace {
+// Cell edges; a ring leaves a cell through one edge and enters the
+// neighbour through the opposite one
+enum Edge : uint8_t { TOP = 0, RIGHT = 1, BOTTOM = 2, LEFT = 3 };
+
+// Corner bits of a cell's case
+constexpr uint8_t TOP_LEFT = 8;
+constexpr uint8_t TOP_RIGHT = 4;
+constexpr uint8_t BOTTOM_RIGHT = 2;
+constexpr uint8_t BOTTOM_LEFT = 1;
+
+// Edge midpoints and corners in half-cell units
+constexpr int8_t EDGE_X[4] = {1, 2, 1, 0};
+constexpr int8_t EDGE_Y[4] = {0, 1, 2, 1};
+
+constexpr size_t BUDGET_POINTS = 4096;  // Several people at the default step and tolerance
+
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t value) {
+    writeLe16(out, static_cast<uint16_t>(value));
+    writeLe16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+/**
+ * Exit edge for each (case, entry edge), or -1. Segments are oriented so
+ * the inside is always on the same side, which makes every ring a
+ * consistently wound polygon. Saddles (5 and 10) keep the two inside
+ * corners apart.
+ */
+struct CaseTable {
+    int8_t exit[16][4];
+
+    CaseTable() {
+        std::memset(exit, -1, sizeof(exit));
+        const uint8_t edgeCorners[4][2] = {
+            {TOP_LEFT, TOP_RIGHT}, {TOP_RIGHT, BOTTOM_RIGHT}, {BOTTOM_RIGHT, BOTTOM_LEFT}, {BOTTOM_LEFT, TOP_LEFT}};
+        auto cornerX = [](uint8_t corner) { return (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) ? 2 : 0; };
+        auto cornerY = [](uint8_t corner) { return (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) ? 2 : 0; };
+
+        auto addSegment = [&](uint8_t c, uint8_t a, uint8_t b, uint8_t inside) {
+            int cross = (EDGE_X[b] - EDGE_X[a]) * (cornerY(inside) - EDGE_Y[a]) -
+                        (EDGE_Y[b] - EDGE_Y[a]) * (cornerX(inside) - EDGE_X[a]);
+            if (cross < 0) {
+                std::swap(a, b);
+            }
+            exit[c][a] = static_cast<int8_t>(b);
+        };
+
+        for (uint8_t c = 1; c < 15; c++) {
+            if (c == (TOP_LEFT | BOTTOM_RIGHT)) {
+                addSegment(c, TOP, LEFT, TOP_LEFT);
+                addSegment(c, RIGHT, BOTTOM, BOTTOM_RIGHT);
+                continue;
+            }
+            if (c == (TOP_RIGHT | BOTTOM_LEFT)) {
+                addSegment(c, TOP, RIGHT, TOP_RIGHT);
+                addSegment(c, BOTTOM, LEFT, BOTTOM_LEFT);
+                continue;
+            }
+            uint8_t crossing[2];
+            int found = 0;
+            for (uint8_t e = 0; e < 4; e++) {
+                if (((c & edgeCorners[e][0]) != 0) != ((c & edgeCorners[e][1]) != 0)) {
+                    crossing[found++] = e;
+                }
+            }
+            uint8_t inside = (c & TOP_LEFT) ? TOP_LEFT : (c & TOP_RIGHT) ? TOP_RIGHT
+                           : (c & BOTTOM_RIGHT) ? BOTTOM_RIGHT : BOTTOM_LEFT;
+            addSegment(c, crossing[0], crossing[1], inside);
+        }
+    }
+};
+
+const CaseTable CASES;
+}  // namespace
+
+KeyParams ContourParams::keying() const {
+    KeyParams params;
+    params.mode = mode;
+    params.minDepthMm = minDepthMm;
+    params.maxDepthMm = maxDepthMm;
+    params.toleranceMm = toleranceMm;
+    return params;
+}
+
+size_t ContourParams::maxPayloadBytes() const {
+    return FRAME_HEADER_SIZE + CONTOUR_HEADER_SIZE + BUDGET_POINTS * 4;
+}
+
+SharedFrame ContourTracer::encode(uint32_t frameId, const std::vector<uint8_t>& mask,
+                                  const ContourParams& params, uint8_t flags) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const uint32_t step = isValidContourStep(params.step) ? params.step : 2;
+    const uint32_t width = FRAME_WIDTH / step;
+    const uint32_t height = FRAME_HEIGHT / step;
+    const uint32_t paddedWidth = width + 2;
+    const uint32_t paddedHeight = height + 2;
+    const uint32_t cellsWide = width + 1;
+    const uint32_t cellsHigh = height + 1;
+
+    padded_.assign(static_cast<size_t>(paddedWidth) * paddedHeight, 0);
+    if (mask.size() >= static_cast<size_t>(width) * height) {
+        for (uint32_t v = 0; v < height; v++) {
+            const uint8_t* src = mask.data() + static_cast<size_t>(v) * width;
+            uint8_t* dst = padded_.data() + static_cast<size_t>(v + 1) * paddedWidth + 1;
+            for (uint32_t u = 0; u < width; u++) {
+                dst[u] = src[u] ? 1 : 0;
+            }
+        }
+    }
+
+    cases_.resize(static_cast<size_t>(cellsWide) * cellsHigh);
+    for (uint32_t j = 0; j < cellsHigh; j++) {
+        const uint8_t* upper = padded_.data() + static_cast<size_t>(j) * paddedWidth;
+        const uint8_t* lower = upper + paddedWidth;
+        uint8_t* out = cases_.data() + static_cast<size_t>(j) * cellsWide;
+        for (uint32_t i = 0; i < cellsWide; i++) {
+            out[i] = static_cast<uint8_t>((upper[i] << 3) | (upper[i + 1] << 2) | (lower[i + 1] << 1) | lower[i]);
+        }
+    }
+    visited_.assign(cases_.size(), 0);
+
+    // Squared tolerance in half pixels, scaled by 25 to stay in integers
+    const int64_t epsilonTenths = std::min<uint16_t>(params.epsilonTenthsPx, CONTOUR_MAX_EPSILON_TENTHS);
+    const int64_t epsilonSquared = epsilonTenths * epsilonTenths;
+    const int64_t minArea = static_cast<int64_t>(params.minAreaPx) * 8;  // Doubled area in half pixels
+
+    simplified_.clear();
+    polygons_.clear();
+    const int32_t offset = -2 * static_cast<int32_t>(step);  // Cell (1, 1) holds mask sample (0, 0)
+    for (uint32_t start = 0; start < cases_.size(); start++) {
+        const uint8_t c = cases_[start];
+        if (c == 0 || c == 15) {
+            continue;
+        }
+        for (uint8_t startEdge = 0; startEdge < 4; startEdge++) {
+            if (CASES.exit[c][startEdge] < 0 || (visited_[start] & (1 << startEdge))) {
+                continue;
+            }
+
+            // Follow the ring until it returns to where it started
+            ring_.clear();
+            uint32_t cell = start;
+            uint8_t entry = startEdge;
+            int64_t area = 0;
+            do {
+                visited_[cell] |= static_cast<uint8_t>(1 << entry);
+                const int32_t i = static_cast<int32_t>(cell % cellsWide);
+                const int32_t j = static_cast<int32_t>(cell / cellsWide);
+                ring_.push_back({static_cast<int16_t>(offset + (2 * i + EDGE_X[entry]) * static_cast<int32_t>(step)),
+                                 static_cast<int16_t>(offset + (2 * j + EDGE_Y[entry]) * static_cast<int32_t>(step))});
+                switch (CASES.exit[cases_[cell]][entry]) {
+                    case TOP:
+                        cell -= cellsWide;
+                        entry = BOTTOM;
+                        break;
+                    case RIGHT:
+                        cell += 1;
+                        entry = LEFT;
+                        break;
+                    case BOTTOM:
+                        cell += cellsWide;
+                        entry = TOP;
+                        break;
+                    default:
+                        cell -= 1;
+                        entry = RIGHT;
+                        break;
+                }
+            } while (cell != start || entry != startEdge);
+
+            for (size_t n = 0; n < ring_.size(); n++) {
+                const Point& a = ring_[n];
+                const Point& b = ring_[(n + 1) % ring_.size()];
+                area += static_cast<int64_t>(a.x) * b.y - static_cast<int64_t>(b.x) * a.y;
+            }
+            if ((area < 0 ? -area : area) < minArea) {
+                continue;
+            }
+
+            size_t first = simplified_.size();
+            simplify(epsilonSquared, simplified_);
+            size_t count = simplified_.size() - first;
+            // Rings past the uint16 count only come from pathological noise masks
+            if (count < 3 || count > CONTOUR_MAX_POLYGON_POINTS || polygons_.size() == 0xFFFF) {
+                simplified_.resize(first);
+                continue;
+            }
+            polygons_.emplace_back(static_cast<uint16_t>(count), area < 0 ? CONTOUR_FLAG_HOLE : 0);
+        }
+    }
+
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + CONTOUR_HEADER_SIZE + polygons_.size() * 4 +
+                                 simplified_.size() * 4);
+    uint8_t* out = payload.data();
+    writeLe32(out, frameId);
+    writeLe16(out + 4, STREAM_TYPE_CONTOURS);
+    writeLe16(out + 6, 0);
+    out += FRAME_HEADER_SIZE;
+    writeLe16(out, static_cast<uint16_t>(polygons_.size()));
+    out[2] = static_cast<uint8_t>(step);
+    out[3] = flags;
+    writeLe32(out + 4, static_cast<uint32_t>(simplified_.size()));
+    out += CONTOUR_HEADER_SIZE;
+
+    const Point* point = simplified_.data();
+    for (const auto& polygon : polygons_) {
+        writeLe16(out, polygon.first);
+        writeLe16(out + 2, polygon.second);
+        out += 4;
+        for (uint16_t n = 0; n < polygon.first; n++, point++) {
+            writeLe16(out, static_cast<uint16_t>(point->x));
+            writeLe16(out + 2, static_cast<uint16_t>(point->y));
+            out += 4;
+        }
+    }
+    return FramedMessage::binary(std::move(payload));
+}
+
+void ContourTracer::simplify(int64_t epsilonSquared, std::vector<Point>& out) {
+    const uint32_t n = static_cast<uint32_t>(ring_.size());
+    if (n < 3) {
+        return;
+    }
+    auto at = [this, n](uint32_t index) -> const Point& { return ring_[index == n ? 0 : index]; };
+
+    // Split the ring at the point farthest from the first, then simplify both halves
+    uint32_t split = 0;
+    int64_t farthest = -1;
+    for (uint32_t i = 1; i < n; i++) {
+        int64_t dx = ring_[i].x - ring_[0].x;
+        int64_t dy = ring_[i].y - ring_[0].y;
+        if (dx * dx + dy * dy > farthest) {
+            farthest = dx * dx + dy * dy;
+            split = i;
+        }
+    }
+
+    keep_.assign(n + 1, 0);
+    keep_[0] = 1;
+    keep_[split] = 1;
+    stack_.clear();
+    stack_.emplace_back(0, split);
+    stack_.emplace_back(split, n);
+    while (!stack_.empty()) {
+        auto [first, last] = stack_.back();
+        stack_.pop_back();
+        if (last - first < 2) {
+            continue;
+        }
+        const Point& a = at(first);
+        const Point& b = at(last);
+        const int64_t dx = b.x - a.x;
+        const int64_t dy = b.y - a.y;
+        const int64_t lengthSquared = dx * dx + dy * dy;
+
+        // Distance² × length², compared against ε² × length² (ε in half pixels = tenths / 5)
+        uint32_t worst = first;
+        int64_t worstDistance = -1;
+        for (uint32_t i = first + 1; i < last; i++) {
+            const int64_t px = at(i).x - a.x;
+            const int64_t py = at(i).y - a.y;
+            int64_t distance = lengthSquared ? (dx * py - dy * px) * (dx * py - dy * px) : px * px + py * py;
+            if (distance > worstDistance) {
+                worstDistance = distance;
+                worst = i;
+            }
+        }
+        const int64_t limit = epsilonSquared * (lengthSquared ? lengthSquared : 1);
+        if (worstDistance * 25 > limit) {
+            keep_[worst] = 1;
+            stack_.emplace_back(first, worst);
+            stack_.emplace_back(worst, last);
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (keep_[i]) {
+            out.push_back(ring_[i]);
+        }
+    }
+}
+
+}  // namespace kinect_xr
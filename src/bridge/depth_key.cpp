@@ -0,0 +1,280 @@
+/**
+ * @file depth_key.cpp
+ * @brief Depth keying, color registration and keyed frame encoding
+ */
+
+#include "kinect_xr/depth_key.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace kinect_xr {
+
+namespace {
+constexpr int SUBPIXEL_BITS = 4;
+constexpr uint32_t PARALLAX_TABLE_SIZE = 8192;  // Depth in mm; farther readings use the last entry
+constexpr uint16_t HOLE_PARALLAX_MM = 2000;     // Holes are transparent; any plausible color will do
+
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t value) {
+    writeLe16(out, static_cast<uint16_t>(value));
+    writeLe16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+int32_t toSubpixel(float value) {
+    return static_cast<int32_t>(std::lround(value * (1 << SUBPIXEL_BITS)));
+}
+
+// Whether a reading survives the key; far is the background reading (0 = none)
+inline bool keeps(uint16_t mm, uint16_t minMm, uint16_t maxMm, bool background, uint16_t far,
+                  uint16_t toleranceMm) {
+    bool inRange = mm >= minMm && mm <= maxMm;
+    return inRange && (!background || far == 0 || static_cast<uint32_t>(mm) + toleranceMm < far);
+}
+}  // namespace
+
+size_t KeyParams::maxPayloadBytes() const {
+    const size_t pixels = static_cast<size_t>(FRAME_WIDTH) * FRAME_HEIGHT;
+    if (format == KeyFormat::Rgba) {
+        return FRAME_HEADER_SIZE + KEY_HEADER_SIZE + pixels * 4;
+    }
+    return FRAME_HEADER_SIZE + KEY_HEADER_SIZE + pixels;
+}
+
+ColorRegistration ColorRegistration::kinectDefault() {
+    ColorRegistration registration;
+    registration.depth = DepthIntrinsics::kinectDefault();
+    // Kinect v1 RGB camera: 62° x 48.6° field of view
+    registration.rgb.fx = 525.0f;
+    registration.rgb.fy = 525.0f;
+    registration.rgb.cx = FRAME_WIDTH / 2.0f;
+    registration.rgb.cy = FRAME_HEIGHT / 2.0f;
+    registration.baselineMm = 25.0f;
+    return registration;
+}
+
+DepthKeyer::DepthKeyer(const ColorRegistration& registration)
+    : colBase_(FRAME_WIDTH), parallax_(PARALLAX_TABLE_SIZE), rgbRow_(FRAME_HEIGHT),
+      background_(static_cast<size_t>(FRAME_WIDTH) * FRAME_HEIGHT, 0) {
+    const DepthIntrinsics& d = registration.depth;
+    const DepthIntrinsics& c = registration.rgb;
+    for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+        colBase_[u] = toSubpixel((static_cast<float>(u) - d.cx) * c.fx / d.fx + c.cx);
+    }
+    for (uint32_t z = 0; z < PARALLAX_TABLE_SIZE; z++) {
+        float mm = static_cast<float>(z ? z : HOLE_PARALLAX_MM);
+        parallax_[z] = toSubpixel(c.fx * registration.baselineMm / mm);
+    }
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        long row = std::lround((static_cast<float>(v) - d.cy) * c.fy / d.fy + c.cy);
+        rgbRow_[v] = (row >= 0 && row < static_cast<long>(FRAME_HEIGHT)) ? static_cast<int32_t>(row) : -1;
+    }
+}
+
+void DepthKeyer::learnBackground(uint32_t frames) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fill(background_.begin(), background_.end(), 0);
+    learnFramesLeft_ = std::max<uint32_t>(1, std::min(frames, KEY_MAX_LEARN_FRAMES));
+    learning_ = true;
+    learned_ = false;
+}
+
+void DepthKeyer::observe(const uint8_t* depth) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!learning_) {
+        if (learned_) {
+            return;
+        }
+        learnFramesLeft_ = KEY_DEFAULT_LEARN_FRAMES;
+        learning_ = true;
+    }
+
+    for (size_t i = 0; i < background_.size(); i++) {
+        uint16_t mm = static_cast<uint16_t>(depth[i * 2] | (depth[i * 2 + 1] << 8));
+        background_[i] = std::max(background_[i], mm);
+    }
+    if (--learnFramesLeft_ == 0) {
+        learning_ = false;
+        learned_ = true;
+    }
+}
+
+bool DepthKeyer::backgroundReady() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return learned_;
+}
+
+SharedFrame DepthKeyer::encode(uint32_t frameId, const uint8_t* depth, const uint8_t* rgb,
+                               const KeyParams& params) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const size_t pixels = static_cast<size_t>(FRAME_WIDTH) * FRAME_HEIGHT;
+    const bool rgba = params.format == KeyFormat::Rgba;
+    const bool background = params.mode == KeyMode::Background;
+    const uint16_t minMm = std::max<uint16_t>(params.minDepthMm, 1);
+    const uint16_t maxMm = params.maxDepthMm ? params.maxDepthMm : 0xFFFF;
+    const uint32_t feather = std::min<uint32_t>(params.featherPx, KEY_MAX_FEATHER);
+
+    // RGBA goes straight into the message; JPEG+mask goes through scratch planes
+    std::vector<uint8_t> payload;
+    uint8_t* color;
+    uint8_t* alpha;
+    size_t colorStride;
+    size_t alphaStride;
+    if (rgba) {
+        payload.resize(FRAME_HEADER_SIZE + KEY_HEADER_SIZE + pixels * 4);
+        color = payload.data() + FRAME_HEADER_SIZE + KEY_HEADER_SIZE;
+        alpha = color + 3;
+        colorStride = 4;
+        alphaStride = 4;
+    } else {
+        colorPlane_.resize(pixels * 3);
+        alphaPlane_.resize(pixels);
+        color = colorPlane_.data();
+        alpha = alphaPlane_.data();
+        colorStride = 3;
+        alphaStride = 1;
+    }
+
+    // One fused pass: key, register and pack. The per-pixel work is table
+    // lookups and compares; the only data-dependent access is the RGB fetch.
+    const uint16_t* backgroundMm = background_.data();
+    const int32_t maxColumn = static_cast<int32_t>(FRAME_WIDTH) - 1;
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        const int32_t row = rgbRow_[v];
+        const uint8_t* rgbRow = rgb + static_cast<size_t>(row < 0 ? 0 : row) * FRAME_WIDTH * 3;
+        const size_t base = static_cast<size_t>(v) * FRAME_WIDTH;
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            const size_t i = base + u;
+            const uint16_t mm = static_cast<uint16_t>(depth[i * 2] | (depth[i * 2 + 1] << 8));
+            const int32_t column = (colBase_[u] - parallax_[std::min<uint32_t>(mm, PARALLAX_TABLE_SIZE - 1)] +
+                                    (1 << (SUBPIXEL_BITS - 1))) >> SUBPIXEL_BITS;
+            const bool visible = row >= 0 && column >= 0 && column <= maxColumn;
+
+            const bool keyed = visible && keeps(mm, minMm, maxMm, background, backgroundMm[i],
+                                                params.toleranceMm);
+
+            const uint8_t* src = rgbRow + static_cast<size_t>(std::min(std::max(column, 0), maxColumn)) * 3;
+            uint8_t* dst = color + i * colorStride;
+            dst[0] = visible ? src[0] : 0;
+            dst[1] = visible ? src[1] : 0;
+            dst[2] = visible ? src[2] : 0;
+            alpha[i * alphaStride] = keyed ? 255 : 0;
+        }
+    }
+
+    if (feather > 0) {
+        featherAlpha(alpha, alphaStride, feather);
+    }
+
+    const uint8_t flags = (background && !learned_) ? KEY_FLAG_LEARNING : 0;
+    uint32_t colorBytes = static_cast<uint32_t>(pixels * 4);
+    if (!rgba) {
+        std::vector<uint8_t> jpeg;
+        if (!encodeJpeg(color, FRAME_WIDTH, FRAME_HEIGHT, params.quality, jpeg)) {
+            std::cerr << "Keyed frame: JPEG encoding failed" << std::endl;
+            return nullptr;
+        }
+        uLongf maskBytes = compressBound(static_cast<uLong>(pixels));
+        payload.resize(FRAME_HEADER_SIZE + KEY_HEADER_SIZE + jpeg.size() + maskBytes);
+        uint8_t* mask = payload.data() + FRAME_HEADER_SIZE + KEY_HEADER_SIZE + jpeg.size();
+        if (compress2(mask, &maskBytes, alpha, static_cast<uLong>(pixels), Z_BEST_SPEED) != Z_OK) {
+            std::cerr << "Keyed frame: mask compression failed" << std::endl;
+            return nullptr;
+        }
+        std::memcpy(payload.data() + FRAME_HEADER_SIZE + KEY_HEADER_SIZE, jpeg.data(), jpeg.size());
+        payload.resize(FRAME_HEADER_SIZE + KEY_HEADER_SIZE + jpeg.size() + maskBytes);
+        colorBytes = static_cast<uint32_t>(jpeg.size());
+    }
+
+    uint8_t* out = payload.data();
+    writeLe32(out, frameId);
+    writeLe16(out + 4, STREAM_TYPE_KEYED);
+    writeLe16(out + 6, 0);
+    out += FRAME_HEADER_SIZE;
+    out[0] = static_cast<uint8_t>(params.format);
+    out[1] = flags;
+    writeLe16(out + 2, static_cast<uint16_t>(FRAME_WIDTH));
+    writeLe16(out + 4, static_cast<uint16_t>(FRAME_HEIGHT));
+    writeLe16(out + 6, 0);
+    writeLe32(out + 8, colorBytes);
+    return FramedMessage::binary(std::move(payload));
+}
+
+void DepthKeyer::keyMask(const uint8_t* depth, const KeyParams& params, uint32_t step,
+                         std::vector<uint8_t>& mask) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const uint32_t width = FRAME_WIDTH / step;
+    const uint32_t height = FRAME_HEIGHT / step;
+    const bool background = params.mode == KeyMode::Background;
+    const uint16_t minMm = std::max<uint16_t>(params.minDepthMm, 1);
+    const uint16_t maxMm = params.maxDepthMm ? params.maxDepthMm : 0xFFFF;
+    mask.resize(static_cast<size_t>(width) * height);
+
+    uint8_t* out = mask.data();
+    for (uint32_t v = 0; v < height; v++) {
+        const size_t base = static_cast<size_t>(v) * step * FRAME_WIDTH;
+        for (uint32_t u = 0; u < width; u++) {
+            const size_t i = base + static_cast<size_t>(u) * step;
+            const uint16_t mm = static_cast<uint16_t>(depth[i * 2] | (depth[i * 2 + 1] << 8));
+            *out++ = keeps(mm, minMm, maxMm, background, background_[i], params.toleranceMm) ? 1 : 0;
+        }
+    }
+}
+
+void DepthKeyer::featherAlpha(uint8_t* alpha, size_t stride, uint32_t radius) {
+    // Separable box blur with running sums and edge clamping: horizontal into
+    // the scratch plane, then vertical back into place
+    const int32_t width = static_cast<int32_t>(FRAME_WIDTH);
+    const int32_t height = static_cast<int32_t>(FRAME_HEIGHT);
+    const int32_t r = static_cast<int32_t>(radius);
+    const uint32_t window = 2 * radius + 1;
+    blurPlane_.resize(static_cast<size_t>(width) * height);
+
+    for (int32_t v = 0; v < height; v++) {
+        const uint8_t* src = alpha + static_cast<size_t>(v) * width * stride;
+        uint8_t* dst = blurPlane_.data() + static_cast<size_t>(v) * width;
+        uint32_t sum = 0;
+        for (int32_t k = -r; k <= r; k++) {
+            sum += src[std::min(std::max(k, 0), width - 1) * stride];
+        }
+        for (int32_t u = 0; u < width; u++) {
+            dst[u] = static_cast<uint8_t>(sum / window);
+            sum += src[std::min(u + r + 1, width - 1) * stride];
+            sum -= src[std::max(u - r, 0) * stride];
+        }
+    }
+
+    std::vector<uint32_t> sums(width, 0);
+    auto blurRow = [this, width, height](int32_t v) {
+        return blurPlane_.data() + static_cast<size_t>(std::min(std::max(v, 0), height - 1)) * width;
+    };
+    for (int32_t k = -r; k <= r; k++) {
+        const uint8_t* row = blurRow(k);
+        for (int32_t u = 0; u < width; u++) {
+            sums[u] += row[u];
+        }
+    }
+    for (int32_t v = 0; v < height; v++) {
+        uint8_t* dst = alpha + static_cast<size_t>(v) * width * stride;
+        const uint8_t* enter = blurRow(v + r + 1);
+        const uint8_t* leave = blurRow(v - r);
+        for (int32_t u = 0; u < width; u++) {
+            dst[u * stride] = static_cast<uint8_t>(sums[u] / window);
+            sums[u] += enter[u];
+            sums[u] -= leave[u];
+        }
+    }
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,340 @@
+/**
+ * @file depth_mesh.cpp
+ * @brief Depth grid triangulation with discontinuity culling and quadtree merging
+ */
+
+#include "kinect_xr/depth_mesh.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace kinect_xr {
+
+namespace {
+constexpr size_t MAX_BANDS = 4;
+constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t value) {
+    writeLe16(out, static_cast<uint16_t>(value));
+    writeLe16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+// First row of a band when splitting rows into bands of near-equal height
+uint32_t bandStart(uint32_t rows, size_t band, size_t bands) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(rows) * band / bands);
+}
+
+/**
+ * @brief Depth sampled at the grid points, with out-of-range samples as holes (0)
+ */
+struct DepthGrid {
+    uint32_t step = 1;
+    uint32_t width = 0;   // Grid points per row
+    uint32_t height = 0;  // Grid rows
+    std::vector<uint16_t> z;
+
+    uint16_t at(uint32_t i, uint32_t j) const { return z[static_cast<size_t>(j) * width + i]; }
+    uint32_t index(uint32_t i, uint32_t j) const { return j * width + i; }
+};
+
+/**
+ * @brief Emits triangles (as grid point indices) for one band of cells
+ */
+class Triangulator {
+public:
+    Triangulator(const DepthGrid& grid, const MeshParams& params, std::vector<uint32_t>& out)
+        : grid_(grid), params_(params), out_(out) {}
+
+    // One grid cell with its top-left corner at (i, j), culled at discontinuities
+    void cell(uint32_t i, uint32_t j) {
+        uint32_t a = grid_.index(i, j);
+        uint32_t b = grid_.index(i + 1, j);
+        uint32_t c = grid_.index(i, j + 1);
+        uint32_t d = grid_.index(i + 1, j + 1);
+        bool va = grid_.z[a] != 0;
+        bool vb = grid_.z[b] != 0;
+        bool vc = grid_.z[c] != 0;
+        bool vd = grid_.z[d] != 0;
+
+        // With one corner missing, the remaining three still make a triangle
+        if (va && vb && vc) triangle(a, c, b);
+        if (vb && vc && vd) triangle(b, c, d);
+        if (!vb && va && vc && vd) triangle(a, c, d);
+        if (!vc && va && vb && vd) triangle(a, d, b);
+    }
+
+    // Square block of size cells: one pair of triangles if flat, else split in four
+    void block(uint32_t i, uint32_t j, uint32_t size) {
+        if (i + 1 >= grid_.width || j + 1 >= grid_.height) {
+            return;  // Starts beyond the last cell
+        }
+        if (size == 1) {
+            cell(i, j);
+            return;
+        }
+        if (i + size < grid_.width && j + size < grid_.height && isFlat(i, j, size)) {
+            uint32_t a = grid_.index(i, j);
+            uint32_t b = grid_.index(i + size, j);
+            uint32_t c = grid_.index(i, j + size);
+            uint32_t d = grid_.index(i + size, j + size);
+            emit(a, c, b);
+            emit(b, c, d);
+            return;
+        }
+        uint32_t half = size / 2;
+        block(i, j, half);
+        block(i + half, j, half);
+        block(i, j + half, half);
+        block(i + half, j + half, half);
+    }
+
+private:
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+        uint16_t za = grid_.z[a];
+        uint16_t zb = grid_.z[b];
+        uint16_t zc = grid_.z[c];
+        uint32_t nearest = std::min({za, zb, zc});
+        uint32_t farthest = std::max({za, zb, zc});
+        // Allowed jump grows with distance (depth noise) and with the edge length in pixels
+        uint64_t limit = static_cast<uint64_t>(nearest) * params_.discontinuityPermille * grid_.step;
+        if (static_cast<uint64_t>(farthest - nearest) * 1000 <= limit) {
+            emit(a, b, c);
+        }
+    }
+
+    void emit(uint32_t a, uint32_t b, uint32_t c) {
+        out_.push_back(a);
+        out_.push_back(b);
+        out_.push_back(c);
+    }
+
+    // Every sample in the block is valid and within tolerance of the bilinear corner surface
+    bool isFlat(uint32_t i0, uint32_t j0, uint32_t size) const {
+        float z00 = grid_.at(i0, j0);
+        float z10 = grid_.at(i0 + size, j0);
+        float z01 = grid_.at(i0, j0 + size);
+        float z11 = grid_.at(i0 + size, j0 + size);
+        if (z00 == 0 || z10 == 0 || z01 == 0 || z11 == 0) {
+            return false;
+        }
+        const float tolerance = params_.flatnessPermille / 1000.0f;
+        const float inv = 1.0f / static_cast<float>(size);
+        for (uint32_t dj = 0; dj <= size; dj++) {
+            float fy = dj * inv;
+            float left = z00 + (z01 - z00) * fy;
+            float right = z10 + (z11 - z10) * fy;
+            for (uint32_t di = 0; di <= size; di++) {
+                uint16_t z = grid_.at(i0 + di, j0 + dj);
+                if (z == 0) {
+                    return false;
+                }
+                float expected = left + (right - left) * (di * inv);
+                if (std::fabs(z - expected) > tolerance * z) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const DepthGrid& grid_;
+    const MeshParams& params_;
+    std::vector<uint32_t>& out_;
+};
+}  // namespace
+
+size_t MeshParams::maxPayloadBytes() const {
+    uint32_t s = isValidMeshStep(step) ? step : 1;
+    size_t width = (FRAME_WIDTH - 1) / s + 1;
+    size_t height = (FRAME_HEIGHT - 1) / s + 1;
+    size_t vertices = width * height;
+    size_t indices = (width - 1) * (height - 1) * 6;
+    size_t indexSize = vertices > 0xFFFF ? 4 : 2;
+    return FRAME_HEADER_SIZE + MESH_HEADER_SIZE + vertices * 6 + 2 + indices * indexSize;
+}
+
+DepthMesher::DepthMesher(size_t threads) {
+    if (threads == 0) {
+        threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), MAX_BANDS);
+    }
+    bands_ = threads;
+}
+
+DepthMesher::~DepthMesher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void DepthMesher::runBands(const std::function<void(size_t)>& work) {
+    if (bands_ == 1) {
+        work(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (workers_.empty()) {
+            for (size_t band = 1; band < bands_; band++) {
+                workers_.emplace_back(&DepthMesher::workerLoop, this, band);
+            }
+        }
+        job_ = &work;
+        pending_ = bands_ - 1;
+        generation_++;
+    }
+    wake_.notify_all();
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+void DepthMesher::workerLoop(size_t band) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        const auto* job = job_;
+        lock.unlock();
+        (*job)(band);
+        lock.lock();
+        if (--pending_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+SharedFrame DepthMesher::encode(uint32_t frameId, const uint8_t* depth, const DepthIntrinsics& intrinsics,
+                                const MeshParams& params) {
+    std::lock_guard<std::mutex> encodeLock(encodeMutex_);
+
+    DepthGrid grid;
+    grid.step = isValidMeshStep(params.step) ? params.step : 1;
+    grid.width = (FRAME_WIDTH - 1) / grid.step + 1;
+    grid.height = (FRAME_HEIGHT - 1) / grid.step + 1;
+    grid.z.resize(static_cast<size_t>(grid.width) * grid.height);
+    const uint16_t minMm = std::max<uint16_t>(params.minDepthMm, 1);
+    const uint16_t maxMm = std::min<uint16_t>(params.maxDepthMm ? params.maxDepthMm : 0x7FFF, 0x7FFF);
+
+    // Adaptive meshes split into bands of whole root blocks, so no block straddles two bands
+    const uint32_t rootCells = params.adaptive ? std::max<uint32_t>(1, MESH_MAX_CELL / grid.step) : 1;
+    const uint32_t cellRows = grid.height - 1;
+    const uint32_t bandRows = (cellRows + rootCells - 1) / rootCells;
+    std::vector<std::vector<uint32_t>> triangles(bands_);
+
+    // Pass 1: sample the grid, then triangulate, one row band per thread
+    runBands([&](size_t band) {
+        uint32_t last = bandStart(grid.height, band + 1, bands_);
+        for (uint32_t j = bandStart(grid.height, band, bands_); j < last; j++) {
+            const uint8_t* row = depth + static_cast<size_t>(j) * grid.step * FRAME_WIDTH * 2;
+            for (uint32_t i = 0; i < grid.width; i++) {
+                const uint8_t* sample = row + static_cast<size_t>(i) * grid.step * 2;
+                uint16_t mm = static_cast<uint16_t>(sample[0] | (sample[1] << 8));
+                grid.z[grid.index(i, j)] = (mm >= minMm && mm <= maxMm) ? mm : 0;
+            }
+        }
+    });
+    runBands([&](size_t band) {
+        uint32_t first = bandStart(bandRows, band, bands_) * rootCells;
+        uint32_t last = std::min(bandStart(bandRows, band + 1, bands_) * rootCells, cellRows);
+        Triangulator triangulator(grid, params, triangles[band]);
+        for (uint32_t j = first; j < last; j += rootCells) {
+            for (uint32_t i = 0; i + 1 < grid.width; i += rootCells) {
+                triangulator.block(i, j, rootCells);
+            }
+        }
+    });
+
+    // Pass 2: number the referenced vertices in row-major order
+    std::vector<uint32_t> remap(grid.z.size(), UNUSED);
+    size_t indexCount = 0;
+    for (const auto& band : triangles) {
+        for (uint32_t index : band) {
+            remap[index] = 0;
+        }
+        indexCount += band.size();
+    }
+    uint32_t vertexCount = 0;
+    for (auto& id : remap) {
+        if (id != UNUSED) {
+            id = vertexCount++;
+        }
+    }
+
+    const bool index32 = vertexCount > 0xFFFF;
+    const size_t positionBytes = static_cast<size_t>(vertexCount) * 6;
+    const size_t padding = index32 ? positionBytes % 4 : 0;
+    const size_t indexSize = index32 ? 4 : 2;
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + MESH_HEADER_SIZE + positionBytes + padding +
+                                 indexCount * indexSize);
+    uint8_t* out = payload.data();
+    writeLe32(out, frameId);
+    writeLe16(out + 4, STREAM_TYPE_MESH);
+    writeLe16(out + 6, 0);
+    out += FRAME_HEADER_SIZE;
+    writeLe32(out, vertexCount);
+    writeLe32(out + 4, static_cast<uint32_t>(indexCount));
+    out[8] = index32 ? MESH_FLAG_INDEX32 : 0;
+    out[9] = static_cast<uint8_t>(grid.step);
+    writeLe16(out + 10, 0);
+
+    // Pass 3: positions and indices, again one row band per thread
+    uint8_t* positions = out + MESH_HEADER_SIZE;
+    uint8_t* indices = positions + positionBytes + padding;
+    std::vector<size_t> indexOffsets(bands_ + 1, 0);
+    for (size_t band = 0; band < bands_; band++) {
+        indexOffsets[band + 1] = indexOffsets[band] + triangles[band].size();
+    }
+
+    runBands([&](size_t band) {
+        uint32_t first = bandStart(grid.height, band, bands_);
+        uint32_t last = bandStart(grid.height, band + 1, bands_);
+        for (uint32_t j = first; j < last; j++) {
+            float yFactor = -(static_cast<float>(j * grid.step) - intrinsics.cy) / intrinsics.fy;
+            for (uint32_t i = 0; i < grid.width; i++) {
+                uint32_t id = remap[grid.index(i, j)];
+                if (id == UNUSED) {
+                    continue;
+                }
+                float z = grid.at(i, j);
+                float xFactor = (static_cast<float>(i * grid.step) - intrinsics.cx) / intrinsics.fx;
+                uint8_t* p = positions + static_cast<size_t>(id) * 6;
+                writeLe16(p, static_cast<uint16_t>(static_cast<int16_t>(std::lround(z * xFactor))));
+                writeLe16(p + 2, static_cast<uint16_t>(static_cast<int16_t>(std::lround(z * yFactor))));
+                writeLe16(p + 4, static_cast<uint16_t>(z));
+            }
+        }
+
+        uint8_t* dst = indices + indexOffsets[band] * indexSize;
+        for (uint32_t index : triangles[band]) {
+            if (index32) {
+                writeLe32(dst, remap[index]);
+            } else {
+                writeLe16(dst, static_cast<uint16_t>(remap[index]));
+            }
+            dst += indexSize;
+        }
+    });
+
+    return FramedMessage::binary(std::move(payload));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,173 @@
+/**
+ * @file depth_packing.cpp
+ * @brief Depth bit packing and unpacking
+ */
+
+#include "kinect_xr/depth_packing.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <cstring>
+#include <vector>
+
+namespace kinect_xr {
+
+namespace {
+// Little-endian loads and stores of the low n bytes of a word
+uint64_t loadLe(const uint8_t* in, size_t n) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < n; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void storeLe(uint8_t* out, uint64_t value, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// Eight samples are exactly Bits bytes. They are built as two halves of
+// four samples (4 * Bits <= 52 bits each), then written as one full word
+// and the Bits - 8 bytes left over, so the loop has no data-dependent
+// branches and unrolls completely.
+template <uint32_t Bits>
+void pack(const uint8_t* depth, size_t count, uint8_t* out) {
+    constexpr uint32_t HALF = 4 * Bits;
+    constexpr uint64_t MAX = (1u << Bits) - 1;
+
+    auto sample = [depth](size_t i) -> uint64_t {
+        uint64_t mm = depth[i * 2] | (static_cast<uint64_t>(depth[i * 2 + 1]) << 8);
+        return mm <= MAX ? mm : 0;  // Out of range: no reading
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, out += Bits) {
+        uint64_t h0 = 0;
+        uint64_t h1 = 0;
+        for (uint32_t k = 0; k < 4; k++) {
+            h0 |= sample(i + k) << (k * Bits);
+            h1 |= sample(i + 4 + k) << (k * Bits);
+        }
+        storeLe(out, h0 | (h1 << HALF), 8);
+        storeLe(out + 8, h1 >> (64 - HALF), Bits - 8);
+    }
+
+    // Tail: fewer than eight samples, bit by bit into a zeroed remainder
+    size_t rest = count - i;
+    std::memset(out, 0, (rest * Bits + 7) / 8);
+    for (size_t k = 0; k < rest; k++) {
+        uint64_t value = sample(i + k);
+        for (uint32_t b = 0; b < Bits; b++) {
+            size_t bit = k * Bits + b;
+            out[bit / 8] |= static_cast<uint8_t>(((value >> b) & 1) << (bit % 8));
+        }
+    }
+}
+
+template <uint32_t Bits>
+void unpack(const uint8_t* packed, size_t count, uint16_t* out) {
+    constexpr uint32_t HALF = 4 * Bits;
+    constexpr uint64_t MASK = (1u << Bits) - 1;
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, packed += Bits) {
+        uint64_t w0 = loadLe(packed, 8);
+        uint64_t w1 = loadLe(packed + 8, Bits - 8);
+        uint64_t h0 = w0;
+        uint64_t h1 = (w0 >> HALF) | (w1 << (64 - HALF));
+        for (uint32_t k = 0; k < 4; k++) {
+            out[i + k] = static_cast<uint16_t>((h0 >> (k * Bits)) & MASK);
+            out[i + 4 + k] = static_cast<uint16_t>((h1 >> (k * Bits)) & MASK);
+        }
+    }
+
+    size_t rest = count - i;
+    for (size_t k = 0; k < rest; k++) {
+        uint16_t value = 0;
+        for (uint32_t b = 0; b < Bits; b++) {
+            size_t bit = k * Bits + b;
+            value = static_cast<uint16_t>(value | (((packed[bit / 8] >> (bit % 8)) & 1) << b));
+        }
+        out[i + k] = value;
+    }
+}
+}  // namespace
+
+const char* depthPackingName(DepthPacking packing) {
+    switch (packing) {
+        case DepthPacking::Bits12:
+            return "packed12";
+        case DepthPacking::Bits13:
+            return "packed13";
+        case DepthPacking::None:
+        default:
+            return "uint16";
+    }
+}
+
+bool parseDepthPacking(const std::string& name, DepthPacking& packing) {
+    for (DepthPacking candidate : {DepthPacking::None, DepthPacking::Bits12, DepthPacking::Bits13}) {
+        if (name == depthPackingName(candidate)) {
+            packing = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void packDepth(const uint8_t* depth, size_t count, DepthPacking packing, uint8_t* out) {
+    switch (packing) {
+        case DepthPacking::Bits12:
+            pack<12>(depth, count, out);
+            break;
+        case DepthPacking::Bits13:
+            pack<13>(depth, count, out);
+            break;
+        case DepthPacking::None:
+        default:
+            std::memcpy(out, depth, count * 2);
+            break;
+    }
+}
+
+void unpackDepth(const uint8_t* packed, size_t count, DepthPacking packing, uint16_t* out) {
+    switch (packing) {
+        case DepthPacking::Bits12:
+            unpack<12>(packed, count, out);
+            break;
+        case DepthPacking::Bits13:
+            unpack<13>(packed, count, out);
+            break;
+        case DepthPacking::None:
+        default:
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<uint16_t>(packed[i * 2] | (packed[i * 2 + 1] << 8));
+            }
+            break;
+    }
+}
+
+SharedFrame packDepthFrame(const SharedFrame& frame, DepthPacking packing) {
+    if (!frame || packing == DepthPacking::None || frame->payloadSize() < FRAME_HEADER_SIZE) {
+        return nullptr;
+    }
+    const uint8_t* header = frame->payload();
+    uint16_t streamType = static_cast<uint16_t>(header[4] | (header[5] << 8));
+    uint16_t flags = static_cast<uint16_t>(header[6] | (header[7] << 8));
+    size_t size = frame->payloadSize() - FRAME_HEADER_SIZE;
+    if (streamType != STREAM_TYPE_DEPTH || size % 2 != 0 || (flags & FRAME_FLAG_DEPTH_PACKING_MASK)) {
+        return nullptr;
+    }
+
+    size_t count = size / 2;
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + packedDepthSize(count, packing));
+    std::memcpy(payload.data(), header, FRAME_HEADER_SIZE);
+    flags = static_cast<uint16_t>(flags | (static_cast<uint16_t>(packing) << FRAME_FLAG_DEPTH_PACKING_SHIFT));
+    payload[6] = static_cast<uint8_t>(flags);
+    payload[7] = static_cast<uint8_t>(flags >> 8);
+    packDepth(header + FRAME_HEADER_SIZE, count, packing, payload.data() + FRAME_HEADER_SIZE);
+    return FramedMessage::binary(std::move(payload));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,136 @@
+/**
+ * @file frame_bundle.cpp
+ * @brief Multi-stream bundle encoding, parsing and per-client collection
+ */
+
+#include "kinect_xr/frame_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kinect_xr {
+
+namespace {
+void writeLe(uint8_t* out, uint64_t value, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t readLe(const uint8_t* in, size_t n) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < n; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+size_t alignUp(size_t offset) {
+    return (offset + BUNDLE_ALIGNMENT - 1) & ~(BUNDLE_ALIGNMENT - 1);
+}
+}  // namespace
+
+SharedFrame bundleFrames(uint32_t frameId, uint64_t captureTimeMs, const std::vector<SharedFrame>& parts) {
+    if (parts.empty() || parts.size() > BUNDLE_MAX_PARTS) {
+        return nullptr;
+    }
+    size_t size = alignUp(FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE + parts.size() * BUNDLE_ENTRY_SIZE);
+    for (const auto& part : parts) {
+        if (!part || !part->isBinary() || part->payloadSize() < FRAME_HEADER_SIZE) {
+            return nullptr;
+        }
+        size = alignUp(size + part->payloadSize());
+    }
+
+    // Zero-initialized, so reserved fields and padding are 0
+    std::vector<uint8_t> payload(size, 0);
+    encodeFrameHeader(payload.data(), frameId, STREAM_TYPE_BUNDLE);
+    uint8_t* header = payload.data() + FRAME_HEADER_SIZE;
+    writeLe(header, parts.size(), 2);
+    writeLe(header + 8, captureTimeMs, 8);
+
+    uint8_t* table = header + BUNDLE_HEADER_SIZE;
+    size_t offset = alignUp(FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE + parts.size() * BUNDLE_ENTRY_SIZE);
+    for (const auto& part : parts) {
+        writeLe(table, offset, 4);
+        writeLe(table + 4, part->payloadSize(), 4);
+        table += BUNDLE_ENTRY_SIZE;
+        std::memcpy(payload.data() + offset, part->payload(), part->payloadSize());
+        offset = alignUp(offset + part->payloadSize());
+    }
+    return FramedMessage::binary(std::move(payload));
+}
+
+bool splitBundle(const uint8_t* message, size_t size, std::vector<BundlePart>& parts,
+                 uint64_t* captureTimeMs) {
+    parts.clear();
+    if (size < FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE || readLe(message + 4, 2) != STREAM_TYPE_BUNDLE) {
+        return false;
+    }
+    const uint8_t* header = message + FRAME_HEADER_SIZE;
+    size_t count = readLe(header, 2);
+    if (count == 0 || count > BUNDLE_MAX_PARTS ||
+        size < FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE + count * BUNDLE_ENTRY_SIZE) {
+        return false;
+    }
+
+    const uint8_t* table = header + BUNDLE_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++, table += BUNDLE_ENTRY_SIZE) {
+        size_t offset = readLe(table, 4);
+        size_t length = readLe(table + 4, 4);
+        if (length < FRAME_HEADER_SIZE || offset > size || length > size - offset) {
+            parts.clear();
+            return false;
+        }
+        parts.push_back({message + offset, length});
+    }
+    if (captureTimeMs) {
+        *captureTimeMs = readLe(header + 8, 8);
+    }
+    return true;
+}
+
+void FrameBundler::add(const ClientPtr& client, const SharedFrame& frame) {
+    auto it = std::find_if(pending_.begin(), pending_.end(),
+                           [&client](const Pending& pending) { return pending.client == client; });
+    if (it == pending_.end()) {
+        pending_.push_back({client, {}});
+        it = pending_.end() - 1;
+    }
+    it->parts.push_back(frame);
+}
+
+size_t FrameBundler::flush(uint32_t frameId, uint64_t captureTimeMs, const SendFn& send) {
+    // Clients subscribed alike get the same parts; build each distinct bundle once
+    std::vector<std::pair<const std::vector<SharedFrame>*, SharedFrame>> built;
+    size_t sent = 0;
+    for (const auto& pending : pending_) {
+        SharedFrame out;
+        if (pending.parts.size() == 1) {
+            out = pending.parts.front();
+        } else {
+            auto it = std::find_if(built.begin(), built.end(), [&pending](const auto& bundle) {
+                return *bundle.first == pending.parts;
+            });
+            if (it == built.end()) {
+                built.emplace_back(&pending.parts, bundleFrames(frameId, captureTimeMs, pending.parts));
+                it = built.end() - 1;
+            }
+            out = it->second;
+        }
+        if (!out) {
+            // Not bundleable (cannot happen with bridge messages): send the parts alone
+            for (const auto& part : pending.parts) {
+                send(pending.client, part);
+            }
+            sent += pending.parts.size();
+            continue;
+        }
+        send(pending.client, out);
+        sent++;
+    }
+    pending_.clear();
+    return sent;
+}
+
+}  // namespace kinect_xr
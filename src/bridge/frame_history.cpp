@@ -0,0 +1,272 @@
+/**
+ * @file frame_history.cpp
+ * @brief Compressed frame history implementation
+ */
+
+#include "kinect_xr/frame_history.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace kinect_xr {
+
+namespace {
+// Frames waiting for compression; beyond this the oldest is dropped
+constexpr size_t MAX_QUEUED_FRAMES = 8;
+
+uint32_t readFrameId(const uint8_t* header) {
+    return static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+           (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+}
+}  // namespace
+
+FrameHistory::FrameHistory(double seconds, size_t maxBytes)
+    : windowMs_(static_cast<uint64_t>(std::max(0.0, seconds) * 1000.0)), maxBytes_(maxBytes) {
+    worker_ = std::thread(&FrameHistory::workerLoop, this);
+}
+
+FrameHistory::~FrameHistory() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueCv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void FrameHistory::push(uint16_t streamType, const SharedFrame& frame, uint64_t timestampMs) {
+    if (!frame || frame->payloadSize() < FRAME_HEADER_SIZE) {
+        return;
+    }
+
+    uint32_t frameId = readFrameId(frame->payload());
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+
+        // The broadcast loop resends the cached frame when no new one arrived
+        auto last = lastQueued_.find(streamType);
+        if (last != lastQueued_.end() && last->second == frameId) {
+            return;
+        }
+        lastQueued_[streamType] = frameId;
+
+        if (queue_.size() >= MAX_QUEUED_FRAMES) {
+            queue_.pop_front();
+            dropped_++;
+        }
+        queue_.push_back(Pending{streamType, frame, timestampMs});
+    }
+    queueCv_.notify_one();
+}
+
+void FrameHistory::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    idleCv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+void FrameHistory::workerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    while (true) {
+        queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            break;
+        }
+
+        Pending pending = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        store(pending);
+
+        lock.lock();
+        busy_ = false;
+        if (queue_.empty()) {
+            idleCv_.notify_all();
+        }
+    }
+    busy_ = false;
+    idleCv_.notify_all();
+}
+
+void FrameHistory::store(const Pending& pending) {
+    const uint8_t* message = pending.frame->payload();
+    const uint8_t* data = message + FRAME_HEADER_SIZE;
+    size_t size = pending.frame->payloadSize() - FRAME_HEADER_SIZE;
+
+    Entry entry;
+    entry.frameId = readFrameId(message);
+    entry.flags = static_cast<uint16_t>(message[6] | (message[7] << 8));
+    entry.timestampMs = pending.timestampMs;
+    entry.rawSize = size;
+
+    // Fastest deflate level: depth compresses ~3x, and we must keep up with 30 Hz
+    uLongf compressedSize = compressBound(static_cast<uLong>(size));
+    entry.compressed.resize(compressedSize);
+    if (compress2(entry.compressed.data(), &compressedSize, data, static_cast<uLong>(size),
+                  Z_BEST_SPEED) != Z_OK) {
+        std::cerr << "History: failed to compress frame " << entry.frameId << std::endl;
+        return;
+    }
+    entry.compressed.resize(compressedSize);
+    entry.compressed.shrink_to_fit();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (servedType_ == pending.streamType && servedId_ == entry.frameId) {
+        served_.reset();  // Frame IDs restarted (e.g. upstream bridge restarted)
+    }
+    rawBytes_ += entry.rawSize;
+    compressedBytes_ += entry.compressed.size();
+    streams_[pending.streamType].push_back(std::move(entry));
+    evict(pending.timestampMs);
+}
+
+void FrameHistory::evict(uint64_t newestMs) {
+    uint64_t cutoff = newestMs > windowMs_ ? newestMs - windowMs_ : 0;
+
+    for (auto& [type, entries] : streams_) {
+        while (!entries.empty() && entries.front().timestampMs < cutoff) {
+            rawBytes_ -= entries.front().rawSize;
+            compressedBytes_ -= entries.front().compressed.size();
+            entries.pop_front();
+        }
+    }
+
+    // Memory cap: drop the globally oldest frame until under budget
+    while (compressedBytes_ > maxBytes_) {
+        std::deque<Entry>* oldest = nullptr;
+        for (auto& [type, entries] : streams_) {
+            if (!entries.empty() &&
+                (!oldest || entries.front().timestampMs < oldest->front().timestampMs)) {
+                oldest = &entries;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        rawBytes_ -= oldest->front().rawSize;
+        compressedBytes_ -= oldest->front().compressed.size();
+        oldest->pop_front();
+    }
+}
+
+SharedFrame FrameHistory::inflate(uint16_t streamType, const Entry& entry) {
+    if (served_ && servedType_ == streamType && servedId_ == entry.frameId) {
+        return served_;
+    }
+
+    // Inflate straight behind a fresh header so the message needs no second copy
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + entry.rawSize);
+    encodeFrameHeader(payload.data(), entry.frameId, streamType,
+                      static_cast<uint16_t>(entry.flags | FRAME_FLAG_HISTORY));
+    uLongf rawSize = static_cast<uLongf>(entry.rawSize);
+    if (uncompress(payload.data() + FRAME_HEADER_SIZE, &rawSize, entry.compressed.data(),
+                   static_cast<uLong>(entry.compressed.size())) != Z_OK ||
+        rawSize != entry.rawSize) {
+        std::cerr << "History: failed to inflate frame " << entry.frameId << std::endl;
+        return nullptr;
+    }
+
+    served_ = FramedMessage::binary(std::move(payload));
+    servedType_ = streamType;
+    servedId_ = entry.frameId;
+    return served_;
+}
+
+SharedFrame FrameHistory::get(uint16_t streamType, uint32_t frameId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(streamType);
+    if (it == streams_.end()) {
+        return nullptr;
+    }
+    for (const Entry& entry : it->second) {
+        if (entry.frameId == frameId) {
+            return inflate(streamType, entry);
+        }
+    }
+    return nullptr;
+}
+
+SharedFrame FrameHistory::getAt(uint16_t streamType, uint64_t timestampMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(streamType);
+    if (it == streams_.end()) {
+        return nullptr;
+    }
+
+    // Entries are in capture order, so binary-search the first one after timestampMs
+    const auto& entries = it->second;
+    auto after = std::upper_bound(entries.begin(), entries.end(), timestampMs,
+        [](uint64_t ts, const Entry& entry) { return ts < entry.timestampMs; });
+    if (after == entries.begin()) {
+        return nullptr;
+    }
+    return inflate(streamType, *std::prev(after));
+}
+
+SharedFrame FrameHistory::latest(uint16_t streamType) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(streamType);
+    if (it == streams_.end() || it->second.empty()) {
+        return nullptr;
+    }
+    return inflate(streamType, it->second.back());
+}
+
+std::vector<SharedFrame> FrameHistory::recent(uint16_t streamType, size_t count) {
+    std::vector<SharedFrame> frames;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(streamType);
+    if (it == streams_.end()) {
+        return frames;
+    }
+
+    const auto& entries = it->second;
+    size_t first = entries.size() > count ? entries.size() - count : 0;
+    for (size_t i = first; i < entries.size(); i++) {
+        if (auto frame = inflate(streamType, entries[i])) {
+            frames.push_back(std::move(frame));
+        }
+    }
+    return frames;
+}
+
+std::vector<SharedFrame> FrameHistory::since(uint16_t streamType, uint64_t timestampMs) {
+    std::vector<SharedFrame> frames;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(streamType);
+    if (it == streams_.end()) {
+        return frames;
+    }
+
+    for (const Entry& entry : it->second) {
+        if (entry.timestampMs >= timestampMs) {
+            if (auto frame = inflate(streamType, entry)) {
+                frames.push_back(std::move(frame));
+            }
+        }
+    }
+    return frames;
+}
+
+FrameHistoryStats FrameHistory::stats() const {
+    FrameHistoryStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [type, entries] : streams_) {
+            stats.frames += entries.size();
+        }
+        stats.rawBytes = rawBytes_;
+        stats.compressedBytes = compressedBytes_;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stats.dropped = dropped_;
+    return stats;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,172 @@
+/**
+ * @file ix_transport.cpp
+ * @brief IXWebSocket-backed bridge transport implementation
+ */
+
+#include "kinect_xr/ix_transport.h"
+
+#include <ixwebsocket/IXWebSocketSendData.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+#include <iostream>
+
+namespace kinect_xr {
+
+/**
+ * @brief ClientConnection wrapping an ix::WebSocket owned by the server
+ *
+ * The ix::WebSocket is destroyed by IXWebSocket after its Close message, so
+ * sends are guarded by open_ under mutex_.
+ */
+class IxConnection : public ClientConnection {
+public:
+    explicit IxConnection(ix::WebSocket* ws) : ws_(ws) {}
+
+    void sendText(const std::string& text) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_) {
+            ws_->sendText(text);
+        }
+    }
+
+    void sendFrame(const SharedFrame& frame) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_) {
+            return;
+        }
+
+        ix::IXWebSocketSendData payload(reinterpret_cast<const char*>(frame->payload()),
+                                        frame->payloadSize());
+        if (frame->isBinary()) {
+            ws_->sendBinary(payload);
+        } else {
+            ws_->sendText(std::string(reinterpret_cast<const char*>(frame->payload()),
+                                      frame->payloadSize()));
+        }
+    }
+
+    size_t bufferedBytes() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return open_ ? ws_->bufferedAmount() : 0;
+    }
+
+    void close() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_) {
+            ws_->close();
+        }
+    }
+
+    bool isOpen() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return open_;
+    }
+
+    void markClosed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = false;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    ix::WebSocket* ws_;
+    bool open_ = true;
+};
+
+IxTransport::IxTransport() = default;
+
+IxTransport::~IxTransport() {
+    stop();
+}
+
+bool IxTransport::start(int port, const TransportCallbacks& callbacks) {
+    callbacks_ = callbacks;
+
+    server_ = std::make_unique<ix::WebSocketServer>(port, "0.0.0.0");
+
+    // Frames are shared by every client; per-message deflate would recompress
+    // each 600-900 KB frame once per connection.
+    server_->disablePerMessageDeflate();
+
+    server_->setOnClientMessageCallback(
+        [this](std::shared_ptr<ix::ConnectionState> /*connectionState*/,
+               ix::WebSocket& webSocket,
+               const ix::WebSocketMessagePtr& msg) {
+            ix::WebSocket* wsPtr = &webSocket;
+
+            switch (msg->type) {
+                case ix::WebSocketMessageType::Open: {
+                    auto connection = std::make_shared<IxConnection>(wsPtr);
+                    {
+                        std::lock_guard<std::mutex> lock(connectionsMutex_);
+                        connections_[wsPtr] = connection;
+                    }
+                    if (callbacks_.onOpen) callbacks_.onOpen(connection);
+                    break;
+                }
+                case ix::WebSocketMessageType::Close: {
+                    auto connection = findConnection(wsPtr);
+                    if (!connection) break;
+
+                    if (callbacks_.onClose) callbacks_.onClose(connection);
+                    connection->markClosed();
+
+                    std::lock_guard<std::mutex> lock(connectionsMutex_);
+                    connections_.erase(wsPtr);
+                    break;
+                }
+                case ix::WebSocketMessageType::Message:
+                {
+                    auto connection = findConnection(wsPtr);
+                    if (!connection) {
+                        break;
+                    }
+                    if (!msg->binary && callbacks_.onMessage) {
+                        callbacks_.onMessage(connection, msg->str);
+                    } else if (msg->binary && callbacks_.onBinary) {
+                        callbacks_.onBinary(connection, reinterpret_cast<const uint8_t*>(msg->str.data()),
+                                            msg->str.size());
+                    }
+                    break;
+                }
+                case ix::WebSocketMessageType::Error:
+                    std::cerr << "WebSocket error: " << msg->errorInfo.reason << std::endl;
+                    break;
+                default:
+                    break;
+            }
+        });
+
+    auto res = server_->listen();
+    if (!res.first) {
+        std::cerr << "Failed to start server: " << res.second << std::endl;
+        server_.reset();
+        return false;
+    }
+
+    server_->start();
+    return true;
+}
+
+void IxTransport::stop() {
+    if (!server_) {
+        return;
+    }
+
+    server_->stop();
+    server_.reset();
+
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    for (auto& [wsPtr, connection] : connections_) {
+        connection->markClosed();
+    }
+    connections_.clear();
+}
+
+std::shared_ptr<IxConnection> IxTransport::findConnection(ix::WebSocket* ws) {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    auto it = connections_.find(ws);
+    return it != connections_.end() ? it->second : nullptr;
+}
+
+}  // namespace kinect_xr
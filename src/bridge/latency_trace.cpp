@@ -0,0 +1,221 @@
+/**
+ * @file latency_trace.cpp
+ * @brief Latency histograms and per-frame stage tracing
+ */
+
+#include "kinect_xr/latency_trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kinect_xr {
+
+namespace {
+constexpr size_t stageIndex(TraceStage stage) {
+    return static_cast<size_t>(stage);
+}
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    if (to <= from) return 0;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+void raiseMax(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+}  // namespace
+
+size_t LatencyHistogram::bucketOf(uint64_t us) {
+    us = std::min(us, MAX_US);
+    if (us < SUB_BUCKETS) {
+        return static_cast<size_t>(us);
+    }
+    size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(us));
+    size_t mantissa = static_cast<size_t>(us >> (exponent - 3)) & (SUB_BUCKETS - 1);
+    return (exponent - 2) * SUB_BUCKETS + mantissa;
+}
+
+uint64_t LatencyHistogram::bucketLow(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t exponent = bucket / SUB_BUCKETS + 2;
+    uint64_t mantissa = bucket % SUB_BUCKETS;
+    return (SUB_BUCKETS + mantissa) << (exponent - 3);
+}
+
+uint64_t LatencyHistogram::bucketHigh(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t exponent = bucket / SUB_BUCKETS + 2;
+    return bucketLow(bucket) + (uint64_t{1} << (exponent - 3)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us) {
+    buckets_[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(us, std::memory_order_relaxed);
+    raiseMax(maxUs_, us);
+}
+
+uint64_t LatencyHistogram::percentileUs(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        seen += buckets_[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Never above the largest value actually seen
+            uint64_t mid = (bucketLow(bucket) + bucketHigh(bucket)) / 2;
+            return std::min(mid, maxUs_.load(std::memory_order_relaxed));
+        }
+    }
+    return maxUs_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::countAtOrBelow(uint64_t us) const {
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT && bucketHigh(bucket) <= us; bucket++) {
+        total += buckets_[bucket].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary out;
+    out.count = count();
+    if (out.count == 0) {
+        return out;
+    }
+    out.meanUs = sumUs_.load(std::memory_order_relaxed) / out.count;
+    out.p50Us = percentileUs(0.50);
+    out.p90Us = percentileUs(0.90);
+    out.p99Us = percentileUs(0.99);
+    out.maxUs = maxUs_.load(std::memory_order_relaxed);
+    return out;
+}
+
+const char* latencySpanName(LatencySpan span) {
+    switch (span) {
+        case LatencySpan::Cache:
+            return "cache";
+        case LatencySpan::Framing:
+            return "framing";
+        case LatencySpan::Fanout:
+            return "fanout";
+        case LatencySpan::Server:
+            return "server";
+        case LatencySpan::ToReceive:
+            return "to_receive";
+        case LatencySpan::Render:
+            return "render";
+        case LatencySpan::ToRender:
+            return "to_render";
+        case LatencySpan::ToAck:
+            return "to_ack";
+        default:
+            return "unknown";
+    }
+}
+
+LatencyTracer::FrameTrace* LatencyTracer::findLocked(uint32_t frameId) {
+    FrameTrace& trace = frames_[frameId % TRACE_FRAMES];
+    return trace.valid && trace.frameId == frameId ? &trace : nullptr;
+}
+
+bool LatencyTracer::begin(uint32_t frameId, Clock::time_point capturedAt, uint64_t captureWallUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (findLocked(frameId)) {
+        return false;
+    }
+    FrameTrace& trace = frames_[frameId % TRACE_FRAMES];
+    trace.frameId = frameId;
+    trace.valid = true;
+    trace.captureWallUs = captureWallUs;
+    // Stages that are never stamped count as zero-length
+    trace.stages.fill(capturedAt);
+    return true;
+}
+
+void LatencyTracer::stamp(uint32_t frameId, TraceStage stage, Clock::time_point at) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (FrameTrace* trace = findLocked(frameId)) {
+        trace->stages[stageIndex(stage)] = at;
+    }
+}
+
+void LatencyTracer::finish(uint32_t frameId, Clock::time_point at) {
+    std::array<Clock::time_point, static_cast<size_t>(TraceStage::Count)> stages;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FrameTrace* trace = findLocked(frameId);
+        if (!trace) {
+            return;
+        }
+        trace->stages[stageIndex(TraceStage::Enqueued)] = at;
+        stages = trace->stages;
+    }
+
+    auto captured = stages[stageIndex(TraceStage::Captured)];
+    auto dequeued = std::max(captured, stages[stageIndex(TraceStage::Dequeued)]);
+    auto framed = std::max(dequeued, stages[stageIndex(TraceStage::Framed)]);
+    histograms_[LatencySpan::Cache].record(elapsedUs(captured, dequeued));
+    histograms_[LatencySpan::Framing].record(elapsedUs(dequeued, framed));
+    histograms_[LatencySpan::Fanout].record(elapsedUs(framed, at));
+    histograms_[LatencySpan::Server].record(elapsedUs(captured, at));
+    framesTraced_++;
+}
+
+bool LatencyTracer::ack(uint32_t frameId, uint64_t receivedWallUs, uint64_t renderedWallUs,
+                        Clock::time_point arrivedAt, LatencyHistograms* client) {
+    uint64_t captureWallUs = 0;
+    Clock::time_point captured;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FrameTrace* trace = findLocked(frameId);
+        if (!trace) {
+            return false;
+        }
+        captureWallUs = trace->captureWallUs;
+        captured = trace->stages[stageIndex(TraceStage::Captured)];
+    }
+
+    auto record = [this, client](LatencySpan span, uint64_t us) {
+        histograms_[span].record(us);
+        if (client) {
+            (*client)[span].record(us);
+        }
+    };
+    // Clamped at zero when the client clock runs behind
+    auto since = [](uint64_t from, uint64_t to) { return to > from ? to - from : 0; };
+
+    record(LatencySpan::ToAck, elapsedUs(captured, arrivedAt));
+    if (receivedWallUs) {
+        record(LatencySpan::ToReceive, since(captureWallUs, receivedWallUs));
+    }
+    if (renderedWallUs) {
+        record(LatencySpan::ToRender, since(captureWallUs, renderedWallUs));
+        if (receivedWallUs) {
+            record(LatencySpan::Render, since(receivedWallUs, renderedWallUs));
+        }
+    }
+    acks_++;
+    return true;
+}
+
+uint64_t wallClockUs(std::chrono::steady_clock::time_point at) {
+    // Shift the current wall time back by how long ago the steady instant was
+    auto steadyNow = std::chrono::steady_clock::now();
+    auto wallNow = std::chrono::system_clock::now();
+    auto ago = steadyNow > at ? steadyNow - at : std::chrono::steady_clock::duration::zero();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        (wallNow - ago).time_since_epoch()).count());
+}
+
+}  // namespace kinect_xr
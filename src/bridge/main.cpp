@@ -8,18 +8,33 @@
  *   kinect-bridge              # Start with Kinect (requires sudo on macOS)
  *   kinect-bridge --mock       # Start with mock data (no Kinect required)
  *   kinect-bridge --port 9000  # Use custom port
+ *   kinect-bridge --transport epoll --io-threads 4  # Reactor transport
+ *   curl http://localhost:8765/rgb.jpg -o frame.jpg  # Snapshot (epoll transport only)
+ *   curl http://localhost:8765/metrics  # Prometheus metrics (epoll transport only)
+ *   kinect-bridge --shm /kinect-xr  # Also publish to shared memory
+ *   kinect-bridge --unix /tmp/kinect-xr.sock  # Also accept Unix socket clients
+ *   kinect-bridge --multicast 239.255.42.99:5004 --fec 8  # Also multicast to the LAN
+ *   kinect-bridge --relay ws://capture-host:8765/kinect --port 8766  # Re-serve another bridge
+ *   kinect-bridge --history 5  # Keep 5 s of frames for rewind and catch-up
+ *   kinect-bridge --trace 10   # Record trace events 10% of the time
+ *   kill -USR1 <pid>           # Write them to kinect-bridge-trace.json
  */
 
 #include "kinect_xr/bridge_server.h"
 #include "kinect_xr/device.h"
+#include "kinect_xr/trace_event.h"
 
+#include <algorithm>
+#include <atomic>
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <string>
 
 namespace {
 kinect_xr::BridgeServer* g_server = nullptr;
+std::atomic<bool> g_dumpTrace{false};
 
 // ANSI color codes
 const char* RED = "\033[1;31m";
@@ -34,6 +49,11 @@ void signalHandler(int signal) {
     }
 }
 
+// Files are written from the main loop, not the handler
+void traceSignalHandler(int) {
+    g_dumpTrace = true;
+}
+
 void printUsage(const char* progName) {
     std::cout << "Kinect XR WebSocket Bridge Server\n"
               << "\n"
@@ -42,6 +62,35 @@ void printUsage(const char* progName) {
               << "Options:\n"
               << "  --mock       Use mock data (no Kinect required)\n"
               << "  --port PORT  Listen on PORT (default: 8765)\n"
+              << "  --transport ix|epoll\n"
+              << "               WebSocket transport (default: ix). epoll is an event\n"
+              << "               reactor (kqueue on macOS) built for many viewers\n"
+              << "               and also serves HTTP snapshots on the same port\n"
+              << "  --io-threads N\n"
+              << "               Reactor I/O threads (default: 2, epoll only)\n"
+              << "  --shm NAME   Also publish frames to POSIX shared memory NAME\n"
+              << "               (e.g. /kinect-xr) for same-host consumers\n"
+              << "  --unix PATH  Also accept local clients on Unix socket PATH\n"
+              << "               (large frames are passed as memfds)\n"
+              << "  --multicast GROUP:PORT\n"
+              << "               Also send frames to a UDP multicast group\n"
+              << "  --multicast-if ADDR\n"
+              << "               Local interface address for multicast (e.g. 127.0.0.1)\n"
+              << "  --multicast-ttl N\n"
+              << "               Multicast hop limit (default: 1, local segment)\n"
+              << "  --fec N      One XOR parity datagram per N fragments (default: off)\n"
+              << "  --relay URL  Re-serve an upstream bridge (ws://host:port/path)\n"
+              << "               instead of a local Kinect\n"
+              << "  --history SECONDS\n"
+              << "               Keep compressed frame history for rewind and catch-up\n"
+              << "  --send-deadline MS\n"
+              << "               Drop depth and RGB frames queued longer than MS for a\n"
+              << "               slow client (default: 100, 0 never drops; epoll/unix)\n"
+              << "  --trace [N]  Record trace events, one 100 ms slice in every N\n"
+              << "               (default: 1, always). SIGUSR1 or GET /trace dumps them\n"
+              << "  --trace-file PATH\n"
+              << "               Where SIGUSR1 and shutdown write the trace\n"
+              << "               (default: kinect-bridge-trace.json)\n"
               << "  --help       Show this help\n"
               << "\n"
               << "Note: Kinect mode requires elevated privileges on macOS.\n"
@@ -72,6 +121,17 @@ void printDeviceError(const char* message, const char* suggestion = nullptr) {
 int main(int argc, char* argv[]) {
     int port = 8765;
     bool mockMode = false;
+    kinect_xr::TransportKind transport = kinect_xr::TransportKind::IXWebSocket;
+    int ioThreads = 2;
+    std::string shmName;
+    std::string unixPath;
+    kinect_xr::MulticastConfig multicast;
+    bool multicastEnabled = false;
+    std::string relayUrl;
+    double historySeconds = 0.0;
+    kinect_xr::SendDeadlines sendDeadlines;
+    uint32_t traceSampleEvery = 0;
+    std::string traceFile = "kinect-bridge-trace.json";
 
     // Parse arguments
     for (int i = 1; i < argc; i++) {
@@ -79,6 +139,54 @@ int main(int argc, char* argv[]) {
             mockMode = true;
         } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
             port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--transport") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "ix") == 0) {
+                transport = kinect_xr::TransportKind::IXWebSocket;
+            } else if (std::strcmp(name, "epoll") == 0) {
+                transport = kinect_xr::TransportKind::Reactor;
+            } else {
+                std::cerr << "Unknown transport: " << name << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--io-threads") == 0 && i + 1 < argc) {
+            ioThreads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shmName = argv[++i];
+        } else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--multicast") == 0 && i + 1 < argc) {
+            std::string target = argv[++i];
+            size_t colon = target.rfind(':');
+            if (colon == std::string::npos) {
+                std::cerr << "Expected GROUP:PORT for --multicast, got " << target << std::endl;
+                return 1;
+            }
+            multicast.group = target.substr(0, colon);
+            multicast.port = std::atoi(target.c_str() + colon + 1);
+            multicastEnabled = true;
+        } else if (std::strcmp(argv[i], "--multicast-if") == 0 && i + 1 < argc) {
+            multicast.interfaceAddr = argv[++i];
+        } else if (std::strcmp(argv[i], "--multicast-ttl") == 0 && i + 1 < argc) {
+            multicast.ttl = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fec") == 0 && i + 1 < argc) {
+            multicast.fecGroup = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--relay") == 0 && i + 1 < argc) {
+            relayUrl = argv[++i];
+        } else if (std::strcmp(argv[i], "--history") == 0 && i + 1 < argc) {
+            historySeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--send-deadline") == 0 && i + 1 < argc) {
+            uint32_t deadlineMs = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+            sendDeadlines.ms[static_cast<size_t>(kinect_xr::SendPriority::Depth)] = deadlineMs;
+            sendDeadlines.ms[static_cast<size_t>(kinect_xr::SendPriority::Video)] = deadlineMs;
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            traceSampleEvery = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                traceSampleEvery = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            }
+        } else if (std::strcmp(argv[i], "--trace-file") == 0 && i + 1 < argc) {
+            traceFile = argv[++i];
         } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -94,16 +202,39 @@ int main(int argc, char* argv[]) {
 
     // Create bridge server
     kinect_xr::BridgeServer server;
+    server.setTransport(transport, ioThreads);
+    server.setSharedMemory(shmName);
+    server.setUnixSocket(unixPath);
+    server.setHistory(historySeconds);
+    server.setSendDeadlines(sendDeadlines);
+    if (multicastEnabled) {
+        server.setMulticast(multicast);
+    }
     g_server = &server;
 
     // Set up signal handlers
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
+    std::signal(SIGUSR1, traceSignalHandler);
+
+    kinect_xr::TraceRecorder& tracer = kinect_xr::TraceRecorder::instance();
+    tracer.setProcessName("kinect-bridge");
+    if (traceSampleEvery > 0) {
+        if (!KINECT_XR_TRACING) {
+            std::cerr << "Warning: built without KINECT_XR_TRACING, --trace records nothing" << std::endl;
+        }
+        tracer.start(traceSampleEvery);
+        std::cout << "Tracing: one slice in " << traceSampleEvery << ", SIGUSR1 writes " << traceFile
+                  << std::endl;
+    }
 
     // Initialize Kinect if not in mock mode
     std::unique_ptr<kinect_xr::KinectDevice> kinect;
 
-    if (mockMode) {
+    if (!relayUrl.empty()) {
+        std::cout << "Mode: Relay from " << relayUrl << std::endl;
+        server.setRelay(relayUrl);
+    } else if (mockMode) {
         std::cout << "Mode: Mock data (no Kinect)" << std::endl;
         server.setMockMode(true);
     } else {
@@ -160,6 +291,12 @@ int main(int argc, char* argv[]) {
     // (Stats are now printed automatically by broadcast loop every 10s)
     while (server.isRunning()) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (g_dumpTrace.exchange(false) && tracer.dump(traceFile)) {
+            std::cout << "Wrote " << tracer.eventCount() << " trace events to " << traceFile << std::endl;
+        }
+    }
+    if (traceSampleEvery > 0 && tracer.dump(traceFile)) {
+        std::cout << "Wrote trace to " << traceFile << std::endl;
     }
 
     // Cleanup (streams are stopped automatically when server stops)
@@ -0,0 +1,197 @@
+/**
+ * @file metrics.cpp
+ * @brief Metrics registry and Prometheus/JSON export
+ */
+
+#include "kinect_xr/metrics.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace kinect_xr {
+
+namespace {
+// Histogram bucket bounds: 2^6 .. 2^24 us (64 us .. 16.8 s)
+constexpr int FIRST_BOUND_SHIFT = 6;
+constexpr int LAST_BOUND_SHIFT = 24;
+
+const char* typeName(MetricType type) {
+    switch (type) {
+        case MetricType::Counter:
+            return "counter";
+        case MetricType::Gauge:
+            return "gauge";
+        case MetricType::Histogram:
+        default:
+            return "histogram";
+    }
+}
+
+std::string formatNumber(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char buffer[32];
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+    return buffer;
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// {a="1",b="2"} with an optional extra label (histogram "le")
+std::string labelText(const MetricLabels& labels, const char* extraName = nullptr,
+                      const std::string& extraValue = {}) {
+    if (labels.empty() && !extraName) {
+        return {};
+    }
+    std::string out = "{";
+    for (const auto& [name, value] : labels) {
+        if (out.size() > 1) out += ',';
+        out += name + "=\"" + escapeLabel(value) + "\"";
+    }
+    if (extraName) {
+        if (out.size() > 1) out += ',';
+        out += std::string(extraName) + "=\"" + extraValue + "\"";
+    }
+    return out + "}";
+}
+}  // namespace
+
+double MetricsRegistry::Series::value() const {
+    if (sample) return sample();
+    if (counter) return static_cast<double>(counter->value());
+    if (gauge) return gauge->value();
+    return 0.0;
+}
+
+MetricsRegistry::Series& MetricsRegistry::add(MetricType type, const std::string& name, const std::string& help,
+                                              MetricLabels labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family* family = nullptr;
+    for (auto& existing : families_) {
+        if (existing->name == name) {
+            family = existing.get();
+            break;
+        }
+    }
+    if (!family) {
+        families_.push_back(std::make_unique<Family>(Family{name, help, type, {}}));
+        family = families_.back().get();
+    } else if (family->type != type) {
+        std::cerr << "Metric " << name << " registered as both " << typeName(family->type) << " and "
+                  << typeName(type) << std::endl;
+    }
+    family->series.push_back(std::make_unique<Series>());
+    family->series.back()->labels = std::move(labels);
+    return *family->series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, MetricLabels labels) {
+    Series& series = add(MetricType::Counter, name, help, std::move(labels));
+    series.counter = std::make_unique<Counter>();
+    return *series.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, MetricLabels labels) {
+    Series& series = add(MetricType::Gauge, name, help, std::move(labels));
+    series.gauge = std::make_unique<Gauge>();
+    return *series.gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             MetricLabels labels) {
+    Series& series = add(MetricType::Histogram, name, help, std::move(labels));
+    series.histogram = std::make_unique<LatencyHistogram>();
+    return *series.histogram;
+}
+
+void MetricsRegistry::sampled(MetricType type, const std::string& name, const std::string& help,
+                              MetricLabels labels, std::function<double()> sample) {
+    add(type, name, help, std::move(labels)).sample = std::move(sample);
+}
+
+void MetricsRegistry::histogramView(const std::string& name, const std::string& help, MetricLabels labels,
+                                    const LatencyHistogram& histogram) {
+    add(MetricType::Histogram, name, help, std::move(labels)).view = &histogram;
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    for (const auto& family : families_) {
+        out << "# HELP " << family->name << ' ' << family->help << '\n';
+        out << "# TYPE " << family->name << ' ' << typeName(family->type) << '\n';
+        for (const auto& series : family->series) {
+            const LatencyHistogram* histogram = series->histogramOf();
+            if (!histogram) {
+                out << family->name << labelText(series->labels) << ' ' << formatNumber(series->value()) << '\n';
+                continue;
+            }
+            // Read the total first so the cumulative buckets never exceed it
+            uint64_t count = histogram->count();
+            for (int shift = FIRST_BOUND_SHIFT; shift <= LAST_BOUND_SHIFT; shift++) {
+                uint64_t boundUs = uint64_t{1} << shift;
+                out << family->name << "_bucket"
+                    << labelText(series->labels, "le", formatNumber(static_cast<double>(boundUs) / 1e6)) << ' '
+                    << std::min(count, histogram->countAtOrBelow(boundUs)) << '\n';
+            }
+            out << family->name << "_bucket" << labelText(series->labels, "le", "+Inf") << ' ' << count << '\n';
+            out << family->name << "_sum" << labelText(series->labels) << ' '
+                << formatNumber(static_cast<double>(histogram->sumUs()) / 1e6) << '\n';
+            out << family->name << "_count" << labelText(series->labels) << ' ' << count << '\n';
+        }
+    }
+    return out.str();
+}
+
+nlohmann::json MetricsRegistry::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json out = nlohmann::json::object();
+    for (const auto& family : families_) {
+        nlohmann::json series = nlohmann::json::array();
+        for (const auto& entry : family->series) {
+            nlohmann::json labels = nlohmann::json::object();
+            for (const auto& [name, value] : entry->labels) {
+                labels[name] = value;
+            }
+            nlohmann::json item = {{"labels", labels}};
+            if (const LatencyHistogram* histogram = entry->histogramOf()) {
+                LatencySummary summary = histogram->summary();
+                item["count"] = summary.count;
+                item["mean_us"] = summary.meanUs;
+                item["p50_us"] = summary.p50Us;
+                item["p90_us"] = summary.p90Us;
+                item["p99_us"] = summary.p99Us;
+                item["max_us"] = summary.maxUs;
+            } else {
+                item["value"] = entry->value();
+            }
+            series.push_back(std::move(item));
+        }
+        out[family->name] = std::move(series);
+    }
+    return out;
+}
+
+}  // namespace kinect_xr
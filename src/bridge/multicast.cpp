@@ -0,0 +1,532 @@
+/**
+ * @file multicast.cpp
+ * @brief UDP multicast sender, reassembler and receiver
+ */
+
+#include "kinect_xr/multicast.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace kinect_xr {
+
+namespace {
+
+constexpr uint8_t KIND_DATA = 0;
+constexpr uint8_t KIND_PARITY = 1;
+constexpr int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr size_t MAX_DATAGRAM_SIZE = 65507;
+constexpr uint32_t MAX_FRAME_SIZE = 64 << 20;
+
+struct FragmentHeader {
+    uint8_t kind;
+    uint32_t frameId;
+    uint32_t sequence;
+    uint16_t streamType;
+    uint16_t flags;
+    uint32_t frameSize;
+    uint32_t offset;
+    uint16_t fragmentSize;
+    uint8_t fecGroup;
+};
+
+void put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+uint16_t get16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void writeHeader(uint8_t* p, const FragmentHeader& h) {
+    put16(p, MULTICAST_MAGIC);
+    p[2] = MULTICAST_VERSION;
+    p[3] = h.kind;
+    put32(p + 4, h.frameId);
+    put32(p + 8, h.sequence);
+    put16(p + 12, h.streamType);
+    put16(p + 14, h.flags);
+    put32(p + 16, h.frameSize);
+    put32(p + 20, h.offset);
+    put16(p + 24, h.fragmentSize);
+    p[26] = h.fecGroup;
+    p[27] = 0;
+}
+
+bool readHeader(const uint8_t* p, size_t size, FragmentHeader& h) {
+    if (size < MULTICAST_HEADER_SIZE || get16(p) != MULTICAST_MAGIC ||
+        p[2] != MULTICAST_VERSION) {
+        return false;
+    }
+    h.kind = p[3];
+    h.frameId = get32(p + 4);
+    h.sequence = get32(p + 8);
+    h.streamType = get16(p + 12);
+    h.flags = get16(p + 14);
+    h.frameSize = get32(p + 16);
+    h.offset = get32(p + 20);
+    h.fragmentSize = get16(p + 24);
+    h.fecGroup = p[26];
+    return h.fragmentSize > 0 && h.frameSize <= MAX_FRAME_SIZE &&
+           (h.kind == KIND_DATA || h.kind == KIND_PARITY);
+}
+
+// Serial-number comparison so sequence wrap-around keeps ordering
+bool seqBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+bool parseGroup(const std::string& text, in_addr& addr) {
+    return inet_pton(AF_INET, text.c_str(), &addr) == 1;
+}
+
+}  // namespace
+
+// ============================================================================
+// Fragmentation
+// ============================================================================
+
+size_t fragmentFrame(const MulticastConfig& config, uint16_t streamType, uint32_t frameId,
+                     uint32_t sequence, const uint8_t* data, size_t size, uint16_t flags,
+                     const std::function<void(const uint8_t*, size_t)>& emit) {
+    if (config.datagramSize <= MULTICAST_HEADER_SIZE || config.datagramSize > MAX_DATAGRAM_SIZE ||
+        config.fecGroup < 0 || config.fecGroup > 255 || size > UINT32_MAX) {
+        return 0;
+    }
+
+    const size_t fragmentSize = config.datagramSize - MULTICAST_HEADER_SIZE;
+    const size_t fecGroup = static_cast<size_t>(config.fecGroup);
+    const size_t fragmentCount = std::max<size_t>(1, (size + fragmentSize - 1) / fragmentSize);
+
+    FragmentHeader header{};
+    header.frameId = frameId;
+    header.sequence = sequence;
+    header.streamType = streamType;
+    header.flags = flags;
+    header.frameSize = static_cast<uint32_t>(size);
+    header.fragmentSize = static_cast<uint16_t>(fragmentSize);
+    header.fecGroup = static_cast<uint8_t>(fecGroup);
+
+    std::vector<uint8_t> datagram(config.datagramSize);
+    std::vector<uint8_t> parity(fecGroup > 0 ? config.datagramSize : 0);
+    size_t emitted = 0;
+
+    for (size_t index = 0; index < fragmentCount; index++) {
+        size_t offset = index * fragmentSize;
+        size_t length = std::min(fragmentSize, size - offset);
+
+        header.kind = KIND_DATA;
+        header.offset = static_cast<uint32_t>(offset);
+        writeHeader(datagram.data(), header);
+        if (length > 0) {
+            std::memcpy(datagram.data() + MULTICAST_HEADER_SIZE, data + offset, length);
+        }
+        emit(datagram.data(), MULTICAST_HEADER_SIZE + length);
+        emitted++;
+
+        if (fecGroup == 0) {
+            continue;
+        }
+
+        uint8_t* p = parity.data() + MULTICAST_HEADER_SIZE;
+        if (index % fecGroup == 0) {
+            std::memset(p, 0, fragmentSize);
+        }
+        for (size_t i = 0; i < length; i++) {
+            p[i] ^= data[offset + i];
+        }
+
+        if (index % fecGroup == fecGroup - 1 || index == fragmentCount - 1) {
+            header.kind = KIND_PARITY;
+            header.offset = static_cast<uint32_t>((index - index % fecGroup) * fragmentSize);
+            writeHeader(parity.data(), header);
+            emit(parity.data(), parity.size());
+            emitted++;
+        }
+    }
+    return emitted;
+}
+
+// ============================================================================
+// MulticastSender
+// ============================================================================
+
+MulticastSender::~MulticastSender() {
+    close();
+}
+
+bool MulticastSender::open(const MulticastConfig& config) {
+    close();
+
+    in_addr group{};
+    if (!parseGroup(config.group, group) || !IN_MULTICAST(ntohl(group.s_addr))) {
+        std::cerr << "Invalid multicast group: " << config.group << std::endl;
+        return false;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create multicast socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    unsigned char ttl = static_cast<unsigned char>(config.ttl);
+    unsigned char loop = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+
+    if (!config.interfaceAddr.empty()) {
+        in_addr iface{};
+        if (!parseGroup(config.interfaceAddr, iface) ||
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0) {
+            std::cerr << "Invalid multicast interface: " << config.interfaceAddr << std::endl;
+            ::close(fd);
+            return false;
+        }
+    }
+
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(static_cast<uint16_t>(config.port));
+    dest.sin_addr = group;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) != 0) {
+        std::cerr << "Failed to address multicast group: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    config_ = config;
+    sequences_.clear();
+    return true;
+}
+
+void MulticastSender::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool MulticastSender::send(uint16_t streamType, uint32_t frameId, const uint8_t* data,
+                           size_t size, uint16_t flags) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    bool ok = true;
+    uint32_t sequence = sequences_[streamType]++;
+    size_t count = fragmentFrame(config_, streamType, frameId, sequence, data, size, flags,
+                                 [&](const uint8_t* datagram, size_t length) {
+        ssize_t sent;
+        do {
+            sent = ::send(fd_, datagram, length, 0);
+        } while (sent < 0 && errno == EINTR);
+        if (sent == static_cast<ssize_t>(length)) {
+            datagramsSent_++;
+        } else {
+            ok = false;  // Best effort: receivers account for what is missing
+        }
+    });
+    return ok && count > 0;
+}
+
+// ============================================================================
+// FrameReassembler
+// ============================================================================
+
+void FrameReassembler::ingest(const uint8_t* datagram, size_t size) {
+    stats_.datagrams++;
+
+    FragmentHeader header{};
+    if (!readHeader(datagram, size, header)) {
+        stats_.malformed++;
+        return;
+    }
+
+    const size_t payloadSize = size - MULTICAST_HEADER_SIZE;
+    const uint8_t* payload = datagram + MULTICAST_HEADER_SIZE;
+    const size_t fragmentSize = header.fragmentSize;
+    const size_t fragmentCount =
+        std::max<size_t>(1, (header.frameSize + fragmentSize - 1) / fragmentSize);
+
+    if (header.offset % fragmentSize != 0 || header.offset / fragmentSize >= fragmentCount) {
+        stats_.malformed++;
+        return;
+    }
+    const size_t index = header.offset / fragmentSize;
+
+    StreamState& stream = streams_[header.streamType];
+    if (stream.delivered && !seqBefore(stream.lastDelivered, header.sequence)) {
+        return;  // Late fragment of a frame that was delivered or given up on
+    }
+
+    auto it = stream.pending.find(header.sequence);
+    if (it == stream.pending.end()) {
+        Pending pending;
+        pending.frame.streamType = header.streamType;
+        pending.frame.flags = header.flags;
+        pending.frame.frameId = header.frameId;
+        pending.frame.sequence = header.sequence;
+        pending.frame.data.resize(header.frameSize);
+        pending.frameSize = header.frameSize;
+        pending.fragmentSize = header.fragmentSize;
+        pending.fecGroup = header.fecGroup;
+        pending.fragmentCount = fragmentCount;
+        pending.have.assign(fragmentCount, false);
+        it = stream.pending.emplace(header.sequence, std::move(pending)).first;
+
+        // Bound memory: give up on the oldest incomplete frames
+        while (stream.pending.size() > maxPending_) {
+            auto oldest = std::min_element(stream.pending.begin(), stream.pending.end(),
+                [](const auto& a, const auto& b) { return seqBefore(a.first, b.first); });
+            stats_.fragmentsLost += oldest->second.fragmentCount - oldest->second.received;
+            stream.pending.erase(oldest);
+        }
+        it = stream.pending.find(header.sequence);
+        if (it == stream.pending.end()) {
+            return;  // The new frame itself was the oldest
+        }
+    }
+
+    Pending& pending = it->second;
+    if (pending.frameSize != header.frameSize || pending.fragmentSize != header.fragmentSize) {
+        stats_.malformed++;
+        return;
+    }
+
+    size_t group = pending.fecGroup > 0 ? index / pending.fecGroup : 0;
+    if (header.kind == KIND_PARITY) {
+        if (pending.fecGroup == 0 || payloadSize != fragmentSize ||
+            index % pending.fecGroup != 0) {
+            stats_.malformed++;
+            return;
+        }
+        pending.parity[group].assign(payload, payload + payloadSize);
+    } else {
+        size_t expected = std::min<size_t>(fragmentSize, pending.frameSize - header.offset);
+        if (payloadSize != expected) {
+            stats_.malformed++;
+            return;
+        }
+        if (pending.have[index]) {
+            return;  // Duplicate
+        }
+        if (expected > 0) {
+            std::memcpy(pending.frame.data.data() + header.offset, payload, expected);
+        }
+        pending.have[index] = true;
+        pending.received++;
+    }
+
+    if (pending.fecGroup > 0 && pending.received < pending.fragmentCount) {
+        tryRecover(pending, group);
+    }
+    if (pending.received == pending.fragmentCount) {
+        complete(stream, header.sequence);
+    }
+}
+
+void FrameReassembler::tryRecover(Pending& pending, size_t group) {
+    auto parity = pending.parity.find(group);
+    if (parity == pending.parity.end()) {
+        return;
+    }
+
+    size_t first = group * pending.fecGroup;
+    size_t last = std::min(first + pending.fecGroup, pending.fragmentCount);
+    size_t missing = last;
+    for (size_t i = first; i < last; i++) {
+        if (!pending.have[i]) {
+            if (missing != last) {
+                return;  // XOR parity repairs at most one loss per group
+            }
+            missing = i;
+        }
+    }
+    if (missing == last) {
+        return;
+    }
+
+    // Missing fragment = parity XOR every other fragment in the group
+    std::vector<uint8_t> rebuilt = parity->second;
+    for (size_t i = first; i < last; i++) {
+        if (i == missing) {
+            continue;
+        }
+        size_t offset = i * pending.fragmentSize;
+        size_t length = std::min<size_t>(pending.fragmentSize, pending.frameSize - offset);
+        const uint8_t* src = pending.frame.data.data() + offset;
+        for (size_t b = 0; b < length; b++) {
+            rebuilt[b] ^= src[b];
+        }
+    }
+
+    size_t offset = missing * pending.fragmentSize;
+    size_t length = std::min<size_t>(pending.fragmentSize, pending.frameSize - offset);
+    if (length > 0) {
+        std::memcpy(pending.frame.data.data() + offset, rebuilt.data(), length);
+    }
+    pending.have[missing] = true;
+    pending.received++;
+    pending.frame.repaired = true;
+    stats_.fragmentsRecovered++;
+}
+
+void FrameReassembler::complete(StreamState& stream, uint32_t sequence) {
+    auto it = stream.pending.find(sequence);
+    if (stream.delivered) {
+        stats_.framesLost += sequence - stream.lastDelivered - 1;
+    }
+    stream.delivered = true;
+    stream.lastDelivered = sequence;
+    stats_.framesCompleted++;
+
+    ready_.push_back(std::move(it->second.frame));
+    stream.pending.erase(it);
+    abandonOlderThan(stream, sequence);
+}
+
+void FrameReassembler::abandonOlderThan(StreamState& stream, uint32_t sequence) {
+    for (auto it = stream.pending.begin(); it != stream.pending.end();) {
+        if (seqBefore(it->first, sequence)) {
+            stats_.fragmentsLost += it->second.fragmentCount - it->second.received;
+            it = stream.pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool FrameReassembler::pop(MulticastFrame& frame) {
+    if (ready_.empty()) {
+        return false;
+    }
+    frame = std::move(ready_.front());
+    ready_.pop_front();
+    return true;
+}
+
+// ============================================================================
+// MulticastReceiver
+// ============================================================================
+
+MulticastReceiver::~MulticastReceiver() {
+    close();
+}
+
+bool MulticastReceiver::open(const MulticastConfig& config) {
+    close();
+
+    in_addr group{};
+    if (!parseGroup(config.group, group) || !IN_MULTICAST(ntohl(group.s_addr))) {
+        std::cerr << "Invalid multicast group: " << config.group << std::endl;
+        return false;
+    }
+    in_addr iface{};
+    iface.s_addr = htonl(INADDR_ANY);
+    if (!config.interfaceAddr.empty() && !parseGroup(config.interfaceAddr, iface)) {
+        std::cerr << "Invalid multicast interface: " << config.interfaceAddr << std::endl;
+        return false;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create multicast socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Several viewers on one host may join the same group
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config.port));
+    addr.sin_addr = group;  // Only this group's traffic
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Failed to bind multicast port " << config.port << ": "
+                  << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    ip_mreq membership{};
+    membership.imr_multiaddr = group;
+    membership.imr_interface = iface;
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        std::cerr << "Failed to join multicast group " << config.group << ": "
+                  << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    reassembler_ = FrameReassembler();
+    buffer_.resize(MAX_DATAGRAM_SIZE);
+    return true;
+}
+
+void MulticastReceiver::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool MulticastReceiver::next(MulticastFrame& frame, int timeoutMs) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    while (!reassembler_.pop(frame)) {
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready;
+        do {
+            ready = ::poll(&pfd, 1, timeoutMs);
+        } while (ready < 0 && errno == EINTR);
+        if (ready <= 0) {
+            return false;
+        }
+
+        // Drain everything queued before going back to poll
+        for (;;) {
+            ssize_t n = ::recv(fd_, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            reassembler_.ingest(buffer_.data(), static_cast<size_t>(n));
+        }
+    }
+    return true;
+}
+
+}  // namespace kinect_xr
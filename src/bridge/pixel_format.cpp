@@ -0,0 +1,163 @@
+/**
+ * @file pixel_format.cpp
+ * @brief RGB888 to four-byte pixel conversion
+ */
+
+#include "kinect_xr/pixel_format.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <cstring>
+#include <vector>
+
+// Vector kernels where the baseline target has a byte shuffle (SSSE3 is
+// the macOS x86-64 default, NEON is always present on arm64); the portable
+// word loop handles other targets and the tail.
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace kinect_xr {
+
+namespace {
+constexpr uint32_t OPAQUE = 0xFF000000u;
+
+// Words are read and written little-endian: byte 0 is bits 0-7
+uint32_t load32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+void store32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// R | G << 8 | B << 16  ->  B | G << 8 | R << 16
+uint32_t swapRedBlue(uint32_t rgb) {
+    return ((rgb & 0xFF) << 16) | (rgb & 0xFF00) | ((rgb >> 16) & 0xFF);
+}
+
+template <bool Bgra>
+void convert(const uint8_t* rgb, size_t count, uint8_t* out) {
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    // Sixteen pixels per iteration: each output register is four pixels
+    // (twelve input bytes) spread out by one byte shuffle
+    const __m128i spread = Bgra ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                                : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(OPAQUE));
+    for (; i + 16 <= count; i += 16, rgb += 48, out += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 32));
+        __m128i p0 = a;
+        __m128i p1 = _mm_alignr_epi8(b, a, 12);
+        __m128i p2 = _mm_alignr_epi8(c, b, 8);
+        __m128i p3 = _mm_srli_si128(c, 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(_mm_shuffle_epi8(p0, spread), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_or_si128(_mm_shuffle_epi8(p1, spread), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_or_si128(_mm_shuffle_epi8(p2, spread), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_or_si128(_mm_shuffle_epi8(p3, spread), alpha));
+    }
+#elif defined(__ARM_NEON)
+    // Sixteen pixels per iteration: de-interleave into planes, re-interleave with alpha
+    for (; i + 16 <= count; i += 16, rgb += 48, out += 64) {
+        uint8x16x3_t in = vld3q_u8(rgb);
+        uint8x16x4_t px;
+        px.val[0] = Bgra ? in.val[2] : in.val[0];
+        px.val[1] = in.val[1];
+        px.val[2] = Bgra ? in.val[0] : in.val[2];
+        px.val[3] = vdupq_n_u8(255);
+        vst4q_u8(out, px);
+    }
+#endif
+
+    // Four pixels are exactly three input words:
+    //   w0 = R0 G0 B0 R1   w1 = G1 B1 R2 G2   w2 = B2 R3 G3 B3
+    for (; i + 4 <= count; i += 4, rgb += 12, out += 16) {
+        uint32_t w0 = load32(rgb);
+        uint32_t w1 = load32(rgb + 4);
+        uint32_t w2 = load32(rgb + 8);
+        uint32_t p0 = w0 & 0xFFFFFF;
+        uint32_t p1 = ((w0 >> 24) | (w1 << 8)) & 0xFFFFFF;
+        uint32_t p2 = ((w1 >> 16) | (w2 << 16)) & 0xFFFFFF;
+        uint32_t p3 = w2 >> 8;
+        if (Bgra) {
+            p0 = swapRedBlue(p0);
+            p1 = swapRedBlue(p1);
+            p2 = swapRedBlue(p2);
+            p3 = swapRedBlue(p3);
+        }
+        store32(out, p0 | OPAQUE);
+        store32(out + 4, p1 | OPAQUE);
+        store32(out + 8, p2 | OPAQUE);
+        store32(out + 12, p3 | OPAQUE);
+    }
+
+    for (; i < count; i++, rgb += 3, out += 4) {
+        out[0] = Bgra ? rgb[2] : rgb[0];
+        out[1] = rgb[1];
+        out[2] = Bgra ? rgb[0] : rgb[2];
+        out[3] = 255;
+    }
+}
+}  // namespace
+
+const char* pixelFormatName(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::Rgba8888:
+            return "RGBA8888";
+        case PixelFormat::Bgra8888:
+            return "BGRA8888";
+        case PixelFormat::Rgb888:
+        default:
+            return "RGB888";
+    }
+}
+
+bool parsePixelFormat(const std::string& name, PixelFormat& format) {
+    for (PixelFormat candidate : {PixelFormat::Rgb888, PixelFormat::Rgba8888, PixelFormat::Bgra8888}) {
+        if (name == pixelFormatName(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void convertRgbPixels(const uint8_t* rgb, size_t count, PixelFormat format, uint8_t* out) {
+    if (format == PixelFormat::Bgra8888) {
+        convert<true>(rgb, count, out);
+    } else {
+        convert<false>(rgb, count, out);
+    }
+}
+
+SharedFrame convertRgbFrame(const SharedFrame& frame, PixelFormat format) {
+    if (!frame || format == PixelFormat::Rgb888 || frame->payloadSize() < FRAME_HEADER_SIZE) {
+        return nullptr;
+    }
+    const uint8_t* header = frame->payload();
+    uint16_t streamType = static_cast<uint16_t>(header[4] | (header[5] << 8));
+    uint16_t flags = static_cast<uint16_t>(header[6] | (header[7] << 8));
+    size_t size = frame->payloadSize() - FRAME_HEADER_SIZE;
+    if (streamType != STREAM_TYPE_RGB || size % 3 != 0 || (flags & FRAME_FLAG_PIXEL_FORMAT_MASK)) {
+        return nullptr;
+    }
+
+    size_t count = size / 3;
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + count * 4);
+    std::memcpy(payload.data(), header, FRAME_HEADER_SIZE);
+    flags = static_cast<uint16_t>(flags | (static_cast<uint16_t>(format) << FRAME_FLAG_PIXEL_FORMAT_SHIFT));
+    payload[6] = static_cast<uint8_t>(flags);
+    payload[7] = static_cast<uint8_t>(flags >> 8);
+    convertRgbPixels(header + FRAME_HEADER_SIZE, count, format, payload.data() + FRAME_HEADER_SIZE);
+    return FramedMessage::binary(std::move(payload));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,167 @@
+/**
+ * @file point_cloud.cpp
+ * @brief Point-cloud frame encoding
+ */
+
+#include "kinect_xr/point_cloud.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace kinect_xr {
+
+namespace {
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t value) {
+    writeLe16(out, static_cast<uint16_t>(value));
+    writeLe16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+// |x| and |y| stay below z inside the field of view, so they fit when z does
+uint16_t toMillimetres(float value) {
+    return static_cast<uint16_t>(static_cast<int16_t>(std::lround(value)));
+}
+}  // namespace
+
+size_t PointCloudParams::maxPayloadBytes() const {
+    size_t points = static_cast<size_t>(FRAME_WIDTH / decimation) * (FRAME_HEIGHT / decimation);
+    return FRAME_HEADER_SIZE + POINT_CLOUD_HEADER_SIZE + points * (6 + (color ? 3 : 0));
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;  // Below the smallest subnormal
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) {
+        half++;  // A carry into the exponent is still the correctly rounded value
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    float value;
+    if (exponent == 0) {
+        value = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        value = mantissa ? NAN : INFINITY;
+    } else {
+        value = std::ldexp(static_cast<float>(mantissa | 0x400), static_cast<int>(exponent) - 25);
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits |= sign;
+    std::memcpy(&value, &bits, sizeof(bits));
+    return value;
+}
+
+SharedFrame encodePointCloud(uint32_t frameId, const uint8_t* depth, const uint8_t* rgb,
+                             const DepthIntrinsics& intrinsics, const PointCloudParams& params) {
+    const uint32_t step = isValidDecimation(params.decimation) ? params.decimation : 1;
+    const uint16_t minMm = std::max<uint16_t>(params.minDepthMm, 1);
+    const bool half = params.format == PointFormat::Float16Metres;
+    uint16_t maxMm = params.maxDepthMm ? params.maxDepthMm : 0xFFFF;
+    if (!half) {
+        maxMm = std::min<uint16_t>(maxMm, 0x7FFF);  // int16 range
+    }
+    const bool color = params.color && rgb;
+
+    // Per-column and per-row projection factors, so each point costs two multiplies
+    std::vector<float> xFactor(FRAME_WIDTH / step);
+    std::vector<float> yFactor(FRAME_HEIGHT / step);
+    for (size_t i = 0; i < xFactor.size(); i++) {
+        xFactor[i] = (static_cast<float>(i * step) - intrinsics.cx) / intrinsics.fx;
+    }
+    for (size_t i = 0; i < yFactor.size(); i++) {
+        yFactor[i] = -(static_cast<float>(i * step) - intrinsics.cy) / intrinsics.fy;
+    }
+
+    auto sampleAt = [depth](size_t pixel) {
+        return static_cast<uint16_t>(depth[pixel * 2] | (depth[pixel * 2 + 1] << 8));
+    };
+
+    // Count first so positions and colors land in one exactly sized buffer
+    uint32_t count = 0;
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v += step) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u += step) {
+            uint16_t mm = sampleAt(static_cast<size_t>(v) * FRAME_WIDTH + u);
+            if (mm >= minMm && mm <= maxMm) {
+                count++;
+            }
+        }
+    }
+
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + POINT_CLOUD_HEADER_SIZE +
+                                 static_cast<size_t>(count) * (6 + (color ? 3 : 0)));
+    uint8_t* out = payload.data();
+    writeLe32(out, frameId);
+    writeLe16(out + 4, STREAM_TYPE_POINTCLOUD);
+    writeLe16(out + 6, 0);
+    out += FRAME_HEADER_SIZE;
+    writeLe32(out, count);
+    out[4] = static_cast<uint8_t>(params.format);
+    out[5] = static_cast<uint8_t>(step);
+    out[6] = color ? POINT_CLOUD_FLAG_COLOR : 0;
+    out[7] = 0;
+
+    uint8_t* position = out + POINT_CLOUD_HEADER_SIZE;
+    uint8_t* rgbOut = position + static_cast<size_t>(count) * 6;
+
+    for (uint32_t v = 0, row = 0; v < FRAME_HEIGHT; v += step, row++) {
+        for (uint32_t u = 0, col = 0; u < FRAME_WIDTH; u += step, col++) {
+            size_t pixel = static_cast<size_t>(v) * FRAME_WIDTH + u;
+            uint16_t mm = sampleAt(pixel);
+            if (mm < minMm || mm > maxMm) {
+                continue;
+            }
+            float z = static_cast<float>(mm);
+            float x = z * xFactor[col];
+            float y = z * yFactor[row];
+            if (half) {
+                writeLe16(position, floatToHalf(x * 0.001f));
+                writeLe16(position + 2, floatToHalf(y * 0.001f));
+                writeLe16(position + 4, floatToHalf(z * 0.001f));
+            } else {
+                writeLe16(position, toMillimetres(x));
+                writeLe16(position + 2, toMillimetres(y));
+                writeLe16(position + 4, mm);
+            }
+            position += 6;
+            if (color) {
+                std::memcpy(rgbOut, rgb + pixel * 3, 3);
+                rgbOut += 3;
+            }
+        }
+    }
+    return FramedMessage::binary(std::move(payload));
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,235 @@
+/**
+ * @file rate_controller.cpp
+ * @brief Per-client throughput estimation and variant control
+ */
+
+#include "kinect_xr/rate_controller.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace kinect_xr {
+
+namespace {
+constexpr int NOMINAL_FRAME_RATE = 30;
+
+constexpr auto SAMPLE_WINDOW = std::chrono::milliseconds(100);
+constexpr double QUEUE_HIGH_MS = 150.0;  // Step down above this much queued time
+constexpr double QUEUE_LOW_MS = 30.0;    // Queue counts as drained below this
+constexpr double HEADROOM = 0.85;        // Target fraction of the estimate
+constexpr double EWMA_WEIGHT = 0.25;
+
+constexpr auto UPGRADE_HOLD = std::chrono::milliseconds(1000);  // Estimate already covers the step
+constexpr auto PROBE_HOLD = std::chrono::milliseconds(2000);    // Blind probe, doubled on failure
+constexpr auto MAX_PROBE_HOLD = std::chrono::milliseconds(30000);
+constexpr auto ROUND_TRIP_STALE = std::chrono::milliseconds(5000);  // Client stopped syncing
+
+// Clients that understand FRAME_FLAG_SCALE_MASK: trade resolution before frame rate
+constexpr DeliveryVariant DOWNSCALE_LADDER[] = {
+    {0, 1},  // 640x480@30
+    {0, 2},  // 640x480@15
+    {1, 1},  // 320x240@30
+    {1, 2},  // 320x240@15
+    {2, 2},  // 160x120@15
+    {2, 4},  // 160x120@7
+};
+
+// Everyone else keeps full-size frames and only loses frame rate
+constexpr DeliveryVariant FULL_SIZE_LADDER[] = {
+    {0, 1},
+    {0, 2},
+    {0, 4},
+    {0, 8},
+};
+
+double blend(double estimate, double sample) {
+    return estimate <= 0 ? sample : estimate * (1.0 - EWMA_WEIGHT) + sample * EWMA_WEIGHT;
+}
+}  // namespace
+
+SharedFrame downscaleFrame(const SharedFrame& frame, uint8_t scaleShift) {
+    if (!frame || frame->payloadSize() < FRAME_HEADER_SIZE) {
+        return nullptr;
+    }
+    const uint8_t* header = frame->payload();
+    const uint8_t* src = header + FRAME_HEADER_SIZE;
+    uint16_t streamType = static_cast<uint16_t>(header[4] | (header[5] << 8));
+    uint16_t flags = static_cast<uint16_t>(header[6] | (header[7] << 8));
+    size_t size = frame->payloadSize() - FRAME_HEADER_SIZE;
+
+    const bool rgb = streamType == STREAM_TYPE_RGB && size == RGB_FRAME_SIZE;
+    const bool depth = streamType == STREAM_TYPE_DEPTH && size == DEPTH_FRAME_SIZE;
+    if ((!rgb && !depth) || (flags & FRAME_FLAG_SCALE_MASK)) {
+        return nullptr;
+    }
+
+    const uint32_t block = 1u << scaleShift;
+    const uint32_t width = FRAME_WIDTH >> scaleShift;
+    const uint32_t height = FRAME_HEIGHT >> scaleShift;
+    const size_t pixelSize = rgb ? 3 : 2;
+
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + static_cast<size_t>(width) * height * pixelSize);
+    std::memcpy(payload.data(), header, FRAME_HEADER_SIZE);
+    flags = static_cast<uint16_t>(flags | (scaleShift << FRAME_FLAG_SCALE_SHIFT));
+    payload[6] = static_cast<uint8_t>(flags);
+    payload[7] = static_cast<uint8_t>(flags >> 8);
+    uint8_t* dst = payload.data() + FRAME_HEADER_SIZE;
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            if (rgb) {
+                uint32_t sum[3] = {0, 0, 0};
+                for (uint32_t by = 0; by < block; by++) {
+                    const uint8_t* row = src + ((y * block + by) * FRAME_WIDTH + x * block) * 3;
+                    for (uint32_t bx = 0; bx < block * 3; bx += 3) {
+                        sum[0] += row[bx];
+                        sum[1] += row[bx + 1];
+                        sum[2] += row[bx + 2];
+                    }
+                }
+                for (int c = 0; c < 3; c++) {
+                    *dst++ = static_cast<uint8_t>(sum[c] >> (2 * scaleShift));
+                }
+            } else {
+                uint8_t lo = 0;
+                uint8_t hi = 0;
+                for (uint32_t by = 0; by < block && !(lo | hi); by++) {
+                    const uint8_t* row = src + ((y * block + by) * FRAME_WIDTH + x * block) * 2;
+                    for (uint32_t bx = 0; bx < block * 2 && !(lo | hi); bx += 2) {
+                        lo = row[bx];
+                        hi = row[bx + 1];
+                    }
+                }
+                *dst++ = lo;
+                *dst++ = hi;
+            }
+        }
+    }
+    return FramedMessage::binary(std::move(payload));
+}
+
+std::string DeliveryVariant::name() const {
+    return std::to_string(FRAME_WIDTH >> scaleShift) + "x" + std::to_string(FRAME_HEIGHT >> scaleShift) +
+           "@" + std::to_string(NOMINAL_FRAME_RATE / frameDivider);
+}
+
+const DeliveryVariant* deliveryLadder(bool downscale, size_t& count) {
+    if (downscale) {
+        count = sizeof(DOWNSCALE_LADDER) / sizeof(DOWNSCALE_LADDER[0]);
+        return DOWNSCALE_LADDER;
+    }
+    count = sizeof(FULL_SIZE_LADDER) / sizeof(FULL_SIZE_LADDER[0]);
+    return FULL_SIZE_LADDER;
+}
+
+RateController::RateController() : probeHold_(PROBE_HOLD) {}
+
+DeliveryVariant RateController::variant() const {
+    size_t count = 0;
+    const DeliveryVariant* ladder = deliveryLadder(downscale_.load(), count);
+    return ladder[std::min(index_.load(), count - 1)];
+}
+
+void RateController::select(size_t index, Clock::time_point now) {
+    if (index == index_.load()) {
+        return;
+    }
+    index_ = index;
+    switches_++;
+    calmSince_ = now;
+}
+
+void RateController::onRoundTrip(uint64_t smoothedRttUs, uint64_t minRttUs, Clock::time_point now) {
+    networkDelayUs_ = smoothedRttUs > minRttUs ? smoothedRttUs - minRttUs : 0;
+    roundTripAt_ = now.time_since_epoch().count();
+}
+
+void RateController::update(size_t bufferedBytes, double fullRateBytesPerSec, bool downscale,
+                            Clock::time_point now) {
+    if (downscale != downscale_.load()) {
+        // A different ladder: start again from full quality
+        downscale_ = downscale;
+        select(0, now);
+    }
+    if (bufferedBytes == 0) {
+        backloggedWindow_ = false;
+    }
+
+    if (windowStart_ == Clock::time_point{}) {
+        windowStart_ = now;
+        windowStartBuffered_ = bufferedBytes;
+        queuedSinceUpdate_ = 0;
+        calmSince_ = now;
+        return;
+    }
+    if (now - windowStart_ < SAMPLE_WINDOW) {
+        return;
+    }
+
+    // Bytes that left the queue during the window
+    double seconds = std::chrono::duration<double>(now - windowStart_).count();
+    double drained = static_cast<double>(windowStartBuffered_) + static_cast<double>(queuedSinceUpdate_) -
+                     static_cast<double>(bufferedBytes);
+    double sample = std::max(0.0, drained) / seconds;
+
+    double estimate = static_cast<double>(estimate_.load());
+    if (backloggedWindow_ && windowStartBuffered_ > 0) {
+        estimate = blend(estimate, sample);  // Link-limited: the drain rate is the link rate
+    } else if (sample > estimate) {
+        estimate = blend(estimate, sample);  // App-limited: only a lower bound
+    }
+    estimate_ = static_cast<uint64_t>(estimate);
+
+    windowStart_ = now;
+    windowStartBuffered_ = bufferedBytes;
+    queuedSinceUpdate_ = 0;
+    backloggedWindow_ = bufferedBytes > 0;
+
+    size_t count = 0;
+    const DeliveryVariant* ladder = deliveryLadder(downscale, count);
+    size_t index = std::min(index_.load(), count - 1);
+    double queueMs = estimate > 0 ? bufferedBytes * 1000.0 / estimate : (bufferedBytes ? QUEUE_HIGH_MS : 0.0);
+    double frameBytes = fullRateBytesPerSec * ladder[index].costFactor() / NOMINAL_FRAME_RATE;
+    Clock::time_point roundTripAt{Clock::duration(roundTripAt_.load())};
+    double networkMs = now - roundTripAt < ROUND_TRIP_STALE ? networkDelayUs_.load() / 1000.0 : 0.0;
+    bool networkBacklog = networkMs > QUEUE_HIGH_MS && roundTripAt > lastDowngrade_;  // One step per sample
+
+    if ((queueMs > QUEUE_HIGH_MS && bufferedBytes > frameBytes) || networkBacklog) {
+        if (index + 1 < count) {
+            // Best variant that fits the estimate, at least one step down
+            size_t target = index + 1;
+            while (target + 1 < count &&
+                   fullRateBytesPerSec * ladder[target].costFactor() > estimate * HEADROOM) {
+                target++;
+            }
+            if (lastUpgrade_ != Clock::time_point{} && now - lastUpgrade_ < probeHold_ * 2) {
+                probeHold_ = std::min(probeHold_ * 2, MAX_PROBE_HOLD);  // The probe failed
+            }
+            select(target, now);
+            lastDowngrade_ = now;
+        }
+        calmSince_ = now;
+        return;
+    }
+
+    if (queueMs > QUEUE_LOW_MS || networkMs > QUEUE_LOW_MS) {
+        calmSince_ = now;
+        return;
+    }
+
+    if (index > 0) {
+        double stepUpRate = fullRateBytesPerSec * ladder[index - 1].costFactor();
+        auto hold = estimate * HEADROOM >= stepUpRate ? UPGRADE_HOLD : probeHold_;
+        if (now - calmSince_ >= hold) {
+            if (lastDowngrade_ < lastUpgrade_) {
+                probeHold_ = PROBE_HOLD;  // The previous probe held
+            }
+            select(index - 1, now);
+            lastUpgrade_ = now;
+        }
+    }
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,1013 @@
+/**
+ * @file reactor_transport.cpp
+ * @brief Event-reactor WebSocket transport implementation
+ */
+
+#include "kinect_xr/reactor_transport.h"
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/trace_event.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace kinect_xr {
+
+namespace {
+
+constexpr size_t MAX_HTTP_REQUEST_SIZE = 8192;
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr int MAX_EVENTS = 64;
+constexpr int POLL_TIMEOUT_MS = 100;
+
+struct PollEvent {
+    int fd;
+    bool readable;
+    bool writable;
+};
+
+/**
+ * @brief Minimal readiness poller: epoll on Linux, kqueue elsewhere
+ */
+class Poller {
+public:
+    ~Poller() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool init() {
+#if defined(__linux__)
+        fd_ = epoll_create1(EPOLL_CLOEXEC);
+#else
+        fd_ = kqueue();
+#endif
+        return fd_ >= 0;
+    }
+
+    bool add(int fd) {
+#if defined(__linux__)
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        return epoll_ctl(fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#else
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        return kevent(fd_, &ev, 1, nullptr, 0, nullptr) == 0;
+#endif
+    }
+
+    void setWritable(int fd, bool enabled) {
+#if defined(__linux__)
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | (enabled ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        epoll_ctl(fd_, EPOLL_CTL_MOD, fd, &ev);
+#else
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_WRITE, enabled ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, nullptr);
+        kevent(fd_, &ev, 1, nullptr, 0, nullptr);
+#endif
+    }
+
+    void remove(int fd) {
+#if defined(__linux__)
+        epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+        // kqueue drops the filters when the descriptor is closed
+        (void)fd;
+#endif
+    }
+
+    int wait(PollEvent* out, int maxEvents, int timeoutMs) {
+#if defined(__linux__)
+        epoll_event events[MAX_EVENTS];
+        int n = epoll_wait(fd_, events, std::min(maxEvents, MAX_EVENTS), timeoutMs);
+        for (int i = 0; i < n; i++) {
+            out[i].fd = events[i].data.fd;
+            // Hang-ups and errors surface through read() returning 0 / -1
+            out[i].readable = (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+            out[i].writable = (events[i].events & EPOLLOUT) != 0;
+        }
+        return n;
+#else
+        struct kevent events[MAX_EVENTS];
+        struct timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        int n = kevent(fd_, nullptr, 0, events, std::min(maxEvents, MAX_EVENTS), &ts);
+        for (int i = 0; i < n; i++) {
+            out[i].fd = static_cast<int>(events[i].ident);
+            out[i].readable = events[i].filter == EVFILT_READ || (events[i].flags & EV_EOF);
+            out[i].writable = events[i].filter == EVFILT_WRITE;
+        }
+        return n;
+#endif
+    }
+
+private:
+    int fd_ = -1;
+};
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void configureClientSocket(int fd) {
+    setNonBlocking(fd);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    size_t end = s.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Parsed HTTP request line and headers (names lower-cased)
+ */
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::unordered_map<std::string, std::string> headers;
+
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : "";
+    }
+};
+
+bool parseHttpRequest(const std::string& text, HttpRequest& request) {
+    size_t lineEnd = text.find("\r\n");
+    if (lineEnd == std::string::npos) return false;
+
+    std::string requestLine = text.substr(0, lineEnd);
+    size_t sp1 = requestLine.find(' ');
+    size_t sp2 = requestLine.find(' ', sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) return false;
+
+    request.method = requestLine.substr(0, sp1);
+    request.path = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+
+    size_t pos = lineEnd + 2;
+    while (pos < text.size()) {
+        size_t end = text.find("\r\n", pos);
+        if (end == std::string::npos || end == pos) break;
+
+        std::string line = text.substr(pos, end - pos);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+        }
+        pos = end + 2;
+    }
+    return true;
+}
+
+SharedFrame httpResponse(const std::string& text) {
+    return FramedMessage::raw(std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+/**
+ * @brief Owned descriptor, closed when the last queued send releases it
+ */
+struct SharedFd {
+    explicit SharedFd(int descriptor) : fd(descriptor) {}
+    ~SharedFd() {
+        if (fd >= 0) ::close(fd);
+    }
+    SharedFd(const SharedFd&) = delete;
+    SharedFd& operator=(const SharedFd&) = delete;
+
+    const int fd;
+};
+
+using SharedFdPtr = std::shared_ptr<SharedFd>;
+
+/**
+ * @brief Copy a payload into a new read-only (sealed where supported) buffer fd
+ */
+int createSealedBuffer(const uint8_t* data, size_t size) {
+#if defined(__linux__)
+    int fd = memfd_create("kinect-frame", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    // No memfd: an immediately unlinked POSIX shm object behaves the same
+    static std::atomic<uint32_t> counter{0};
+    std::string name = "/kinect-xr-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) shm_unlink(name.c_str());
+#endif
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        ::close(fd);
+        return -1;
+    }
+    std::memcpy(mapped, data, size);
+    munmap(mapped, size);
+
+#if defined(__linux__)
+    // Receivers can trust the contents and size without copying
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+    return fd;
+}
+
+/**
+ * @brief Descriptor frame for a memfd-passed payload
+ *
+ * Same 8-byte bridge header with FRAME_FLAG_MEMFD set, followed by the
+ * payload size as uint64 LE.
+ */
+SharedFrame memfdDescriptor(const FramedMessage& frame) {
+    std::vector<uint8_t> descriptor(FRAME_HEADER_SIZE + sizeof(uint64_t));
+    std::memcpy(descriptor.data(), frame.payload(), FRAME_HEADER_SIZE);
+    descriptor[7] |= static_cast<uint8_t>(FRAME_FLAG_MEMFD >> 8);
+
+    uint64_t size = frame.payloadSize() - FRAME_HEADER_SIZE;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        descriptor[FRAME_HEADER_SIZE + i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+    return FramedMessage::binary(std::move(descriptor));
+}
+
+}  // namespace
+
+/**
+ * @brief Shares one memfd per broadcast frame across all local clients
+ *
+ * Keyed by the shared frame; entries expire once the frame is released.
+ */
+class MemfdCache {
+public:
+    struct Passed {
+        SharedFrame descriptor;
+        SharedFdPtr fd;
+    };
+
+    bool lookup(const SharedFrame& frame, Passed& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Drop entries whose frame has been released
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                      [](const Entry& e) { return e.source.expired(); }),
+                       entries_.end());
+
+        for (const auto& entry : entries_) {
+            if (entry.key == frame.get()) {
+                out = entry.passed;
+                return true;
+            }
+        }
+
+        int fd = createSealedBuffer(frame->payload() + FRAME_HEADER_SIZE,
+                                    frame->payloadSize() - FRAME_HEADER_SIZE);
+        if (fd < 0) {
+            return false;
+        }
+
+        Entry entry{frame.get(), frame, {memfdDescriptor(*frame), std::make_shared<SharedFd>(fd)}};
+        out = entry.passed;
+        entries_.push_back(std::move(entry));
+        return true;
+    }
+
+private:
+    struct Entry {
+        const FramedMessage* key;
+        std::weak_ptr<const FramedMessage> source;
+        Passed passed;
+    };
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+/**
+ * @brief One client socket served by a Reactor
+ *
+ * The output queue is shared with sending threads (guarded by mutex_); the
+ * read side and handshake state are only touched by the owning reactor.
+ */
+class ReactorConnection : public ClientConnection,
+                          public std::enable_shared_from_this<ReactorConnection> {
+public:
+    ReactorConnection(Reactor& reactor, int fd, bool local)
+        : reactor_(reactor), fd_(fd), local_(local), parser_(!local) {}
+
+    void sendText(const std::string& text) override {
+        sendFrame(FramedMessage::text(text));
+    }
+
+    void sendFrame(const SharedFrame& frame) override;
+
+    size_t bufferedBytes() const override { return buffered_.load(); }
+
+    void close() override;
+
+    bool isOpen() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return open_ && !closeAfterFlush_;
+    }
+
+    SendQueueStats sendStats() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.stats(std::chrono::steady_clock::now());
+    }
+
+    int fd() const { return fd_; }
+
+private:
+    friend class Reactor;
+
+    struct OutItem {
+        SharedFrame frame;
+        size_t offset;
+        SharedFdPtr passFd;  // Attached with the first byte (Unix sockets)
+    };
+
+    // Queue without marking dirty (reactor thread only)
+    void enqueueLocked(const SharedFrame& frame, SharedFdPtr passFd = nullptr) {
+        queue_.push({frame, 0, std::move(passFd)}, std::chrono::steady_clock::now());
+        buffered_ += frame->wireSize();
+    }
+
+    Reactor& reactor_;
+    const int fd_;
+    const bool local_;  // Unix socket: no handshake, memfd passing
+
+    // Reactor-thread state
+    std::string request_;
+    bool upgraded_ = false;
+    bool writeArmed_ = false;
+    WsFrameParser parser_;
+
+    // Shared state
+    mutable std::mutex mutex_;
+    SendQueue<OutItem> queue_;
+    bool open_ = true;
+    bool dirty_ = false;
+    bool closeAfterFlush_ = false;
+    bool http_ = false;  // Plain HTTP request handed to onHttp; further input is ignored
+    std::atomic<size_t> buffered_{0};
+};
+
+/**
+ * @brief One I/O thread with its own poller and connection set
+ */
+class Reactor {
+public:
+    explicit Reactor(ReactorTransport& owner) : owner_(owner) {}
+
+    ReactorTransport& owner() { return owner_; }
+
+    ~Reactor() {
+        if (wakePipe_[0] >= 0) ::close(wakePipe_[0]);
+        if (wakePipe_[1] >= 0) ::close(wakePipe_[1]);
+    }
+
+    bool init() {
+        if (!poller_.init() || pipe(wakePipe_) != 0) {
+            return false;
+        }
+        setNonBlocking(wakePipe_[0]);
+        setNonBlocking(wakePipe_[1]);
+        return poller_.add(wakePipe_[0]);
+    }
+
+    bool addListener(int fd) {
+        listenFd_ = fd;
+        return poller_.add(fd);
+    }
+
+    void start() { thread_ = std::thread(&Reactor::run, this); }
+
+    void join() {
+        wake();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    /**
+     * @brief Hand over an accepted socket (any thread)
+     */
+    void adopt(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            pendingFds_.push_back(fd);
+        }
+        wake();
+    }
+
+    /**
+     * @brief Schedule a connection for flushing (any thread)
+     */
+    void markDirty(std::shared_ptr<ReactorConnection> connection) {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            dirty_.push_back(std::move(connection));
+        }
+        wake();
+    }
+
+private:
+    void wake() {
+        // Coalesce wake-ups: one pipe write per reactor iteration
+        if (!wakePending_.exchange(true)) {
+            char byte = 1;
+            ssize_t ignored = ::write(wakePipe_[1], &byte, 1);
+            (void)ignored;
+        }
+    }
+
+    void drainWakePipe() {
+        char buffer[64];
+        while (::read(wakePipe_[0], buffer, sizeof(buffer)) > 0) {
+        }
+        wakePending_ = false;
+    }
+
+    void run() {
+        KINECT_XR_TRACE_THREAD("reactor io");
+        PollEvent events[MAX_EVENTS];
+
+        while (owner_.running_) {
+            int n = poller_.wait(events, MAX_EVENTS, POLL_TIMEOUT_MS);
+
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].fd;
+
+                if (fd == wakePipe_[0]) {
+                    drainWakePipe();
+                    continue;
+                }
+                if (fd == listenFd_) {
+                    owner_.acceptConnections();
+                    continue;
+                }
+
+                auto it = connections_.find(fd);
+                if (it == connections_.end()) {
+                    continue;
+                }
+                auto connection = it->second;
+
+                if (events[i].readable) {
+                    handleReadable(connection);
+                }
+                if (events[i].writable && connection->open_) {
+                    flush(connection);
+                }
+            }
+
+            processPending();
+        }
+
+        // Shutdown: close everything this reactor owns
+        processPending();
+        std::vector<std::shared_ptr<ReactorConnection>> remaining;
+        for (auto& [fd, connection] : connections_) {
+            remaining.push_back(connection);
+        }
+        for (auto& connection : remaining) {
+            closeConnection(connection);
+        }
+    }
+
+    void processPending() {
+        std::vector<int> fds;
+        std::vector<std::shared_ptr<ReactorConnection>> dirty;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            fds.swap(pendingFds_);
+            dirty.swap(dirty_);
+        }
+
+        bool local = !owner_.unixPath_.empty();
+        for (int fd : fds) {
+            auto connection = std::make_shared<ReactorConnection>(*this, fd, local);
+            if (!poller_.add(fd)) {
+                ::close(fd);
+                continue;
+            }
+            connections_[fd] = connection;
+
+            // Local clients are ready as soon as they connect
+            if (local) {
+                connection->upgraded_ = true;
+                if (owner_.callbacks_.onOpen) {
+                    owner_.callbacks_.onOpen(connection);
+                }
+            }
+        }
+
+        for (auto& connection : dirty) {
+            {
+                std::lock_guard<std::mutex> lock(connection->mutex_);
+                connection->dirty_ = false;
+            }
+            flush(connection);
+        }
+    }
+
+    void handleReadable(const std::shared_ptr<ReactorConnection>& connection) {
+        uint8_t buffer[READ_CHUNK_SIZE];
+
+        while (connection->open_) {
+            ssize_t n = ::read(connection->fd(), buffer, sizeof(buffer));
+            if (n == 0) {
+                closeConnection(connection);
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeConnection(connection);
+                }
+                return;
+            }
+
+            if (connection->http_) {
+                continue;
+            }
+            if (!connection->upgraded_) {
+                connection->request_.append(reinterpret_cast<char*>(buffer), n);
+                if (!handleHandshake(connection)) {
+                    return;
+                }
+            } else {
+                connection->parser_.append(buffer, static_cast<size_t>(n));
+                handleMessages(connection);
+            }
+        }
+    }
+
+    /**
+     * @return false if the connection is not (yet) upgraded
+     */
+    bool handleHandshake(const std::shared_ptr<ReactorConnection>& connection) {
+        size_t headerEnd = connection->request_.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (connection->request_.size() > MAX_HTTP_REQUEST_SIZE) {
+                closeConnection(connection);
+            }
+            return false;
+        }
+
+        HttpRequest request;
+        bool valid = parseHttpRequest(connection->request_.substr(0, headerEnd + 2), request);
+        std::string key = request.header("sec-websocket-key");
+
+        if (valid && request.method == "GET" && request.header("upgrade").empty() &&
+            owner_.callbacks_.onHttp) {
+            handleHttp(connection, request);
+            return false;
+        }
+
+        if (!valid || request.method != "GET" ||
+            toLower(request.header("upgrade")) != "websocket" || key.empty()) {
+            sendAndClose(connection, httpResponse(
+                "HTTP/1.1 400 Bad Request\r\n"
+                "Content-Length: 0\r\n"
+                "Connection: close\r\n\r\n"));
+            return false;
+        }
+
+        // Bytes after the request belong to the WebSocket stream
+        std::string leftover = connection->request_.substr(headerEnd + 4);
+        connection->request_.clear();
+        connection->request_.shrink_to_fit();
+
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            connection->enqueueLocked(httpResponse(
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + computeWsAcceptKey(key) + "\r\n\r\n"));
+        }
+        connection->upgraded_ = true;
+        flush(connection);
+
+        if (owner_.callbacks_.onOpen) {
+            owner_.callbacks_.onOpen(connection);
+        }
+
+        if (!leftover.empty()) {
+            connection->parser_.append(reinterpret_cast<const uint8_t*>(leftover.data()),
+                                       leftover.size());
+            handleMessages(connection);
+        }
+        return connection->open_;
+    }
+
+    void handleHttp(const std::shared_ptr<ReactorConnection>& connection,
+                    const HttpRequest& request) {
+        {
+            // close() reads it from sending threads to skip the WebSocket close frame
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            connection->http_ = true;
+        }
+        connection->request_.clear();
+        connection->request_.shrink_to_fit();
+
+        if (owner_.callbacks_.onHttp(connection, request.path)) {
+            return;
+        }
+        sendAndClose(connection, httpResponse(
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n\r\n"));
+    }
+
+    void handleMessages(const std::shared_ptr<ReactorConnection>& connection) {
+        KINECT_XR_TRACE_SCOPE_ARG("reactor", "handleMessages", "fd", connection->fd());
+        WsMessage message;
+        while (connection->open_ && connection->parser_.next(message)) {
+            switch (message.opcode) {
+                case WsOpcode::Text:
+                    if (owner_.callbacks_.onMessage) {
+                        owner_.callbacks_.onMessage(connection, message.payload);
+                    }
+                    break;
+                case WsOpcode::Binary:
+                    if (owner_.callbacks_.onBinary) {
+                        owner_.callbacks_.onBinary(connection,
+                                                   reinterpret_cast<const uint8_t*>(message.payload.data()),
+                                                   message.payload.size());
+                    }
+                    break;
+                case WsOpcode::Ping:
+                    connection->sendFrame(FramedMessage::control(
+                        WsOpcode::Pong,
+                        std::vector<uint8_t>(message.payload.begin(), message.payload.end())));
+                    break;
+                case WsOpcode::Close:
+                    connection->close();
+                    break;
+                default:
+                    // Pongs are not part of the protocol
+                    break;
+            }
+        }
+
+        if (connection->parser_.failed()) {
+            closeConnection(connection);
+        }
+    }
+
+    void sendAndClose(const std::shared_ptr<ReactorConnection>& connection,
+                      const SharedFrame& response) {
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            connection->enqueueLocked(response);
+            connection->closeAfterFlush_ = true;
+        }
+        flush(connection);
+    }
+
+    void flush(const std::shared_ptr<ReactorConnection>& connection) {
+        KINECT_XR_TRACE_SCOPE_ARG("reactor", "flush", "fd", connection->fd());
+        bool shouldClose = false;
+        bool wantWrite = false;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            if (!connection->open_) {
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            size_t dropped = 0;
+            while (auto* next = connection->queue_.front(now, owner_.deadlines_, dropped)) {
+                auto& item = *next;
+                ssize_t written = writeFramedMessage(connection->fd(), *item.frame, item.offset,
+                                                     item.passFd ? item.passFd->fd : -1);
+
+                if (written < 0) {
+                    shouldClose = true;
+                    break;
+                }
+                if (written == 0) {
+                    wantWrite = true;
+                    break;
+                }
+
+                item.offset += static_cast<size_t>(written);
+                connection->buffered_ -= static_cast<size_t>(written);
+                if (item.offset == item.frame->wireSize()) {
+                    connection->queue_.pop(now);
+                }
+            }
+            connection->buffered_ -= dropped;
+
+            if (connection->queue_.empty() && connection->closeAfterFlush_) {
+                shouldClose = true;
+            }
+        }
+
+        if (shouldClose) {
+            closeConnection(connection);
+            return;
+        }
+
+        if (wantWrite != connection->writeArmed_) {
+            poller_.setWritable(connection->fd(), wantWrite);
+            connection->writeArmed_ = wantWrite;
+        }
+    }
+
+    void closeConnection(const std::shared_ptr<ReactorConnection>& connection) {
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex_);
+            if (!connection->open_) {
+                return;
+            }
+            connection->open_ = false;
+            connection->queue_.clear();
+            connection->buffered_ = 0;
+        }
+
+        poller_.remove(connection->fd());
+        ::close(connection->fd());
+        connections_.erase(connection->fd());
+
+        if (connection->upgraded_ && owner_.callbacks_.onClose) {
+            owner_.callbacks_.onClose(connection);
+        }
+    }
+
+    ReactorTransport& owner_;
+    Poller poller_;
+    int wakePipe_[2] = {-1, -1};
+    int listenFd_ = -1;
+    std::thread thread_;
+
+    std::mutex pendingMutex_;
+    std::vector<int> pendingFds_;
+    std::vector<std::shared_ptr<ReactorConnection>> dirty_;
+    std::atomic<bool> wakePending_{false};
+
+    // Owned by the reactor thread
+    std::unordered_map<int, std::shared_ptr<ReactorConnection>> connections_;
+};
+
+void ReactorConnection::sendFrame(const SharedFrame& frame) {
+    // Large frames to local clients travel as a shared memfd
+    MemfdCache::Passed passed;
+    bool viaMemfd = local_ && frame->isBinary() &&
+                    frame->payloadSize() >= FRAME_HEADER_SIZE + UNIX_MEMFD_THRESHOLD &&
+                    reactor_.owner().memfds_->lookup(frame, passed);
+
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_ || closeAfterFlush_) {
+            return;
+        }
+        if (viaMemfd) {
+            enqueueLocked(passed.descriptor, std::move(passed.fd));
+        } else {
+            enqueueLocked(frame);
+        }
+        if (!dirty_) {
+            dirty_ = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        reactor_.markDirty(shared_from_this());
+    }
+}
+
+void ReactorConnection::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_ || closeAfterFlush_) {
+            return;
+        }
+        if (!http_) {
+            enqueueLocked(FramedMessage::control(WsOpcode::Close, {0x03, 0xE8}));  // 1000
+        }
+        closeAfterFlush_ = true;
+        dirty_ = true;
+    }
+    reactor_.markDirty(shared_from_this());
+}
+
+ReactorTransport::ReactorTransport(int ioThreads, const std::string& unixPath)
+    : ioThreads_(std::max(1, ioThreads)),
+      unixPath_(unixPath),
+      memfds_(std::make_unique<MemfdCache>()) {}
+
+ReactorTransport::~ReactorTransport() {
+    stop();
+}
+
+bool ReactorTransport::start(int port, const TransportCallbacks& callbacks) {
+    if (running_) {
+        return false;
+    }
+    callbacks_ = callbacks;
+
+    if (!(unixPath_.empty() ? listenTcp(port) : listenUnix())) {
+        return false;
+    }
+
+    reactors_.clear();
+    for (int i = 0; i < ioThreads_; i++) {
+        auto reactor = std::make_unique<Reactor>(*this);
+        if (!reactor->init()) {
+            std::cerr << "Failed to create reactor: " << std::strerror(errno) << std::endl;
+            reactors_.clear();
+            ::close(listenFd_);
+            listenFd_ = -1;
+            return false;
+        }
+        reactors_.push_back(std::move(reactor));
+    }
+    reactors_[0]->addListener(listenFd_);
+    reserveFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    running_ = true;
+    for (auto& reactor : reactors_) {
+        reactor->start();
+    }
+    return true;
+}
+
+void ReactorTransport::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    for (auto& reactor : reactors_) {
+        reactor->join();
+    }
+    reactors_.clear();
+
+    ::close(listenFd_);
+    listenFd_ = -1;
+    if (reserveFd_ >= 0) {
+        ::close(reserveFd_);
+        reserveFd_ = -1;
+    }
+
+    if (!unixPath_.empty()) {
+        ::unlink(unixPath_.c_str());
+    }
+}
+
+bool ReactorTransport::listenTcp(int port) {
+    listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0 || !setNonBlocking(listenFd_)) {
+        std::cerr << "Failed to start server: " << std::strerror(errno) << std::endl;
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    socklen_t addrLen = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+    boundPort_ = ntohs(addr.sin_port);
+    return true;
+}
+
+bool ReactorTransport::listenUnix() {
+    sockaddr_un addr{};
+    if (unixPath_.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Unix socket path too long: " << unixPath_ << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, unixPath_.c_str(), sizeof(addr.sun_path) - 1);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Replace a socket file left behind by a previous run
+    ::unlink(unixPath_.c_str());
+
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0 || !setNonBlocking(listenFd_)) {
+        std::cerr << "Failed to listen on " << unixPath_ << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void ReactorTransport::acceptConnections() {
+    while (true) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                // The listener is level-triggered: leaving the connection pending
+                // would wake this reactor again at once. Free the reserve fd to
+                // accept and drop it, then take the reserve back.
+                if (!rejectWithReserveFd()) {
+                    return;
+                }
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED) {
+                std::cerr << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        configureClientSocket(fd);
+        reactors_[nextReactor_++ % reactors_.size()]->adopt(fd);
+    }
+}
+
+bool ReactorTransport::rejectWithReserveFd() {
+    if (reserveFd_ < 0) {
+        reserveFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (reserveFd_ < 0) {
+            return false;
+        }
+    }
+    ::close(reserveFd_);
+    int fd = ::accept(listenFd_, nullptr, nullptr);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    reserveFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    rejectedConnections_++;
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastRejectLog_ >= std::chrono::seconds(1)) {
+        lastRejectLog_ = now;
+        std::cerr << "Out of file descriptors: rejected " << rejectedConnections_ << " connection(s)"
+                  << std::endl;
+        rejectedConnections_ = 0;
+    }
+    return fd >= 0 && reserveFd_ >= 0;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,100 @@
+/**
+ * @file send_queue.cpp
+ * @brief Message classification for per-client send scheduling
+ */
+
+#include "kinect_xr/send_queue.h"
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/frame_bundle.h"
+
+namespace kinect_xr {
+
+namespace {
+uint32_t readLe(const uint8_t* in, size_t n) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < n; i++) {
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Losing these would leave the client out of step with the bridge
+constexpr uint16_t UNDROPPABLE_FLAGS = FRAME_FLAG_HISTORY | FRAME_FLAG_TILES | FRAME_FLAG_TILE_KEY;
+
+// Whether any part of a bundle must not be dropped
+bool bundleHasUndroppablePart(const uint8_t* message, size_t size) {
+    if (size < FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE) {
+        return true;
+    }
+    size_t count = readLe(message + FRAME_HEADER_SIZE, 2);
+    const uint8_t* table = message + FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE;
+    if (size < FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE + count * BUNDLE_ENTRY_SIZE) {
+        return true;
+    }
+    for (size_t i = 0; i < count; i++, table += BUNDLE_ENTRY_SIZE) {
+        size_t offset = readLe(table, 4);
+        if (offset > size || size - offset < FRAME_HEADER_SIZE ||
+            (readLe(message + offset + 6, 2) & UNDROPPABLE_FLAGS)) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+const char* sendPriorityName(SendPriority priority) {
+    switch (priority) {
+        case SendPriority::Control:
+            return "control";
+        case SendPriority::Depth:
+            return "depth";
+        case SendPriority::Video:
+        default:
+            return "video";
+    }
+}
+
+SendClass classifyFrame(const FramedMessage& frame) {
+    switch (frame.opcode()) {
+        case WsOpcode::Binary:
+            break;
+        case WsOpcode::Close:
+            // Last on the wire: nothing may follow it
+            return {SendPriority::Video, false};
+        case WsOpcode::Continuation:
+            if (frame.headerSize() == 0) {
+                // HTTP response bytes keep their order
+                return {SendPriority::Video, false};
+            }
+            return {SendPriority::Control, false};
+        default:
+            // JSON, ping, pong
+            return {SendPriority::Control, false};
+    }
+
+    if (frame.payloadSize() < FRAME_HEADER_SIZE) {
+        return {SendPriority::Control, false};
+    }
+    const uint8_t* payload = frame.payload();
+    uint16_t streamType = static_cast<uint16_t>(readLe(payload + 4, 2));
+    bool droppable = (readLe(payload + 6, 2) & UNDROPPABLE_FLAGS) == 0;
+    switch (streamType) {
+        case STREAM_TYPE_RGB:
+        case STREAM_TYPE_KEYED:
+            return {SendPriority::Video, droppable};
+        case STREAM_TYPE_DEPTH:
+        case STREAM_TYPE_POINTCLOUD:
+        case STREAM_TYPE_MESH:
+        case STREAM_TYPE_CONTOURS:
+            return {SendPriority::Depth, droppable};
+        case STREAM_TYPE_BUNDLE:
+            // Bundles carry depth; dropped as a whole or not at all
+            return {SendPriority::Depth, droppable && !bundleHasUndroppablePart(payload, frame.payloadSize())};
+        case STREAM_TYPE_CONTROL:
+        default:
+            return {SendPriority::Control, false};
+    }
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,351 @@
+/**
+ * @file shm_ring.cpp
+ * @brief Shared-memory frame ring implementation
+ */
+
+#include "kinect_xr/shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+namespace kinect_xr {
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+constexpr size_t PAGE_ALIGN = 4096;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+ShmSlot* slotTable(uint8_t* base) {
+    return reinterpret_cast<ShmSlot*>(base + sizeof(ShmRingHeader));
+}
+
+const ShmSlot* slotTable(const uint8_t* base) {
+    return reinterpret_cast<const ShmSlot*>(base + sizeof(ShmRingHeader));
+}
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Wake word helpers. The futex is process-shared (no FUTEX_PRIVATE_FLAG);
+// other platforms fall back to short sleeps in wait().
+void wakeAll(std::atomic<uint32_t>* word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+void waitOnWord(const std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+#ifdef __linux__
+    timespec timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAIT, expected,
+            &timeout, nullptr, 0);
+#else
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (word->load(std::memory_order_acquire) == expected &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+#endif
+}
+
+}  // namespace
+
+// ============================================================================
+// ShmRingWriter
+// ============================================================================
+
+ShmRingWriter::~ShmRingWriter() {
+    destroy();
+}
+
+bool ShmRingWriter::create(const std::string& name, uint32_t slotCount, uint32_t slotSize) {
+    destroy();
+
+    if (name.empty() || name[0] != '/' || slotCount == 0 || slotSize == 0) {
+        std::cerr << "Invalid shared-memory ring parameters" << std::endl;
+        return false;
+    }
+
+    size_t tableEnd = sizeof(ShmRingHeader) + sizeof(ShmSlot) * slotCount;
+    size_t dataOffset = alignUp(tableEnd, PAGE_ALIGN);
+    size_t slotStride = alignUp(slotSize, CACHE_LINE);
+    size_t mappedSize = dataOffset + slotStride * slotCount;
+
+    // Replace a region left behind by a previous run
+    shm_unlink(name.c_str());
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "shm_open(" << name << ") failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+        std::cerr << "ftruncate(" << name << ") failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "mmap(" << name << ") failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    base_ = static_cast<uint8_t*>(base);
+    fd_ = fd;
+    name_ = name;
+
+    // Slots first; the header (with magic) last so readers never see a partial layout
+    ShmSlot* slots = slotTable(base_);
+    for (uint32_t i = 0; i < slotCount; i++) {
+        new (&slots[i]) ShmSlot();
+        slots[i].lock.store(0, std::memory_order_relaxed);
+        slots[i].sequence.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    header_ = new (base_) ShmRingHeader();
+    header_->version = SHM_RING_VERSION;
+    header_->slotCount = slotCount;
+    header_->slotSize = slotSize;
+    header_->slotStride = slotStride;
+    header_->dataOffset = dataOffset;
+    header_->mappedSize = mappedSize;
+    header_->published.store(0, std::memory_order_relaxed);
+    header_->wakeWord.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHM_RING_MAGIC;
+
+    nextSequence_ = 0;
+    return true;
+}
+
+void ShmRingWriter::destroy() {
+    if (base_) {
+        munmap(base_, header_->mappedSize);
+        base_ = nullptr;
+        header_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (!name_.empty()) {
+        shm_unlink(name_.c_str());
+        name_.clear();
+    }
+}
+
+bool ShmRingWriter::publish(uint16_t streamType, uint32_t frameId, const uint8_t* data,
+                            size_t size, uint16_t flags) {
+    if (!header_ || size > header_->slotSize) {
+        return false;
+    }
+
+    uint64_t sequence = nextSequence_++;
+    uint32_t index = static_cast<uint32_t>(sequence % header_->slotCount);
+    ShmSlot& slot = slotTable(base_)[index];
+    uint8_t* payload = base_ + header_->dataOffset + index * header_->slotStride;
+
+    // Seqlock write: odd while the slot is being rewritten
+    uint32_t lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.streamType.store(streamType, std::memory_order_relaxed);
+    slot.flags.store(flags, std::memory_order_relaxed);
+    slot.frameId.store(frameId, std::memory_order_relaxed);
+    slot.size.store(static_cast<uint32_t>(size), std::memory_order_relaxed);
+    slot.sequence.store(sequence, std::memory_order_relaxed);
+    slot.timestampNs.store(nowNs(), std::memory_order_relaxed);
+    std::memcpy(payload, data, size);
+
+    slot.lock.store(lock + 2, std::memory_order_release);
+    header_->published.store(sequence + 1, std::memory_order_release);
+
+    header_->wakeWord.fetch_add(1, std::memory_order_release);
+    wakeAll(&header_->wakeWord);
+    return true;
+}
+
+// ============================================================================
+// ShmRingReader
+// ============================================================================
+
+ShmRingReader::~ShmRingReader() {
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ShmRingHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    auto* header = static_cast<const ShmRingHeader*>(base);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool valid = header->magic == SHM_RING_MAGIC &&
+                 header->version == SHM_RING_VERSION &&
+                 header->mappedSize == size &&
+                 header->dataOffset + header->slotStride * header->slotCount <= size;
+    if (!valid) {
+        std::cerr << "Shared-memory ring " << name << " has an incompatible layout" << std::endl;
+        munmap(base, size);
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    base_ = static_cast<const uint8_t*>(base);
+    mappedSize_ = size;
+    header_ = header;
+
+    // Start at the newest frame rather than replaying the whole ring
+    uint64_t published = header_->published.load(std::memory_order_acquire);
+    nextSequence_ = published > 0 ? published - 1 : 0;
+    dropped_ = 0;
+    return true;
+}
+
+void ShmRingReader::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), mappedSize_);
+        base_ = nullptr;
+        header_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool ShmRingReader::wait(int timeoutMs) {
+    if (!header_) {
+        return false;
+    }
+
+    uint32_t word = header_->wakeWord.load(std::memory_order_acquire);
+    if (header_->published.load(std::memory_order_acquire) > nextSequence_) {
+        return true;
+    }
+
+    waitOnWord(&header_->wakeWord, word, timeoutMs);
+    return header_->published.load(std::memory_order_acquire) > nextSequence_;
+}
+
+bool ShmRingReader::next(ShmFrameView& view) {
+    if (!header_) {
+        return false;
+    }
+
+    const uint32_t slotCount = header_->slotCount;
+
+    while (true) {
+        uint64_t published = header_->published.load(std::memory_order_acquire);
+        if (nextSequence_ >= published) {
+            return false;
+        }
+
+        // Fell behind: the oldest slot may be mid-rewrite, so skip to the one after it
+        if (published - nextSequence_ >= slotCount) {
+            uint64_t resume = published - slotCount + 1;
+            dropped_ += resume - nextSequence_;
+            nextSequence_ = resume;
+        }
+
+        uint32_t index = static_cast<uint32_t>(nextSequence_ % slotCount);
+        const ShmSlot& slot = slotTable(base_)[index];
+
+        uint32_t lock = slot.lock.load(std::memory_order_acquire);
+        if ((lock & 1) != 0 ||
+            slot.sequence.load(std::memory_order_relaxed) != nextSequence_) {
+            // Overwritten while we looked at it
+            dropped_++;
+            nextSequence_++;
+            continue;
+        }
+
+        view.data = base_ + header_->dataOffset + index * header_->slotStride;
+        view.size = std::min<size_t>(slot.size.load(std::memory_order_relaxed), header_->slotSize);
+        view.streamType = slot.streamType.load(std::memory_order_relaxed);
+        view.flags = slot.flags.load(std::memory_order_relaxed);
+        view.frameId = slot.frameId.load(std::memory_order_relaxed);
+        view.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        view.sequence = nextSequence_;
+        view.slot = index;
+        view.lockValue = lock;
+
+        nextSequence_++;
+
+        if (!stillValid(view)) {
+            dropped_++;
+            continue;
+        }
+        return true;
+    }
+}
+
+bool ShmRingReader::stillValid(const ShmFrameView& view) const {
+    if (!header_ || view.slot >= header_->slotCount) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotTable(base_)[view.slot].lock.load(std::memory_order_relaxed) == view.lockValue;
+}
+
+bool ShmRingReader::copyNext(ShmFrameView& view, std::vector<uint8_t>& out) {
+    while (next(view)) {
+        out.assign(view.data, view.data + view.size);
+        if (stillValid(view)) {
+            view.data = out.data();
+            return true;
+        }
+        dropped_++;
+    }
+    return false;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,313 @@
+/**
+ * @file snapshot_encoder.cpp
+ * @brief JPEG, PNG and PLY snapshot encoders and the lazy snapshot cache
+ */
+
+#include "kinect_xr/snapshot_encoder.h"
+#include "kinect_xr/bridge_protocol.h"
+
+// jpeglib.h needs size_t and FILE declared first
+#include <cstdio>
+#include <jpeglib.h>
+#include <png.h>
+
+#include <cmath>
+#include <csetjmp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace kinect_xr {
+
+namespace {
+constexpr float KINECT_DEPTH_FOV_H_DEG = 57.0f;
+constexpr float KINECT_DEPTH_FOV_V_DEG = 43.0f;
+constexpr float DEG_TO_RAD = 3.14159265358979f / 180.0f;
+
+uint32_t readFrameId(const uint8_t* header) {
+    return static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+           (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+}
+
+// libjpeg's default error handler calls exit(); jump back to the encoder instead
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+    auto* errors = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    std::cerr << "Snapshot: JPEG encode failed: " << message << std::endl;
+    std::longjmp(errors->jump, 1);
+}
+
+void pngWrite(png_structp png, png_bytep data, png_size_t size) {
+    auto* out = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+    out->insert(out->end(), data, data + size);
+}
+
+void pngFlush(png_structp) {}
+
+void pngError(png_structp png, png_const_charp message) {
+    std::cerr << "Snapshot: PNG encode failed: " << message << std::endl;
+    png_longjmp(png, 1);
+}
+
+/**
+ * @param colorType PNG_COLOR_TYPE_RGB (8-bit) or PNG_COLOR_TYPE_GRAY (16-bit LE input)
+ */
+bool encodePng(const uint8_t* pixels, uint32_t width, uint32_t height, int colorType,
+               std::vector<uint8_t>& out) {
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, pngError, nullptr);
+    if (!png) {
+        return false;
+    }
+    png_infop info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_write_struct(&png, nullptr);
+        return false;
+    }
+
+    const bool depth16 = colorType == PNG_COLOR_TYPE_GRAY;
+    const size_t rowBytes = static_cast<size_t>(width) * (depth16 ? 2 : 3);
+    out.clear();
+    out.reserve(rowBytes * height / 2);
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        out.clear();
+        return false;
+    }
+
+    png_set_write_fn(png, &out, pngWrite, pngFlush);
+    png_set_IHDR(png, info, width, height, depth16 ? 16 : 8, colorType, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+    // Snapshots are polled at frame rate: favour encode speed over size
+    png_set_compression_level(png, 1);
+    png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+    png_write_info(png, info);
+    if (depth16) {
+        png_set_swap(png);  // PNG samples are big-endian, frames are little-endian
+    }
+
+    for (uint32_t y = 0; y < height; y++) {
+        png_write_row(png, const_cast<png_bytep>(pixels + y * rowBytes));
+    }
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return true;
+}
+
+template <typename T>
+void appendValue(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+}  // namespace
+
+const char* snapshotContentType(SnapshotFormat format) {
+    switch (format) {
+        case SnapshotFormat::RgbJpeg: return "image/jpeg";
+        case SnapshotFormat::RgbPng: return "image/png";
+        case SnapshotFormat::DepthPng: return "image/png";
+        case SnapshotFormat::DepthRaw: return "application/octet-stream";
+        case SnapshotFormat::PointCloudPly: return "application/x-ply";
+    }
+    return "application/octet-stream";
+}
+
+DepthIntrinsics DepthIntrinsics::kinectDefault() {
+    DepthIntrinsics intrinsics;
+    intrinsics.fx = (FRAME_WIDTH / 2.0f) / std::tan(KINECT_DEPTH_FOV_H_DEG * DEG_TO_RAD / 2.0f);
+    intrinsics.fy = (FRAME_HEIGHT / 2.0f) / std::tan(KINECT_DEPTH_FOV_V_DEG * DEG_TO_RAD / 2.0f);
+    intrinsics.cx = FRAME_WIDTH / 2.0f;
+    intrinsics.cy = FRAME_HEIGHT / 2.0f;
+    return intrinsics;
+}
+
+bool encodeJpeg(const uint8_t* rgb, uint32_t width, uint32_t height, int quality,
+                std::vector<uint8_t>& out) {
+    jpeg_compress_struct cinfo;
+    JpegErrorManager errors;
+    cinfo.err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = jpegErrorExit;
+
+    unsigned char* buffer = nullptr;
+    unsigned long bufferSize = 0;
+
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        std::free(buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &bufferSize);
+
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    cinfo.dct_method = JDCT_IFAST;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    const size_t rowBytes = static_cast<size_t>(width) * 3;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(rgb + cinfo.next_scanline * rowBytes);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+
+    out.assign(buffer, buffer + bufferSize);
+    jpeg_destroy_compress(&cinfo);
+    std::free(buffer);
+    return true;
+}
+
+bool encodeRgbPng(const uint8_t* rgb, uint32_t width, uint32_t height, std::vector<uint8_t>& out) {
+    return encodePng(rgb, width, height, PNG_COLOR_TYPE_RGB, out);
+}
+
+bool encodeDepthPng(const uint8_t* depth, uint32_t width, uint32_t height,
+                    std::vector<uint8_t>& out) {
+    return encodePng(depth, width, height, PNG_COLOR_TYPE_GRAY, out);
+}
+
+void encodePly(const uint8_t* depth, const uint8_t* rgb, uint32_t width, uint32_t height,
+               const DepthIntrinsics& intrinsics, std::vector<uint8_t>& out) {
+    const size_t pixels = static_cast<size_t>(width) * height;
+    size_t valid = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        if (depth[i * 2] | depth[i * 2 + 1]) {
+            valid++;
+        }
+    }
+
+    std::string header =
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "comment kinect-xr-bridge depth snapshot, metres, +Y up, +Z forward\n"
+        "element vertex " + std::to_string(valid) + "\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n";
+    if (rgb) {
+        header +=
+            "property uchar red\n"
+            "property uchar green\n"
+            "property uchar blue\n";
+    }
+    header += "end_header\n";
+
+    const size_t vertexSize = 3 * sizeof(float) + (rgb ? 3 : 0);
+    out.clear();
+    out.reserve(header.size() + valid * vertexSize);
+    out.insert(out.end(), header.begin(), header.end());
+
+    const float invFx = 1.0f / intrinsics.fx;
+    const float invFy = 1.0f / intrinsics.fy;
+    for (uint32_t v = 0; v < height; v++) {
+        for (uint32_t u = 0; u < width; u++) {
+            size_t i = static_cast<size_t>(v) * width + u;
+            uint16_t mm = static_cast<uint16_t>(depth[i * 2] | (depth[i * 2 + 1] << 8));
+            if (mm == 0) {
+                continue;
+            }
+            float z = mm * 0.001f;
+            appendValue(out, (u - intrinsics.cx) * z * invFx);
+            appendValue(out, -(v - intrinsics.cy) * z * invFy);
+            appendValue(out, z);
+            if (rgb) {
+                out.insert(out.end(), rgb + i * 3, rgb + i * 3 + 3);
+            }
+        }
+    }
+}
+
+SnapshotCache::SnapshotCache(int jpegQuality)
+    : jpegQuality_(jpegQuality), intrinsics_(DepthIntrinsics::kinectDefault()) {}
+
+void SnapshotCache::update(uint16_t streamType, const SharedFrame& frame) {
+    if (!frame) return;
+
+    std::lock_guard<std::mutex> lock(framesMutex_);
+    if (streamType == STREAM_TYPE_RGB && frame->payloadSize() == FRAME_HEADER_SIZE + RGB_FRAME_SIZE) {
+        rgb_ = frame;
+    } else if (streamType == STREAM_TYPE_DEPTH &&
+               frame->payloadSize() == FRAME_HEADER_SIZE + DEPTH_FRAME_SIZE) {
+        depth_ = frame;
+    }
+}
+
+SharedFrame SnapshotCache::get(SnapshotFormat format, uint32_t* frameId) {
+    SharedFrame rgb;
+    SharedFrame depth;
+    {
+        std::lock_guard<std::mutex> lock(framesMutex_);
+        rgb = rgb_;
+        depth = depth_;
+    }
+
+    const bool needsDepth = format == SnapshotFormat::DepthPng ||
+                            format == SnapshotFormat::DepthRaw ||
+                            format == SnapshotFormat::PointCloudPly;
+    const SharedFrame& source = needsDepth ? depth : rgb;
+    if (!source) {
+        return nullptr;
+    }
+
+    // The point cloud is colored from RGB, so it changes with either stream
+    uint32_t sourceId = readFrameId(source->payload());
+    uint64_t key = sourceId;
+    if (format == SnapshotFormat::PointCloudPly && rgb) {
+        key |= static_cast<uint64_t>(readFrameId(rgb->payload()) + 1) << 32;
+    }
+    if (frameId) {
+        *frameId = sourceId;
+    }
+
+    Slot& slot = slots_[static_cast<size_t>(format)];
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (slot.body && slot.sourceKey == key) {
+        return slot.body;
+    }
+
+    std::vector<uint8_t> out;
+    if (!encode(format, rgb, depth, out)) {
+        return nullptr;
+    }
+    encodes_++;
+    slot.body = FramedMessage::raw(std::move(out));
+    slot.sourceKey = key;
+    return slot.body;
+}
+
+bool SnapshotCache::encode(SnapshotFormat format, const SharedFrame& rgb, const SharedFrame& depth,
+                           std::vector<uint8_t>& out) const {
+    const uint8_t* rgbData = rgb ? rgb->payload() + FRAME_HEADER_SIZE : nullptr;
+    const uint8_t* depthData = depth ? depth->payload() + FRAME_HEADER_SIZE : nullptr;
+
+    switch (format) {
+        case SnapshotFormat::RgbJpeg:
+            return encodeJpeg(rgbData, FRAME_WIDTH, FRAME_HEIGHT, jpegQuality_, out);
+        case SnapshotFormat::RgbPng:
+            return encodeRgbPng(rgbData, FRAME_WIDTH, FRAME_HEIGHT, out);
+        case SnapshotFormat::DepthPng:
+            return encodeDepthPng(depthData, FRAME_WIDTH, FRAME_HEIGHT, out);
+        case SnapshotFormat::DepthRaw:
+            out.assign(depthData, depthData + DEPTH_FRAME_SIZE);
+            return true;
+        case SnapshotFormat::PointCloudPly:
+            encodePly(depthData, rgbData, FRAME_WIDTH, FRAME_HEIGHT, intrinsics_, out);
+            return true;
+    }
+    return false;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,179 @@
+/**
+ * @file tile_update.cpp
+ * @brief Dirty-tile reference tracking and tile frame encoding
+ */
+
+#include "kinect_xr/tile_update.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace kinect_xr {
+
+namespace {
+void writeLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+uint16_t readLe16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+// Byte offset of the top-left pixel of a tile in a full-size image
+size_t tileOrigin(uint32_t tile, size_t pixelSize) {
+    uint32_t u = (tile % TILE_COLUMNS) * TILE_SIZE;
+    uint32_t v = (tile / TILE_COLUMNS) * TILE_SIZE;
+    return (static_cast<size_t>(v) * FRAME_WIDTH + u) * pixelSize;
+}
+}  // namespace
+
+TileEncoder::TileEncoder(uint16_t streamType, const TileParams& params)
+    : streamType_(streamType),
+      params_(params),
+      pixelSize_(streamType == STREAM_TYPE_RGB ? 3 : 2) {
+    dirty_.reserve(TILE_COUNT);
+}
+
+bool TileEncoder::tileChanged(const uint8_t* frame, uint32_t tile) const {
+    const size_t origin = tileOrigin(tile, pixelSize_);
+    const size_t rowBytes = TILE_SIZE * pixelSize_;
+    const size_t stride = FRAME_WIDTH * pixelSize_;
+
+    for (uint32_t row = 0; row < TILE_SIZE; row++) {
+        const uint8_t* next = frame + origin + row * stride;
+        const uint8_t* held = reference_.data() + origin + row * stride;
+        if (std::memcmp(next, held, rowBytes) == 0) {
+            continue;
+        }
+        if (pixelSize_ == 3) {
+            for (size_t i = 0; i < rowBytes; i++) {
+                if (std::abs(next[i] - held[i]) > params_.rgbThreshold) {
+                    return true;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < rowBytes; i += 2) {
+                int a = readLe16(next + i);
+                int b = readLe16(held + i);
+                if ((a == 0) != (b == 0) || std::abs(a - b) > params_.depthThresholdMm) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool TileEncoder::update(const SharedFrame& frame) {
+    if (!frame || frame->payloadSize() != FRAME_HEADER_SIZE + FRAME_WIDTH * FRAME_HEIGHT * pixelSize_) {
+        return false;
+    }
+    const uint8_t* header = frame->payload();
+    uint16_t flags = readLe16(header + 6);
+    if (readLe16(header + 4) != streamType_ ||
+        (flags & (FRAME_FLAG_SCALE_MASK | FRAME_FLAG_PIXEL_FORMAT_MASK | FRAME_FLAG_DEPTH_PACKING_MASK |
+                  FRAME_FLAG_TILES))) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frame == lastFrame_) {
+        return true;
+    }
+    const uint8_t* pixels = header + FRAME_HEADER_SIZE;
+
+    dirty_.clear();
+    bool refresh = reference_.empty() || version_ % params_.refreshFrames == 0;
+    if (reference_.empty()) {
+        reference_.assign(pixels, pixels + FRAME_WIDTH * FRAME_HEIGHT * pixelSize_);
+    }
+    const size_t rowBytes = TILE_SIZE * pixelSize_;
+    const size_t stride = FRAME_WIDTH * pixelSize_;
+    for (uint32_t tile = 0; tile < TILE_COUNT; tile++) {
+        if (!refresh && !tileChanged(pixels, tile)) {
+            continue;
+        }
+        dirty_.push_back(static_cast<uint16_t>(tile));
+        const size_t origin = tileOrigin(tile, pixelSize_);
+        for (uint32_t row = 0; row < TILE_SIZE; row++) {
+            std::memcpy(reference_.data() + origin + row * stride, pixels + origin + row * stride, rowBytes);
+        }
+    }
+
+    frameId_ = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+               (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    lastFrame_ = frame;
+    version_++;
+    deltas_.fill(nullptr);
+    key_.reset();
+    return true;
+}
+
+uint64_t TileEncoder::version() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return version_;
+}
+
+uint32_t TileEncoder::dirtyCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(dirty_.size());
+}
+
+SharedFrame TileEncoder::delta(PixelFormat format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version_ == 0) {
+        return nullptr;
+    }
+    if (streamType_ != STREAM_TYPE_RGB) {
+        format = PixelFormat::Rgb888;
+    }
+    SharedFrame& cached = deltas_[static_cast<size_t>(format)];
+    if (cached) {
+        return cached;
+    }
+
+    const size_t outPixel = streamType_ == STREAM_TYPE_RGB ? bytesPerPixel(format) : pixelSize_;
+    const size_t tileBytes = TILE_SIZE * TILE_SIZE * outPixel;
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + TILE_HEADER_SIZE + dirty_.size() * tileBytes, 0);
+    uint16_t flags = static_cast<uint16_t>(FRAME_FLAG_TILES |
+                                           (static_cast<uint16_t>(format) << FRAME_FLAG_PIXEL_FORMAT_SHIFT));
+    encodeFrameHeader(payload.data(), frameId_, streamType_, flags);
+
+    uint8_t* out = payload.data() + FRAME_HEADER_SIZE;
+    out[0] = static_cast<uint8_t>(TILE_SIZE);
+    writeLe16(out + 2, static_cast<uint16_t>(dirty_.size()));
+    for (uint16_t tile : dirty_) {
+        out[4 + tile / 8] |= static_cast<uint8_t>(1u << (tile % 8));
+    }
+
+    uint8_t* data = out + TILE_HEADER_SIZE;
+    const size_t stride = FRAME_WIDTH * pixelSize_;
+    for (uint16_t tile : dirty_) {
+        const uint8_t* src = reference_.data() + tileOrigin(tile, pixelSize_);
+        for (uint32_t row = 0; row < TILE_SIZE; row++, src += stride, data += TILE_SIZE * outPixel) {
+            if (outPixel == pixelSize_) {
+                std::memcpy(data, src, TILE_SIZE * pixelSize_);
+            } else {
+                convertRgbPixels(src, TILE_SIZE, format, data);
+            }
+        }
+    }
+
+    cached = FramedMessage::binary(std::move(payload));
+    return cached;
+}
+
+SharedFrame TileEncoder::keyFrame() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version_ == 0) {
+        return nullptr;
+    }
+    if (!key_) {
+        key_ = FramedMessage::binaryFrame(streamType_, frameId_, reference_.data(), reference_.size(),
+                                          FRAME_FLAG_TILE_KEY);
+    }
+    return key_;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,215 @@
+/**
+ * @file unix_client.cpp
+ * @brief Unix domain socket bridge client implementation
+ */
+
+#include "kinect_xr/unix_client.h"
+#include "kinect_xr/bridge_protocol.h"
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace kinect_xr {
+
+namespace {
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr size_t MAX_FDS_PER_READ = 16;
+}  // namespace
+
+UnixFrameClient::~UnixFrameClient() {
+    close();
+}
+
+bool UnixFrameClient::connect(const std::string& path) {
+    close();
+
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    fd_ = fd;
+    parser_ = WsFrameParser(false, 64 << 20);
+    return true;
+}
+
+void UnixFrameClient::close() {
+    releaseMapping();
+    for (int fd : passedFds_) {
+        ::close(fd);
+    }
+    passedFds_.clear();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool UnixFrameClient::sendText(const std::string& text) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    auto frame = FramedMessage::text(text);
+    size_t offset = 0;
+    while (offset < frame->wireSize()) {
+        ssize_t written = writeFramedMessage(fd_, *frame, offset);
+        if (written <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool UnixFrameClient::next(LocalMessage& message, int timeoutMs) {
+    releaseMapping();
+
+    while (fd_ >= 0) {
+        if (parser_.next(current_)) {
+            if (current_.opcode == WsOpcode::Close) {
+                close();
+                return false;
+            }
+            if (current_.opcode == WsOpcode::Text || current_.opcode == WsOpcode::Binary) {
+                return decode(message);
+            }
+            continue;  // Ping/pong
+        }
+        if (parser_.failed() || !receive(timeoutMs)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool UnixFrameClient::receive(int timeoutMs) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready;
+    do {
+        ready = ::poll(&pfd, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) {
+        return false;
+    }
+
+    uint8_t buffer[READ_CHUNK_SIZE];
+    iovec iov{buffer, sizeof(buffer)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS_PER_READ)];
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(fd_, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        close();
+        return false;
+    }
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; i++) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                passedFds_.push_back(fd);
+            }
+        }
+    }
+
+    parser_.append(buffer, static_cast<size_t>(n));
+    return true;
+}
+
+bool UnixFrameClient::decode(LocalMessage& message) {
+    message = LocalMessage{};
+    message.opcode = current_.opcode;
+
+    if (current_.opcode == WsOpcode::Text) {
+        message.text = std::move(current_.payload);
+        return true;
+    }
+
+    const auto* payload = reinterpret_cast<const uint8_t*>(current_.payload.data());
+    if (current_.payload.size() < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    message.frameId = static_cast<uint32_t>(payload[0]) |
+                      (static_cast<uint32_t>(payload[1]) << 8) |
+                      (static_cast<uint32_t>(payload[2]) << 16) |
+                      (static_cast<uint32_t>(payload[3]) << 24);
+    message.streamType = static_cast<uint16_t>(payload[4] | (payload[5] << 8));
+    uint16_t flags = static_cast<uint16_t>(payload[6] | (payload[7] << 8));
+    message.flags = flags & ~FRAME_FLAG_MEMFD;
+
+    if ((flags & FRAME_FLAG_MEMFD) == 0) {
+        message.data = payload + FRAME_HEADER_SIZE;
+        message.size = current_.payload.size() - FRAME_HEADER_SIZE;
+        return true;
+    }
+
+    // Descriptor frame: payload size follows the header, data is in the next passed fd
+    if (current_.payload.size() < FRAME_HEADER_SIZE + sizeof(uint64_t) || passedFds_.empty()) {
+        return false;
+    }
+    uint64_t size = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        size |= static_cast<uint64_t>(payload[FRAME_HEADER_SIZE + i]) << (8 * i);
+    }
+
+    int fd = passedFds_.front();
+    passedFds_.pop_front();
+
+    void* mapped = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : nullptr;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    mapping_ = mapped;
+    mappingSize_ = size;
+    message.data = static_cast<const uint8_t*>(mapped);
+    message.size = size;
+    message.mapped = true;
+    return true;
+}
+
+void UnixFrameClient::releaseMapping() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,301 @@
+/**
+ * @file ws_client.cpp
+ * @brief Minimal blocking WebSocket client implementation
+ */
+
+#include "kinect_xr/ws_client.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace kinect_xr {
+
+namespace {
+constexpr size_t READ_CHUNK_SIZE = 256 * 1024;
+constexpr size_t MAX_HANDSHAKE_SIZE = 16 * 1024;
+
+bool waitFor(int fd, short events, int timeoutMs) {
+    pollfd pfd{fd, events, 0};
+    int ready;
+    do {
+        ready = ::poll(&pfd, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0;
+}
+
+int connectTcp(const std::string& host, int port, int timeoutMs) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = results; ai && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Non-blocking connect so an unreachable upstream cannot stall the relay
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        int error = 0;
+        if (rc != 0 && errno == EINPROGRESS && waitFor(fd, POLLOUT, timeoutMs)) {
+            socklen_t len = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            rc = error == 0 ? 0 : -1;
+        }
+        if (rc != 0) {
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        fcntl(fd, F_SETFL, flags);
+    }
+    freeaddrinfo(results);
+
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    }
+    return fd;
+}
+}  // namespace
+
+bool WsUrl::parse(const std::string& url, WsUrl& out) {
+    const std::string scheme = "ws://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+
+    std::string rest = url.substr(scheme.size());
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    out.path = slash == std::string::npos ? "/" : rest.substr(slash);
+
+    out.port = 80;
+    std::string portText;
+    if (!authority.empty() && authority.front() == '[') {
+        size_t close = authority.find(']');  // [IPv6]:port
+        if (close == std::string::npos) {
+            return false;
+        }
+        if (close + 1 < authority.size()) {
+            if (authority[close + 1] != ':') {
+                return false;
+            }
+            portText = authority.substr(close + 2);
+        }
+        authority = authority.substr(1, close - 1);
+    } else {
+        size_t colon = authority.find(':');
+        if (colon != std::string::npos) {
+            portText = authority.substr(colon + 1);
+            authority.resize(colon);
+        }
+    }
+    if (!portText.empty()) {
+        out.port = std::atoi(portText.c_str());
+    }
+    out.host = authority;
+    return !out.host.empty() && out.port > 0 && out.port < 65536;
+}
+
+WsClient::WsClient() : maskRng_(std::random_device{}()) {}
+
+WsClient::~WsClient() {
+    close();
+}
+
+bool WsClient::connect(const std::string& url, int timeoutMs) {
+    close();
+
+    WsUrl target;
+    if (!WsUrl::parse(url, target)) {
+        std::cerr << "Unsupported WebSocket URL: " << url << std::endl;
+        return false;
+    }
+
+    int fd = connectTcp(target.host, target.port, timeoutMs);
+    if (fd < 0) {
+        return false;
+    }
+    fd_ = fd;
+
+    uint8_t nonce[16];
+    for (auto& byte : nonce) {
+        byte = static_cast<uint8_t>(maskRng_());
+    }
+    std::string key = base64Encode(nonce, sizeof(nonce));
+
+    std::string request =
+        "GET " + target.path + " HTTP/1.1\r\n"
+        "Host: " + target.host + ":" + std::to_string(target.port) + "\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: " + key + "\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (!writeAll(reinterpret_cast<const uint8_t*>(request.data()), request.size())) {
+        close();
+        return false;
+    }
+
+    // Read the handshake response; anything after it is WebSocket data
+    std::string response;
+    char buffer[4096];
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0 || response.size() > MAX_HANDSHAKE_SIZE ||
+            !waitFor(fd_, POLLIN, static_cast<int>(remaining))) {
+            close();
+            return false;
+        }
+        ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            close();
+            return false;
+        }
+        response.append(buffer, static_cast<size_t>(n));
+    }
+
+    size_t headerEnd = response.find("\r\n\r\n") + 4;
+    std::string headers = response.substr(0, headerEnd);
+    if (headers.compare(0, 12, "HTTP/1.1 101") != 0 ||
+        headers.find(computeWsAcceptKey(key)) == std::string::npos) {
+        std::cerr << "WebSocket upgrade rejected by " << url << std::endl;
+        close();
+        return false;
+    }
+
+    parser_ = WsFrameParser(false, 64 << 20);
+    parser_.append(reinterpret_cast<const uint8_t*>(response.data()) + headerEnd,
+                   response.size() - headerEnd);
+    readBuffer_.resize(READ_CHUNK_SIZE);
+    return true;
+}
+
+void WsClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool WsClient::sendText(const std::string& text) {
+    return sendFrame(WsOpcode::Text, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+bool WsClient::sendBinary(const uint8_t* data, size_t size) {
+    return sendFrame(WsOpcode::Binary, data, size);
+}
+
+bool WsClient::sendFrame(WsOpcode opcode, const uint8_t* data, size_t size) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    // Client → server frames must be masked (RFC 6455 section 5.3)
+    std::vector<uint8_t> frame(WS_MAX_HEADER_SIZE + 4 + size);
+    size_t headerSize = encodeWsHeader(frame.data(), opcode, size);
+    frame[1] |= 0x80;
+
+    uint32_t key = maskRng_();
+    uint8_t mask[4];
+    std::memcpy(mask, &key, sizeof(mask));
+    std::memcpy(frame.data() + headerSize, mask, sizeof(mask));
+    uint8_t* payload = frame.data() + headerSize + sizeof(mask);
+    for (size_t i = 0; i < size; i++) {
+        payload[i] = data[i] ^ mask[i & 3];
+    }
+
+    return writeAll(frame.data(), headerSize + sizeof(mask) + size);
+}
+
+bool WsClient::writeAll(const uint8_t* data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = ::send(fd_, data + offset, size - offset, MSG_NOSIGNAL);
+#else
+        ssize_t n = ::send(fd_, data + offset, size - offset, 0);
+#endif
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WsClient::next(WsMessage& message, int timeoutMs) {
+    while (fd_ >= 0) {
+        if (parser_.next(message)) {
+            switch (message.opcode) {
+                case WsOpcode::Text:
+                case WsOpcode::Binary:
+                    return true;
+                case WsOpcode::Ping:
+                    sendFrame(WsOpcode::Pong,
+                              reinterpret_cast<const uint8_t*>(message.payload.data()),
+                              message.payload.size());
+                    continue;
+                case WsOpcode::Close:
+                    close();
+                    return false;
+                default:
+                    continue;
+            }
+        }
+        if (parser_.failed()) {
+            close();
+            return false;
+        }
+        if (!receive(timeoutMs)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool WsClient::receive(int timeoutMs) {
+    if (!waitFor(fd_, POLLIN, timeoutMs)) {
+        return false;
+    }
+
+    ssize_t n;
+    do {
+        n = ::read(fd_, readBuffer_.data(), readBuffer_.size());
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        close();
+        return false;
+    }
+    parser_.append(readBuffer_.data(), static_cast<size_t>(n));
+    return true;
+}
+
+}  // namespace kinect_xr
@@ -0,0 +1,366 @@
+/**
+ * @file ws_frame.cpp
+ * @brief Pre-framed WebSocket message implementation
+ */
+
+#include "kinect_xr/ws_frame.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace kinect_xr {
+
+namespace {
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;  // macOS: sockets set SO_NOSIGPIPE instead
+#endif
+
+constexpr const char* WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+inline uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// SHA-1 is only used for the handshake accept key (RFC 6455 section 4.2.2)
+std::array<uint8_t, 20> sha1(const std::string& input) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::vector<uint8_t> data(input.begin(), input.end());
+    uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+    data.push_back(0x80);
+    while (data.size() % 64 != 56) {
+        data.push_back(0);
+    }
+    for (int i = 7; i >= 0; i--) {
+        data.push_back(static_cast<uint8_t>(bitLength >> (i * 8)));
+    }
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t(data[chunk + 4 * i]) << 24) | (uint32_t(data[chunk + 4 * i + 1]) << 16) |
+                   (uint32_t(data[chunk + 4 * i + 2]) << 8) | uint32_t(data[chunk + 4 * i + 3]);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 5; i++) {
+        digest[4 * i] = static_cast<uint8_t>(h[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(h[i]);
+    }
+    return digest;
+}
+}  // namespace
+
+std::string base64Encode(const uint8_t* data, size_t size) {
+    static const char* table =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t triple = uint32_t(data[i]) << 16;
+        if (i + 1 < size) triple |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) triple |= data[i + 2];
+
+        out.push_back(table[(triple >> 18) & 0x3F]);
+        out.push_back(table[(triple >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? table[(triple >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? table[triple & 0x3F] : '=');
+    }
+    return out;
+}
+
+size_t encodeWsHeader(uint8_t* out, WsOpcode opcode, uint64_t payloadSize) {
+    out[0] = 0x80 | static_cast<uint8_t>(opcode);  // FIN + opcode
+
+    if (payloadSize < 126) {
+        out[1] = static_cast<uint8_t>(payloadSize);
+        return 2;
+    }
+
+    if (payloadSize <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = static_cast<uint8_t>(payloadSize >> 8);
+        out[3] = static_cast<uint8_t>(payloadSize);
+        return 4;
+    }
+
+    out[1] = 127;
+    for (int i = 0; i < 8; i++) {
+        out[2 + i] = static_cast<uint8_t>(payloadSize >> (56 - 8 * i));
+    }
+    return 10;
+}
+
+void encodeFrameHeader(uint8_t* out, uint32_t frameId, uint16_t streamType, uint16_t flags) {
+    out[0] = frameId & 0xFF;
+    out[1] = (frameId >> 8) & 0xFF;
+    out[2] = (frameId >> 16) & 0xFF;
+    out[3] = (frameId >> 24) & 0xFF;
+    out[4] = streamType & 0xFF;
+    out[5] = (streamType >> 8) & 0xFF;
+    out[6] = flags & 0xFF;
+    out[7] = (flags >> 8) & 0xFF;
+}
+
+FramedMessage::FramedMessage(WsOpcode opcode, std::vector<uint8_t> payload, bool framed)
+    : opcode_(opcode), payload_(std::move(payload)), data_(payload_.data()), size_(payload_.size()) {
+    if (framed) {
+        headerSize_ = encodeWsHeader(header_.data(), opcode_, size_);
+    }
+}
+
+FramedMessage::FramedMessage(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+    : opcode_(WsOpcode::Binary), owner_(std::move(owner)), data_(data), size_(size) {
+    headerSize_ = encodeWsHeader(header_.data(), opcode_, size_);
+}
+
+SharedFrame FramedMessage::binaryFrame(uint16_t streamType, uint32_t frameId,
+                                       const uint8_t* data, size_t size, uint16_t flags) {
+    std::vector<uint8_t> payload(FRAME_HEADER_SIZE + size);
+    encodeFrameHeader(payload.data(), frameId, streamType, flags);
+    if (size > 0) {
+        std::memcpy(payload.data() + FRAME_HEADER_SIZE, data, size);
+    }
+    return binary(std::move(payload));
+}
+
+SharedFrame FramedMessage::binary(std::vector<uint8_t> payload) {
+    return SharedFrame(new FramedMessage(WsOpcode::Binary, std::move(payload)));
+}
+
+SharedFrame FramedMessage::binaryView(std::shared_ptr<const void> owner, const uint8_t* data, size_t size) {
+    return SharedFrame(new FramedMessage(std::move(owner), data, size));
+}
+
+SharedFrame FramedMessage::text(const std::string& payload) {
+    return SharedFrame(new FramedMessage(WsOpcode::Text,
+                                         std::vector<uint8_t>(payload.begin(), payload.end())));
+}
+
+SharedFrame FramedMessage::control(WsOpcode opcode, std::vector<uint8_t> payload) {
+    if (payload.size() > 125) {
+        payload.resize(125);
+    }
+    return SharedFrame(new FramedMessage(opcode, std::move(payload)));
+}
+
+SharedFrame FramedMessage::raw(std::vector<uint8_t> bytes) {
+    return SharedFrame(new FramedMessage(WsOpcode::Continuation, std::move(bytes), false));
+}
+
+ssize_t writeFramedMessage(int fd, const FramedMessage& message, size_t offset,
+                           int passFd) {
+    struct iovec iov[2];
+    int iovCount = 0;
+    bool attachFd = passFd >= 0 && offset == 0;
+
+    if (offset < message.headerSize()) {
+        iov[iovCount].iov_base = const_cast<uint8_t*>(message.header() + offset);
+        iov[iovCount].iov_len = message.headerSize() - offset;
+        iovCount++;
+        offset = 0;
+    } else {
+        offset -= message.headerSize();
+    }
+
+    if (offset < message.payloadSize()) {
+        iov[iovCount].iov_base = const_cast<uint8_t*>(message.payload() + offset);
+        iov[iovCount].iov_len = message.payloadSize() - offset;
+        iovCount++;
+    }
+
+    if (iovCount == 0) {
+        return 0;
+    }
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovCount;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (attachFd) {
+        std::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &passFd, sizeof(int));
+    }
+
+    ssize_t written;
+    do {
+        written = ::sendmsg(fd, &msg, SEND_FLAGS);
+    } while (written < 0 && errno == EINTR);
+
+    if (written < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    return written;
+}
+
+std::string computeWsAcceptKey(const std::string& clientKey) {
+    auto digest = sha1(clientKey + WS_GUID);
+    return base64Encode(digest.data(), digest.size());
+}
+
+WsFrameParser::WsFrameParser(bool expectMasked, size_t maxMessageSize)
+    : expectMasked_(expectMasked), maxMessageSize_(maxMessageSize) {}
+
+void WsFrameParser::append(const uint8_t* data, size_t size) {
+    // Drop consumed bytes before growing the buffer
+    if (readPos_ > 0 && readPos_ == buffer_.size()) {
+        buffer_.clear();
+        readPos_ = 0;
+    } else if (readPos_ > 4096 && readPos_ * 2 > buffer_.size()) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + readPos_);
+        readPos_ = 0;
+    }
+    buffer_.insert(buffer_.end(), data, data + size);
+}
+
+bool WsFrameParser::next(WsMessage& out) {
+    while (!failed_) {
+        size_t available = buffer_.size() - readPos_;
+        if (available < 2) {
+            return false;
+        }
+
+        const uint8_t* p = buffer_.data() + readPos_;
+        bool fin = (p[0] & 0x80) != 0;
+        uint8_t rsv = p[0] & 0x70;
+        auto opcode = static_cast<WsOpcode>(p[0] & 0x0F);
+        bool masked = (p[1] & 0x80) != 0;
+        uint64_t length = p[1] & 0x7F;
+        size_t headerSize = 2;
+
+        // No extensions are negotiated, and clients must mask
+        if (rsv != 0 || masked != expectMasked_) {
+            failed_ = true;
+            return false;
+        }
+
+        if (length == 126) {
+            if (available < 4) return false;
+            length = (uint64_t(p[2]) << 8) | p[3];
+            headerSize = 4;
+        } else if (length == 127) {
+            if (available < 10) return false;
+            // RFC 6455: the most significant bit of a 64-bit length must be 0
+            if (p[2] & 0x80) {
+                failed_ = true;
+                return false;
+            }
+            length = 0;
+            for (int i = 0; i < 8; i++) {
+                length = (length << 8) | p[2 + i];
+            }
+            headerSize = 10;
+        }
+
+        // Compare without adding: a declared length near 2^64 must not wrap
+        bool isControl = (static_cast<uint8_t>(opcode) & 0x08) != 0;
+        if ((isControl && (!fin || length > 125)) || length > maxMessageSize_ ||
+            fragments_.size() > maxMessageSize_ - length) {
+            failed_ = true;
+            return false;
+        }
+
+        size_t maskOffset = headerSize;
+        if (masked) {
+            headerSize += 4;
+        }
+        if (available < headerSize || available - headerSize < length) {
+            return false;
+        }
+
+        std::string payload(reinterpret_cast<const char*>(p + headerSize), length);
+        if (masked) {
+            const uint8_t* mask = p + maskOffset;
+            for (size_t i = 0; i < payload.size(); i++) {
+                payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+            }
+        }
+        readPos_ += headerSize + length;
+
+        if (isControl) {
+            out.opcode = opcode;
+            out.payload = std::move(payload);
+            return true;
+        }
+
+        if (opcode == WsOpcode::Continuation) {
+            if (!fragmenting_) {
+                failed_ = true;
+                return false;
+            }
+            fragments_ += payload;
+        } else if (opcode == WsOpcode::Text || opcode == WsOpcode::Binary) {
+            if (fragmenting_) {
+                failed_ = true;
+                return false;
+            }
+            fragmentOpcode_ = opcode;
+            fragments_ = std::move(payload);
+            fragmenting_ = true;
+        } else {
+            failed_ = true;
+            return false;
+        }
+
+        if (fin) {
+            out.opcode = fragmentOpcode_;
+            out.payload = std::move(fragments_);
+            fragments_.clear();
+            fragmenting_ = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace kinect_xr
@@ -4,6 +4,7 @@
  */
 
 #include "kinect_xr/device.h"
+#include "kinect_xr/trace_event.h"
 
 #include <libfreenect/libfreenect.h>
 
@@ -197,6 +198,7 @@ DeviceError KinectDevice::startStreams() {
 
 void KinectDevice::eventLoop() {
   std::cout << "USB event loop started" << std::endl;
+  KINECT_XR_TRACE_THREAD("usb events");
 
   // Suppress libfreenect USB error spam by redirecting stderr
   // (libfreenect logs "Invalid magic" errors that are non-fatal)
@@ -210,6 +212,8 @@ void KinectDevice::eventLoop() {
   int errorsSinceLastLog = 0;
 
   while (eventThreadRunning_) {
+    // Depth and video callbacks run inside this call
+    KINECT_XR_TRACE_SCOPE("device", "freenect_process_events");
     if (freenect_process_events(ctx_) < 0) {
       errorsSinceLastLog++;
 
@@ -271,6 +275,7 @@ DeviceError KinectDevice::stopStreams() {
 
 // Static callback functions for libfreenect
 void KinectDevice::depthCallback(freenect_device* dev, void* depth, uint32_t timestamp) {
+  KINECT_XR_TRACE_SCOPE_ARG("device", "depthCallback", "timestamp", timestamp);
   // Get the KinectDevice instance from user data
   KinectDevice* device = static_cast<KinectDevice*>(freenect_get_user(dev));
   if (!device) {
@@ -284,6 +289,7 @@ void KinectDevice::depthCallback(freenect_device* dev, void* depth, uint32_t tim
 }
 
 void KinectDevice::videoCallback(freenect_device* dev, void* rgb, uint32_t timestamp) {
+  KINECT_XR_TRACE_SCOPE_ARG("device", "videoCallback", "timestamp", timestamp);
   // Get the KinectDevice instance from user data
   KinectDevice* device = static_cast<KinectDevice*>(freenect_get_user(dev));
   if (!device) {
@@ -315,7 +321,7 @@ DeviceError KinectDevice::setTiltAngle(double degrees) {
   if (clamped > 27.0) clamped = 27.0;
 
   // Set tilt using libfreenect (thread-safe)
-  std::lock_guard<std::mutex> lock(deviceMutex_);
+  std::lock_guard<NamedMutex> lock(deviceMutex_);
   int result = freenect_set_tilt_degs(dev_, clamped);
   if (result < 0) {
     return DeviceError::MotorControlFailed;
@@ -330,7 +336,7 @@ DeviceError KinectDevice::getTiltAngle(double& outAngle) {
   }
 
   // Update tilt state (thread-safe)
-  std::lock_guard<std::mutex> lock(deviceMutex_);
+  std::lock_guard<NamedMutex> lock(deviceMutex_);
   if (freenect_update_tilt_state(dev_) < 0) {
     return DeviceError::MotorControlFailed;
   }
@@ -376,7 +382,7 @@ DeviceError KinectDevice::setLED(LEDState state) {
   }
 
   // Set LED using libfreenect (thread-safe)
-  std::lock_guard<std::mutex> lock(deviceMutex_);
+  std::lock_guard<NamedMutex> lock(deviceMutex_);
   int result = freenect_set_led(dev_, led_option);
   if (result < 0) {
     return DeviceError::MotorControlFailed;
@@ -391,7 +397,7 @@ DeviceError KinectDevice::getMotorStatus(MotorStatus& outStatus) {
   }
 
   // Update tilt state (thread-safe)
-  std::lock_guard<std::mutex> lock(deviceMutex_);
+  std::lock_guard<NamedMutex> lock(deviceMutex_);
   if (freenect_update_tilt_state(dev_) < 0) {
     return DeviceError::MotorControlFailed;
   }
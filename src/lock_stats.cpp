@@ -0,0 +1,69 @@
+/**
+ * @file lock_stats.cpp
+ * @brief Process-wide registry of per-name lock statistics
+ */
+
+#include "kinect_xr/lock_stats.h"
+
+#include <cstring>
+#include <memory>
+
+namespace kinect_xr {
+
+namespace {
+void raiseMax(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+struct LockStatsRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<LockStats>> entries;
+};
+
+// Never destroyed: locks in other static objects may still report during exit
+LockStatsRegistry& registry() {
+    static LockStatsRegistry* instance = new LockStatsRegistry();
+    return *instance;
+}
+}  // namespace
+
+void LockStats::onAcquired(uint64_t waitedNs, bool wasContended) {
+    acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (wasContended) {
+        contended.fetch_add(1, std::memory_order_relaxed);
+        waitNs.fetch_add(waitedNs, std::memory_order_relaxed);
+        raiseMax(maxWaitNs, waitedNs);
+    }
+}
+
+void LockStats::onReleased(uint64_t heldNs) {
+    holdNs.fetch_add(heldNs, std::memory_order_relaxed);
+    raiseMax(maxHoldNs, heldNs);
+}
+
+LockStats& LockStats::named(const char* name) {
+    LockStatsRegistry& stats = registry();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    for (const auto& entry : stats.entries) {
+        if (std::strcmp(entry->name.c_str(), name) == 0) {
+            return *entry;
+        }
+    }
+    stats.entries.push_back(std::make_unique<LockStats>(name));
+    return *stats.entries.back();
+}
+
+std::vector<const LockStats*> LockStats::all() {
+    LockStatsRegistry& stats = registry();
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    std::vector<const LockStats*> out;
+    out.reserve(stats.entries.size());
+    for (const auto& entry : stats.entries) {
+        out.push_back(entry.get());
+    }
+    return out;
+}
+
+}  // namespace kinect_xr
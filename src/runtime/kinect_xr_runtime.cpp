@@ -1,8 +1,10 @@
 #include "kinect_xr/runtime.h"
 #include "kinect_xr/metal_helper.h"
 #include "kinect_xr/device.h"
+#include "kinect_xr/trace_event.h"
 #include <openxr/openxr_platform.h>
 #include <cstring>
+#include <cstdlib>
 #include <chrono>
 #include <thread>
 
@@ -64,6 +66,11 @@ XrResult KinectXRRuntime::createInstance(const XrInstanceCreateInfo* createInfo,
         }
     }
 
+    // KINECT_XR_TRACE=N records trace events (one slice in N) until the instance is destroyed
+    if (TraceRecorder::instance().startFromEnvironment()) {
+        TraceRecorder::instance().setProcessName("kinect_xr_runtime");
+    }
+
     // Create instance handle (use pointer to InstanceData as handle)
     std::lock_guard<std::mutex> lock(instanceMutex_);
 
@@ -93,6 +100,13 @@ XrResult KinectXRRuntime::destroyInstance(XrInstance instance) {
     }
 
     instances_.erase(it);
+
+    // Written to KINECT_XR_TRACE_FILE; open in chrome://tracing or ui.perfetto.dev
+    TraceRecorder& tracer = TraceRecorder::instance();
+    if (tracer.enabled()) {
+        const char* path = std::getenv("KINECT_XR_TRACE_FILE");
+        tracer.dump(path ? path : "kinect-xr-trace.json");
+    }
     return XR_SUCCESS;
 }
 
@@ -236,7 +250,7 @@ XrResult KinectXRRuntime::createSession(XrInstance instance, const XrSessionCrea
 
     // Only allow one session per instance
     {
-        std::lock_guard<std::mutex> lock(sessionMutex_);
+        std::lock_guard<NamedMutex> lock(sessionMutex_);
         for (const auto& [handle, sessionData] : sessions_) {
             if (sessionData->instance == instance) {
                 return XR_ERROR_LIMIT_REACHED;
@@ -245,7 +259,7 @@ XrResult KinectXRRuntime::createSession(XrInstance instance, const XrSessionCrea
     }
 
     // Create session handle
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     XrSession handle = reinterpret_cast<XrSession>(nextSessionId_++);
 
     auto sessionData = std::make_unique<SessionData>(handle, instance, createInfo->systemId);
@@ -271,7 +285,7 @@ XrResult KinectXRRuntime::createSession(XrInstance instance, const XrSessionCrea
 }
 
 XrResult KinectXRRuntime::destroySession(XrSession session) {
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
 
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
@@ -291,12 +305,12 @@ XrResult KinectXRRuntime::destroySession(XrSession session) {
 }
 
 bool KinectXRRuntime::isValidSession(XrSession session) const {
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     return sessions_.find(session) != sessions_.end();
 }
 
 SessionData* KinectXRRuntime::getSessionData(XrSession session) {
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
 
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
@@ -315,7 +329,7 @@ XrResult KinectXRRuntime::beginSession(XrSession session, const XrSessionBeginIn
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> sessionLock(sessionMutex_);
+    std::lock_guard<NamedMutex> sessionLock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -352,7 +366,8 @@ XrResult KinectXRRuntime::beginSession(XrSession session, const XrSessionBeginIn
 
     // Register callbacks to populate frame cache
     sessionData->kinectDevice->setDepthCallback([sessionData](const void* depth, uint32_t timestamp) {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        KINECT_XR_TRACE_SCOPE("runtime", "cacheDepth");
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         // Copy depth data (640x480 uint16_t)
         const uint16_t* depthData = static_cast<const uint16_t*>(depth);
         std::copy(depthData, depthData + (640 * 480), sessionData->frameCache.depthData.begin());
@@ -361,7 +376,8 @@ XrResult KinectXRRuntime::beginSession(XrSession session, const XrSessionBeginIn
     });
 
     sessionData->kinectDevice->setVideoCallback([sessionData](const void* rgb, uint32_t timestamp) {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        KINECT_XR_TRACE_SCOPE("runtime", "cacheRgb");
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         // Copy RGB data (640x480x3 uint8_t)
         const uint8_t* rgbData = static_cast<const uint8_t*>(rgb);
         std::copy(rgbData, rgbData + (640 * 480 * 3), sessionData->frameCache.rgbData.begin());
@@ -394,7 +410,7 @@ XrResult KinectXRRuntime::beginSession(XrSession session, const XrSessionBeginIn
 }
 
 XrResult KinectXRRuntime::endSession(XrSession session) {
-    std::lock_guard<std::mutex> sessionLock(sessionMutex_);
+    std::lock_guard<NamedMutex> sessionLock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -572,12 +588,12 @@ XrResult KinectXRRuntime::getMetalGraphicsRequirements(XrInstance instance, XrSy
 }
 
 bool KinectXRRuntime::isValidSwapchain(XrSwapchain swapchain) const {
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     return swapchains_.find(swapchain) != swapchains_.end();
 }
 
 SwapchainData* KinectXRRuntime::getSwapchainData(XrSwapchain swapchain) {
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
 
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
@@ -683,7 +699,7 @@ XrResult KinectXRRuntime::createSwapchain(XrSession session, const XrSwapchainCr
     }
 
     // Create swapchain handle
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     XrSwapchain handle = reinterpret_cast<XrSwapchain>(nextSwapchainId_++);
 
     auto swapchainData = std::make_unique<SwapchainData>(
@@ -718,7 +734,7 @@ XrResult KinectXRRuntime::createSwapchain(XrSession session, const XrSwapchainCr
 }
 
 XrResult KinectXRRuntime::destroySwapchain(XrSwapchain swapchain) {
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
 
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
@@ -743,7 +759,7 @@ XrResult KinectXRRuntime::enumerateSwapchainImages(XrSwapchain swapchain, uint32
     }
 
     // Validate swapchain
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -792,7 +808,7 @@ XrResult KinectXRRuntime::acquireSwapchainImage(XrSwapchain swapchain, const XrS
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -816,6 +832,7 @@ XrResult KinectXRRuntime::acquireSwapchainImage(XrSwapchain swapchain, const XrS
 }
 
 XrResult KinectXRRuntime::waitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
+    KINECT_XR_TRACE_SCOPE("runtime", "waitSwapchainImage");
     if (!waitInfo) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
@@ -824,7 +841,7 @@ XrResult KinectXRRuntime::waitSwapchainImage(XrSwapchain swapchain, const XrSwap
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -844,9 +861,11 @@ XrResult KinectXRRuntime::waitSwapchainImage(XrSwapchain swapchain, const XrSwap
         // Upload RGB or depth based on swapchain format
         if (data->format == 80) {
             // Color swapchain - upload RGB
+            KINECT_XR_TRACE_SCOPE("runtime", "uploadRGBTexture");
             uploadRGBTexture(sessionData, data);
         } else if (data->format == 13) {
             // Depth swapchain - upload depth
+            KINECT_XR_TRACE_SCOPE("runtime", "uploadDepthTexture");
             uploadDepthTexture(sessionData, data);
         }
     }
@@ -867,7 +886,7 @@ XrResult KinectXRRuntime::releaseSwapchainImage(XrSwapchain swapchain, const XrS
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(swapchainMutex_);
+    std::lock_guard<NamedMutex> lock(swapchainMutex_);
     auto it = swapchains_.find(swapchain);
     if (it == swapchains_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -887,6 +906,7 @@ XrResult KinectXRRuntime::releaseSwapchainImage(XrSwapchain swapchain, const XrS
 }
 
 XrResult KinectXRRuntime::waitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
+    KINECT_XR_TRACE_SCOPE("runtime", "waitFrame");
     if (!frameWaitInfo || !frameState) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
@@ -899,7 +919,7 @@ XrResult KinectXRRuntime::waitFrame(XrSession session, const XrFrameWaitInfo* fr
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -926,6 +946,7 @@ XrResult KinectXRRuntime::waitFrame(XrSession session, const XrFrameWaitInfo* fr
 
         // Sleep if we're rendering too fast
         if (elapsed < targetFrameTime) {
+            KINECT_XR_TRACE_SCOPE("runtime", "pace");
             std::this_thread::sleep_for(targetFrameTime - elapsed);
             now = std::chrono::steady_clock::now();
         }
@@ -945,6 +966,7 @@ XrResult KinectXRRuntime::waitFrame(XrSession session, const XrFrameWaitInfo* fr
 }
 
 XrResult KinectXRRuntime::beginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) {
+    KINECT_XR_TRACE_SCOPE("runtime", "beginFrame");
     if (!frameBeginInfo) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
@@ -953,7 +975,7 @@ XrResult KinectXRRuntime::beginFrame(XrSession session, const XrFrameBeginInfo*
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -980,6 +1002,7 @@ XrResult KinectXRRuntime::beginFrame(XrSession session, const XrFrameBeginInfo*
 }
 
 XrResult KinectXRRuntime::endFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
+    KINECT_XR_TRACE_SCOPE("runtime", "endFrame");
     if (!frameEndInfo) {
         return XR_ERROR_VALIDATION_FAILURE;
     }
@@ -988,7 +1011,7 @@ XrResult KinectXRRuntime::endFrame(XrSession session, const XrFrameEndInfo* fram
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
@@ -1089,7 +1112,7 @@ XrResult KinectXRRuntime::locateViews(XrSession session, const XrViewLocateInfo*
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    std::lock_guard<std::mutex> lock(sessionMutex_);
+    std::lock_guard<NamedMutex> lock(sessionMutex_);
     auto it = sessions_.find(session);
     if (it == sessions_.end()) {
         return XR_ERROR_HANDLE_INVALID;
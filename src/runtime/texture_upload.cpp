@@ -49,7 +49,7 @@ bool uploadRGBTexture(SessionData* sessionData, SwapchainData* swapchainData) {
     bool hasRGB = false;
     std::vector<uint8_t> rgbCopy;
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         if (sessionData->frameCache.rgbValid) {
             hasRGB = true;
             rgbCopy = sessionData->frameCache.rgbData;  // Copy to avoid holding lock during upload
@@ -104,7 +104,7 @@ bool uploadDepthTexture(SessionData* sessionData, SwapchainData* swapchainData)
     bool hasDepth = false;
     std::vector<uint16_t> depthCopy;
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         if (sessionData->frameCache.depthValid) {
             hasDepth = true;
             depthCopy = sessionData->frameCache.depthData;  // Copy to avoid holding lock during upload
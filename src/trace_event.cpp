@@ -0,0 +1,275 @@
+/**
+ * @file trace_event.cpp
+ * @brief Per-thread trace rings and trace-event JSON export
+ */
+
+#include "kinect_xr/trace_event.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace kinect_xr {
+
+/**
+ * @brief The calling thread's ring, attached on first record
+ *
+ * Rings are shared with the recorder so a thread's events can still be
+ * dumped after it exits.
+ */
+struct TraceThreadSlot {
+    std::shared_ptr<TraceRecorder::ThreadRing> ring;
+    std::string pendingName;
+
+    ~TraceThreadSlot() {
+        if (ring) {
+            TraceRecorder::instance().retire(ring);
+        }
+    }
+};
+
+namespace {
+thread_local TraceThreadSlot t_slot;
+
+void appendEscaped(std::string& out, const char* text) {
+    for (const char* c = text; *c; c++) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (ch < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", ch);
+            out += buffer;
+        } else {
+            out += *c;
+        }
+    }
+}
+
+// Trace-event timestamps are microseconds; keep the nanoseconds as a fraction
+void appendMicros(std::string& out, uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out += buffer;
+}
+
+void appendMetadata(std::string& out, const char* kind, int pid, uint32_t tid, const std::string& name) {
+    out += "{\"ph\":\"M\",\"name\":\"";
+    out += kind;
+    out += "\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":\"";
+    appendEscaped(out, name.c_str());
+    out += "\"}}";
+}
+}  // namespace
+
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::start(uint32_t sampleEvery) {
+    sampleEvery_.store(std::max<uint32_t>(sampleEvery, 1), std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::stop() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+bool TraceRecorder::startFromEnvironment() {
+    const char* value = std::getenv("KINECT_XR_TRACE");
+    if (!value) {
+        return false;
+    }
+    int every = std::atoi(value);
+    if (every <= 0) {
+        return false;
+    }
+    start(static_cast<uint32_t>(every));
+    return true;
+}
+
+TraceRecorder::ThreadRing& TraceRecorder::ring() {
+    if (!t_slot.ring) {
+        t_slot.ring = attach();
+    }
+    return *t_slot.ring;
+}
+
+std::shared_ptr<TraceRecorder::ThreadRing> TraceRecorder::attach() {
+    auto ring = std::make_shared<ThreadRing>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring->tid = nextTid_++;
+    ring->name = t_slot.pendingName;
+    rings_.push_back(ring);
+    return ring;
+}
+
+void TraceRecorder::retire(const std::shared_ptr<ThreadRing>& ring) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring->retired = true;
+
+    // Short-lived threads (per-connection I/O) would otherwise grow the list forever
+    size_t retired = static_cast<size_t>(
+        std::count_if(rings_.begin(), rings_.end(), [](const auto& entry) { return entry->retired; }));
+    for (auto it = rings_.begin(); it != rings_.end() && retired > MAX_RETIRED_RINGS;) {
+        if ((*it)->retired) {
+            it = rings_.erase(it);
+            retired--;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TraceRecorder::record(const char* category, const char* name, uint64_t startNs, uint64_t endNs,
+                           const char* argName, int64_t arg) {
+    ThreadRing& target = ring();
+    uint64_t index = target.head.load(std::memory_order_relaxed);
+    Slot& slot = target.slots[index % target.slots.size()];
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.argName.store(argName, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs > startNs ? endNs - startNs : 0, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    target.head.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::setThreadName(const char* name) {
+    t_slot.pendingName = name;
+    if (t_slot.ring) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        t_slot.ring->name = name;
+    }
+}
+
+void TraceRecorder::setProcessName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    processName_ = name;
+}
+
+void TraceRecorder::readRing(const ThreadRing& ring, std::vector<Event>& out) {
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = std::max(ring.floor.load(std::memory_order_relaxed),
+                              head > RING_CAPACITY ? head - RING_CAPACITY : 0);
+    size_t begin = out.size();
+    for (uint64_t index = first; index < head; index++) {
+        const Slot& slot = ring.slots[index % ring.slots.size()];
+        out.push_back(Event{slot.category.load(std::memory_order_relaxed), slot.name.load(std::memory_order_relaxed),
+                            slot.argName.load(std::memory_order_relaxed),
+                            slot.startNs.load(std::memory_order_relaxed),
+                            slot.durationNs.load(std::memory_order_relaxed),
+                            slot.arg.load(std::memory_order_relaxed)});
+    }
+
+    // Drop slots the writer may have started reusing while they were copied;
+    // the spare slot means an idle writer never invalidates any
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = ring.head.load(std::memory_order_relaxed);
+    uint64_t safe = after > RING_CAPACITY ? after - RING_CAPACITY : 0;
+    if (safe > first) {
+        size_t stale = static_cast<size_t>(std::min(safe - first, head - first));
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(begin),
+                  out.begin() + static_cast<std::ptrdiff_t>(begin + stale));
+    }
+}
+
+size_t TraceRecorder::eventCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& ring : rings_) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t floor = ring->floor.load(std::memory_order_relaxed);
+        count += static_cast<size_t>(std::min<uint64_t>(head - std::min(head, floor), RING_CAPACITY));
+    }
+    return count;
+}
+
+uint64_t TraceRecorder::droppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t dropped = 0;
+    for (const auto& ring : rings_) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t held = head - std::min(head, ring->floor.load(std::memory_order_relaxed));
+        dropped += held > RING_CAPACITY ? held - RING_CAPACITY : 0;
+    }
+    return dropped;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& ring : rings_) {
+        ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+std::string TraceRecorder::chromeJson() const {
+    const int pid = static_cast<int>(getpid());
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&out, &first]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!processName_.empty()) {
+        separate();
+        appendMetadata(out, "process_name", pid, 0, processName_);
+    }
+
+    std::vector<Event> events;
+    for (const auto& ring : rings_) {
+        if (!ring->name.empty()) {
+            separate();
+            appendMetadata(out, "thread_name", pid, ring->tid, ring->name);
+        }
+
+        events.clear();
+        readRing(*ring, events);
+        for (const Event& event : events) {
+            separate();
+            out += "{\"ph\":\"X\",\"cat\":\"";
+            appendEscaped(out, event.category ? event.category : "");
+            out += "\",\"name\":\"";
+            appendEscaped(out, event.name ? event.name : "");
+            out += "\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(ring->tid) + ",\"ts\":";
+            appendMicros(out, event.startNs);
+            out += ",\"dur\":";
+            appendMicros(out, event.durationNs);
+            if (event.argName) {
+                out += ",\"args\":{\"";
+                appendEscaped(out, event.argName);
+                out += "\":" + std::to_string(event.arg) + "}";
+            }
+            out += "}";
+        }
+    }
+    out += "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"sample_every\":" +
+           std::to_string(sampleEvery()) + "}}\n";
+    return out;
+}
+
+bool TraceRecorder::dump(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+    std::string json = chromeJson();
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (!file) {
+        std::cerr << "Failed to write trace file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace kinect_xr
@@ -121,7 +121,7 @@ TEST_F(KinectIntegrationTest, Callbacks_PopulateFrameCache) {
 
     // Check frame cache
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
 
         // Depth should be valid (depth is more reliable than RGB)
         EXPECT_TRUE(sessionData->frameCache.depthValid);
@@ -157,7 +157,7 @@ TEST_F(KinectIntegrationTest, Callbacks_UpdateFrameCache) {
 
     uint32_t firstDepthTimestamp = 0;
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         firstDepthTimestamp = sessionData->frameCache.depthTimestamp;
     }
 
@@ -166,7 +166,7 @@ TEST_F(KinectIntegrationTest, Callbacks_UpdateFrameCache) {
 
     // Depth timestamps should have updated (if Kinect is delivering frames)
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         if (sessionData->frameCache.depthTimestamp > firstDepthTimestamp) {
             std::cout << "Depth frame updated successfully" << std::endl;
         } else {
@@ -199,7 +199,7 @@ TEST_F(KinectIntegrationTest, DepthData_ValidRange) {
     // Note: device.cpp uses FREENECT_DEPTH_MM which returns millimeter values (0-10000mm)
     // not 11-bit raw disparity (0-2047)
     {
-        std::lock_guard<std::mutex> lock(sessionData->frameCache.mutex);
+        std::lock_guard<NamedMutex> lock(sessionData->frameCache.mutex);
         ASSERT_TRUE(sessionData->frameCache.depthValid);
 
         int count_out_of_range = 0;
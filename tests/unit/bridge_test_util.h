@@ -0,0 +1,208 @@
+/**
+ * @file bridge_test_util.h
+ * @brief Shared helpers for tests that run a bridge and talk to it over loopback
+ *
+ * Bridges listen on ports the kernel hands out for port 0, so concurrent
+ * test runs never compete for a fixed port range.
+ *
+ * Usage:
+ *   BridgeServer server;
+ *   const int port = startMockBridge(server);
+ *   ASSERT_GT(port, 0);
+ *   WsClient client;
+ *   ASSERT_TRUE(connectClient(client, port));
+ *   auto frames = subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth"]})", 2);
+ */
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/ws_client.h"
+
+namespace kinect_xr {
+namespace test_util {
+
+inline uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLe32(const uint8_t* p) {
+    return readLe16(p) | (static_cast<uint32_t>(readLe16(p + 2)) << 16);
+}
+
+/**
+ * @brief A loopback port the kernel just assigned to a socket bound to port 0
+ * @return The port, or -1 on failure
+ */
+inline int freePort() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t length = sizeof(addr);
+    int port = -1;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) == 0) {
+        port = ntohs(addr.sin_port);
+    }
+    ::close(fd);
+    return port;
+}
+
+inline std::string bridgeUrl(int port) {
+    return "ws://127.0.0.1:" + std::to_string(port) + "/kinect";
+}
+
+/**
+ * @brief Start `server` on the reactor transport (one I/O thread) and a free port
+ *
+ * Configure everything else (history, relay, ...) before calling.
+ * @return The port, or -1 if the server did not start
+ */
+inline int startBridge(BridgeServer& server) {
+    server.setTransport(TransportKind::Reactor, 1);
+    // Another process may take the port between freePort() and start()
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int port = freePort();
+        if (port > 0 && server.start(port)) {
+            return port;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief startBridge() with the built-in mock camera
+ */
+inline int startMockBridge(BridgeServer& server) {
+    server.setMockMode(true);
+    return startBridge(server);
+}
+
+inline bool connectClient(WsClient& client, int port) {
+    return client.connect(bridgeUrl(port));
+}
+
+/**
+ * @brief Next message with the given opcode; messages of other opcodes are skipped
+ */
+inline bool nextOf(WsClient& client, WsOpcode opcode, WsMessage& message, int timeoutMs = 3000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (client.next(message, 200) && message.opcode == opcode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Next JSON text message whose "type" is `type`; anything else is skipped
+ */
+inline bool nextOfType(WsClient& client, const std::string& type, nlohmann::json& out, int timeoutMs = 3000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    WsMessage message;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!client.next(message, 200) || message.opcode != WsOpcode::Text) {
+            continue;
+        }
+        out = nlohmann::json::parse(message.payload, nullptr, false);
+        if (out.is_object() && out.value("type", "") == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Send a subscribe message, then collect the next `count` binary messages
+ * @return Fewer than `count` messages if they did not all arrive in time
+ */
+inline std::vector<WsMessage> subscribeAndCollect(WsClient& client, const std::string& subscribe, size_t count,
+                                                  int timeoutMs = 3000) {
+    std::vector<WsMessage> frames;
+    if (!client.sendText(subscribe)) {
+        return frames;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    WsMessage message;
+    while (frames.size() < count && std::chrono::steady_clock::now() < deadline) {
+        if (client.next(message, 200) && message.opcode == WsOpcode::Binary) {
+            frames.push_back(std::move(message));
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief True if the bridge answers `request` with an error message
+ */
+inline bool rejects(WsClient& client, const std::string& request) {
+    nlohmann::json error;
+    return client.sendText(request) && nextOfType(client, "error", error, 2000);
+}
+
+/**
+ * @brief TCP connection to a loopback port with a 2 s receive timeout, or -1
+ */
+inline int connectLoopback(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+inline bool sendGet(int fd, const std::string& path) {
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    return ::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size());
+}
+
+/**
+ * @brief Plain HTTP GET; reads until the server closes the connection
+ */
+inline std::string httpGet(int port, const std::string& path) {
+    int fd = connectLoopback(port);
+    if (fd < 0) {
+        return "";
+    }
+    std::string response;
+    if (sendGet(fd, path)) {
+        char buffer[65536];
+        ssize_t n;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            response.append(buffer, static_cast<size_t>(n));
+        }
+    }
+    ::close(fd);
+    return response;
+}
+
+}  // namespace test_util
+}  // namespace kinect_xr
@@ -0,0 +1,132 @@
+/**
+ * @file client_registry_test.cpp
+ * @brief Unit tests for the copy-on-write client registry
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "kinect_xr/client_registry.h"
+
+using namespace kinect_xr;
+
+namespace {
+
+class FakeClient : public ClientConnection {
+public:
+    void sendText(const std::string&) override {}
+    void sendFrame(const SharedFrame&) override { frames++; }
+    size_t bufferedBytes() const override { return 0; }
+    void close() override {}
+    bool isOpen() const override { return true; }
+
+    std::atomic<int> frames{0};
+};
+
+ClientState subscribed(bool rgb, bool depth) {
+    ClientState state;
+    state.subscribedRgb = rgb;
+    state.subscribedDepth = depth;
+    return state;
+}
+
+}  // namespace
+
+TEST(ClientRegistryTest, StartsEmpty) {
+    ClientRegistry registry;
+    auto snapshot = registry.snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(registry.size(), 0u);
+    EXPECT_TRUE(snapshot->subscribersOf(STREAM_TYPE_RGB).empty());
+    EXPECT_TRUE(snapshot->subscribersOf(0x7FFF).empty());
+}
+
+TEST(ClientRegistryTest, AddAndRemoveReturnCount) {
+    ClientRegistry registry;
+    auto a = std::make_shared<FakeClient>();
+    auto b = std::make_shared<FakeClient>();
+
+    EXPECT_EQ(registry.add(a), 1u);
+    EXPECT_EQ(registry.add(b), 2u);
+    EXPECT_EQ(registry.add(a), 2u);  // Already registered
+    EXPECT_EQ(registry.remove(a), 1u);
+    EXPECT_EQ(registry.remove(a), 1u);  // Not registered
+    EXPECT_EQ(registry.remove(b), 0u);
+}
+
+TEST(ClientRegistryTest, SubscribersAreIndexedByStream) {
+    ClientRegistry registry;
+    auto rgbOnly = std::make_shared<FakeClient>();
+    auto depthOnly = std::make_shared<FakeClient>();
+    auto both = std::make_shared<FakeClient>();
+    registry.add(rgbOnly);
+    registry.add(depthOnly);
+    registry.add(both);
+
+    EXPECT_TRUE(registry.update(rgbOnly, subscribed(true, false)));
+    EXPECT_TRUE(registry.update(depthOnly, subscribed(false, true)));
+    EXPECT_TRUE(registry.update(both, subscribed(true, true)));
+
+    auto snapshot = registry.snapshot();
+    ASSERT_EQ(snapshot->subscribersOf(STREAM_TYPE_RGB).size(), 2u);
+    ASSERT_EQ(snapshot->subscribersOf(STREAM_TYPE_DEPTH).size(), 2u);
+    for (const ClientEntry* entry : snapshot->subscribersOf(STREAM_TYPE_DEPTH)) {
+        EXPECT_NE(entry->client, rgbOnly);
+        EXPECT_TRUE(entry->state.subscribedDepth);
+    }
+}
+
+TEST(ClientRegistryTest, UpdateUnknownClientFails) {
+    ClientRegistry registry;
+    auto client = std::make_shared<FakeClient>();
+    EXPECT_FALSE(registry.update(client, subscribed(true, true)));
+}
+
+TEST(ClientRegistryTest, SnapshotIsImmutable) {
+    ClientRegistry registry;
+    auto a = std::make_shared<FakeClient>();
+    registry.add(a);
+    registry.update(a, subscribed(false, true));
+
+    auto before = registry.snapshot();
+    registry.remove(a);
+
+    // The old snapshot still holds the client and its subscriptions
+    ASSERT_EQ(before->clients.size(), 1u);
+    EXPECT_EQ(before->subscribersOf(STREAM_TYPE_DEPTH).size(), 1u);
+    EXPECT_EQ(registry.snapshot()->clients.size(), 0u);
+}
+
+TEST(ClientRegistryTest, ConcurrentChurnDuringBroadcast) {
+    ClientRegistry registry;
+    auto stable = std::make_shared<FakeClient>();
+    registry.add(stable);
+    registry.update(stable, subscribed(false, true));
+
+    std::atomic<bool> done{false};
+    std::thread churn([&] {
+        for (int i = 0; i < 500; i++) {
+            auto client = std::make_shared<FakeClient>();
+            registry.add(client);
+            registry.update(client, subscribed(true, true));
+            registry.remove(client);
+        }
+        done = true;
+    });
+
+    int broadcasts = 0;
+    while (!done) {
+        auto snapshot = registry.snapshot();
+        for (const ClientEntry* entry : snapshot->subscribersOf(STREAM_TYPE_DEPTH)) {
+            entry->client->sendFrame(nullptr);
+        }
+        broadcasts++;
+    }
+    churn.join();
+
+    EXPECT_EQ(stable->frames, broadcasts);
+    EXPECT_EQ(registry.size(), 1u);
+}
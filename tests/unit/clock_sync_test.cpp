@@ -0,0 +1,139 @@
+/**
+ * @file clock_sync_test.cpp
+ * @brief Unit tests for client clock offset estimation
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/clock_sync.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+/**
+ * @brief Run one exchange against a client clock `offset` us behind the bridge
+ */
+bool exchange(ClockSync& sync, int64_t clientSend, int64_t offset, int64_t up, int64_t down,
+              int64_t processing = 50) {
+    int64_t t1 = clientSend + offset + up;
+    int64_t t2 = t1 + processing;
+    int64_t t3 = t2 - offset + down;
+    return sync.addSample(clientSend, t1, t2, t3);
+}
+
+}  // namespace
+
+TEST(ClockSyncTest, SymmetricPathGivesExactOffset) {
+    ClockSync sync;
+    EXPECT_FALSE(sync.estimate().valid);
+
+    ASSERT_TRUE(exchange(sync, 1'000'000, 250'000, 3000, 3000));
+    ClockEstimate estimate = sync.estimate();
+    ASSERT_TRUE(estimate.valid);
+    EXPECT_EQ(estimate.offsetUs, 250'000);
+    EXPECT_EQ(estimate.minRttUs, 6000u);
+    EXPECT_EQ(estimate.smoothedRttUs, 6000u);
+    EXPECT_EQ(estimate.samples, 1u);
+    EXPECT_EQ(sync.toBridgeUs(2'000'000), 2'250'000);
+}
+
+TEST(ClockSyncTest, PrefersTheFastestRecentExchange) {
+    ClockSync sync;
+    const int64_t offset = -40'000;  // Client clock ahead
+    exchange(sync, 1'000'000, offset, 2000, 2000);
+    // Queued uplink: a one-sided delay skews this sample by half of it
+    exchange(sync, 2'000'000, offset, 80'000, 2000);
+    ClockEstimate estimate = sync.estimate();
+    EXPECT_EQ(estimate.offsetUs, offset);
+    EXPECT_EQ(estimate.minRttUs, 4000u);
+    EXPECT_GT(estimate.smoothedRttUs, 4000u);
+    EXPECT_GT(estimate.jitterUs, 0u);
+
+    // Once the fast sample leaves the window the best remaining one is used
+    for (size_t i = 0; i < ClockSync::WINDOW; i++) {
+        exchange(sync, 3'000'000 + static_cast<int64_t>(i) * 1'000'000, offset, 5000, 3000);
+    }
+    estimate = sync.estimate();
+    EXPECT_EQ(estimate.minRttUs, 8000u);
+    EXPECT_EQ(estimate.offsetUs, offset + 1000);
+    EXPECT_EQ(estimate.samples, ClockSync::WINDOW + 2);
+}
+
+TEST(ClockSyncTest, RejectsInconsistentTimestamps) {
+    ClockSync sync;
+    EXPECT_FALSE(sync.addSample(1000, 5000, 6000, 1500));  // Bridge took longer than the round trip
+    EXPECT_FALSE(sync.addSample(1000, 6000, 5000, 9000));  // Replied before receiving
+    EXPECT_FALSE(sync.estimate().valid);
+
+    // Only the last reply can be completed, once
+    sync.replied(7, 1000, 2000, 2100);
+    EXPECT_FALSE(sync.complete(6, 3000));
+    EXPECT_TRUE(sync.complete(7, 3000));
+    EXPECT_FALSE(sync.complete(7, 3000));
+    EXPECT_EQ(sync.estimate().samples, 1u);
+    EXPECT_EQ(sync.estimate().minRttUs, 1900u);
+}
+
+TEST(BridgeClockSyncTest, StatusReportsClientClock) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    auto clientMs = []() {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - 1500.0;  // Client runs behind
+    };
+
+    nlohmann::json request = {{"type", "time.sync"}, {"id", 1}, {"t0", clientMs()}};
+    ASSERT_TRUE(client.sendText(request.dump()));
+    nlohmann::json reply;
+    ASSERT_TRUE(nextOfType(client, "time.sync", reply));
+    double t3 = clientMs();
+    EXPECT_EQ(reply["id"].get<int>(), 1);
+    EXPECT_EQ(reply["t0"].get<double>(), request["t0"].get<double>());
+    EXPECT_LE(reply["t1"].get<double>(), reply["t2"].get<double>());
+
+    request = {{"type", "time.sync"}, {"id", 2}, {"t0", clientMs()}, {"prev_id", 1}, {"prev_t3", t3}};
+    ASSERT_TRUE(client.sendText(request.dump()));
+    ASSERT_TRUE(nextOfType(client, "time.sync", reply));
+    ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+
+    nlohmann::json status;
+    ASSERT_TRUE(nextOfType(client, "status", status));
+    const auto& clock = status["clients"][0]["clock"];
+    ASSERT_TRUE(clock.is_object());
+    EXPECT_EQ(clock["samples"].get<int>(), 1);
+    EXPECT_NEAR(clock["offset_ms"].get<double>(), 1500.0, 50.0);
+    EXPECT_GE(clock["rtt_ms"].get<double>(), 0.0);
+
+    // Times outside the epoch window never reach the clock filter
+    for (const char* hostile : {R"({"type":"time.sync","id":3,"t0":1e300})",
+                                R"({"type":"time.sync","id":3,"t0":-5})",
+                                R"({"type":"time.sync","id":3,"t0":1,"prev_id":2,"prev_t3":1e400})",
+                                R"({"type":"ack","frame_id":1,"received_ms":9e18})",
+                                R"({"type":"ack","frame_id":1,"rendered_ms":"soon"})"}) {
+        ASSERT_TRUE(client.sendText(hostile));
+        nlohmann::json error;
+        ASSERT_TRUE(nextOfType(client, "error", error)) << hostile;
+        EXPECT_EQ(error["code"], "PROTOCOL_ERROR") << hostile;
+    }
+    ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+    ASSERT_TRUE(nextOfType(client, "status", status));
+    EXPECT_EQ(status["clients"][0]["clock"]["samples"].get<int>(), 1);
+
+    client.close();
+    server.stop();
+}
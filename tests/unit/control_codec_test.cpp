@@ -0,0 +1,192 @@
+/**
+ * @file control_codec_test.cpp
+ * @brief Unit tests for binary control messages
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/control_codec.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+std::vector<uint8_t> bytesOf(const SharedFrame& frame) {
+    return std::vector<uint8_t>(frame->payload(), frame->payload() + frame->payloadSize());
+}
+
+}  // namespace
+
+TEST(ControlCodecTest, WriterRecordsReadBack) {
+    MotorStatus motor{-12.34, TiltStatus::Stopped, 0.5, -9.81, 0.126};
+    ControlStatus status;
+    status.frameId = 123456;
+    status.clientsConnected = 3;
+    status.kinectConnected = true;
+    status.scale = 2;
+    status.queueMs = 40;
+
+    ControlWriter writer;
+    EXPECT_TRUE(writer.empty());
+    ASSERT_TRUE(writer.addMotorStatus(motor, true));
+    ASSERT_TRUE(writer.addStatus(status));
+    ASSERT_TRUE(writer.addError(ControlError::RateLimited, "slow down"));
+    EXPECT_FALSE(writer.empty());
+    auto bytes = bytesOf(writer.frame());
+    EXPECT_EQ(readLe16(bytes.data() + 4), STREAM_TYPE_CONTROL);
+
+    ControlReader reader(bytes.data(), bytes.size());
+    ControlRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, ControlType::MotorStatus);
+    ASSERT_EQ(record.length, 10);
+    int16_t angle = 0;
+    ASSERT_TRUE(record.readInt16(angle));
+    EXPECT_EQ(angle, -123);
+    EXPECT_EQ(record.value[2], static_cast<uint8_t>(TiltStatus::Stopped));
+    EXPECT_EQ(record.value[3], CONTROL_MOTOR_FLAG_ACCEL);
+    EXPECT_EQ(static_cast<int16_t>(readLe16(record.value + 6)), -981);
+    EXPECT_EQ(static_cast<int16_t>(readLe16(record.value + 8)), 13);
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, ControlType::StatusReply);
+    ASSERT_EQ(record.length, CONTROL_STATUS_SIZE);
+    EXPECT_EQ(readLe32(record.value), 123456u);
+    EXPECT_EQ(readLe16(record.value + 8), 3);
+    EXPECT_EQ(record.value[10], 1);
+    EXPECT_EQ(record.value[12], 2);
+    EXPECT_EQ(readLe32(record.value + 24), 40u);
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, ControlType::Error);
+    EXPECT_EQ(readLe16(record.value), static_cast<uint16_t>(ControlError::RateLimited));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(record.value + 2), record.length - 2), "slow down");
+
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.failed());
+}
+
+TEST(ControlCodecTest, MovingMotorHasUnknownAngleAndNoAccelerometer) {
+    ControlWriter writer;
+    ASSERT_TRUE(writer.addMotorStatus(MotorStatus{std::nan(""), TiltStatus::Moving, 0, 0, 0}, false));
+    auto bytes = bytesOf(writer.frame());
+
+    ControlReader reader(bytes.data(), bytes.size());
+    ControlRecord record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.length, 4);
+    int16_t angle = 0;
+    ASSERT_TRUE(record.readInt16(angle));
+    EXPECT_EQ(angle, CONTROL_ANGLE_UNKNOWN);
+    EXPECT_EQ(record.value[3], 0);
+}
+
+TEST(ControlCodecTest, RejectsMalformedMessages) {
+    // setTilt(+15.0) then a truncated record
+    std::vector<uint8_t> message(FRAME_HEADER_SIZE, 0);
+    message[4] = STREAM_TYPE_CONTROL;
+    std::vector<uint8_t> records = {0x01, 0x00, 0x02, 0x00, 150, 0x00, 0x04, 0x00, 0x05};
+    message.insert(message.end(), records.begin(), records.end());
+
+    ControlReader reader(message.data(), message.size());
+    ControlRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, ControlType::MotorSetTilt);
+    int16_t tenths = 0;
+    ASSERT_TRUE(record.readInt16(tenths));
+    EXPECT_EQ(tenths, 150);
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.failed());
+
+    // Length running past the end
+    message.resize(FRAME_HEADER_SIZE + 4);
+    message[FRAME_HEADER_SIZE + 2] = 8;
+    ControlReader overrun(message.data(), message.size());
+    EXPECT_FALSE(overrun.next(record));
+    EXPECT_TRUE(overrun.failed());
+
+    // Another stream type, or too short to hold a record
+    message[FRAME_HEADER_SIZE + 2] = 0;
+    message[4] = STREAM_TYPE_RGB;
+    EXPECT_TRUE(ControlReader(message.data(), message.size()).failed());
+    message[4] = STREAM_TYPE_CONTROL;
+    EXPECT_TRUE(ControlReader(message.data(), FRAME_HEADER_SIZE).failed());
+    EXPECT_FALSE(ControlReader(message.data(), message.size()).failed());
+
+    // Empty value reads fail instead of reading past the record
+    ControlReader empty(message.data(), message.size());
+    ASSERT_TRUE(empty.next(record));
+    uint8_t led = 0;
+    EXPECT_FALSE(record.readUint8(led));
+}
+
+TEST(ControlCodecTest, LongErrorMessagesAreCutToFit) {
+    ControlWriter writer;
+    ASSERT_TRUE(writer.addError(ControlError::ProtocolError, std::string(1000, 'x')));
+    auto bytes = bytesOf(writer.frame());
+    EXPECT_EQ(bytes.size(), CONTROL_MAX_MESSAGE_SIZE);
+
+    // Full: further records are refused, the message stays valid
+    EXPECT_FALSE(writer.addStatus(ControlStatus{}));
+    EXPECT_EQ(writer.frame()->payloadSize(), CONTROL_MAX_MESSAGE_SIZE);
+    ControlReader reader(bytes.data(), bytes.size());
+    ControlRecord record;
+    EXPECT_TRUE(reader.next(record));
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.failed());
+}
+
+TEST(BridgeControlTest, RepliesInTheEncodingOfTheLatestRequest) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    // status + motor.getStatus in one message
+    std::vector<uint8_t> request(FRAME_HEADER_SIZE, 0);
+    request[4] = STREAM_TYPE_CONTROL;
+    std::vector<uint8_t> records = {0x05, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00};
+    request.insert(request.end(), records.begin(), records.end());
+    ASSERT_TRUE(client.sendBinary(request.data(), request.size()));
+
+    WsMessage message;
+    ASSERT_TRUE(nextOf(client, WsOpcode::Binary, message));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(message.payload.data());
+    ControlReader status(bytes, message.payload.size());
+    ControlRecord record;
+    ASSERT_TRUE(status.next(record));
+    EXPECT_EQ(record.type, ControlType::StatusReply);
+    EXPECT_EQ(readLe16(record.value + 8), 1);  // clients_connected
+    EXPECT_EQ(record.value[10], 1);            // Mock mode counts as connected
+
+    // No device in mock mode
+    ASSERT_TRUE(nextOf(client, WsOpcode::Binary, message));
+    bytes = reinterpret_cast<const uint8_t*>(message.payload.data());
+    ControlReader error(bytes, message.payload.size());
+    ASSERT_TRUE(error.next(record));
+    EXPECT_EQ(record.type, ControlType::Error);
+    EXPECT_EQ(readLe16(record.value), static_cast<uint16_t>(ControlError::DeviceNotConnected));
+
+    // A JSON request switches back
+    ASSERT_TRUE(client.sendText(R"({"type":"motor.getStatus"})"));
+    bool sawJsonError = false;
+    while (!sawJsonError && nextOf(client, WsOpcode::Text, message)) {
+        sawJsonError = message.payload.find("\"motor.error\"") != std::string::npos &&
+                       message.payload.find("DEVICE_NOT_CONNECTED") != std::string::npos;
+    }
+    EXPECT_TRUE(sawJsonError);
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,230 @@
+/**
+ * @file depth_contour_test.cpp
+ * @brief Unit tests for contour tracing and the contours stream
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/depth_contour.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+struct Polygon {
+    uint16_t flags = 0;
+    std::vector<std::pair<double, double>> points;  // Pixels
+
+    // Shoelace area in square pixels; positive for clockwise on screen
+    double area() const {
+        double sum = 0.0;
+        for (size_t n = 0; n < points.size(); n++) {
+            const auto& a = points[n];
+            const auto& b = points[(n + 1) % points.size()];
+            sum += a.first * b.second - b.first * a.second;
+        }
+        return sum / 2.0;
+    }
+};
+
+std::vector<Polygon> parse(const uint8_t* payload, size_t size, uint8_t* step = nullptr) {
+    const uint8_t* p = payload + FRAME_HEADER_SIZE;
+    uint16_t count = readLe16(p);
+    if (step) *step = p[2];
+    uint32_t totalPoints = readLe32(p + 4);
+    EXPECT_EQ(size, FRAME_HEADER_SIZE + CONTOUR_HEADER_SIZE + count * 4 + totalPoints * 4);
+    p += CONTOUR_HEADER_SIZE;
+
+    std::vector<Polygon> polygons(count);
+    for (auto& polygon : polygons) {
+        uint16_t points = readLe16(p);
+        polygon.flags = readLe16(p + 2);
+        p += 4;
+        for (uint16_t n = 0; n < points; n++, p += 4) {
+            polygon.points.emplace_back(static_cast<int16_t>(readLe16(p)) / 2.0,
+                                        static_cast<int16_t>(readLe16(p + 2)) / 2.0);
+        }
+    }
+    return polygons;
+}
+
+std::vector<Polygon> parse(const SharedFrame& frame) {
+    return parse(frame->payload(), frame->payloadSize());
+}
+
+// Full-resolution mask with a filled rectangle [u0, u1) x [v0, v1)
+void fill(std::vector<uint8_t>& mask, uint32_t u0, uint32_t v0, uint32_t u1, uint32_t v1, uint8_t value = 1) {
+    for (uint32_t v = v0; v < v1; v++) {
+        for (uint32_t u = u0; u < u1; u++) {
+            mask[v * FRAME_WIDTH + u] = value;
+        }
+    }
+}
+
+std::vector<uint8_t> emptyMask() {
+    return std::vector<uint8_t>(FRAME_WIDTH * FRAME_HEIGHT, 0);
+}
+
+}  // namespace
+
+TEST(DepthContourTest, TracesARectangleAsOneClockwisePolygon) {
+    auto mask = emptyMask();
+    fill(mask, 100, 50, 300, 250);
+    ContourTracer tracer;
+    ContourParams params;
+    params.step = 1;
+    auto frame = tracer.encode(5, mask, params, 0);
+
+    EXPECT_EQ(readLe32(frame->payload()), 5u);
+    EXPECT_EQ(readLe16(frame->payload() + 4), STREAM_TYPE_CONTOURS);
+    auto polygons = parse(frame);
+    ASSERT_EQ(polygons.size(), 1u);
+    EXPECT_EQ(polygons[0].flags, 0);
+    // Corners are chamfered by half a pixel and simplification keeps one
+    // chamfer end per corner, so each side may tilt by up to half a pixel
+    EXPECT_GE(polygons[0].points.size(), 4u);
+    EXPECT_LE(polygons[0].points.size(), 8u);
+    EXPECT_NEAR(polygons[0].area(), 200.0 * 200.0, 4 * 200 * 0.5);
+    for (const auto& point : polygons[0].points) {
+        EXPECT_GE(point.first, 99.5);
+        EXPECT_LE(point.first, 299.5);
+        EXPECT_GE(point.second, 49.5);
+        EXPECT_LE(point.second, 249.5);
+    }
+}
+
+TEST(DepthContourTest, HolesAreFlaggedAndWoundTheOtherWay) {
+    auto mask = emptyMask();
+    fill(mask, 100, 100, 400, 400);
+    fill(mask, 200, 200, 300, 300, 0);
+    ContourTracer tracer;
+    ContourParams params;
+    params.step = 1;
+    auto polygons = parse(tracer.encode(1, mask, params, 0));
+
+    ASSERT_EQ(polygons.size(), 2u);
+    int holes = 0;
+    for (const auto& polygon : polygons) {
+        if (polygon.flags & CONTOUR_FLAG_HOLE) {
+            holes++;
+            EXPECT_LT(polygon.area(), 0.0);
+            EXPECT_NEAR(polygon.area(), -100.0 * 100.0, 4 * 100 * 0.5);
+        } else {
+            EXPECT_GT(polygon.area(), 0.0);
+            EXPECT_NEAR(polygon.area(), 300.0 * 300.0, 4 * 300 * 0.5);
+        }
+    }
+    EXPECT_EQ(holes, 1);
+}
+
+TEST(DepthContourTest, DiagonalNeighboursStaySeparateAndSmallBlobsAreDropped) {
+    auto mask = emptyMask();
+    fill(mask, 100, 100, 120, 120);
+    fill(mask, 120, 120, 140, 140);  // Touches the first only at a corner
+    fill(mask, 500, 400, 504, 404);  // 16 px²
+    ContourTracer tracer;
+    ContourParams params;
+    params.step = 1;
+    params.minAreaPx = 64;
+    EXPECT_EQ(parse(tracer.encode(1, mask, params, 0)).size(), 2u);
+
+    params.minAreaPx = 0;
+    EXPECT_EQ(parse(tracer.encode(1, mask, params, 0)).size(), 3u);
+}
+
+TEST(DepthContourTest, SimplificationStaysWithinTolerance) {
+    auto mask = emptyMask();
+    const double cx = 320.0, cy = 240.0, radius = 150.0;
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            mask[v * FRAME_WIDTH + u] = std::hypot(u - cx, v - cy) <= radius;
+        }
+    }
+    ContourTracer tracer;
+    ContourParams params;
+    params.step = 1;
+    params.epsilonTenthsPx = 0;
+    auto exact = parse(tracer.encode(1, mask, params, 0));
+    params.epsilonTenthsPx = 15;
+    auto simple = parse(tracer.encode(1, mask, params, 0));
+
+    ASSERT_EQ(exact.size(), 1u);
+    ASSERT_EQ(simple.size(), 1u);
+    EXPECT_LT(simple[0].points.size() * 4, exact[0].points.size());
+    EXPECT_NEAR(simple[0].area(), M_PI * radius * radius, M_PI * radius * radius * 0.02);
+    for (const auto& point : simple[0].points) {
+        EXPECT_NEAR(std::hypot(point.first - cx, point.second - cy), radius, 1.5);
+    }
+}
+
+TEST(DepthContourTest, MasksTouchingTheBorderStillClose) {
+    std::vector<uint8_t> mask((FRAME_WIDTH / 4) * (FRAME_HEIGHT / 4), 1);
+    ContourTracer tracer;
+    ContourParams params;
+    params.step = 4;
+    uint8_t step = 0;
+    auto frame = tracer.encode(1, mask, params, KEY_FLAG_LEARNING);
+    auto polygons = parse(frame->payload(), frame->payloadSize(), &step);
+    EXPECT_EQ(step, 4);
+    EXPECT_EQ(frame->payload()[FRAME_HEADER_SIZE + 3], KEY_FLAG_LEARNING);
+    ASSERT_EQ(polygons.size(), 1u);
+    EXPECT_NEAR(polygons[0].area(), 640.0 * 480.0, 640.0 * 480.0 * 0.01);
+}
+
+TEST(DepthContourTest, KeysDepthLikeTheKeyedStream) {
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE, 0);
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            uint16_t mm = (u >= 200 && u < 440 && v >= 100 && v < 400) ? 1000 : 3000;
+            depth[(v * FRAME_WIDTH + u) * 2] = static_cast<uint8_t>(mm);
+            depth[(v * FRAME_WIDTH + u) * 2 + 1] = static_cast<uint8_t>(mm >> 8);
+        }
+    }
+    DepthKeyer keyer;
+    ContourTracer tracer;
+    ContourParams params;
+    std::vector<uint8_t> mask;
+    keyer.keyMask(depth.data(), params.keying(), params.step, mask);
+    ASSERT_EQ(mask.size(), (FRAME_WIDTH / 2) * (FRAME_HEIGHT / 2));
+    auto polygons = parse(tracer.encode(1, mask, params, 0));
+    ASSERT_EQ(polygons.size(), 1u);
+    EXPECT_NEAR(polygons[0].area(), 240.0 * 300.0, 240.0 * 300.0 * 0.02);
+}
+
+TEST(BridgeContourTest, StreamsContoursToSubscribers) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(client,
+                                      R"({"type":"subscribe","streams":["contours"],"contours":)"
+                                      R"({"step":4,"min_depth_mm":800,"max_depth_mm":2000,"epsilon":2}})",
+                                      1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+    const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_CONTOURS);
+    uint8_t step = 0;
+    auto polygons = parse(p, message.payload.size(), &step);
+    EXPECT_EQ(step, 4);
+    EXPECT_FALSE(polygons.empty());  // The mock scene's centre is within 2 m
+    EXPECT_LT(message.payload.size(), 16384u);
+
+    // Invalid options are rejected
+    EXPECT_TRUE(
+        rejects(client, R"({"type":"subscribe","streams":["contours"],"contours":{"step":3}})"));
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,255 @@
+/**
+ * @file depth_key_test.cpp
+ * @brief Unit tests for depth keying and the keyed stream
+ */
+
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/depth_key.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+std::vector<uint8_t> depthImage(uint16_t (*depthAt)(uint32_t u, uint32_t v)) {
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE);
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            uint16_t mm = depthAt(u, v);
+            depth[(v * FRAME_WIDTH + u) * 2] = static_cast<uint8_t>(mm);
+            depth[(v * FRAME_WIDTH + u) * 2 + 1] = static_cast<uint8_t>(mm >> 8);
+        }
+    }
+    return depth;
+}
+
+uint16_t stepEdge(uint32_t u, uint32_t) { return u < 320 ? 1000 : 3000; }
+uint16_t wall(uint32_t, uint32_t) { return 2000; }
+uint16_t boxInFrontOfWall(uint32_t u, uint32_t v) {
+    return (u >= 200 && u < 440 && v >= 120 && v < 360) ? 1200 : 2000;
+}
+
+// Red channel holds the RGB column / 3, so registration can be read back
+std::vector<uint8_t> columnCodedRgb() {
+    std::vector<uint8_t> rgb(RGB_FRAME_SIZE);
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            uint8_t* px = &rgb[(v * FRAME_WIDTH + u) * 3];
+            px[0] = static_cast<uint8_t>(u / 3);
+            px[1] = 100;
+            px[2] = 50;
+        }
+    }
+    return rgb;
+}
+
+// Identity registration: same intrinsics for both cameras, no baseline
+ColorRegistration aligned() {
+    ColorRegistration registration;
+    registration.depth = DepthIntrinsics::kinectDefault();
+    registration.rgb = registration.depth;
+    registration.baselineMm = 0.0f;
+    return registration;
+}
+
+const uint8_t* rgbaPixel(const SharedFrame& frame, uint32_t u, uint32_t v) {
+    return frame->payload() + FRAME_HEADER_SIZE + KEY_HEADER_SIZE + (v * FRAME_WIDTH + u) * 4;
+}
+
+}  // namespace
+
+TEST(DepthKeyTest, RangeKeysPixelsInsideTheRange) {
+    auto depth = depthImage(stepEdge);
+    auto rgb = columnCodedRgb();
+    DepthKeyer keyer(aligned());
+    KeyParams params;
+    params.minDepthMm = 500;
+    params.maxDepthMm = 1500;
+    auto frame = keyer.encode(7, depth.data(), rgb.data(), params);
+    ASSERT_NE(frame, nullptr);
+
+    const uint8_t* p = frame->payload();
+    EXPECT_EQ(readLe32(p), 7u);
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_KEYED);
+    p += FRAME_HEADER_SIZE;
+    EXPECT_EQ(p[0], static_cast<uint8_t>(KeyFormat::Rgba));
+    EXPECT_EQ(p[1], 0);
+    EXPECT_EQ(readLe16(p + 2), FRAME_WIDTH);
+    EXPECT_EQ(readLe16(p + 4), FRAME_HEIGHT);
+    EXPECT_EQ(readLe32(p + 8), FRAME_WIDTH * FRAME_HEIGHT * 4);
+    EXPECT_EQ(frame->payloadSize(), params.maxPayloadBytes());
+
+    const uint8_t* near = rgbaPixel(frame, 100, 240);
+    EXPECT_EQ(near[0], 100 / 3);
+    EXPECT_EQ(near[1], 100);
+    EXPECT_EQ(near[3], 255);
+    const uint8_t* far = rgbaPixel(frame, 500, 240);
+    EXPECT_EQ(far[0], 500 / 3);  // Color is kept; only alpha keys it out
+    EXPECT_EQ(far[3], 0);
+}
+
+TEST(DepthKeyTest, RegistrationShiftsNearPixelsMore) {
+    auto rgb = columnCodedRgb();
+    DepthKeyer keyer;  // Kinect defaults: 25 mm baseline
+    KeyParams params;
+    params.minDepthMm = 0;
+    params.maxDepthMm = 0;
+
+    const ColorRegistration registration = ColorRegistration::kinectDefault();
+    auto expectedColumn = [&registration](uint32_t u, float mm) {
+        return (u - registration.depth.cx) * registration.rgb.fx / registration.depth.fx +
+               registration.rgb.cx - registration.rgb.fx * registration.baselineMm / mm;
+    };
+
+    auto nearDepth = depthImage([](uint32_t, uint32_t) -> uint16_t { return 600; });
+    auto farDepth = depthImage([](uint32_t, uint32_t) -> uint16_t { return 4000; });
+    auto nearFrame = keyer.encode(1, nearDepth.data(), rgb.data(), params);
+    auto farFrame = keyer.encode(1, farDepth.data(), rgb.data(), params);
+
+    const uint32_t u = 320;
+    EXPECT_NEAR(rgbaPixel(nearFrame, u, 240)[0], expectedColumn(u, 600.0f) / 3, 1.0);
+    EXPECT_NEAR(rgbaPixel(farFrame, u, 240)[0], expectedColumn(u, 4000.0f) / 3, 1.0);
+    EXPECT_GT(rgbaPixel(farFrame, u, 240)[0] - rgbaPixel(nearFrame, u, 240)[0], 5);
+
+    // Very near, the left depth columns see past the RGB image's edge:
+    // transparent and black
+    auto closeDepth = depthImage([](uint32_t, uint32_t) -> uint16_t { return 300; });
+    auto closeFrame = keyer.encode(1, closeDepth.data(), rgb.data(), params);
+    EXPECT_EQ(rgbaPixel(closeFrame, 0, 240)[3], 0);
+    EXPECT_EQ(rgbaPixel(closeFrame, 0, 240)[0], 0);
+    EXPECT_EQ(rgbaPixel(closeFrame, 320, 240)[3], 255);
+}
+
+TEST(DepthKeyTest, BackgroundModeKeysOnlyNewObjects) {
+    auto empty = depthImage(wall);
+    auto scene = depthImage(boxInFrontOfWall);
+    auto rgb = columnCodedRgb();
+    DepthKeyer keyer(aligned());
+    KeyParams params;
+    params.mode = KeyMode::Background;
+    params.maxDepthMm = 0;
+
+    EXPECT_FALSE(keyer.backgroundReady());
+    keyer.learnBackground(2);
+    keyer.observe(empty.data());
+    auto learning = keyer.encode(1, empty.data(), rgb.data(), params);
+    EXPECT_EQ(learning->payload()[FRAME_HEADER_SIZE + 1], KEY_FLAG_LEARNING);
+    keyer.observe(empty.data());
+    EXPECT_TRUE(keyer.backgroundReady());
+    keyer.observe(scene.data());  // Ignored once learned
+
+    auto frame = keyer.encode(2, scene.data(), rgb.data(), params);
+    EXPECT_EQ(frame->payload()[FRAME_HEADER_SIZE + 1], 0);
+    EXPECT_EQ(rgbaPixel(frame, 320, 240)[3], 255);
+    EXPECT_EQ(rgbaPixel(frame, 100, 240)[3], 0);
+    EXPECT_EQ(rgbaPixel(frame, 320, 50)[3], 0);
+
+    // Within the tolerance of the background stays keyed out
+    params.toleranceMm = 900;
+    auto tolerant = keyer.encode(3, scene.data(), rgb.data(), params);
+    EXPECT_EQ(rgbaPixel(tolerant, 320, 240)[3], 0);
+}
+
+TEST(DepthKeyTest, FeatherRampsAlphaAcrossEdges) {
+    auto depth = depthImage(stepEdge);
+    auto rgb = columnCodedRgb();
+    DepthKeyer keyer(aligned());
+    KeyParams params;
+    params.featherPx = 4;
+    auto frame = keyer.encode(1, depth.data(), rgb.data(), params);
+
+    EXPECT_EQ(rgbaPixel(frame, 300, 240)[3], 255);
+    EXPECT_EQ(rgbaPixel(frame, 340, 240)[3], 0);
+    uint8_t previous = 255;
+    int partial = 0;
+    for (uint32_t u = 310; u < 330; u++) {
+        uint8_t alpha = rgbaPixel(frame, u, 240)[3];
+        EXPECT_LE(alpha, previous) << u;
+        previous = alpha;
+        partial += alpha > 0 && alpha < 255;
+    }
+    EXPECT_EQ(partial, 8);  // 2 * radius soft pixels
+}
+
+TEST(DepthKeyTest, JpegMaskMatchesRgbaAlpha) {
+    auto depth = depthImage(boxInFrontOfWall);
+    auto rgb = columnCodedRgb();
+    DepthKeyer keyer(aligned());
+    KeyParams params;
+    params.featherPx = 2;
+    params.maxDepthMm = 1500;
+    auto rgba = keyer.encode(1, depth.data(), rgb.data(), params);
+    params.format = KeyFormat::JpegMask;
+    auto jpeg = keyer.encode(1, depth.data(), rgb.data(), params);
+    ASSERT_NE(jpeg, nullptr);
+
+    const uint8_t* p = jpeg->payload() + FRAME_HEADER_SIZE;
+    EXPECT_EQ(p[0], static_cast<uint8_t>(KeyFormat::JpegMask));
+    uint32_t colorBytes = readLe32(p + 8);
+    const uint8_t* color = p + KEY_HEADER_SIZE;
+    EXPECT_EQ(color[0], 0xFF);  // JPEG SOI marker
+    EXPECT_EQ(color[1], 0xD8);
+    EXPECT_LT(jpeg->payloadSize(), rgba->payloadSize() / 4);
+
+    size_t maskOffset = FRAME_HEADER_SIZE + KEY_HEADER_SIZE + colorBytes;
+    ASSERT_LT(maskOffset, jpeg->payloadSize());
+    std::vector<uint8_t> mask(FRAME_WIDTH * FRAME_HEIGHT);
+    uLongf maskSize = mask.size();
+    ASSERT_EQ(uncompress(mask.data(), &maskSize, jpeg->payload() + maskOffset,
+                         jpeg->payloadSize() - maskOffset), Z_OK);
+    ASSERT_EQ(maskSize, mask.size());
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v += 7) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u += 5) {
+            ASSERT_EQ(mask[v * FRAME_WIDTH + u], rgbaPixel(rgba, u, v)[3]) << u << "," << v;
+        }
+    }
+}
+
+TEST(BridgeKeyTest, StreamsKeyedFramesToSubscribers) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    ASSERT_TRUE(client.sendText(
+        R"({"type":"subscribe","streams":["keyed"],"key":{"mode":"background","format":"jpeg","feather":1}})"));
+    ASSERT_TRUE(client.sendText(R"({"type":"key.learn","frames":5})"));
+
+    WsMessage message;
+    bool learnAcknowledged = false;
+    bool binary = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (std::chrono::steady_clock::now() < deadline && !(learnAcknowledged && binary) &&
+           client.next(message, 500)) {
+        if (message.opcode == WsOpcode::Text) {
+            learnAcknowledged |= message.payload.find("\"key.learn\"") != std::string::npos;
+            continue;
+        }
+        const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+        ASSERT_EQ(readLe16(p + 4), STREAM_TYPE_KEYED);
+        EXPECT_EQ(p[FRAME_HEADER_SIZE], static_cast<uint8_t>(KeyFormat::JpegMask));
+        EXPECT_GT(message.payload.size(), FRAME_HEADER_SIZE + KEY_HEADER_SIZE + readLe32(p + FRAME_HEADER_SIZE + 8));
+        binary = true;
+    }
+    EXPECT_TRUE(learnAcknowledged);
+    EXPECT_TRUE(binary);
+
+    // Invalid options are rejected
+    EXPECT_TRUE(rejects(client, R"({"type":"subscribe","streams":["keyed"],"key":{"feather":9}})"));
+
+    client.close();
+    server.stop();
+}
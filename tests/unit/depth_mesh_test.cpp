@@ -0,0 +1,210 @@
+/**
+ * @file depth_mesh_test.cpp
+ * @brief Unit tests for depth mesh extraction and the mesh stream
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/depth_mesh.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+struct Mesh {
+    SharedFrame frame;  // Keeps the views below alive
+    uint32_t vertices = 0;
+    uint32_t indices = 0;
+    uint8_t flags = 0;
+    uint8_t step = 0;
+    const uint8_t* positions = nullptr;
+    const uint8_t* indexData = nullptr;
+
+    uint32_t index(size_t n) const {
+        return flags & MESH_FLAG_INDEX32 ? readLe32(indexData + n * 4) : readLe16(indexData + n * 2);
+    }
+    int16_t coord(uint32_t vertex, int axis) const {
+        return static_cast<int16_t>(readLe16(positions + vertex * 6 + axis * 2));
+    }
+};
+
+Mesh parse(const uint8_t* payload, size_t size) {
+    Mesh mesh;
+    const uint8_t* p = payload + FRAME_HEADER_SIZE;
+    mesh.vertices = readLe32(p);
+    mesh.indices = readLe32(p + 4);
+    mesh.flags = p[8];
+    mesh.step = p[9];
+    mesh.positions = p + MESH_HEADER_SIZE;
+    size_t positionBytes = mesh.vertices * 6;
+    size_t padding = (mesh.flags & MESH_FLAG_INDEX32) ? positionBytes % 4 : 0;
+    mesh.indexData = mesh.positions + positionBytes + padding;
+    size_t indexSize = (mesh.flags & MESH_FLAG_INDEX32) ? 4 : 2;
+    EXPECT_EQ(size, FRAME_HEADER_SIZE + MESH_HEADER_SIZE + positionBytes + padding + mesh.indices * indexSize);
+    return mesh;
+}
+
+Mesh parse(const SharedFrame& frame) {
+    Mesh mesh = parse(frame->payload(), frame->payloadSize());
+    mesh.frame = frame;
+    return mesh;
+}
+
+std::vector<uint8_t> depthImage(uint16_t (*depthAt)(uint32_t u, uint32_t v)) {
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE);
+    for (uint32_t v = 0; v < FRAME_HEIGHT; v++) {
+        for (uint32_t u = 0; u < FRAME_WIDTH; u++) {
+            uint16_t mm = depthAt(u, v);
+            depth[(v * FRAME_WIDTH + u) * 2] = static_cast<uint8_t>(mm);
+            depth[(v * FRAME_WIDTH + u) * 2 + 1] = static_cast<uint8_t>(mm >> 8);
+        }
+    }
+    return depth;
+}
+
+uint16_t flatWall(uint32_t, uint32_t) { return 2000; }
+uint16_t stepEdge(uint32_t u, uint32_t) { return u < 320 ? 1000 : 3000; }
+uint16_t slopedFloor(uint32_t, uint32_t v) { return static_cast<uint16_t>(1000 + v * 4); }
+
+const DepthIntrinsics INTRINSICS = DepthIntrinsics::kinectDefault();
+
+}  // namespace
+
+TEST(DepthMeshTest, TriangulatesTheFullGrid) {
+    auto depth = depthImage(flatWall);
+    DepthMesher mesher(1);
+    MeshParams params;
+    params.step = 8;
+    auto frame = mesher.encode(9, depth.data(), INTRINSICS, params);
+
+    EXPECT_EQ(readLe32(frame->payload()), 9u);
+    EXPECT_EQ(readLe16(frame->payload() + 4), STREAM_TYPE_MESH);
+    Mesh mesh = parse(frame);
+    const uint32_t width = 80;
+    const uint32_t height = 60;
+    EXPECT_EQ(mesh.step, 8);
+    EXPECT_EQ(mesh.flags, 0);
+    ASSERT_EQ(mesh.vertices, width * height);
+    ASSERT_EQ(mesh.indices, (width - 1) * (height - 1) * 6);
+
+    // Vertices are row-major; the first triangle is (top-left, bottom-left, top-right)
+    EXPECT_EQ(mesh.index(0), 0u);
+    EXPECT_EQ(mesh.index(1), width);
+    EXPECT_EQ(mesh.index(2), 1u);
+    EXPECT_LT(mesh.coord(0, 0), 0);
+    EXPECT_GT(mesh.coord(0, 1), 0);
+    EXPECT_EQ(mesh.coord(0, 2), 2000);
+}
+
+TEST(DepthMeshTest, CullsTrianglesAcrossDiscontinuities) {
+    auto depth = depthImage(stepEdge);
+    DepthMesher mesher(1);
+    MeshParams params;
+    params.step = 8;
+    Mesh mesh = parse(mesher.encode(1, depth.data(), INTRINSICS, params));
+
+    // One column of cells straddles the edge and is dropped
+    EXPECT_EQ(mesh.indices, (79u - 1) * 59 * 6);
+    for (uint32_t n = 0; n < mesh.indices; n += 3) {
+        int16_t z0 = mesh.coord(mesh.index(n), 2);
+        EXPECT_EQ(mesh.coord(mesh.index(n + 1), 2), z0);
+        EXPECT_EQ(mesh.coord(mesh.index(n + 2), 2), z0);
+    }
+}
+
+TEST(DepthMeshTest, HolesDropOnlyTheirTriangles) {
+    auto depth = depthImage(flatWall);
+    // Clear the grid point at (8, 8) (pixel 64, 64) for step 8
+    depth[(64 * FRAME_WIDTH + 64) * 2] = 0;
+    depth[(64 * FRAME_WIDTH + 64) * 2 + 1] = 0;
+
+    DepthMesher mesher(1);
+    MeshParams params;
+    params.step = 8;
+    Mesh mesh = parse(mesher.encode(1, depth.data(), INTRINSICS, params));
+    EXPECT_EQ(mesh.vertices, 80u * 60 - 1);
+    // The four cells around the hole keep the triangle of their other three corners
+    EXPECT_EQ(mesh.indices, (79u * 59 * 2 - 4) * 3);
+}
+
+TEST(DepthMeshTest, AdaptiveMergesFlatRegionsAndKeepsEdges) {
+    DepthMesher mesher(1);
+    MeshParams params;
+    params.step = 4;
+    params.adaptive = true;
+
+    auto floor = depthImage(slopedFloor);
+    Mesh flat = parse(mesher.encode(1, floor.data(), INTRINSICS, params));
+    params.adaptive = false;
+    Mesh full = parse(mesher.encode(1, floor.data(), INTRINSICS, params));
+    EXPECT_LT(flat.indices * 10, full.indices);  // Planar: mostly 32-pixel cells
+
+    params.adaptive = true;
+    auto edge = depthImage(stepEdge);
+    Mesh edged = parse(mesher.encode(1, edge.data(), INTRINSICS, params));
+    EXPECT_GT(edged.indices, flat.indices);  // Finer cells along the edge
+    for (uint32_t n = 0; n < edged.indices; n += 3) {
+        int16_t z0 = edged.coord(edged.index(n), 2);
+        EXPECT_EQ(edged.coord(edged.index(n + 2), 2), z0);
+    }
+}
+
+TEST(DepthMeshTest, BandsProduceTheSameMesh) {
+    auto depth = depthImage(stepEdge);
+    DepthMesher serial(1);
+    DepthMesher parallel(4);
+    for (bool adaptive : {false, true}) {
+        MeshParams params;
+        params.step = 2;
+        params.adaptive = adaptive;
+        auto a = serial.encode(3, depth.data(), INTRINSICS, params);
+        auto b = parallel.encode(3, depth.data(), INTRINSICS, params);
+        ASSERT_EQ(a->payloadSize(), b->payloadSize());
+        EXPECT_EQ(std::memcmp(a->payload(), b->payload(), a->payloadSize()), 0);
+    }
+}
+
+TEST(DepthMeshTest, LargeMeshesUseAlignedThirtyTwoBitIndices) {
+    auto depth = depthImage(flatWall);
+    DepthMesher mesher(2);
+    MeshParams params;
+    params.step = 1;
+    auto frame = mesher.encode(1, depth.data(), INTRINSICS, params);
+    Mesh mesh = parse(frame);
+    EXPECT_EQ(mesh.flags, MESH_FLAG_INDEX32);
+    EXPECT_EQ(mesh.vertices, FRAME_WIDTH * FRAME_HEIGHT);
+    EXPECT_EQ((mesh.indexData - frame->payload()) % 4, 0);
+    EXPECT_EQ(mesh.index(mesh.indices - 1), FRAME_WIDTH * FRAME_HEIGHT - 1);
+    EXPECT_LE(frame->payloadSize(), params.maxPayloadBytes());
+}
+
+TEST(BridgeMeshTest, StreamsMeshesToSubscribers) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(
+        client, R"({"type":"subscribe","streams":["mesh"],"mesh":{"step":8,"adaptive":true,"discontinuity":0.03}})",
+        1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+    const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_MESH);
+    Mesh mesh = parse(p, message.payload.size());
+    EXPECT_EQ(mesh.step, 8);
+    EXPECT_GT(mesh.indices, 0u);
+
+    client.close();
+    server.stop();
+}
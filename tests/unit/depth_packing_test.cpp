@@ -0,0 +1,125 @@
+/**
+ * @file depth_packing_test.cpp
+ * @brief Unit tests for bit-packed depth
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/depth_packing.h"
+#include "kinect_xr/rate_controller.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+std::vector<uint8_t> testDepth(size_t count, uint16_t maxMm) {
+    std::vector<uint8_t> depth(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t mm = static_cast<uint16_t>((i * 2654435761u) % (maxMm + 1u));
+        depth[i * 2] = static_cast<uint8_t>(mm);
+        depth[i * 2 + 1] = static_cast<uint8_t>(mm >> 8);
+    }
+    return depth;
+}
+
+}  // namespace
+
+TEST(DepthPackingTest, RoundTripsEverySampleIncludingTheTail) {
+    for (DepthPacking packing : {DepthPacking::Bits12, DepthPacking::Bits13}) {
+        uint16_t maxMm = static_cast<uint16_t>((1u << depthPackingBits(packing)) - 1);
+        // Counts around the eight-sample group
+        for (size_t count : {0u, 1u, 7u, 8u, 9u, 15u, 17u, 640u * 480u}) {
+            auto depth = testDepth(count, maxMm);
+            std::vector<uint8_t> packed(packedDepthSize(count, packing) + 1, 0xAB);
+            packDepth(depth.data(), count, packing, packed.data());
+            EXPECT_EQ(packed.back(), 0xAB) << "wrote past the packed size";
+
+            std::vector<uint16_t> unpacked(count, 0xFFFF);
+            unpackDepth(packed.data(), count, packing, unpacked.data());
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(unpacked[i], readLe16(&depth[i * 2]))
+                    << depthPackingName(packing) << " count " << count << " sample " << i;
+            }
+        }
+    }
+    EXPECT_EQ(packedDepthSize(640 * 480, DepthPacking::Bits12), 460800u);
+    EXPECT_EQ(packedDepthSize(640 * 480, DepthPacking::Bits13), 499200u);
+}
+
+TEST(DepthPackingTest, OutOfRangeReadingsBecomeNoReading) {
+    std::vector<uint8_t> depth = {0x00, 0x10,   // 4096 mm: too far for 12 bits
+                                  0xFF, 0x0F,   // 4095 mm
+                                  0x00, 0x20,   // 8192 mm: too far for 13 bits
+                                  0x20, 0x03};  // 800 mm
+    std::vector<uint8_t> packed(packedDepthSize(4, DepthPacking::Bits13));
+    std::vector<uint16_t> out(4);
+
+    packDepth(depth.data(), 4, DepthPacking::Bits12, packed.data());
+    unpackDepth(packed.data(), 4, DepthPacking::Bits12, out.data());
+    EXPECT_EQ(out, (std::vector<uint16_t>{0, 4095, 0, 800}));
+
+    packDepth(depth.data(), 4, DepthPacking::Bits13, packed.data());
+    unpackDepth(packed.data(), 4, DepthPacking::Bits13, out.data());
+    EXPECT_EQ(out, (std::vector<uint16_t>{4096, 4095, 0, 800}));
+}
+
+TEST(DepthPackingTest, PackedFramesRecordThePackingAndKeepTheScale) {
+    auto depth = testDepth(FRAME_WIDTH * FRAME_HEIGHT, 4000);
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 7, depth.data(), depth.size());
+    auto half = downscaleFrame(frame, 1);
+    ASSERT_TRUE(half);
+
+    auto packed = packDepthFrame(half, DepthPacking::Bits12);
+    ASSERT_TRUE(packed);
+    const size_t count = (FRAME_WIDTH / 2) * (FRAME_HEIGHT / 2);
+    ASSERT_EQ(packed->payloadSize(), FRAME_HEADER_SIZE + count * 3 / 2);
+    uint16_t flags = readLe16(packed->payload() + 6);
+    EXPECT_EQ((flags & FRAME_FLAG_SCALE_MASK) >> FRAME_FLAG_SCALE_SHIFT, 1);
+    EXPECT_EQ((flags & FRAME_FLAG_DEPTH_PACKING_MASK) >> FRAME_FLAG_DEPTH_PACKING_SHIFT,
+              static_cast<int>(DepthPacking::Bits12));
+
+    std::vector<uint16_t> out(count);
+    unpackDepth(packed->payload() + FRAME_HEADER_SIZE, count, DepthPacking::Bits12, out.data());
+    EXPECT_EQ(out[1000], readLe16(half->payload() + FRAME_HEADER_SIZE + 2000));
+
+    // Only unpacked depth frames pack, and only once
+    EXPECT_FALSE(packDepthFrame(packed, DepthPacking::Bits13));
+    EXPECT_FALSE(packDepthFrame(frame, DepthPacking::None));
+    std::vector<uint8_t> rgb(RGB_FRAME_SIZE, 0);
+    EXPECT_FALSE(packDepthFrame(
+        FramedMessage::binaryFrame(STREAM_TYPE_RGB, 1, rgb.data(), rgb.size()), DepthPacking::Bits12));
+}
+
+TEST(BridgeDepthPackingTest, SendsDepthInTheSubscribedPacking) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(
+        client, R"({"type":"subscribe","streams":["depth"],"depth_format":"packed13"})", 1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+    const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_DEPTH);
+    EXPECT_EQ((readLe16(p + 6) & FRAME_FLAG_DEPTH_PACKING_MASK) >> FRAME_FLAG_DEPTH_PACKING_SHIFT,
+              static_cast<int>(DepthPacking::Bits13));
+    EXPECT_EQ(message.payload.size(),
+              FRAME_HEADER_SIZE + packedDepthSize(FRAME_WIDTH * FRAME_HEIGHT, DepthPacking::Bits13));
+
+    // Unknown packings are rejected
+    EXPECT_TRUE(
+        rejects(client, R"({"type":"subscribe","streams":["depth"],"depth_format":"packed11"})"));
+
+    client.close();
+    server.stop();
+}
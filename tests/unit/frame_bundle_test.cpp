@@ -0,0 +1,149 @@
+/**
+ * @file frame_bundle_test.cpp
+ * @brief Unit tests for multi-stream bundles
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/frame_bundle.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+SharedFrame testFrame(uint16_t streamType, uint32_t frameId, size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(i * 13 + streamType);
+    }
+    return FramedMessage::binaryFrame(streamType, frameId, data.data(), data.size());
+}
+
+// Records what a client would have been sent
+class RecordingClient : public ClientConnection {
+public:
+    void sendText(const std::string&) override {}
+    void sendFrame(const SharedFrame& frame) override { frames.push_back(frame); }
+    size_t bufferedBytes() const override { return 0; }
+    void close() override {}
+    bool isOpen() const override { return true; }
+
+    std::vector<SharedFrame> frames;
+};
+
+}  // namespace
+
+TEST(FrameBundleTest, PartsRoundTripAlignedAndUnchanged) {
+    // Odd sizes, so every part after the first needs padding
+    std::vector<SharedFrame> parts = {testFrame(STREAM_TYPE_RGB, 42, 1001),
+                                      testFrame(STREAM_TYPE_DEPTH, 42, 614),
+                                      testFrame(STREAM_TYPE_CONTOURS, 42, 3)};
+    auto bundle = bundleFrames(42, 1700000000123ull, parts);
+    ASSERT_TRUE(bundle);
+    const uint8_t* bytes = bundle->payload();
+    EXPECT_EQ(readLe16(bytes + 4), STREAM_TYPE_BUNDLE);
+    EXPECT_EQ(readLe16(bytes + FRAME_HEADER_SIZE), 3);
+    EXPECT_EQ(bundle->payloadSize() % BUNDLE_ALIGNMENT, 0u);
+
+    std::vector<BundlePart> split;
+    uint64_t captureTimeMs = 0;
+    ASSERT_TRUE(splitBundle(bytes, bundle->payloadSize(), split, &captureTimeMs));
+    EXPECT_EQ(captureTimeMs, 1700000000123ull);
+    ASSERT_EQ(split.size(), parts.size());
+    for (size_t i = 0; i < parts.size(); i++) {
+        EXPECT_EQ(static_cast<size_t>(split[i].data - bytes) % BUNDLE_ALIGNMENT, 0u);
+        ASSERT_EQ(split[i].size, parts[i]->payloadSize());
+        EXPECT_EQ(std::memcmp(split[i].data, parts[i]->payload(), split[i].size), 0);
+    }
+
+    EXPECT_FALSE(bundleFrames(42, 0, {}));
+    EXPECT_FALSE(bundleFrames(42, 0, {FramedMessage::text("{}")}));
+}
+
+TEST(FrameBundleTest, RejectsMalformedBundles) {
+    auto bundle = bundleFrames(7, 0, {testFrame(STREAM_TYPE_RGB, 7, 64), testFrame(STREAM_TYPE_DEPTH, 7, 64)});
+    ASSERT_TRUE(bundle);
+    std::vector<uint8_t> bytes(bundle->payload(), bundle->payload() + bundle->payloadSize());
+    std::vector<BundlePart> parts;
+
+    // Truncated: the last part runs past the end
+    EXPECT_FALSE(splitBundle(bytes.data(), bytes.size() - 16, parts));
+    EXPECT_TRUE(parts.empty());
+
+    // Not a bundle
+    auto plain = testFrame(STREAM_TYPE_RGB, 7, 64);
+    EXPECT_FALSE(splitBundle(plain->payload(), plain->payloadSize(), parts));
+
+    // Offset table pointing outside the message
+    auto corrupt = bytes;
+    corrupt[FRAME_HEADER_SIZE + BUNDLE_HEADER_SIZE + 3] = 0x7F;
+    EXPECT_FALSE(splitBundle(corrupt.data(), corrupt.size(), parts));
+
+    EXPECT_TRUE(splitBundle(bytes.data(), bytes.size(), parts));
+}
+
+TEST(FrameBundleTest, BundlerSharesIdenticalBundlesAndPassesSingletonsThrough) {
+    auto a = std::make_shared<RecordingClient>();
+    auto b = std::make_shared<RecordingClient>();
+    auto c = std::make_shared<RecordingClient>();
+    auto rgb = testFrame(STREAM_TYPE_RGB, 3, 100);
+    auto depth = testFrame(STREAM_TYPE_DEPTH, 3, 100);
+
+    FrameBundler bundler;
+    EXPECT_TRUE(bundler.empty());
+    bundler.add(a, rgb);
+    bundler.add(b, rgb);
+    bundler.add(c, depth);
+    bundler.add(a, depth);
+    bundler.add(b, depth);
+    size_t sent = bundler.flush(3, 0, [](const ClientPtr& client, const SharedFrame& frame) {
+        client->sendFrame(frame);
+    });
+    EXPECT_EQ(sent, 3u);
+    EXPECT_TRUE(bundler.empty());
+
+    ASSERT_EQ(a->frames.size(), 1u);
+    ASSERT_EQ(b->frames.size(), 1u);
+    EXPECT_EQ(a->frames[0], b->frames[0]);  // Built once
+    EXPECT_EQ(readLe16(a->frames[0]->payload() + 4), STREAM_TYPE_BUNDLE);
+    ASSERT_EQ(c->frames.size(), 1u);
+    EXPECT_EQ(c->frames[0], depth);  // Nothing to pair with: sent as is
+}
+
+TEST(BridgeBundleTest, SendsRgbAndDepthAsOneMessage) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(
+        client, R"({"type":"subscribe","streams":["rgb","depth"],"bundle":true,"depth_format":"packed12"})",
+        1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+    const auto* bytes = reinterpret_cast<const uint8_t*>(message.payload.data());
+    std::vector<BundlePart> parts;
+    uint64_t captureTimeMs = 0;
+    ASSERT_TRUE(splitBundle(bytes, message.payload.size(), parts, &captureTimeMs));
+    EXPECT_GT(captureTimeMs, 0u);
+    ASSERT_EQ(parts.size(), 2u);
+    EXPECT_EQ(readLe16(parts[0].data + 4), STREAM_TYPE_RGB);
+    EXPECT_EQ(readLe16(parts[1].data + 4), STREAM_TYPE_DEPTH);
+    EXPECT_EQ(std::memcmp(parts[0].data, bytes, 4), 0);  // Same frame ID throughout
+    EXPECT_EQ(std::memcmp(parts[1].data, bytes, 4), 0);
+    EXPECT_EQ(parts[0].size, FRAME_HEADER_SIZE + RGB_FRAME_SIZE);
+    EXPECT_EQ(parts[1].size, FRAME_HEADER_SIZE + DEPTH_FRAME_SIZE * 3 / 4);  // Layouts still apply
+
+    client.close();
+    server.stop();
+}
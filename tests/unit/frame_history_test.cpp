@@ -0,0 +1,254 @@
+/**
+ * @file frame_history_test.cpp
+ * @brief Unit tests for the compressed frame history ring
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/frame_history.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+SharedFrame depthFrame(uint32_t frameId) {
+    std::vector<uint8_t> data(DEPTH_FRAME_SIZE);
+    for (size_t i = 0; i < data.size(); i += 2) {
+        uint16_t depth = static_cast<uint16_t>(800 + (i / 2 + frameId) % 3200);
+        data[i] = static_cast<uint8_t>(depth);
+        data[i + 1] = static_cast<uint8_t>(depth >> 8);
+    }
+    return FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, frameId, data.data(), data.size());
+}
+
+uint16_t flagsOf(const SharedFrame& frame) {
+    return static_cast<uint16_t>(frame->payload()[6] | (frame->payload()[7] << 8));
+}
+
+uint32_t idOf(const SharedFrame& frame) {
+    const uint8_t* p = frame->payload();
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+TEST(FrameHistoryTest, ReturnsStoredFrameByIdWithHistoryFlag) {
+    FrameHistory history(5.0);
+    auto live = depthFrame(42);
+    history.push(STREAM_TYPE_DEPTH, live, 1000);
+    history.flush();
+
+    auto frame = history.get(STREAM_TYPE_DEPTH, 42);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(idOf(frame), 42u);
+    EXPECT_EQ(flagsOf(frame), FRAME_FLAG_HISTORY);
+    ASSERT_EQ(frame->payloadSize(), live->payloadSize());
+    EXPECT_EQ(std::memcmp(frame->payload() + FRAME_HEADER_SIZE, live->payload() + FRAME_HEADER_SIZE,
+                          DEPTH_FRAME_SIZE), 0);
+
+    EXPECT_EQ(history.get(STREAM_TYPE_DEPTH, 43), nullptr);
+    EXPECT_EQ(history.get(STREAM_TYPE_RGB, 42), nullptr);
+}
+
+TEST(FrameHistoryTest, StoresFramesCompressed) {
+    FrameHistory history(5.0);
+    for (uint32_t id = 1; id <= 5; id++) {
+        history.push(STREAM_TYPE_DEPTH, depthFrame(id), 1000 + id * 33);
+    }
+    history.flush();
+
+    auto stats = history.stats();
+    EXPECT_EQ(stats.frames, 5u);
+    EXPECT_EQ(stats.rawBytes, 5u * DEPTH_FRAME_SIZE);
+    EXPECT_LT(stats.compressedBytes, stats.rawBytes / 2);
+}
+
+TEST(FrameHistoryTest, IgnoresRepeatedFrameIds) {
+    FrameHistory history(5.0);
+    auto frame = depthFrame(7);
+    history.push(STREAM_TYPE_DEPTH, frame, 1000);
+    history.push(STREAM_TYPE_DEPTH, frame, 1033);
+    history.flush();
+    EXPECT_EQ(history.stats().frames, 1u);
+}
+
+TEST(FrameHistoryTest, FindsFrameByTimestamp) {
+    FrameHistory history(5.0);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(1), 1000);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(2), 1033);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(3), 1066);
+    history.flush();
+
+    EXPECT_EQ(history.getAt(STREAM_TYPE_DEPTH, 999), nullptr);
+    EXPECT_EQ(idOf(history.getAt(STREAM_TYPE_DEPTH, 1000)), 1u);
+    EXPECT_EQ(idOf(history.getAt(STREAM_TYPE_DEPTH, 1050)), 2u);
+    EXPECT_EQ(idOf(history.getAt(STREAM_TYPE_DEPTH, 5000)), 3u);
+    EXPECT_EQ(idOf(history.latest(STREAM_TYPE_DEPTH)), 3u);
+}
+
+TEST(FrameHistoryTest, ReplaysRecentFramesOldestFirst) {
+    FrameHistory history(5.0);
+    for (uint32_t id = 1; id <= 6; id++) {
+        history.push(STREAM_TYPE_DEPTH, depthFrame(id), 1000 + id * 33);
+    }
+    history.flush();
+
+    auto burst = history.recent(STREAM_TYPE_DEPTH, 3);
+    ASSERT_EQ(burst.size(), 3u);
+    EXPECT_EQ(idOf(burst[0]), 4u);
+    EXPECT_EQ(idOf(burst[2]), 6u);
+
+    auto window = history.since(STREAM_TYPE_DEPTH, 1000 + 5 * 33);
+    ASSERT_EQ(window.size(), 2u);
+    EXPECT_EQ(idOf(window[0]), 5u);
+}
+
+TEST(FrameHistoryTest, EvictsFramesOutsideTheWindow) {
+    FrameHistory history(1.0);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(1), 1000);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(2), 1500);
+    history.push(STREAM_TYPE_DEPTH, depthFrame(3), 2100);
+    history.flush();
+
+    EXPECT_EQ(history.get(STREAM_TYPE_DEPTH, 1), nullptr);
+    EXPECT_NE(history.get(STREAM_TYPE_DEPTH, 2), nullptr);
+    EXPECT_EQ(history.stats().frames, 2u);
+}
+
+TEST(FrameHistoryTest, EnforcesMemoryBudget) {
+    FrameHistory history(60.0, 1);  // Budget smaller than a single frame
+    history.push(STREAM_TYPE_DEPTH, depthFrame(1), 1000);
+    history.flush();
+    EXPECT_EQ(history.stats().frames, 0u);
+    EXPECT_EQ(history.stats().compressedBytes, 0u);
+}
+
+TEST(BridgeHistoryTest, ServesCatchUpGetAndReplay) {
+    BridgeServer server;
+    server.setHistory(2.0);
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    // Let history fill; compression runs in the background and can lag on a busy machine
+    WsMessage message;
+    size_t stored = 0;
+    auto fillDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (stored < 8 && std::chrono::steady_clock::now() < fillDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+        while (client.next(message, 1000) && message.opcode == WsOpcode::Text) {
+            auto status = nlohmann::json::parse(message.payload);
+            if (status["type"] == "status") {
+                stored = status["history"]["frames"].get<size_t>();
+                break;
+            }
+        }
+    }
+    ASSERT_GE(stored, 8u);
+    ASSERT_TRUE(client.sendText(R"({"type":"subscribe","streams":["depth"],"catch_up":true})"));
+
+    // First binary message is the catch-up frame, flagged as history
+    ASSERT_TRUE(nextOf(client, WsOpcode::Binary, message, 2000));
+    auto bytes = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(bytes + 6), FRAME_FLAG_HISTORY);
+    uint32_t caughtUpId = readLe32(bytes);
+
+    ASSERT_TRUE(client.sendText(R"({"type":"history.replay","stream":"depth","count":3})"));
+    int replayed = -1;
+    int flagged = 0;
+    bool fetched = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while ((replayed < 0 || flagged < replayed || !fetched) &&
+           std::chrono::steady_clock::now() < deadline && client.next(message, 500)) {
+        if (message.opcode == WsOpcode::Text) {
+            auto reply = nlohmann::json::parse(message.payload);
+            if (reply["type"] == "history.replay") {
+                replayed = reply["frames"].get<int>();
+                ASSERT_TRUE(client.sendText("{\"type\":\"history.get\",\"stream\":\"depth\",\"frame_id\":" +
+                                            std::to_string(caughtUpId) + "}"));
+            }
+            continue;
+        }
+        bytes = reinterpret_cast<const uint8_t*>(message.payload.data());
+        if (readLe16(bytes + 6) & FRAME_FLAG_HISTORY) {
+            uint32_t id = readLe32(bytes);
+            if (flagged < replayed) {
+                flagged++;
+            } else if (id == caughtUpId) {
+                fetched = true;
+            }
+        }
+    }
+    EXPECT_EQ(replayed, 3);
+    EXPECT_EQ(flagged, 3);
+    EXPECT_TRUE(fetched);
+
+    client.close();
+    server.stop();
+}
+
+TEST(BridgeHistoryTest, RejectsArgumentsOutOfRange) {
+    BridgeServer server;
+    server.setHistory(2.0);
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    // Reply to a request: "error" (with its code), "history.replay" or "frame"
+    auto replyTo = [&client](const std::string& request) {
+        if (!client.sendText(request)) return std::string("send failed");
+        WsMessage message;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+        while (std::chrono::steady_clock::now() < deadline && client.next(message, 500)) {
+            if (message.opcode == WsOpcode::Binary) return std::string("frame");
+            if (message.opcode != WsOpcode::Text) continue;
+            auto reply = nlohmann::json::parse(message.payload);
+            if (reply["type"] == "error") return "error " + reply["code"].get<std::string>();
+            if (reply["type"] == "history.replay") return std::string("history.replay");
+        }
+        return std::string("no reply");
+    };
+
+    auto replay = [&replyTo](const std::string& field) {
+        return replyTo(R"({"type":"history.replay","stream":"depth",)" + field + "}");
+    };
+    EXPECT_EQ(replay(R"("seconds":-1)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(replay(R"("seconds":0)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(replay(R"("seconds":2.5)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(replay(R"("seconds":1e300)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(replay(R"("seconds":1e400)"), "error PROTOCOL_ERROR");  // Parses as infinity
+    EXPECT_EQ(replay(R"("count":-1)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(replay(R"("seconds":2)"), "history.replay");
+
+    auto get = [&replyTo](const std::string& field) {
+        return replyTo(R"({"type":"history.get","stream":"depth",)" + field + "}");
+    };
+    EXPECT_EQ(get(R"("frame_id":-1)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(get(R"("frame_id":4294967296)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(get(R"("frame_id":1.5)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(get(R"("timestamp_ms":1e30)"), "error PROTOCOL_ERROR");
+    EXPECT_EQ(get(R"("ago_ms":-1)"), "error PROTOCOL_ERROR");  // Used to wrap to the oldest frame
+    EXPECT_EQ(get(R"("frame_id":4294967295)"), "error HISTORY_MISS");
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,211 @@
+/**
+ * @file http_snapshot_test.cpp
+ * @brief Unit tests for snapshot encoders and the bridge HTTP endpoints
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <png.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/snapshot_encoder.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+SharedFrame rgbFrame(uint32_t frameId) {
+    std::vector<uint8_t> data(RGB_FRAME_SIZE);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>((i / 3 + frameId) & 0xFF);
+    }
+    return FramedMessage::binaryFrame(STREAM_TYPE_RGB, frameId, data.data(), data.size());
+}
+
+SharedFrame depthFrame(uint32_t frameId, uint16_t depthMm) {
+    std::vector<uint8_t> data(DEPTH_FRAME_SIZE, 0);
+    // Only the top half has readings
+    for (size_t i = 0; i < FRAME_WIDTH * FRAME_HEIGHT / 2; i++) {
+        data[i * 2] = static_cast<uint8_t>(depthMm);
+        data[i * 2 + 1] = static_cast<uint8_t>(depthMm >> 8);
+    }
+    return FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, frameId, data.data(), data.size());
+}
+
+const uint8_t* dataOf(const SharedFrame& frame) {
+    return frame->payload() + FRAME_HEADER_SIZE;
+}
+
+std::string headerValue(const std::string& response, const std::string& name) {
+    size_t pos = response.find("\r\n" + name + ": ");
+    if (pos == std::string::npos) return "";
+    pos += name.size() + 4;
+    return response.substr(pos, response.find("\r\n", pos) - pos);
+}
+
+std::string bodyOf(const std::string& response) {
+    size_t end = response.find("\r\n\r\n");
+    return end == std::string::npos ? "" : response.substr(end + 4);
+}
+
+}  // namespace
+
+TEST(SnapshotEncoderTest, EncodesJpeg) {
+    auto frame = rgbFrame(1);
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(encodeJpeg(dataOf(frame), FRAME_WIDTH, FRAME_HEIGHT, 80, jpeg));
+    ASSERT_GT(jpeg.size(), 4u);
+    EXPECT_LT(jpeg.size(), RGB_FRAME_SIZE / 4);
+    EXPECT_EQ(jpeg[0], 0xFF);  // SOI
+    EXPECT_EQ(jpeg[1], 0xD8);
+    EXPECT_EQ(jpeg[jpeg.size() - 2], 0xFF);  // EOI
+    EXPECT_EQ(jpeg[jpeg.size() - 1], 0xD9);
+}
+
+TEST(SnapshotEncoderTest, DepthPngRoundTripsSixteenBitSamples) {
+    auto frame = depthFrame(1, 1234);
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(encodeDepthPng(dataOf(frame), FRAME_WIDTH, FRAME_HEIGHT, png));
+
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+    ASSERT_TRUE(png_image_begin_read_from_memory(&image, png.data(), png.size()));
+    EXPECT_EQ(image.width, FRAME_WIDTH);
+    EXPECT_EQ(image.height, FRAME_HEIGHT);
+    EXPECT_TRUE(image.format & PNG_FORMAT_FLAG_LINEAR);  // 16-bit samples
+
+    // The simplified API treats 16-bit grayscale as linear, so it keeps samples as-is
+    image.format = PNG_FORMAT_LINEAR_Y;
+    std::vector<uint16_t> pixels(FRAME_WIDTH * FRAME_HEIGHT);
+    ASSERT_TRUE(png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr));
+    EXPECT_EQ(pixels[0], 1234);
+    EXPECT_EQ(pixels[pixels.size() - 1], 0);
+}
+
+TEST(SnapshotEncoderTest, PlyContainsOnlyValidDepthPixels) {
+    auto depth = depthFrame(1, 2000);
+    auto rgb = rgbFrame(1);
+    std::vector<uint8_t> ply;
+    encodePly(dataOf(depth), dataOf(rgb), FRAME_WIDTH, FRAME_HEIGHT,
+              DepthIntrinsics::kinectDefault(), ply);
+
+    std::string text(ply.begin(), ply.end());
+    size_t headerEnd = text.find("end_header\n");
+    ASSERT_NE(headerEnd, std::string::npos);
+    const size_t points = FRAME_WIDTH * FRAME_HEIGHT / 2;
+    EXPECT_NE(text.find("element vertex " + std::to_string(points) + "\n"), std::string::npos);
+    EXPECT_NE(text.find("property uchar red"), std::string::npos);
+
+    const size_t vertexSize = 3 * sizeof(float) + 3;
+    ASSERT_EQ(ply.size(), headerEnd + 11 + points * vertexSize);
+
+    // First pixel is top-left: left of and above the optical axis
+    float vertex[3];
+    std::memcpy(vertex, ply.data() + headerEnd + 11, sizeof(vertex));
+    EXPECT_LT(vertex[0], 0.0f);
+    EXPECT_GT(vertex[1], 0.0f);
+    EXPECT_FLOAT_EQ(vertex[2], 2.0f);
+}
+
+TEST(SnapshotCacheTest, EncodesOncePerFrame) {
+    SnapshotCache cache;
+    EXPECT_EQ(cache.get(SnapshotFormat::RgbJpeg), nullptr);
+
+    cache.update(STREAM_TYPE_RGB, rgbFrame(5));
+    uint32_t frameId = 0;
+    auto first = cache.get(SnapshotFormat::RgbJpeg, &frameId);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(frameId, 5u);
+    EXPECT_EQ(cache.get(SnapshotFormat::RgbJpeg), first);
+
+    // The broadcast loop resends an unchanged frame as a new message
+    cache.update(STREAM_TYPE_RGB, rgbFrame(5));
+    EXPECT_EQ(cache.get(SnapshotFormat::RgbJpeg), first);
+    EXPECT_EQ(cache.encodes(), 1u);
+
+    cache.update(STREAM_TYPE_RGB, rgbFrame(6));
+    EXPECT_NE(cache.get(SnapshotFormat::RgbJpeg), first);
+    EXPECT_EQ(cache.encodes(), 2u);
+
+    // Formats are cached independently; depth formats need a depth frame
+    EXPECT_EQ(cache.get(SnapshotFormat::DepthPng), nullptr);
+    cache.update(STREAM_TYPE_DEPTH, depthFrame(6, 1500));
+    auto raw = cache.get(SnapshotFormat::DepthRaw);
+    ASSERT_NE(raw, nullptr);
+    EXPECT_EQ(raw->payloadSize(), DEPTH_FRAME_SIZE);
+}
+
+TEST(BridgeHttpTest, ServesSnapshotsAndNotFound) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::string response = httpGet(port, "/depth.raw");
+    ASSERT_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0) << response.substr(0, 80);
+    EXPECT_EQ(headerValue(response, "Content-Type"), "application/octet-stream");
+    EXPECT_EQ(headerValue(response, "Content-Length"), std::to_string(DEPTH_FRAME_SIZE));
+    EXPECT_FALSE(headerValue(response, "X-Frame-Id").empty());
+    EXPECT_EQ(bodyOf(response).size(), DEPTH_FRAME_SIZE);
+
+    response = httpGet(port, "/rgb.jpg?t=1");
+    ASSERT_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+    EXPECT_EQ(headerValue(response, "Content-Type"), "image/jpeg");
+    std::string jpeg = bodyOf(response);
+    EXPECT_EQ(std::to_string(jpeg.size()), headerValue(response, "Content-Length"));
+
+    response = httpGet(port, "/pointcloud.ply");
+    EXPECT_EQ(bodyOf(response).compare(0, 4, "ply\n"), 0);
+
+    response = httpGet(port, "/missing");
+    EXPECT_EQ(response.compare(0, 12, "HTTP/1.1 404"), 0);
+
+    server.stop();
+}
+
+TEST(BridgeHttpTest, StreamsMjpegParts) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    int fd = connectLoopback(port);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(sendGet(fd, "/rgb.mjpeg"));
+
+    // Read until three part boundaries arrived
+    std::string stream;
+    char buffer[65536];
+    size_t parts = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (parts < 3 && std::chrono::steady_clock::now() < deadline) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        stream.append(buffer, static_cast<size_t>(n));
+        parts = 0;
+        for (size_t pos = stream.find("--kinectframe\r\n"); pos != std::string::npos;
+             pos = stream.find("--kinectframe\r\n", pos + 1)) {
+            parts++;
+        }
+    }
+    close(fd);
+
+    ASSERT_EQ(stream.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+    EXPECT_EQ(headerValue(stream, "Content-Type"), "multipart/x-mixed-replace; boundary=kinectframe");
+    EXPECT_GE(parts, 3u);
+    EXPECT_NE(stream.find("Content-Type: image/jpeg\r\n"), std::string::npos);
+
+    server.stop();
+}
@@ -0,0 +1,162 @@
+/**
+ * @file latency_trace_test.cpp
+ * @brief Unit tests for latency histograms and frame tracing
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/latency_trace.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::chrono::microseconds us(int n) {
+    return std::chrono::microseconds(n);
+}
+
+}  // namespace
+
+TEST(LatencyHistogramTest, BucketsCoverEveryValueInOrder) {
+    size_t previous = 0;
+    const uint64_t values[] = {0, 1, 7, 8, 9, 15, 16, 100, 1000, 33333, 1000000, LatencyHistogram::MAX_US};
+    for (uint64_t value : values) {
+        size_t bucket = LatencyHistogram::bucketOf(value);
+        ASSERT_LT(bucket, LatencyHistogram::BUCKET_COUNT) << value;
+        EXPECT_LE(LatencyHistogram::bucketLow(bucket), value);
+        EXPECT_GE(LatencyHistogram::bucketHigh(bucket), value);
+        EXPECT_GE(bucket, previous);
+        previous = bucket;
+    }
+    // Adjacent buckets leave no gaps
+    for (size_t bucket = 1; bucket < LatencyHistogram::BUCKET_COUNT; bucket++) {
+        EXPECT_EQ(LatencyHistogram::bucketLow(bucket), LatencyHistogram::bucketHigh(bucket - 1) + 1) << bucket;
+    }
+    // Out of range values land in the last bucket
+    EXPECT_EQ(LatencyHistogram::bucketOf(~uint64_t{0}), LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(LatencyHistogramTest, SummarizesPercentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.summary().count, 0u);
+    EXPECT_EQ(histogram.percentileUs(0.5), 0u);
+
+    for (int i = 0; i < 90; i++) histogram.record(1000);
+    for (int i = 0; i < 9; i++) histogram.record(10000);
+    histogram.record(50000);
+
+    LatencySummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 100u);
+    EXPECT_EQ(summary.meanUs, (90 * 1000 + 9 * 10000 + 50000) / 100u);
+    EXPECT_EQ(summary.maxUs, 50000u);
+    // Within the ~12% bucket resolution
+    EXPECT_NEAR(static_cast<double>(summary.p50Us), 1000.0, 125.0);
+    EXPECT_NEAR(static_cast<double>(summary.p90Us), 1000.0, 125.0);
+    EXPECT_NEAR(static_cast<double>(summary.p99Us), 10000.0, 1250.0);
+    EXPECT_LE(histogram.percentileUs(1.0), summary.maxUs);
+}
+
+TEST(LatencyTracerTest, RecordsServerSpansOncePerFrame) {
+    LatencyTracer tracer;
+    auto captured = Clock::now();
+    ASSERT_TRUE(tracer.begin(7, captured, 1'000'000));
+    EXPECT_FALSE(tracer.begin(7, captured, 1'000'000));  // Second part of the same frame
+    tracer.stamp(7, TraceStage::Dequeued, captured + us(300));
+    tracer.stamp(7, TraceStage::Framed, captured + us(1300));
+    tracer.finish(7, captured + us(1500));
+    tracer.finish(8, captured + us(1500));  // Never traced
+
+    EXPECT_EQ(tracer.framesTraced(), 1u);
+    const auto& spans = tracer.histograms();
+    EXPECT_EQ(spans[LatencySpan::Cache].summary().maxUs, 300u);
+    EXPECT_EQ(spans[LatencySpan::Framing].summary().maxUs, 1000u);
+    EXPECT_EQ(spans[LatencySpan::Fanout].summary().maxUs, 200u);
+    EXPECT_EQ(spans[LatencySpan::Server].summary().maxUs, 1500u);
+    EXPECT_EQ(spans[LatencySpan::Server].count(), 1u);
+}
+
+TEST(LatencyTracerTest, AcksFeedBridgeAndClientHistograms) {
+    LatencyTracer tracer;
+    LatencyHistograms client;
+    auto captured = Clock::now();
+    tracer.begin(42, captured, 5'000'000);
+    tracer.finish(42, captured + us(500));
+
+    EXPECT_TRUE(tracer.ack(42, 5'020'000, 5'036'000, captured + us(40000), &client));
+    EXPECT_EQ(client[LatencySpan::ToReceive].summary().maxUs, 20000u);
+    EXPECT_EQ(client[LatencySpan::Render].summary().maxUs, 16000u);
+    EXPECT_EQ(client[LatencySpan::ToRender].summary().maxUs, 36000u);
+    EXPECT_EQ(client[LatencySpan::ToAck].summary().maxUs, 40000u);
+    EXPECT_EQ(tracer.histograms()[LatencySpan::ToRender].count(), 1u);
+
+    // A client clock running behind clamps to zero; no render time, no render spans
+    EXPECT_TRUE(tracer.ack(42, 4'990'000, 0, captured + us(40000), &client));
+    EXPECT_EQ(client[LatencySpan::ToReceive].count(), 2u);
+    EXPECT_EQ(client[LatencySpan::ToRender].count(), 1u);
+
+    // Frames that were never traced or fell out of the ring are ignored
+    EXPECT_FALSE(tracer.ack(43, 5'020'000, 0, captured, &client));
+    tracer.begin(42 + LatencyTracer::TRACE_FRAMES, captured, 6'000'000);
+    EXPECT_FALSE(tracer.ack(42, 5'020'000, 0, captured, &client));
+    EXPECT_EQ(tracer.acks(), 2u);
+}
+
+TEST(BridgeLatencyTest, StatusReportsTracedFramesAndAcks) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth"]})", 1);
+    ASSERT_EQ(frames.size(), 1u);
+    uint32_t frameId = readLe32(reinterpret_cast<const uint8_t*>(frames[0].payload.data()));
+
+    double nowMs = std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    nlohmann::json ack = {
+        {"type", "ack"},
+        {"frame_id", frameId},
+        {"received_ms", nowMs},
+        {"rendered_ms", nowMs + 5.0}
+    };
+    ASSERT_TRUE(client.sendText(ack.dump()));
+
+    // The next frame is only broadcast once the first one is fully traced
+    WsMessage message;
+    nextOf(client, WsOpcode::Binary, message);
+    ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+
+    nlohmann::json status;
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (Clock::now() < deadline && client.next(message, 500)) {
+        if (message.opcode != WsOpcode::Text) continue;
+        auto msg = nlohmann::json::parse(message.payload, nullptr, false);
+        ASSERT_NE(msg.value("type", ""), "error") << message.payload;
+        if (msg.value("type", "") == "status") {
+            status = msg;
+            break;
+        }
+    }
+    ASSERT_TRUE(status.is_object());
+    EXPECT_GE(status["latency"]["frames_traced"].get<int>(), 1);
+    EXPECT_EQ(status["latency"]["acks"].get<int>(), 1);
+    EXPECT_TRUE(status["latency"]["spans"].contains("server"));
+    const auto& spans = status["clients"][0]["latency"];
+    ASSERT_TRUE(spans.contains("to_ack"));
+    EXPECT_EQ(spans["render"]["count"].get<int>(), 1);
+    EXPECT_GE(spans["render"]["max_us"].get<int>(), 4000);
+
+    client.close();
+    server.stop();
+}
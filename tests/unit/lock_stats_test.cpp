@@ -0,0 +1,119 @@
+/**
+ * @file lock_stats_test.cpp
+ * @brief Unit tests for instrumented mutexes and their bridge metrics
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/lock_stats.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+TEST(LockStatsTest, RecordsHoldTimeWithoutContention) {
+    InstrumentedMutex mutex("test_uncontended");
+    const LockStats& stats = mutex.stats();
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    EXPECT_EQ(stats.name, "test_uncontended");
+    EXPECT_EQ(stats.acquisitions.load(), 2u);
+    EXPECT_EQ(stats.contended.load(), 0u);
+    EXPECT_EQ(stats.waitNs.load(), 0u);
+    EXPECT_GE(stats.holdNs.load(), 5'000'000u);
+    EXPECT_GE(stats.maxHoldNs.load(), 5'000'000u);
+}
+
+TEST(LockStatsTest, RecordsWaitWhenContended) {
+    InstrumentedMutex mutex("test_contended");
+    std::atomic<bool> held{false};
+
+    std::thread holder([&] {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        held = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+    while (!held) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(mutex.try_lock());
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    }
+    holder.join();
+
+    const LockStats& stats = mutex.stats();
+    EXPECT_EQ(stats.acquisitions.load(), 2u);
+    EXPECT_EQ(stats.contended.load(), 1u);
+    EXPECT_GE(stats.waitNs.load(), 5'000'000u);
+    EXPECT_EQ(stats.maxWaitNs.load(), stats.waitNs.load());
+    EXPECT_GE(stats.maxHoldNs.load(), 20'000'000u);
+}
+
+TEST(LockStatsTest, LocksWithOneNameShareStats) {
+    InstrumentedMutex first("test_shared");
+    InstrumentedMutex second("test_shared");
+    EXPECT_EQ(&first.stats(), &second.stats());
+
+    first.lock();
+    first.unlock();
+    second.lock();
+    second.unlock();
+    EXPECT_EQ(first.stats().acquisitions.load(), 2u);
+
+    size_t named = 0;
+    for (const LockStats* stats : LockStats::all()) {
+        named += stats->name == "test_shared";
+    }
+    EXPECT_EQ(named, 1u);
+}
+
+TEST(BridgeLockStatsTest, StatsReportNamedLocks) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    ASSERT_EQ(subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth"]})", 2).size(), 2u);
+
+    ASSERT_TRUE(client.sendText(R"({"type":"stats"})"));
+    nlohmann::json stats;
+    ASSERT_TRUE(nextOfType(client, "stats", stats));
+
+    const auto& metrics = stats["metrics"];
+    auto valueOf = [&metrics](const std::string& name, const std::string& lock) {
+        if (!metrics.contains(name)) return -1.0;
+        for (const auto& series : metrics[name]) {
+            if (series["labels"]["lock"] == lock) return series["value"].get<double>();
+        }
+        return -1.0;
+    };
+#if KINECT_XR_LOCK_STATS
+    EXPECT_GE(valueOf("kinect_lock_acquisitions_total", "bridge_frame_cache"), 2.0);
+    EXPECT_GE(valueOf("kinect_lock_hold_seconds_total", "bridge_frame_cache"), 0.0);
+    EXPECT_GE(valueOf("kinect_lock_acquisitions_total", "clients"), 2.0);  // Connect and subscribe
+    EXPECT_GE(valueOf("kinect_lock_contended_total", "clients"), 0.0);
+#else
+    // Compiled out: NamedMutex registers nothing
+    EXPECT_EQ(valueOf("kinect_lock_acquisitions_total", "bridge_frame_cache"), -1.0);
+#endif
+
+    client.close();
+    server.stop();
+}
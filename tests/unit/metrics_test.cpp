@@ -0,0 +1,123 @@
+/**
+ * @file metrics_test.cpp
+ * @brief Unit tests for the metrics registry and the bridge metrics endpoints
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/metrics.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line) != std::string::npos;
+}
+
+}  // namespace
+
+TEST(MetricsRegistryTest, ExportsCountersAndGaugesAsPrometheusText) {
+    MetricsRegistry registry;
+    Counter& rgb = registry.counter("test_frames_total", "Frames", {{"stream", "rgb"}});
+    Counter& depth = registry.counter("test_frames_total", "Frames", {{"stream", "depth"}});
+    Gauge& temperature = registry.gauge("test_temperature", "Temperature");
+    double sampledValue = 3;
+    registry.sampled(MetricType::Gauge, "test_sampled", "Read on export", {{"name", "quote\"d"}},
+                     [&sampledValue] { return sampledValue; });
+
+    rgb.add();
+    rgb.add(2);
+    depth.add();
+    temperature.set(21.5);
+    sampledValue = 4;
+
+    std::string text = registry.prometheusText();
+    EXPECT_TRUE(contains(text, "# HELP test_frames_total Frames\n# TYPE test_frames_total counter\n"));
+    EXPECT_TRUE(contains(text, "test_frames_total{stream=\"rgb\"} 3\n"));
+    EXPECT_TRUE(contains(text, "test_frames_total{stream=\"depth\"} 1\n"));
+    EXPECT_TRUE(contains(text, "# TYPE test_temperature gauge\ntest_temperature 21.5\n"));
+    EXPECT_TRUE(contains(text, "test_sampled{name=\"quote\\\"d\"} 4\n"));
+    // One HELP/TYPE block per family
+    EXPECT_EQ(text.find("# TYPE test_frames_total"), text.rfind("# TYPE test_frames_total"));
+
+    nlohmann::json json = registry.toJson();
+    ASSERT_EQ(json["test_frames_total"].size(), 2u);
+    EXPECT_EQ(json["test_frames_total"][0]["labels"]["stream"], "rgb");
+    EXPECT_EQ(json["test_frames_total"][0]["value"].get<double>(), 3.0);
+    EXPECT_EQ(json["test_temperature"][0]["value"].get<double>(), 21.5);
+}
+
+TEST(MetricsRegistryTest, ExportsHistogramsInSeconds) {
+    MetricsRegistry registry;
+    LatencyHistogram& owned = registry.histogram("test_latency_seconds", "Latency", {{"stage", "a"}});
+    LatencyHistogram external;
+    registry.histogramView("test_latency_seconds", "Latency", {{"stage", "b"}}, external);
+
+    owned.record(50);       // Below the first bound
+    owned.record(1000);     // Between 2^9 and 2^10 us
+    owned.record(5000000);  // 5 s
+    external.record(100);
+
+    std::string text = registry.prometheusText();
+    EXPECT_TRUE(contains(text, "# TYPE test_latency_seconds histogram\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"6.4e-05\"} 1\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"0.000512\"} 1\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"0.001024\"} 2\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"4.194304\"} 2\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"8.388608\"} 3\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_bucket{stage=\"a\",le=\"+Inf\"} 3\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_sum{stage=\"a\"} 5.00105\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_count{stage=\"a\"} 3\n"));
+    EXPECT_TRUE(contains(text, "test_latency_seconds_count{stage=\"b\"} 1\n"));
+
+    nlohmann::json json = registry.toJson();
+    EXPECT_EQ(json["test_latency_seconds"][0]["count"].get<int>(), 3);
+    EXPECT_EQ(json["test_latency_seconds"][0]["max_us"].get<int>(), 5000000);
+    EXPECT_EQ(json["test_latency_seconds"][1]["labels"]["stage"], "b");
+}
+
+TEST(BridgeMetricsTest, ServesPrometheusTextAndStatsMessage) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    // Let a few frames through the pipeline
+    auto frames = subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth","pointcloud"]})", 4);
+    ASSERT_EQ(frames.size(), 4u);
+
+    std::string response = httpGet(port, "/metrics");
+    ASSERT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << response.substr(0, 200);
+    EXPECT_TRUE(contains(response, "Content-Type: text/plain; version=0.0.4"));
+    EXPECT_TRUE(contains(response, "# TYPE kinect_device_frames_total counter\n"));
+    EXPECT_TRUE(contains(response, "kinect_device_connected 1\n"));
+    EXPECT_TRUE(contains(response, "kinect_clients 1\n"));
+    EXPECT_TRUE(contains(response, "kinect_encode_seconds_count{stream=\"pointcloud\"}"));
+    EXPECT_TRUE(contains(response, "kinect_frame_latency_seconds_bucket{span=\"server\",le=\"+Inf\"}"));
+    EXPECT_TRUE(contains(response, "kinect_send_queue_bytes{priority=\"video\"}"));
+
+    ASSERT_TRUE(client.sendText(R"({"type":"stats"})"));
+    nlohmann::json stats;
+    ASSERT_TRUE(nextOfType(client, "stats", stats));
+    const auto& metrics = stats["metrics"];
+    EXPECT_GE(metrics["kinect_broadcasts_total"][0]["value"].get<double>(), 2.0);
+    EXPECT_GT(metrics["kinect_bytes_queued_total"][0]["value"].get<double>(), 0.0);
+    EXPECT_GE(metrics["kinect_encodes_total"][0]["value"].get<double>(), 2.0);
+    EXPECT_EQ(metrics["kinect_encodes_total"][0]["labels"]["stream"], "pointcloud");
+    EXPECT_GE(metrics["kinect_device_frames_total"][1]["value"].get<double>(), 2.0);
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,196 @@
+/**
+ * @file multicast_test.cpp
+ * @brief Unit tests for multicast fragmentation, FEC and reassembly
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/multicast.h"
+
+using namespace kinect_xr;
+
+namespace {
+
+using Datagram = std::vector<uint8_t>;
+
+std::vector<uint8_t> makeFrame(size_t size, uint8_t seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(i * 31 + seed);
+    }
+    return data;
+}
+
+std::vector<Datagram> fragment(const MulticastConfig& config, uint16_t streamType,
+                               uint32_t frameId, uint32_t sequence,
+                               const std::vector<uint8_t>& data) {
+    std::vector<Datagram> datagrams;
+    fragmentFrame(config, streamType, frameId, sequence, data.data(), data.size(), 0,
+                  [&](const uint8_t* bytes, size_t size) {
+        datagrams.emplace_back(bytes, bytes + size);
+    });
+    return datagrams;
+}
+
+void feed(FrameReassembler& reassembler, const std::vector<Datagram>& datagrams) {
+    for (const auto& datagram : datagrams) {
+        reassembler.ingest(datagram.data(), datagram.size());
+    }
+}
+
+MulticastConfig smallDatagrams(int fecGroup = 0) {
+    MulticastConfig config;
+    config.datagramSize = MULTICAST_HEADER_SIZE + 100;
+    config.fecGroup = fecGroup;
+    return config;
+}
+
+}  // namespace
+
+TEST(MulticastFragmentTest, SplitsFrameIntoMtuSizedDatagrams) {
+    MulticastConfig config;
+    auto data = makeFrame(DEPTH_FRAME_SIZE, 1);
+    auto datagrams = fragment(config, STREAM_TYPE_DEPTH, 5, 0, data);
+
+    size_t fragmentSize = config.datagramSize - MULTICAST_HEADER_SIZE;
+    EXPECT_EQ(datagrams.size(), (data.size() + fragmentSize - 1) / fragmentSize);
+    for (const auto& datagram : datagrams) {
+        EXPECT_LE(datagram.size(), config.datagramSize);
+    }
+}
+
+TEST(MulticastFragmentTest, AddsOneParityDatagramPerGroup) {
+    auto data = makeFrame(1050, 2);  // 11 fragments of 100 bytes
+    EXPECT_EQ(fragment(smallDatagrams(4), STREAM_TYPE_RGB, 1, 0, data).size(), 11u + 3u);
+}
+
+TEST(MulticastReassemblyTest, ReassemblesOutOfOrderFragments) {
+    auto data = makeFrame(1050, 3);
+    auto datagrams = fragment(smallDatagrams(), STREAM_TYPE_RGB, 42, 0, data);
+    std::swap(datagrams.front(), datagrams.back());
+    std::swap(datagrams[3], datagrams[7]);
+
+    FrameReassembler reassembler;
+    feed(reassembler, datagrams);
+
+    MulticastFrame frame;
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_EQ(frame.frameId, 42u);
+    EXPECT_EQ(frame.streamType, STREAM_TYPE_RGB);
+    EXPECT_FALSE(frame.repaired);
+    EXPECT_EQ(frame.data, data);
+    EXPECT_FALSE(reassembler.pop(frame));
+}
+
+TEST(MulticastReassemblyTest, ParityRepairsOneLossPerGroup) {
+    auto data = makeFrame(1050, 4);
+    auto datagrams = fragment(smallDatagrams(4), STREAM_TYPE_DEPTH, 7, 0, data);
+
+    // Drop fragment 1 (group 0) and the short last fragment 10 (group 2)
+    datagrams.erase(datagrams.begin() + 12);  // Fragment 10
+    datagrams.erase(datagrams.begin() + 1);   // Fragment 1
+
+    FrameReassembler reassembler;
+    feed(reassembler, datagrams);
+
+    MulticastFrame frame;
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_TRUE(frame.repaired);
+    EXPECT_EQ(frame.data, data);
+    EXPECT_EQ(reassembler.stats().fragmentsRecovered, 2u);
+}
+
+TEST(MulticastReassemblyTest, ReportsUnrecoverableLoss) {
+    auto config = smallDatagrams(4);
+    auto first = fragment(config, STREAM_TYPE_DEPTH, 1, 0, makeFrame(1050, 5));
+    auto second = fragment(config, STREAM_TYPE_DEPTH, 2, 1, makeFrame(1050, 6));
+    auto third = fragment(config, STREAM_TYPE_DEPTH, 3, 2, makeFrame(1050, 7));
+
+    // Two losses in one group defeat XOR parity
+    second.erase(second.begin() + 1, second.begin() + 3);
+
+    FrameReassembler reassembler;
+    feed(reassembler, first);
+    feed(reassembler, second);
+    feed(reassembler, third);
+
+    MulticastFrame frame;
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_EQ(frame.frameId, 1u);
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_EQ(frame.frameId, 3u);
+    EXPECT_FALSE(reassembler.pop(frame));
+
+    const auto& stats = reassembler.stats();
+    EXPECT_EQ(stats.framesCompleted, 2u);
+    EXPECT_EQ(stats.framesLost, 1u);
+    EXPECT_EQ(stats.fragmentsLost, 2u);
+}
+
+TEST(MulticastReassemblyTest, IgnoresLateFragmentsAndGarbage) {
+    auto config = smallDatagrams();
+    auto data = makeFrame(300, 8);
+    auto datagrams = fragment(config, STREAM_TYPE_RGB, 1, 0, data);
+
+    FrameReassembler reassembler;
+    feed(reassembler, datagrams);
+    feed(reassembler, datagrams);  // Duplicates after delivery
+
+    uint8_t garbage[40] = {};
+    reassembler.ingest(garbage, sizeof(garbage));
+
+    MulticastFrame frame;
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_FALSE(reassembler.pop(frame));
+    EXPECT_EQ(reassembler.stats().malformed, 1u);
+}
+
+TEST(MulticastReassemblyTest, StreamsAreTrackedIndependently) {
+    auto config = smallDatagrams();
+    auto rgb = fragment(config, STREAM_TYPE_RGB, 10, 0, makeFrame(250, 9));
+    auto depth = fragment(config, STREAM_TYPE_DEPTH, 10, 0, makeFrame(250, 10));
+
+    FrameReassembler reassembler;
+    for (size_t i = 0; i < rgb.size(); i++) {
+        reassembler.ingest(rgb[i].data(), rgb[i].size());
+        reassembler.ingest(depth[i].data(), depth[i].size());
+    }
+
+    MulticastFrame frame;
+    ASSERT_TRUE(reassembler.pop(frame));
+    ASSERT_TRUE(reassembler.pop(frame));
+    EXPECT_EQ(reassembler.stats().framesLost, 0u);
+}
+
+TEST(MulticastLoopbackTest, DeliversFramesOverLoopbackGroup) {
+    MulticastConfig config;
+    config.group = "239.255.42.99";
+    config.port = 20000 + static_cast<int>(getpid() % 20000);
+    config.interfaceAddr = "127.0.0.1";
+    config.fecGroup = 8;
+
+    MulticastReceiver receiver;
+    if (!receiver.open(config)) {
+        GTEST_SKIP() << "Multicast not available on loopback";
+    }
+    MulticastSender sender;
+    ASSERT_TRUE(sender.open(config));
+
+    auto data = makeFrame(DEPTH_FRAME_SIZE, 11);
+    ASSERT_TRUE(sender.send(STREAM_TYPE_DEPTH, 99, data.data(), data.size()));
+
+    MulticastFrame frame;
+    if (!receiver.next(frame, 2000)) {
+        GTEST_SKIP() << "Loopback interface does not route multicast";
+    }
+    EXPECT_EQ(frame.frameId, 99u);
+    EXPECT_EQ(frame.streamType, STREAM_TYPE_DEPTH);
+    EXPECT_EQ(frame.data, data);
+    EXPECT_GT(sender.datagramsSent(), 0u);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file pixel_format_test.cpp
+ * @brief Unit tests for RGB pixel format conversion
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/pixel_format.h"
+#include "kinect_xr/rate_controller.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+std::vector<uint8_t> testPixels(size_t count) {
+    std::vector<uint8_t> rgb(count * 3);
+    for (size_t i = 0; i < rgb.size(); i++) {
+        rgb[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    return rgb;
+}
+
+}  // namespace
+
+TEST(PixelFormatTest, ConvertsEveryPixelIncludingTheTail) {
+    // Counts around the 16- and 4-pixel kernel widths
+    for (size_t count : {0u, 1u, 3u, 4u, 5u, 15u, 16u, 17u, 31u, 33u, 640u * 480u}) {
+        auto rgb = testPixels(count);
+        std::vector<uint8_t> rgba(count * 4, 0);
+        std::vector<uint8_t> bgra(count * 4, 0);
+        convertRgbPixels(rgb.data(), count, PixelFormat::Rgba8888, rgba.data());
+        convertRgbPixels(rgb.data(), count, PixelFormat::Bgra8888, bgra.data());
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* in = &rgb[i * 3];
+            ASSERT_EQ(rgba[i * 4], in[0]) << "count " << count << " pixel " << i;
+            ASSERT_EQ(rgba[i * 4 + 1], in[1]);
+            ASSERT_EQ(rgba[i * 4 + 2], in[2]);
+            ASSERT_EQ(rgba[i * 4 + 3], 255);
+            ASSERT_EQ(bgra[i * 4], in[2]) << "count " << count << " pixel " << i;
+            ASSERT_EQ(bgra[i * 4 + 1], in[1]);
+            ASSERT_EQ(bgra[i * 4 + 2], in[0]);
+            ASSERT_EQ(bgra[i * 4 + 3], 255);
+        }
+    }
+}
+
+TEST(PixelFormatTest, ParsesWireNames) {
+    PixelFormat format = PixelFormat::Rgb888;
+    EXPECT_TRUE(parsePixelFormat("BGRA8888", format));
+    EXPECT_EQ(format, PixelFormat::Bgra8888);
+    EXPECT_TRUE(parsePixelFormat("RGBA8888", format));
+    EXPECT_EQ(format, PixelFormat::Rgba8888);
+    EXPECT_TRUE(parsePixelFormat("RGB888", format));
+    EXPECT_EQ(format, PixelFormat::Rgb888);
+    EXPECT_FALSE(parsePixelFormat("rgba", format));
+    EXPECT_EQ(bytesPerPixel(PixelFormat::Rgb888), 3u);
+    EXPECT_EQ(bytesPerPixel(PixelFormat::Bgra8888), 4u);
+}
+
+TEST(PixelFormatTest, ConvertedFramesRecordTheFormatAndKeepTheScale) {
+    auto rgb = testPixels(FRAME_WIDTH * FRAME_HEIGHT);
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_RGB, 42, rgb.data(), rgb.size());
+    auto half = downscaleFrame(frame, 1);
+    ASSERT_TRUE(half);
+
+    auto converted = convertRgbFrame(half, PixelFormat::Bgra8888);
+    ASSERT_TRUE(converted);
+    const uint8_t* p = converted->payload();
+    EXPECT_EQ(converted->payloadSize(), FRAME_HEADER_SIZE + (FRAME_WIDTH / 2) * (FRAME_HEIGHT / 2) * 4);
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_RGB);
+    uint16_t flags = readLe16(p + 6);
+    EXPECT_EQ((flags & FRAME_FLAG_SCALE_MASK) >> FRAME_FLAG_SCALE_SHIFT, 1);
+    EXPECT_EQ((flags & FRAME_FLAG_PIXEL_FORMAT_MASK) >> FRAME_FLAG_PIXEL_FORMAT_SHIFT,
+              static_cast<int>(PixelFormat::Bgra8888));
+    const uint8_t* src = half->payload() + FRAME_HEADER_SIZE;
+    EXPECT_EQ(p[FRAME_HEADER_SIZE], src[2]);
+    EXPECT_EQ(p[FRAME_HEADER_SIZE + 2], src[0]);
+
+    // Only RGB888 frames convert, and only once
+    EXPECT_FALSE(convertRgbFrame(converted, PixelFormat::Rgba8888));
+    EXPECT_FALSE(convertRgbFrame(frame, PixelFormat::Rgb888));
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE, 0);
+    EXPECT_FALSE(convertRgbFrame(
+        FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 1, depth.data(), depth.size()), PixelFormat::Rgba8888));
+}
+
+TEST(BridgePixelFormatTest, SendsRgbInTheSubscribedFormat) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(
+        client, R"({"type":"subscribe","streams":["rgb"],"rgb_format":"RGBA8888"})", 1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+    const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_RGB);
+    EXPECT_EQ((readLe16(p + 6) & FRAME_FLAG_PIXEL_FORMAT_MASK) >> FRAME_FLAG_PIXEL_FORMAT_SHIFT,
+              static_cast<int>(PixelFormat::Rgba8888));
+    ASSERT_EQ(message.payload.size(), FRAME_HEADER_SIZE + FRAME_WIDTH * FRAME_HEIGHT * 4);
+    EXPECT_EQ(p[FRAME_HEADER_SIZE + 3], 255);
+
+    // Unknown formats are rejected
+    EXPECT_TRUE(rejects(client, R"({"type":"subscribe","streams":["rgb"],"rgb_format":"YUYV"})"));
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,143 @@
+/**
+ * @file point_cloud_test.cpp
+ * @brief Unit tests for the pointcloud stream
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/point_cloud.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+// Depth readings only at the given pixels
+std::vector<uint8_t> sparseDepth(const std::vector<std::pair<uint32_t, uint16_t>>& readings) {
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE, 0);
+    for (const auto& reading : readings) {
+        depth[reading.first * 2] = static_cast<uint8_t>(reading.second);
+        depth[reading.first * 2 + 1] = static_cast<uint8_t>(reading.second >> 8);
+    }
+    return depth;
+}
+
+uint32_t pixel(uint32_t u, uint32_t v) {
+    return v * FRAME_WIDTH + u;
+}
+
+}  // namespace
+
+TEST(PointCloudTest, HalfFloatRoundTrips) {
+    for (float value : {0.0f, 1.0f, -2.5f, 0.001f, 3.999f, 65504.0f}) {
+        EXPECT_NEAR(halfToFloat(floatToHalf(value)), value, std::fabs(value) / 1024.0f + 1e-7f) << value;
+    }
+    EXPECT_EQ(floatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(floatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(floatToHalf(1e6f), 0x7C00);   // Overflow becomes infinity
+    EXPECT_EQ(floatToHalf(1e-9f), 0x0000);  // Underflow becomes zero
+}
+
+TEST(PointCloudTest, KeepsOnlyValidPointsInPixelOrder) {
+    const DepthIntrinsics intrinsics = DepthIntrinsics::kinectDefault();
+    auto depth = sparseDepth({{pixel(320, 240), 2000}, {pixel(0, 0), 1000}, {pixel(638, 478), 3000}});
+    std::vector<uint8_t> rgb(RGB_FRAME_SIZE, 0);
+    rgb[pixel(320, 240) * 3] = 200;
+
+    PointCloudParams params;
+    params.decimation = 2;
+    params.color = true;
+    auto frame = encodePointCloud(42, depth.data(), rgb.data(), intrinsics, params);
+    ASSERT_NE(frame, nullptr);
+
+    const uint8_t* p = frame->payload();
+    EXPECT_EQ(readLe32(p), 42u);
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_POINTCLOUD);
+    p += FRAME_HEADER_SIZE;
+    ASSERT_EQ(readLe32(p), 3u);
+    EXPECT_EQ(p[4], static_cast<uint8_t>(PointFormat::Int16Mm));
+    EXPECT_EQ(p[5], 2);
+    EXPECT_EQ(p[6], POINT_CLOUD_FLAG_COLOR);
+    ASSERT_EQ(frame->payloadSize(), FRAME_HEADER_SIZE + POINT_CLOUD_HEADER_SIZE + 3 * 9);
+
+    // Row-major: top-left first, then the centre, then the bottom-right
+    const uint8_t* positions = p + POINT_CLOUD_HEADER_SIZE;
+    auto coord = [positions](int point, int axis) {
+        return static_cast<int16_t>(readLe16(positions + point * 6 + axis * 2));
+    };
+    EXPECT_LT(coord(0, 0), 0);  // Left of and above the optical axis
+    EXPECT_GT(coord(0, 1), 0);
+    EXPECT_EQ(coord(0, 2), 1000);
+    EXPECT_EQ(coord(1, 0), 0);  // On the optical axis
+    EXPECT_EQ(coord(1, 1), 0);
+    EXPECT_EQ(coord(1, 2), 2000);
+    EXPECT_NEAR(coord(2, 0), (638 - intrinsics.cx) * 3000 / intrinsics.fx, 1.0);
+    EXPECT_EQ(coord(2, 2), 3000);
+
+    const uint8_t* colors = positions + 3 * 6;
+    EXPECT_EQ(colors[3], 200);  // Second point's red
+}
+
+TEST(PointCloudTest, DecimationRangeAndHalfFloats) {
+    const DepthIntrinsics intrinsics = DepthIntrinsics::kinectDefault();
+    // (1, 1) is skipped by decimation 2; 500 mm falls below the range
+    auto depth = sparseDepth({{pixel(1, 1), 2000}, {pixel(2, 2), 500}, {pixel(4, 4), 1500}});
+
+    PointCloudParams params;
+    params.decimation = 2;
+    params.format = PointFormat::Float16Metres;
+    params.color = true;  // No RGB image: no colors
+    params.minDepthMm = 800;
+    auto frame = encodePointCloud(1, depth.data(), nullptr, intrinsics, params);
+
+    const uint8_t* p = frame->payload() + FRAME_HEADER_SIZE;
+    ASSERT_EQ(readLe32(p), 1u);
+    EXPECT_EQ(p[6], 0);
+    ASSERT_EQ(frame->payloadSize(), FRAME_HEADER_SIZE + POINT_CLOUD_HEADER_SIZE + 6);
+    EXPECT_FLOAT_EQ(halfToFloat(readLe16(p + POINT_CLOUD_HEADER_SIZE + 4)), 1.5f);
+}
+
+TEST(BridgePointCloudTest, StreamsCompactPointsToSubscribers) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    nlohmann::json hello;
+    ASSERT_TRUE(nextOfType(client, "hello", hello));
+    EXPECT_TRUE(hello["capabilities"].contains("pointcloud"));
+
+    auto frames = subscribeAndCollect(
+        client,
+        R"({"type":"subscribe","streams":["pointcloud"],"pointcloud":{"decimation":4,"format":"float16"}})",
+        1);
+    ASSERT_EQ(frames.size(), 1u);
+    const WsMessage& message = frames[0];
+
+    const auto* p = reinterpret_cast<const uint8_t*>(message.payload.data());
+    EXPECT_EQ(readLe16(p + 4), STREAM_TYPE_POINTCLOUD);
+    uint32_t count = readLe32(p + FRAME_HEADER_SIZE);
+    EXPECT_GT(count, 0u);
+    EXPECT_LE(count, (FRAME_WIDTH / 4) * (FRAME_HEIGHT / 4));
+    EXPECT_EQ(p[FRAME_HEADER_SIZE + 5], 4);
+    EXPECT_EQ(message.payload.size(), FRAME_HEADER_SIZE + POINT_CLOUD_HEADER_SIZE + count * 6);
+
+    // Invalid options are rejected
+    EXPECT_TRUE(rejects(
+        client, R"({"type":"subscribe","streams":["pointcloud"],"pointcloud":{"decimation":3}})"));
+
+    client.close();
+    server.stop();
+}
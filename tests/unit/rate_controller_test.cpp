@@ -0,0 +1,203 @@
+/**
+ * @file rate_controller_test.cpp
+ * @brief Unit tests for per-client adaptive delivery
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/rate_controller.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+constexpr double FULL_RATE = (RGB_FRAME_SIZE + DEPTH_FRAME_SIZE) * 30.0;  // ~46 MB/s
+
+/**
+ * @brief Send queue drained by a link of fixed throughput, ticked at 30 Hz
+ */
+struct SimulatedLink {
+    RateController rate;
+    double bytesPerSecond;
+    bool adaptive;
+    double queued = 0;
+    uint32_t frameId = 0;
+    RateController::Clock::time_point now{std::chrono::seconds(1)};
+
+    SimulatedLink(double linkRate, bool downscale) : bytesPerSecond(linkRate), adaptive(downscale) {}
+
+    void run(double seconds) {
+        const auto tick = std::chrono::microseconds(33333);
+        for (int i = 0; i < static_cast<int>(seconds * 30); i++) {
+            frameId++;
+            DeliveryVariant variant = rate.variant();
+            if (variant.sends(frameId)) {
+                double bytes = FULL_RATE / 30.0 / (1 << (2 * variant.scaleShift));
+                queued += bytes;
+                rate.onQueued(static_cast<size_t>(bytes));
+            }
+            queued = std::max(0.0, queued - bytesPerSecond / 30.0);
+            now += tick;
+            rate.update(static_cast<size_t>(queued), FULL_RATE, adaptive, now);
+        }
+    }
+
+    double sendRate() const { return FULL_RATE * rate.variant().costFactor(); }
+};
+
+SharedFrame rgbFrame() {
+    std::vector<uint8_t> data(RGB_FRAME_SIZE);
+    for (uint32_t y = 0; y < FRAME_HEIGHT; y++) {
+        for (uint32_t x = 0; x < FRAME_WIDTH; x++) {
+            uint8_t* p = &data[(y * FRAME_WIDTH + x) * 3];
+            p[0] = static_cast<uint8_t>(x % 2 ? 100 : 200);  // Averages to 150 per 2x2 block
+            p[1] = 7;
+            p[2] = static_cast<uint8_t>(y);
+        }
+    }
+    return FramedMessage::binaryFrame(STREAM_TYPE_RGB, 12, data.data(), data.size());
+}
+
+}  // namespace
+
+TEST(RateControllerTest, LaddersGetCheaperStepByStep) {
+    for (bool downscale : {false, true}) {
+        size_t count = 0;
+        const DeliveryVariant* ladder = deliveryLadder(downscale, count);
+        ASSERT_GE(count, 4u);
+        EXPECT_DOUBLE_EQ(ladder[0].costFactor(), 1.0);
+        for (size_t i = 1; i < count; i++) {
+            EXPECT_LT(ladder[i].costFactor(), ladder[i - 1].costFactor());
+            if (!downscale) {
+                EXPECT_EQ(ladder[i].scaleShift, 0);
+            }
+        }
+    }
+    EXPECT_EQ((DeliveryVariant{1, 2}.name()), "320x240@15");
+}
+
+TEST(RateControllerTest, DownscalesRgbAndDepth) {
+    auto scaled = downscaleFrame(rgbFrame(), 1);
+    ASSERT_NE(scaled, nullptr);
+    ASSERT_EQ(scaled->payloadSize(), FRAME_HEADER_SIZE + RGB_FRAME_SIZE / 4);
+    const uint8_t* p = scaled->payload();
+    EXPECT_EQ(p[0], 12);  // Frame ID kept
+    EXPECT_EQ((p[6] | (p[7] << 8)) & FRAME_FLAG_SCALE_MASK, 1 << FRAME_FLAG_SCALE_SHIFT);
+    const uint8_t* pixel = p + FRAME_HEADER_SIZE + (10 * 320 + 5) * 3;
+    EXPECT_EQ(pixel[0], 150);
+    EXPECT_EQ(pixel[1], 7);
+    EXPECT_EQ(pixel[2], 20);  // Rows 20 and 21 average to 20 (rounded down)
+
+    // Depth keeps a real sample instead of averaging with holes
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE, 0);
+    depth[(1 * FRAME_WIDTH + 3) * 2] = 0xD0;  // 2000 mm at (3, 1)
+    depth[(1 * FRAME_WIDTH + 3) * 2 + 1] = 0x07;
+    auto depthScaled = downscaleFrame(
+        FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 1, depth.data(), depth.size()), 2);
+    ASSERT_NE(depthScaled, nullptr);
+    ASSERT_EQ(depthScaled->payloadSize(), FRAME_HEADER_SIZE + DEPTH_FRAME_SIZE / 16);
+    const uint8_t* d = depthScaled->payload() + FRAME_HEADER_SIZE;
+    EXPECT_EQ(d[0] | (d[1] << 8), 2000);
+    EXPECT_EQ(d[2] | (d[3] << 8), 0);
+
+    // Already scaled frames are left alone
+    EXPECT_EQ(downscaleFrame(scaled, 1), nullptr);
+}
+
+TEST(RateControllerTest, FastLinkStaysAtFullQuality) {
+    SimulatedLink link(FULL_RATE * 3, true);
+    link.run(5.0);
+    EXPECT_EQ(link.rate.variant().scaleShift, 0);
+    EXPECT_EQ(link.rate.variant().frameDivider, 1);
+    EXPECT_EQ(link.rate.switches(), 0u);
+    EXPECT_GT(link.rate.estimatedBytesPerSecond(), FULL_RATE * 0.8);
+}
+
+TEST(RateControllerTest, SlowLinkSettlesOnAFittingVariant) {
+    const double linkRate = 4e6;  // 4 MB/s: about a tenth of the full rate
+    SimulatedLink link(linkRate, true);
+    link.run(10.0);
+
+    EXPECT_GT(link.rate.variant().scaleShift, 0);
+    EXPECT_NEAR(static_cast<double>(link.rate.estimatedBytesPerSecond()), linkRate, linkRate * 0.3);
+
+    // Once settled the queue stays short on average (occasional probes aside)
+    double queuedSum = 0;
+    for (int i = 0; i < 300; i++) {
+        link.run(1.0 / 30);
+        queuedSum += link.queued;
+    }
+    EXPECT_LT(queuedSum / 300 / linkRate, 0.2);  // Average queue under 200 ms
+}
+
+TEST(RateControllerTest, NonAdaptiveClientsOnlyLoseFrameRate) {
+    SimulatedLink link(FULL_RATE / 3, false);
+    link.run(10.0);
+    EXPECT_EQ(link.rate.variant().scaleShift, 0);
+    EXPECT_GT(link.rate.variant().frameDivider, 1);
+    EXPECT_LE(link.sendRate(), FULL_RATE / 3);
+}
+
+TEST(RateControllerTest, RecoversWhenTheLinkImproves) {
+    SimulatedLink link(3e6, true);
+    link.run(8.0);
+    ASSERT_GT(link.rate.variant().scaleShift, 0);
+
+    link.bytesPerSecond = FULL_RATE * 2;
+    link.run(30.0);
+    EXPECT_EQ(link.rate.variant().scaleShift, 0);
+    EXPECT_EQ(link.rate.variant().frameDivider, 1);
+}
+
+TEST(RateControllerTest, StepsDownWhenRoundTripsGrow) {
+    // The send queue drains, but data piles up further along the path
+    SimulatedLink link(FULL_RATE * 3, true);
+    link.run(1.0);
+    link.rate.onRoundTrip(230000, 20000, link.now);
+    link.run(0.2);
+    EXPECT_GT(link.rate.switches(), 0u);
+    EXPECT_EQ(link.rate.networkDelayUs(), 210000u);
+
+    // A client that stopped syncing no longer holds quality down
+    size_t switches = link.rate.switches();
+    link.run(10.0);
+    EXPECT_GT(link.rate.switches(), switches);
+    EXPECT_EQ(link.rate.variant().scaleShift, 0);
+    EXPECT_EQ(link.rate.variant().frameDivider, 1);
+}
+
+TEST(BridgeRateTest, StatusReportsEachClientsVariant) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    ASSERT_TRUE(client.sendText(R"({"type":"subscribe","streams":["depth"],"adaptive":true})"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+
+    nlohmann::json status;
+    ASSERT_TRUE(nextOfType(client, "status", status, 2000));
+    ASSERT_EQ(status["clients"].size(), 1u);
+    const auto& self = status["clients"][0];
+    EXPECT_TRUE(self["self"].get<bool>());
+    EXPECT_TRUE(self["adaptive"].get<bool>());
+    EXPECT_EQ(self["variant"], "640x480@30");  // Loopback is fast
+    EXPECT_GT(self["estimated_kbps"].get<uint64_t>(), 0u);
+
+    client.close();
+    server.stop();
+}
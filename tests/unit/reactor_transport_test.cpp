@@ -0,0 +1,239 @@
+/**
+ * @file reactor_transport_test.cpp
+ * @brief Unit tests for the event-reactor WebSocket transport (loopback only)
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kinect_xr/reactor_transport.h"
+
+using namespace kinect_xr;
+
+namespace {
+
+int connectLoopback(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+std::string readHttpResponse(int fd, std::string& leftover) {
+    std::string response;
+    char buffer[4096];
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        response.append(buffer, n);
+    }
+    size_t end = response.find("\r\n\r\n");
+    if (end != std::string::npos) {
+        leftover = response.substr(end + 4);
+        response.resize(end + 4);
+    }
+    return response;
+}
+
+// Client → server frames must be masked
+std::vector<uint8_t> maskedTextFrame(const std::string& text) {
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::vector<uint8_t> frame = {0x81, static_cast<uint8_t>(0x80 | text.size()),
+                                  mask[0], mask[1], mask[2], mask[3]};
+    for (size_t i = 0; i < text.size(); i++) {
+        frame.push_back(static_cast<uint8_t>(text[i]) ^ mask[i & 3]);
+    }
+    return frame;
+}
+
+bool readMessage(int fd, WsFrameParser& parser, WsMessage& message) {
+    uint8_t buffer[65536];
+    while (!parser.next(message)) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0 || parser.failed()) return false;
+        parser.append(buffer, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+const char* UPGRADE_REQUEST =
+    "GET /kinect HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+    "Sec-WebSocket-Version: 13\r\n\r\n";
+
+}  // namespace
+
+class ReactorTransportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        callbacks_.onOpen = [this](const ClientPtr& client) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.push_back(client);
+            cv_.notify_all();
+        };
+        callbacks_.onMessage = [this](const ClientPtr&, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            messages_.push_back(message);
+            cv_.notify_all();
+        };
+        callbacks_.onClose = [this](const ClientPtr&) {
+            closed_++;
+            cv_.notify_all();
+        };
+        ASSERT_TRUE(transport_.start(0, callbacks_));
+        ASSERT_GT(transport_.port(), 0);
+    }
+
+    void TearDown() override { transport_.stop(); }
+
+    template <typename Pred>
+    bool waitFor(Pred pred) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(2), pred);
+    }
+
+    ReactorTransport transport_{2};
+    TransportCallbacks callbacks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<ClientPtr> clients_;
+    std::vector<std::string> messages_;
+    std::atomic<int> closed_{0};
+};
+
+TEST_F(ReactorTransportTest, CompletesWebSocketHandshake) {
+    int fd = connectLoopback(transport_.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_GT(::write(fd, UPGRADE_REQUEST, std::strlen(UPGRADE_REQUEST)), 0);
+
+    std::string leftover;
+    std::string response = readHttpResponse(fd, leftover);
+    EXPECT_NE(response.find("101 Switching Protocols"), std::string::npos);
+    EXPECT_NE(response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo="), std::string::npos);
+    EXPECT_TRUE(waitFor([this] { return clients_.size() == 1; }));
+
+    ::close(fd);
+}
+
+TEST_F(ReactorTransportTest, RejectsPlainHttpRequest) {
+    int fd = connectLoopback(transport_.port());
+    ASSERT_GE(fd, 0);
+    const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ASSERT_GT(::write(fd, request, std::strlen(request)), 0);
+
+    std::string leftover;
+    std::string response = readHttpResponse(fd, leftover);
+    EXPECT_NE(response.find("400"), std::string::npos);
+    EXPECT_TRUE(clients_.empty());
+
+    ::close(fd);
+}
+
+TEST_F(ReactorTransportTest, DeliversTextAndSharedFrames) {
+    int fd = connectLoopback(transport_.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_GT(::write(fd, UPGRADE_REQUEST, std::strlen(UPGRADE_REQUEST)), 0);
+
+    std::string leftover;
+    readHttpResponse(fd, leftover);
+    ASSERT_TRUE(waitFor([this] { return clients_.size() == 1; }));
+
+    // Client → server text
+    auto frame = maskedTextFrame("{\"type\":\"subscribe\"}");
+    ASSERT_GT(::write(fd, frame.data(), frame.size()), 0);
+    ASSERT_TRUE(waitFor([this] { return messages_.size() == 1; }));
+    EXPECT_EQ(messages_[0], "{\"type\":\"subscribe\"}");
+
+    // Server → client text + large binary frame
+    std::vector<uint8_t> payload(300000, 0x5A);
+    clients_[0]->sendText("{\"type\":\"hello\"}");
+    clients_[0]->sendFrame(FramedMessage::binaryFrame(0x0002, 42, payload.data(), payload.size()));
+
+    WsFrameParser parser(false, 1 << 20);
+    parser.append(reinterpret_cast<const uint8_t*>(leftover.data()), leftover.size());
+
+    WsMessage message;
+    ASSERT_TRUE(readMessage(fd, parser, message));
+    EXPECT_EQ(message.opcode, WsOpcode::Text);
+    EXPECT_EQ(message.payload, "{\"type\":\"hello\"}");
+
+    ASSERT_TRUE(readMessage(fd, parser, message));
+    EXPECT_EQ(message.opcode, WsOpcode::Binary);
+    ASSERT_EQ(message.payload.size(), FRAME_HEADER_SIZE + payload.size());
+    EXPECT_EQ(static_cast<uint8_t>(message.payload[0]), 42);
+    EXPECT_EQ(static_cast<uint8_t>(message.payload.back()), 0x5A);
+
+    ::close(fd);
+    EXPECT_TRUE(waitFor([this] { return closed_ == 1; }));
+}
+
+TEST_F(ReactorTransportTest, RejectsConnectionsWhenOutOfFds) {
+    // Cap the process a few fds above what it uses, then use them all up
+    rlimit original{};
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &original), 0);
+    int probe = ::open("/dev/null", O_RDONLY);
+    ASSERT_GE(probe, 0);
+    ::close(probe);
+    rlimit capped = original;
+    capped.rlim_cur = static_cast<rlim_t>(probe + 16);
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &capped), 0);
+
+    std::vector<int> fillers;
+    for (int fd; (fd = ::open("/dev/null", O_RDONLY)) >= 0;) {
+        fillers.push_back(fd);
+    }
+    ASSERT_EQ(errno, EMFILE);
+    ::close(fillers.back());  // Room for the client side only
+    fillers.pop_back();
+
+    int fd = connectLoopback(transport_.port());
+    ASSERT_GE(fd, 0);
+    char byte;
+    ssize_t n = ::read(fd, &byte, 1);
+    int readErrno = errno;
+    ::close(fd);
+
+    for (int filler : fillers) {
+        ::close(filler);
+    }
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &original), 0);
+
+    // Closed by the bridge rather than left pending until the read timeout
+    EXPECT_TRUE(n == 0 || (n < 0 && readErrno == ECONNRESET)) << "read returned " << n;
+    EXPECT_TRUE(clients_.empty());
+
+    // Accepting resumes once fds are free
+    fd = connectLoopback(transport_.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_GT(::write(fd, UPGRADE_REQUEST, std::strlen(UPGRADE_REQUEST)), 0);
+    std::string leftover;
+    EXPECT_NE(readHttpResponse(fd, leftover).find("101 Switching Protocols"), std::string::npos);
+    ::close(fd);
+}
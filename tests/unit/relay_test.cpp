@@ -0,0 +1,194 @@
+/**
+ * @file relay_test.cpp
+ * @brief Unit tests for the WebSocket client and bridge relay mode
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/reactor_transport.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+using json = nlohmann::json;
+
+namespace {
+
+uint32_t frameIdOf(const std::string& payload) {
+    return readLe32(reinterpret_cast<const uint8_t*>(payload.data()));
+}
+
+bool connectWithRetry(WsClient& client, const std::string& url) {
+    for (int attempt = 0; attempt < 100; attempt++) {
+        if (client.connect(url)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+// Collect up to count depth frames, keyed by frame ID
+std::map<uint32_t, std::string> collectDepth(WsClient& client, int count) {
+    std::map<uint32_t, std::string> frames;
+    WsMessage message;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (static_cast<int>(frames.size()) < count && std::chrono::steady_clock::now() < deadline) {
+        if (client.next(message, 200) && message.opcode == WsOpcode::Binary) {
+            frames[frameIdOf(message.payload)] = message.payload;
+        }
+    }
+    return frames;
+}
+
+}  // namespace
+
+TEST(WsUrlTest, ParsesHostPortAndPath) {
+    WsUrl url;
+    ASSERT_TRUE(WsUrl::parse("ws://capture-host:8765/kinect", url));
+    EXPECT_EQ(url.host, "capture-host");
+    EXPECT_EQ(url.port, 8765);
+    EXPECT_EQ(url.path, "/kinect");
+
+    ASSERT_TRUE(WsUrl::parse("ws://10.0.0.2", url));
+    EXPECT_EQ(url.host, "10.0.0.2");
+    EXPECT_EQ(url.port, 80);
+    EXPECT_EQ(url.path, "/");
+
+    ASSERT_TRUE(WsUrl::parse("ws://[::1]:9000/", url));
+    EXPECT_EQ(url.host, "::1");
+    EXPECT_EQ(url.port, 9000);
+}
+
+TEST(WsUrlTest, RejectsUnsupportedUrls) {
+    WsUrl url;
+    EXPECT_FALSE(WsUrl::parse("wss://host:8765/", url));
+    EXPECT_FALSE(WsUrl::parse("http://host/", url));
+    EXPECT_FALSE(WsUrl::parse("ws://:8765/", url));
+    EXPECT_FALSE(WsUrl::parse("ws://host:0/", url));
+}
+
+TEST(WsClientTest, ExchangesMessagesWithReactorServer) {
+    ReactorTransport server(1);
+    std::mutex mutex;
+    std::condition_variable cv;
+    ClientPtr connection;
+    std::string received;
+
+    TransportCallbacks callbacks;
+    callbacks.onOpen = [&](const ClientPtr& client) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connection = client;
+        cv.notify_all();
+    };
+    callbacks.onMessage = [&](const ClientPtr&, const std::string& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received = message;
+        cv.notify_all();
+    };
+    callbacks.onClose = [](const ClientPtr&) {};
+    ASSERT_TRUE(server.start(0, callbacks));
+
+    WsClient client;
+    ASSERT_TRUE(client.connect(bridgeUrl(server.port())));
+    ASSERT_TRUE(client.sendText("{\"type\":\"subscribe\",\"streams\":[\"rgb\"]}"));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(2),
+                                [&] { return connection && !received.empty(); }));
+    }
+    EXPECT_EQ(received, "{\"type\":\"subscribe\",\"streams\":[\"rgb\"]}");
+
+    std::vector<uint8_t> data(200000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 13);
+    }
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_RGB, 3, data.data(), data.size());
+    connection->sendFrame(frame);
+
+    WsMessage message;
+    ASSERT_TRUE(client.next(message, 2000));
+    EXPECT_EQ(message.opcode, WsOpcode::Binary);
+    ASSERT_EQ(message.payload.size(), frame->payloadSize());
+    EXPECT_EQ(std::memcmp(message.payload.data(), frame->payload(), frame->payloadSize()), 0);
+
+    client.close();
+    server.stop();
+}
+
+TEST(BridgeRelayTest, ChainedRelaysForwardFramesVerbatim) {
+    BridgeServer origin;
+    const int originPort = startMockBridge(origin);
+    ASSERT_GT(originPort, 0);
+
+    BridgeServer relay;
+    relay.setRelay(bridgeUrl(originPort));
+    const int relayPort = startBridge(relay);
+    ASSERT_GT(relayPort, 0);
+
+    BridgeServer edge;
+    edge.setRelay(bridgeUrl(relayPort));
+    const int edgePort = startBridge(edge);
+    ASSERT_GT(edgePort, 0);
+
+    WsClient direct;
+    WsClient viaRelays;
+    ASSERT_TRUE(connectWithRetry(direct, bridgeUrl(originPort)));
+    ASSERT_TRUE(connectWithRetry(viaRelays, bridgeUrl(edgePort)));
+    ASSERT_TRUE(direct.sendText(R"({"type":"subscribe","streams":["depth"]})"));
+    ASSERT_TRUE(viaRelays.sendText(R"({"type":"subscribe","streams":["depth"]})"));
+
+    auto directFrames = collectDepth(direct, 20);
+    auto relayedFrames = collectDepth(viaRelays, 5);
+    ASSERT_FALSE(relayedFrames.empty());
+
+    // Frames that both clients saw must be byte-identical, header included
+    int compared = 0;
+    for (const auto& [frameId, payload] : relayedFrames) {
+        auto it = directFrames.find(frameId);
+        if (it != directFrames.end()) {
+            EXPECT_EQ(payload, it->second) << "frame " << frameId;
+            compared++;
+        }
+    }
+    EXPECT_GT(compared, 0);
+
+    // The edge reports its own hop and the upstream relay's status
+    ASSERT_TRUE(viaRelays.sendText(R"({"type":"status"})"));
+    WsMessage message;
+    json status;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline && viaRelays.next(message, 200)) {
+        if (message.opcode == WsOpcode::Text) {
+            status = json::parse(message.payload);
+            if (status.value("type", "") == "status") break;
+        }
+    }
+    ASSERT_EQ(status.value("type", ""), "status");
+    ASSERT_TRUE(status.contains("relay"));
+    EXPECT_TRUE(status["relay"]["connected"].get<bool>());
+    EXPECT_GT(status["relay"]["frames_forwarded"].get<uint64_t>(), 0u);
+    EXPECT_GE(status["relay"]["link_latency_us"].get<int64_t>(), 0);
+    ASSERT_TRUE(status["relay"].contains("upstream_relay"));
+    EXPECT_EQ(status["relay"]["upstream_relay"]["upstream"], bridgeUrl(originPort));
+
+    direct.close();
+    viaRelays.close();
+    edge.stop();
+    relay.stop();
+    origin.stop();
+}
@@ -0,0 +1,215 @@
+/**
+ * @file send_queue_test.cpp
+ * @brief Unit tests for per-client send scheduling
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/frame_bundle.h"
+#include "kinect_xr/send_queue.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct TestItem {
+    SharedFrame frame;
+    size_t offset = 0;
+};
+
+SharedFrame testFrame(uint16_t streamType, uint16_t flags = 0, size_t size = 64) {
+    std::vector<uint8_t> data(size, 0x5A);
+    return FramedMessage::binaryFrame(streamType, 1, data.data(), data.size(), flags);
+}
+
+std::chrono::milliseconds ms(int n) {
+    return std::chrono::milliseconds(n);
+}
+
+}  // namespace
+
+TEST(SendQueueTest, ClassifiesByStreamAndFlags) {
+    EXPECT_EQ(classifyFrame(*FramedMessage::text("{}")).priority, SendPriority::Control);
+    EXPECT_FALSE(classifyFrame(*FramedMessage::text("{}")).droppable);
+    EXPECT_EQ(classifyFrame(*testFrame(STREAM_TYPE_CONTROL)).priority, SendPriority::Control);
+
+    SendClass depth = classifyFrame(*testFrame(STREAM_TYPE_DEPTH));
+    EXPECT_EQ(depth.priority, SendPriority::Depth);
+    EXPECT_TRUE(depth.droppable);
+    EXPECT_EQ(classifyFrame(*testFrame(STREAM_TYPE_CONTOURS)).priority, SendPriority::Depth);
+
+    SendClass rgb = classifyFrame(*testFrame(STREAM_TYPE_RGB));
+    EXPECT_EQ(rgb.priority, SendPriority::Video);
+    EXPECT_TRUE(rgb.droppable);
+
+    // The client could not recover from losing these
+    EXPECT_FALSE(classifyFrame(*testFrame(STREAM_TYPE_RGB, FRAME_FLAG_TILES)).droppable);
+    EXPECT_FALSE(classifyFrame(*testFrame(STREAM_TYPE_DEPTH, FRAME_FLAG_HISTORY)).droppable);
+    EXPECT_FALSE(classifyFrame(*FramedMessage::raw({'H', 'T'})).droppable);
+    SendClass close = classifyFrame(*FramedMessage::control(WsOpcode::Close));
+    EXPECT_EQ(close.priority, SendPriority::Video);  // After everything already queued
+    EXPECT_FALSE(close.droppable);
+
+    // Bundles ride with depth, and inherit undroppable parts
+    auto plain = bundleFrames(1, 0, {testFrame(STREAM_TYPE_RGB), testFrame(STREAM_TYPE_DEPTH)});
+    auto tiled = bundleFrames(1, 0, {testFrame(STREAM_TYPE_RGB, FRAME_FLAG_TILES), testFrame(STREAM_TYPE_DEPTH)});
+    EXPECT_EQ(classifyFrame(*plain).priority, SendPriority::Depth);
+    EXPECT_TRUE(classifyFrame(*plain).droppable);
+    EXPECT_FALSE(classifyFrame(*tiled).droppable);
+}
+
+TEST(SendQueueTest, WritesControlThenDepthThenVideo) {
+    SendQueue<TestItem> queue;
+    SendDeadlines deadlines;
+    auto now = Clock::now();
+    auto rgb = testFrame(STREAM_TYPE_RGB);
+    auto depth = testFrame(STREAM_TYPE_DEPTH);
+    auto text = FramedMessage::text(R"({"type":"motor.status"})");
+    queue.push({rgb}, now);
+    queue.push({depth}, now);
+    queue.push({text}, now);
+
+    size_t dropped = 0;
+    std::vector<SharedFrame> order;
+    while (TestItem* item = queue.front(now, deadlines, dropped)) {
+        order.push_back(item->frame);
+        queue.pop(now);
+    }
+    EXPECT_EQ(order, (std::vector<SharedFrame>{text, depth, rgb}));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(dropped, 0u);
+}
+
+TEST(SendQueueTest, FinishesPartlyWrittenMessageFirst) {
+    SendQueue<TestItem> queue;
+    SendDeadlines deadlines;
+    auto now = Clock::now();
+    auto rgb = testFrame(STREAM_TYPE_RGB);
+    queue.push({rgb}, now);
+
+    size_t dropped = 0;
+    TestItem* item = queue.front(now, deadlines, dropped);
+    ASSERT_NE(item, nullptr);
+    item->offset = 10;  // Socket took part of it
+
+    // Newer, more urgent messages wait, even past the RGB deadline
+    queue.push({testFrame(STREAM_TYPE_DEPTH)}, now);
+    queue.push({FramedMessage::text("{}")}, now);
+    item = queue.front(now + ms(500), deadlines, dropped);
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->frame, rgb);
+    queue.pop(now + ms(500));
+    EXPECT_EQ(queue.front(now + ms(500), deadlines, dropped)->frame->opcode(), WsOpcode::Text);
+}
+
+TEST(SendQueueTest, DropsLateFramesAndReportsQueueAge) {
+    SendQueue<TestItem> queue;
+    SendDeadlines deadlines;
+    deadlines.ms[static_cast<size_t>(SendPriority::Depth)] = 50;
+    deadlines.ms[static_cast<size_t>(SendPriority::Video)] = 30;
+    auto start = Clock::now();
+    auto lateRgb = testFrame(STREAM_TYPE_RGB);
+    auto tiles = testFrame(STREAM_TYPE_RGB, FRAME_FLAG_TILES);
+    auto depth = testFrame(STREAM_TYPE_DEPTH);
+    auto freshRgb = testFrame(STREAM_TYPE_RGB);
+    queue.push({lateRgb}, start);
+    queue.push({tiles}, start);
+    queue.push({depth}, start);
+    queue.push({freshRgb}, start + ms(30));
+
+    auto now = start + ms(40);
+    SendQueueStats stats = queue.stats(now);
+    EXPECT_TRUE(stats.scheduled);
+    const auto& video = stats.priorities[static_cast<size_t>(SendPriority::Video)];
+    EXPECT_EQ(video.queued, 3u);
+    EXPECT_EQ(video.oldestMs, 40u);
+    EXPECT_EQ(video.queuedBytes, lateRgb->wireSize() + tiles->wireSize() + freshRgb->wireSize());
+
+    size_t dropped = 0;
+    std::vector<SharedFrame> order;
+    while (TestItem* item = queue.front(now, deadlines, dropped)) {
+        order.push_back(item->frame);
+        queue.pop(now);
+    }
+    // Depth is within its deadline; the old RGB frame is not, the tile delta is kept
+    EXPECT_EQ(order, (std::vector<SharedFrame>{depth, tiles, freshRgb}));
+    EXPECT_EQ(dropped, lateRgb->wireSize());
+
+    stats = queue.stats(now);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Video)].dropped, 1u);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Video)].sent, 2u);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Video)].wait.maxUs, 40000u);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Video)].wait.count, 2u);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Depth)].dropped, 0u);
+    EXPECT_EQ(stats.priorities[static_cast<size_t>(SendPriority::Video)].queued, 0u);
+}
+
+TEST(SendQueueTest, KeepsLateTileKeyFrames) {
+    // The bridge records a tile client as holding the key frame's version when
+    // it is queued; dropping it would leave later deltas patching a stale base
+    EXPECT_FALSE(classifyFrame(*testFrame(STREAM_TYPE_RGB, FRAME_FLAG_TILE_KEY)).droppable);
+    auto keyed = bundleFrames(1, 0, {testFrame(STREAM_TYPE_DEPTH, FRAME_FLAG_TILE_KEY)});
+    EXPECT_FALSE(classifyFrame(*keyed).droppable);
+
+    SendQueue<TestItem> queue;
+    SendDeadlines deadlines;
+    deadlines.ms[static_cast<size_t>(SendPriority::Depth)] = 30;
+    deadlines.ms[static_cast<size_t>(SendPriority::Video)] = 30;
+    auto start = Clock::now();
+    auto lateRgb = testFrame(STREAM_TYPE_RGB);
+    auto rgbKey = testFrame(STREAM_TYPE_RGB, FRAME_FLAG_TILE_KEY);
+    auto depthKey = testFrame(STREAM_TYPE_DEPTH, FRAME_FLAG_TILE_KEY);
+    queue.push({lateRgb}, start);
+    queue.push({rgbKey}, start);
+    queue.push({depthKey}, start);
+
+    auto now = start + ms(100);
+    size_t dropped = 0;
+    std::vector<SharedFrame> order;
+    while (TestItem* item = queue.front(now, deadlines, dropped)) {
+        order.push_back(item->frame);
+        queue.pop(now);
+    }
+    EXPECT_EQ(order, (std::vector<SharedFrame>{depthKey, rgbKey}));
+    EXPECT_EQ(dropped, lateRgb->wireSize());
+}
+
+TEST(BridgeSendQueueTest, StatusReportsQueuesPerPriority) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    // Wait for hello to be written before asking
+    nlohmann::json hello;
+    ASSERT_TRUE(nextOfType(client, "hello", hello, 1000));
+    ASSERT_TRUE(client.sendText(R"({"type":"status"})"));
+
+    nlohmann::json status;
+    ASSERT_TRUE(nextOfType(client, "status", status));
+    ASSERT_EQ(status["clients"].size(), 1u);
+    const auto& queues = status["clients"][0]["send_queue"];
+    for (const char* name : {"control", "depth", "video"}) {
+        ASSERT_TRUE(queues.contains(name)) << name;
+        EXPECT_TRUE(queues[name].contains("oldest_ms"));
+        EXPECT_TRUE(queues[name].contains("dropped"));
+    }
+    EXPECT_GE(queues["control"]["sent"].get<int>(), 1);  // hello
+
+    client.close();
+    server.stop();
+}
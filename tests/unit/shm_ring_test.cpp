@@ -0,0 +1,140 @@
+/**
+ * @file shm_ring_test.cpp
+ * @brief Unit tests for the shared-memory frame ring
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kinect_xr/shm_ring.h"
+
+using namespace kinect_xr;
+
+namespace {
+
+std::string uniqueName(const char* suffix) {
+    return "/kinect-xr-test-" + std::to_string(getpid()) + "-" + suffix;
+}
+
+std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(seed + i);
+    }
+    return data;
+}
+
+}  // namespace
+
+TEST(ShmRingTest, OpenFailsWithoutWriter) {
+    ShmRingReader reader;
+    EXPECT_FALSE(reader.open(uniqueName("missing")));
+    EXPECT_FALSE(reader.isOpen());
+}
+
+TEST(ShmRingTest, ReaderSeesPublishedFrameInPlace) {
+    std::string name = uniqueName("basic");
+    ShmRingWriter writer;
+    ASSERT_TRUE(writer.create(name, 4, 1024));
+
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    auto data = pattern(600, 7);
+    ASSERT_TRUE(writer.publish(0x0002, 42, data.data(), data.size(), 0x0001));
+
+    ShmFrameView view;
+    ASSERT_TRUE(reader.next(view));
+    EXPECT_EQ(view.streamType, 0x0002);
+    EXPECT_EQ(view.flags, 0x0001);
+    EXPECT_EQ(view.frameId, 42u);
+    ASSERT_EQ(view.size, data.size());
+    EXPECT_EQ(std::vector<uint8_t>(view.data, view.data + view.size), data);
+    EXPECT_TRUE(reader.stillValid(view));
+
+    EXPECT_FALSE(reader.next(view));
+    EXPECT_EQ(reader.droppedFrames(), 0u);
+}
+
+TEST(ShmRingTest, RejectsOversizedFrames) {
+    ShmRingWriter writer;
+    ASSERT_TRUE(writer.create(uniqueName("oversize"), 2, 16));
+    auto data = pattern(17, 0);
+    EXPECT_FALSE(writer.publish(0x0001, 1, data.data(), data.size()));
+}
+
+TEST(ShmRingTest, SlowReaderSkipsOverwrittenFrames) {
+    std::string name = uniqueName("overrun");
+    ShmRingWriter writer;
+    ASSERT_TRUE(writer.create(name, 4, 64));
+
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    for (uint32_t i = 0; i < 10; i++) {
+        auto data = pattern(64, static_cast<uint8_t>(i));
+        ASSERT_TRUE(writer.publish(0x0001, i, data.data(), data.size()));
+    }
+
+    std::vector<uint32_t> ids;
+    ShmFrameView view;
+    while (reader.next(view)) {
+        ids.push_back(view.frameId);
+    }
+
+    // Only the newest slotCount - 1 frames are guaranteed intact
+    EXPECT_EQ(ids, (std::vector<uint32_t>{7, 8, 9}));
+    EXPECT_EQ(reader.droppedFrames(), 7u);
+}
+
+TEST(ShmRingTest, ViewIsInvalidatedWhenSlotIsReused) {
+    std::string name = uniqueName("torn");
+    ShmRingWriter writer;
+    ASSERT_TRUE(writer.create(name, 2, 64));
+
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    auto data = pattern(64, 1);
+    writer.publish(0x0001, 1, data.data(), data.size());
+
+    ShmFrameView view;
+    ASSERT_TRUE(reader.next(view));
+    writer.publish(0x0001, 2, data.data(), data.size());
+    EXPECT_TRUE(reader.stillValid(view));  // Different slot
+    writer.publish(0x0001, 3, data.data(), data.size());
+    EXPECT_FALSE(reader.stillValid(view));  // Wrapped onto our slot
+}
+
+TEST(ShmRingTest, WaitWakesOnPublish) {
+    std::string name = uniqueName("wait");
+    ShmRingWriter writer;
+    ASSERT_TRUE(writer.create(name, 4, 64));
+
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    EXPECT_FALSE(reader.wait(10));  // Nothing published yet
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto data = pattern(8, 3);
+        writer.publish(0x0002, 5, data.data(), data.size());
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reader.wait(2000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    producer.join();
+
+    std::vector<uint8_t> copy;
+    ShmFrameView view;
+    ASSERT_TRUE(reader.copyNext(view, copy));
+    EXPECT_EQ(view.frameId, 5u);
+    EXPECT_EQ(copy, pattern(8, 3));
+}
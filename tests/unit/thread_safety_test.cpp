@@ -97,15 +97,15 @@ TEST_F(ThreadSafetyTest, DeviceMutexProtectsLibfreenectCalls) {
     // The actual mutex usage is in device.cpp:
     //
     // setTiltAngle (line ~320):
-    //   std::lock_guard<std::mutex> lock(deviceMutex_);
+    //   std::lock_guard<NamedMutex> lock(deviceMutex_);
     //   freenect_set_tilt_degs(dev_, clamped);
     //
     // setLED (line ~381):
-    //   std::lock_guard<std::mutex> lock(deviceMutex_);
+    //   std::lock_guard<NamedMutex> lock(deviceMutex_);
     //   freenect_set_led(dev_, led_option);
     //
     // getMotorStatus (line ~397):
-    //   std::lock_guard<std::mutex> lock(deviceMutex_);
+    //   std::lock_guard<NamedMutex> lock(deviceMutex_);
     //   freenect_update_tilt_state(dev_);
 
     KinectDevice device;
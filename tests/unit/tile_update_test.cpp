@@ -0,0 +1,195 @@
+/**
+ * @file tile_update_test.cpp
+ * @brief Unit tests for dirty-tile partial updates
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/tile_update.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+std::vector<uint8_t> testRgb(uint8_t seed) {
+    std::vector<uint8_t> rgb(RGB_FRAME_SIZE);
+    for (size_t i = 0; i < rgb.size(); i++) {
+        rgb[i] = static_cast<uint8_t>(i * 31 + seed);
+    }
+    return rgb;
+}
+
+SharedFrame rgbFrame(const std::vector<uint8_t>& rgb, uint32_t frameId) {
+    return FramedMessage::binaryFrame(STREAM_TYPE_RGB, frameId, rgb.data(), rgb.size());
+}
+
+// What a client does with a tile frame: copy each listed tile into its buffer
+void applyTiles(const SharedFrame& frame, size_t pixelSize, std::vector<uint8_t>& image) {
+    const uint8_t* p = frame->payload() + FRAME_HEADER_SIZE;
+    ASSERT_EQ(p[0], TILE_SIZE);
+    const uint8_t* data = p + TILE_HEADER_SIZE;
+    uint16_t applied = 0;
+    for (uint32_t tile = 0; tile < TILE_COUNT; tile++) {
+        if (!(p[4 + tile / 8] & (1u << (tile % 8)))) continue;
+        uint32_t u = (tile % TILE_COLUMNS) * TILE_SIZE;
+        uint32_t v = (tile / TILE_COLUMNS) * TILE_SIZE;
+        for (uint32_t row = 0; row < TILE_SIZE; row++, data += TILE_SIZE * pixelSize) {
+            std::memcpy(&image[((v + row) * FRAME_WIDTH + u) * pixelSize], data, TILE_SIZE * pixelSize);
+        }
+        applied++;
+    }
+    EXPECT_EQ(applied, readLe16(p + 2));
+    EXPECT_EQ(data, frame->payload() + frame->payloadSize());
+}
+
+}  // namespace
+
+TEST(TileUpdateTest, FirstUpdateSendsEveryTileAndKeyFrameIsTheReference) {
+    TileEncoder tiles(STREAM_TYPE_RGB);
+    EXPECT_FALSE(tiles.delta());
+    auto rgb = testRgb(0);
+    ASSERT_TRUE(tiles.update(rgbFrame(rgb, 1)));
+    EXPECT_EQ(tiles.version(), 1u);
+    EXPECT_EQ(tiles.dirtyCount(), TILE_COUNT);
+
+    auto delta = tiles.delta();
+    uint16_t flags = readLe16(delta->payload() + 6);
+    EXPECT_TRUE(flags & FRAME_FLAG_TILES);
+    EXPECT_EQ(delta->payloadSize(), FRAME_HEADER_SIZE + TILE_HEADER_SIZE + RGB_FRAME_SIZE);
+
+    std::vector<uint8_t> image(RGB_FRAME_SIZE, 0);
+    applyTiles(delta, 3, image);
+    EXPECT_EQ(image, rgb);
+
+    auto key = tiles.keyFrame();
+    ASSERT_EQ(key->payloadSize(), FRAME_HEADER_SIZE + RGB_FRAME_SIZE);
+    EXPECT_EQ(readLe16(key->payload() + 6), FRAME_FLAG_TILE_KEY);
+    EXPECT_EQ(std::memcmp(key->payload() + FRAME_HEADER_SIZE, rgb.data(), rgb.size()), 0);
+}
+
+TEST(TileUpdateTest, OnlyChangesAboveTheThresholdAreSent) {
+    TileParams params;
+    params.rgbThreshold = 10;
+    TileEncoder tiles(STREAM_TYPE_RGB, params);
+    auto rgb = testRgb(0);
+    ASSERT_TRUE(tiles.update(rgbFrame(rgb, 1)));
+    std::vector<uint8_t> image(RGB_FRAME_SIZE, 0);
+    applyTiles(tiles.delta(), 3, image);
+
+    // Noise everywhere, one real change in tile (5, 3)
+    auto next = rgb;
+    for (size_t i = 0; i < next.size(); i += 7) {
+        next[i] = static_cast<uint8_t>(next[i] ^ 0x03);
+    }
+    const size_t changed = ((3 * TILE_SIZE + 10) * FRAME_WIDTH + 5 * TILE_SIZE + 4) * 3;
+    next[changed] = static_cast<uint8_t>(next[changed] + 100);
+    auto frame = rgbFrame(next, 2);
+    ASSERT_TRUE(tiles.update(frame));
+    ASSERT_TRUE(tiles.update(frame));  // Same frame again: no second update
+    EXPECT_EQ(tiles.version(), 2u);
+    EXPECT_EQ(tiles.dirtyCount(), 1u);
+
+    auto delta = tiles.delta();
+    const uint8_t* bitmap = delta->payload() + FRAME_HEADER_SIZE + 4;
+    const uint32_t tile = 3 * TILE_COLUMNS + 5;
+    EXPECT_TRUE(bitmap[tile / 8] & (1u << (tile % 8)));
+    EXPECT_EQ(delta->payloadSize(), FRAME_HEADER_SIZE + TILE_HEADER_SIZE + TILE_SIZE * TILE_SIZE * 3);
+
+    // The client now holds exactly the reference
+    applyTiles(delta, 3, image);
+    EXPECT_EQ(image[changed], next[changed]);
+    EXPECT_EQ(std::memcmp(tiles.keyFrame()->payload() + FRAME_HEADER_SIZE, image.data(), image.size()), 0);
+}
+
+TEST(TileUpdateTest, DepthDropoutsAndPeriodicRefreshMarkTiles) {
+    TileParams params;
+    params.refreshFrames = 3;
+    TileEncoder tiles(STREAM_TYPE_DEPTH, params);
+    std::vector<uint8_t> depth(DEPTH_FRAME_SIZE);
+    for (size_t i = 0; i < depth.size(); i += 2) {
+        depth[i] = 0xE8;  // 1000 mm
+        depth[i + 1] = 0x03;
+    }
+    auto frame = [&](uint32_t id) {
+        return FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, id, depth.data(), depth.size());
+    };
+    ASSERT_TRUE(tiles.update(frame(1)));
+
+    depth[0] = 0x00;  // 1000 -> 1024 mm: within 20 mm? no, 24 mm away
+    depth[1] = 0x04;
+    ASSERT_TRUE(tiles.update(frame(2)));
+    EXPECT_EQ(tiles.dirtyCount(), 1u);
+
+    depth[2 * 100] = 0;  // Reading lost in tile 3
+    depth[2 * 100 + 1] = 0;
+    ASSERT_TRUE(tiles.update(frame(3)));
+    EXPECT_EQ(tiles.dirtyCount(), 1u);
+
+    ASSERT_TRUE(tiles.update(frame(4)));  // Fourth update: periodic refresh
+    EXPECT_EQ(tiles.dirtyCount(), TILE_COUNT);
+    ASSERT_TRUE(tiles.update(frame(5)));
+    EXPECT_EQ(tiles.dirtyCount(), 0u);
+
+    // Other streams, downscaled or converted frames do not qualify
+    auto rgb = testRgb(0);
+    EXPECT_FALSE(tiles.update(rgbFrame(rgb, 6)));
+    EXPECT_FALSE(tiles.update(FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 6, depth.data(), depth.size(),
+                                                         1 << FRAME_FLAG_SCALE_SHIFT)));
+}
+
+TEST(TileUpdateTest, TilesFollowTheRequestedPixelFormat) {
+    TileEncoder tiles(STREAM_TYPE_RGB);
+    auto rgb = testRgb(9);
+    ASSERT_TRUE(tiles.update(rgbFrame(rgb, 1)));
+    auto delta = tiles.delta(PixelFormat::Rgba8888);
+    EXPECT_EQ((readLe16(delta->payload() + 6) & FRAME_FLAG_PIXEL_FORMAT_MASK) >> FRAME_FLAG_PIXEL_FORMAT_SHIFT,
+              static_cast<int>(PixelFormat::Rgba8888));
+
+    std::vector<uint8_t> image(FRAME_WIDTH * FRAME_HEIGHT * 4, 0);
+    applyTiles(delta, 4, image);
+    std::vector<uint8_t> expected(image.size());
+    convertRgbPixels(rgb.data(), FRAME_WIDTH * FRAME_HEIGHT, PixelFormat::Rgba8888, expected.data());
+    EXPECT_EQ(image, expected);
+    EXPECT_EQ(tiles.delta(PixelFormat::Rgba8888), delta);  // Built once per update and format
+}
+
+TEST(BridgeTileTest, SendsAFullFrameThenTiles) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+    auto frames = subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth"],"tiles":true})", 3);
+    ASSERT_EQ(frames.size(), 3u);
+    std::vector<uint16_t> flags;
+    for (const auto& frame : frames) {
+        flags.push_back(readLe16(reinterpret_cast<const uint8_t*>(frame.payload.data()) + 6));
+    }
+    // The first frame is the whole image: a key frame, or the very first update
+    const auto* first = reinterpret_cast<const uint8_t*>(frames[0].payload.data());
+    if (flags[0] & FRAME_FLAG_TILES) {
+        EXPECT_EQ(readLe16(first + FRAME_HEADER_SIZE + 2), TILE_COUNT);
+    } else {
+        EXPECT_TRUE(flags[0] & FRAME_FLAG_TILE_KEY);
+        EXPECT_EQ(frames[0].payload.size(), FRAME_HEADER_SIZE + DEPTH_FRAME_SIZE);
+    }
+    EXPECT_TRUE(flags[1] & FRAME_FLAG_TILES);
+    EXPECT_TRUE(flags[2] & FRAME_FLAG_TILES);
+
+    // Tiles need unpacked depth
+    EXPECT_TRUE(rejects(
+        client, R"({"type":"subscribe","streams":["depth"],"tiles":true,"depth_format":"packed12"})"));
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,182 @@
+/**
+ * @file trace_event_test.cpp
+ * @brief Unit tests for trace rings and trace-event JSON export
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/trace_event.h"
+#include "kinect_xr/ws_client.h"
+
+#include "bridge_test_util.h"
+
+using namespace kinect_xr;
+using namespace kinect_xr::test_util;
+
+namespace {
+
+// Complete events with the given name
+std::vector<nlohmann::json> eventsNamed(const nlohmann::json& trace, const std::string& name) {
+    std::vector<nlohmann::json> found;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "X" && event["name"] == name) {
+            found.push_back(event);
+        }
+    }
+    return found;
+}
+
+}  // namespace
+
+TEST(TraceEventTest, ExportsThreadsAndEventsAsChromeJson) {
+    TraceRecorder& tracer = TraceRecorder::instance();
+    tracer.clear();
+    tracer.start();
+
+    tracer.setThreadName("test \"main\"");
+    tracer.record("test", "outer", 1'000'000, 1'250'500);
+    std::thread worker([&tracer] {
+        tracer.setThreadName("worker");
+        tracer.record("test", "inner", 1'100'000, 1'200'000, "frame", 42);
+    });
+    worker.join();
+    tracer.stop();
+
+    EXPECT_EQ(tracer.eventCount(), 2u);
+    auto trace = nlohmann::json::parse(tracer.chromeJson(), nullptr, false);
+    ASSERT_TRUE(trace.is_object());
+
+    auto outer = eventsNamed(trace, "outer");
+    auto inner = eventsNamed(trace, "inner");
+    ASSERT_EQ(outer.size(), 1u);
+    ASSERT_EQ(inner.size(), 1u);
+    EXPECT_EQ(outer[0]["cat"], "test");
+    EXPECT_DOUBLE_EQ(outer[0]["ts"].get<double>(), 1000.0);
+    EXPECT_DOUBLE_EQ(outer[0]["dur"].get<double>(), 250.5);
+    EXPECT_FALSE(outer[0].contains("args"));
+    EXPECT_EQ(inner[0]["args"]["frame"].get<int>(), 42);
+    EXPECT_NE(outer[0]["tid"], inner[0]["tid"]);
+    EXPECT_EQ(outer[0]["pid"].get<int>(), static_cast<int>(getpid()));
+
+    // Named threads get metadata, and names survive the thread exiting
+    std::set<std::string> names;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "M" && event["name"] == "thread_name") {
+            names.insert(event["args"]["name"].get<std::string>());
+        }
+    }
+    EXPECT_TRUE(names.count("test \"main\""));
+    EXPECT_TRUE(names.count("worker"));
+    tracer.clear();
+}
+
+TEST(TraceEventTest, RingKeepsTheNewestEvents) {
+    TraceRecorder& tracer = TraceRecorder::instance();
+    tracer.clear();
+    const size_t extra = 10;
+
+    // A fresh thread has a fresh ring
+    std::thread writer([&tracer, extra] {
+        for (uint64_t i = 0; i < TraceRecorder::RING_CAPACITY + extra; i++) {
+            tracer.record("test", "tick", i * 1000, i * 1000 + 500);
+        }
+    });
+    writer.join();
+
+    EXPECT_EQ(tracer.eventCount(), TraceRecorder::RING_CAPACITY);
+    EXPECT_EQ(tracer.droppedCount(), extra);
+    auto ticks = eventsNamed(nlohmann::json::parse(tracer.chromeJson()), "tick");
+    ASSERT_EQ(ticks.size(), TraceRecorder::RING_CAPACITY);
+    EXPECT_DOUBLE_EQ(ticks.front()["ts"].get<double>(), static_cast<double>(extra));
+    EXPECT_DOUBLE_EQ(ticks.back()["ts"].get<double>(),
+                     static_cast<double>(TraceRecorder::RING_CAPACITY + extra - 1));
+
+    tracer.clear();
+    EXPECT_EQ(tracer.eventCount(), 0u);
+    EXPECT_EQ(tracer.droppedCount(), 0u);
+}
+
+TEST(TraceEventTest, SamplesWholeSlicesAndSkipsWhenStopped) {
+    TraceRecorder& tracer = TraceRecorder::instance();
+    tracer.clear();
+
+    tracer.start(4);
+    const uint64_t slice = TraceRecorder::SAMPLE_SLICE_NS;
+    EXPECT_TRUE(tracer.sampled(0));
+    EXPECT_TRUE(tracer.sampled(slice - 1));
+    EXPECT_FALSE(tracer.sampled(slice));
+    EXPECT_FALSE(tracer.sampled(3 * slice + slice / 2));
+    EXPECT_TRUE(tracer.sampled(4 * slice));
+
+    tracer.stop();
+    {
+        TraceScope scope("test", "stopped");
+    }
+    EXPECT_EQ(tracer.eventCount(), 0u);
+
+#if KINECT_XR_TRACING
+    tracer.start(1);
+    {
+        KINECT_XR_TRACE_SCOPE_ARG("test", "scoped", "n", 7);
+    }
+    tracer.stop();
+    auto scoped = eventsNamed(nlohmann::json::parse(tracer.chromeJson()), "scoped");
+    ASSERT_EQ(scoped.size(), 1u);
+    EXPECT_EQ(scoped[0]["args"]["n"].get<int>(), 7);
+#endif
+    tracer.clear();
+}
+
+TEST(BridgeTraceTest, TraceCommandAndEndpoint) {
+    BridgeServer server;
+    const int port = startMockBridge(server);
+    ASSERT_GT(port, 0);
+
+    WsClient client;
+    ASSERT_TRUE(connectClient(client, port));
+
+    nlohmann::json hello;
+    ASSERT_TRUE(nextOfType(client, "hello", hello));
+    EXPECT_EQ(hello["capabilities"]["trace"]["compiled"].get<bool>(), KINECT_XR_TRACING != 0);
+
+    ASSERT_TRUE(client.sendText(R"({"type":"trace","action":"sample"})"));
+    nlohmann::json reply;
+    ASSERT_TRUE(nextOfType(client, "error", reply));
+    EXPECT_EQ(reply["code"], "INVALID_PARAMS");
+
+#if KINECT_XR_TRACING
+    TraceRecorder::instance().clear();
+    ASSERT_TRUE(client.sendText(R"({"type":"trace","action":"start"})"));
+    ASSERT_TRUE(nextOfType(client, "trace", reply));
+    EXPECT_TRUE(reply["enabled"].get<bool>());
+    EXPECT_EQ(reply["path"], "/trace");
+
+    ASSERT_EQ(subscribeAndCollect(client, R"({"type":"subscribe","streams":["depth"]})", 3).size(), 3u);
+
+    ASSERT_TRUE(client.sendText(R"({"type":"trace","action":"stop"})"));
+    ASSERT_TRUE(nextOfType(client, "trace", reply));
+    EXPECT_FALSE(reply["enabled"].get<bool>());
+    EXPECT_GT(reply["events"].get<int>(), 0);
+
+    std::string response = httpGet(port, "/trace");
+    ASSERT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << response.substr(0, 200);
+    auto trace = nlohmann::json::parse(response.substr(response.find("\r\n\r\n") + 4), nullptr, false);
+    ASSERT_TRUE(trace.is_object());
+    EXPECT_FALSE(eventsNamed(trace, "frame").empty());
+    EXPECT_FALSE(eventsNamed(trace, "broadcastFrame").empty());
+    EXPECT_FALSE(eventsNamed(trace, "flush").empty());
+    TraceRecorder::instance().clear();
+#endif
+
+    client.close();
+    server.stop();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file unix_transport_test.cpp
+ * @brief Unit tests for the Unix domain socket transport and client
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "kinect_xr/bridge_protocol.h"
+#include "kinect_xr/reactor_transport.h"
+#include "kinect_xr/unix_client.h"
+
+using namespace kinect_xr;
+
+class UnixTransportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "/tmp/kinect-xr-test-" + std::to_string(getpid()) + ".sock";
+        transport_ = std::make_unique<ReactorTransport>(1, path_);
+
+        TransportCallbacks callbacks;
+        callbacks.onOpen = [this](const ClientPtr& client) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.push_back(client);
+            cv_.notify_all();
+        };
+        callbacks.onMessage = [this](const ClientPtr&, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            messages_.push_back(message);
+            cv_.notify_all();
+        };
+        callbacks.onClose = [this](const ClientPtr&) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_++;
+            cv_.notify_all();
+        };
+        ASSERT_TRUE(transport_->start(0, callbacks));
+        EXPECT_STREQ(transport_->name(), "unix");
+    }
+
+    void TearDown() override {
+        transport_->stop();
+        EXPECT_NE(access(path_.c_str(), F_OK), 0);  // Socket file removed
+    }
+
+    template <typename Pred>
+    bool waitFor(Pred pred) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(2), pred);
+    }
+
+    std::string path_;
+    std::unique_ptr<ReactorTransport> transport_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<ClientPtr> clients_;
+    std::vector<std::string> messages_;
+    int closed_ = 0;
+};
+
+TEST_F(UnixTransportTest, ExchangesControlMessagesWithoutHandshake) {
+    UnixFrameClient client;
+    ASSERT_TRUE(client.connect(path_));
+    ASSERT_TRUE(waitFor([this] { return clients_.size() == 1; }));
+
+    ASSERT_TRUE(client.sendText("{\"type\":\"subscribe\",\"streams\":[\"depth\"]}"));
+    ASSERT_TRUE(waitFor([this] { return messages_.size() == 1; }));
+    EXPECT_EQ(messages_[0], "{\"type\":\"subscribe\",\"streams\":[\"depth\"]}");
+
+    clients_[0]->sendText("{\"type\":\"hello\"}");
+    LocalMessage message;
+    ASSERT_TRUE(client.next(message, 2000));
+    EXPECT_EQ(message.opcode, WsOpcode::Text);
+    EXPECT_EQ(message.text, "{\"type\":\"hello\"}");
+
+    client.close();
+    EXPECT_TRUE(waitFor([this] { return closed_ == 1; }));
+}
+
+TEST_F(UnixTransportTest, SmallFramesAreSentInline) {
+    UnixFrameClient client;
+    ASSERT_TRUE(client.connect(path_));
+    ASSERT_TRUE(waitFor([this] { return clients_.size() == 1; }));
+
+    std::vector<uint8_t> data(1000, 0x11);
+    clients_[0]->sendFrame(FramedMessage::binaryFrame(STREAM_TYPE_RGB, 9, data.data(), data.size()));
+
+    LocalMessage message;
+    ASSERT_TRUE(client.next(message, 2000));
+    EXPECT_EQ(message.opcode, WsOpcode::Binary);
+    EXPECT_FALSE(message.mapped);
+    EXPECT_EQ(message.frameId, 9u);
+    EXPECT_EQ(message.streamType, STREAM_TYPE_RGB);
+    ASSERT_EQ(message.size, data.size());
+    EXPECT_EQ(message.data[999], 0x11);
+}
+
+TEST_F(UnixTransportTest, LargeFramesArePassedAsSharedMemfd) {
+    UnixFrameClient first;
+    UnixFrameClient second;
+    ASSERT_TRUE(first.connect(path_));
+    ASSERT_TRUE(second.connect(path_));
+    ASSERT_TRUE(waitFor([this] { return clients_.size() == 2; }));
+
+    std::vector<uint8_t> data(DEPTH_FRAME_SIZE);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 77, data.data(), data.size());
+    clients_[0]->sendFrame(frame);
+    clients_[1]->sendFrame(frame);
+
+    for (UnixFrameClient* client : {&first, &second}) {
+        LocalMessage message;
+        ASSERT_TRUE(client->next(message, 2000));
+        EXPECT_TRUE(message.mapped);
+        EXPECT_EQ(message.frameId, 77u);
+        EXPECT_EQ(message.streamType, STREAM_TYPE_DEPTH);
+        EXPECT_EQ(message.flags, 0);  // Transport flag is stripped
+        ASSERT_EQ(message.size, data.size());
+        EXPECT_EQ(std::memcmp(message.data, data.data(), data.size()), 0);
+    }
+
+    // Only the descriptor goes through the socket
+    EXPECT_EQ(clients_[0]->bufferedBytes(), 0u);
+}
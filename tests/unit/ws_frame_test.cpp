@@ -0,0 +1,222 @@
+/**
+ * @file ws_frame_test.cpp
+ * @brief Unit tests for pre-framed WebSocket messages
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/ws_frame.h"
+
+using namespace kinect_xr;
+
+namespace {
+
+std::vector<uint8_t> readAll(int fd, size_t size) {
+    std::vector<uint8_t> out(size);
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = ::read(fd, out.data() + got, size - got);
+        if (n <= 0) break;
+        got += static_cast<size_t>(n);
+    }
+    out.resize(got);
+    return out;
+}
+
+}  // namespace
+
+TEST(WsFrameTest, SmallPayloadUsesTwoByteHeader) {
+    uint8_t header[WS_MAX_HEADER_SIZE];
+    EXPECT_EQ(encodeWsHeader(header, WsOpcode::Binary, 125), 2u);
+    EXPECT_EQ(header[0], 0x82);  // FIN + binary
+    EXPECT_EQ(header[1], 125);   // No mask bit
+}
+
+TEST(WsFrameTest, MediumPayloadUsesExtended16BitLength) {
+    uint8_t header[WS_MAX_HEADER_SIZE];
+    EXPECT_EQ(encodeWsHeader(header, WsOpcode::Text, 126), 4u);
+    EXPECT_EQ(header[0], 0x81);
+    EXPECT_EQ(header[1], 126);
+    EXPECT_EQ(header[2], 0x00);
+    EXPECT_EQ(header[3], 126);
+
+    EXPECT_EQ(encodeWsHeader(header, WsOpcode::Binary, 0xFFFF), 4u);
+    EXPECT_EQ(header[2], 0xFF);
+    EXPECT_EQ(header[3], 0xFF);
+}
+
+TEST(WsFrameTest, LargePayloadUsesExtended64BitLength) {
+    uint8_t header[WS_MAX_HEADER_SIZE];
+    EXPECT_EQ(encodeWsHeader(header, WsOpcode::Binary, RGB_FRAME_SIZE + 8), 10u);
+    EXPECT_EQ(header[1], 127);
+
+    uint64_t length = 0;
+    for (int i = 0; i < 8; i++) {
+        length = (length << 8) | header[2 + i];
+    }
+    EXPECT_EQ(length, RGB_FRAME_SIZE + 8u);
+}
+
+TEST(WsFrameTest, BinaryFrameCarriesBridgeHeader) {
+    std::vector<uint8_t> data = {1, 2, 3, 4};
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, 0x01020304, data.data(), data.size());
+
+    ASSERT_TRUE(frame->isBinary());
+    ASSERT_EQ(frame->payloadSize(), FRAME_HEADER_SIZE + data.size());
+    EXPECT_EQ(frame->headerSize(), 2u);
+    EXPECT_EQ(frame->wireSize(), 2u + FRAME_HEADER_SIZE + data.size());
+
+    const uint8_t* p = frame->payload();
+    EXPECT_EQ(p[0], 0x04);  // Frame ID, little-endian
+    EXPECT_EQ(p[3], 0x01);
+    EXPECT_EQ(p[4], STREAM_TYPE_DEPTH);
+    EXPECT_EQ(p[5], 0x00);
+    EXPECT_EQ(p[6], 0x00);  // Flags default to 0
+    EXPECT_EQ(p[7], 0x00);
+    EXPECT_EQ(p[8], 1);
+    EXPECT_EQ(p[11], 4);
+}
+
+TEST(WsFrameTest, BinaryViewSharesTheOwnersBytes) {
+    auto buffer = std::make_shared<std::string>(200, 'x');
+    std::weak_ptr<std::string> watch = buffer;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(buffer->data());
+    auto frame = FramedMessage::binaryView(buffer, bytes + 16, 150);
+    buffer.reset();
+
+    ASSERT_FALSE(watch.expired());  // The frame keeps the buffer alive
+    EXPECT_TRUE(frame->isBinary());
+    EXPECT_EQ(frame->payload(), bytes + 16);
+    EXPECT_EQ(frame->payloadSize(), 150u);
+    EXPECT_EQ(frame->headerSize(), 4u);
+    EXPECT_EQ(frame->wireSize(), 154u);
+
+    frame.reset();
+    EXPECT_TRUE(watch.expired());
+}
+
+TEST(WsFrameTest, WriteFramedMessageSendsHeaderAndPayload) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto frame = FramedMessage::text("{\"type\":\"hello\"}");
+    ASSERT_EQ(writeFramedMessage(fds[0], *frame, 0), static_cast<ssize_t>(frame->wireSize()));
+
+    auto received = readAll(fds[1], frame->wireSize());
+    ASSERT_EQ(received.size(), frame->wireSize());
+    EXPECT_EQ(received[0], 0x81);
+    EXPECT_EQ(received[1], frame->payloadSize());
+    EXPECT_EQ(std::string(received.begin() + 2, received.end()), "{\"type\":\"hello\"}");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(WsFrameTest, WriteFramedMessageResumesFromOffset) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::vector<uint8_t> data(300, 0xAB);
+    auto frame = FramedMessage::binaryFrame(STREAM_TYPE_RGB, 7, data.data(), data.size());
+
+    // Simulate a partial write that stopped inside the WebSocket header
+    size_t offset = 1;
+    std::vector<uint8_t> expected(frame->header(), frame->header() + frame->headerSize());
+    expected.insert(expected.end(), frame->payload(), frame->payload() + frame->payloadSize());
+
+    ASSERT_EQ(writeFramedMessage(fds[0], *frame, offset),
+              static_cast<ssize_t>(frame->wireSize() - offset));
+
+    auto received = readAll(fds[1], frame->wireSize() - offset);
+    EXPECT_EQ(received, std::vector<uint8_t>(expected.begin() + offset, expected.end()));
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(WsFrameTest, AcceptKeyMatchesRfcExample) {
+    // RFC 6455 section 1.3
+    EXPECT_EQ(computeWsAcceptKey("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST(WsFrameTest, ParserUnmasksAndReassemblesFragments) {
+    const uint8_t mask[4] = {1, 2, 3, 4};
+    auto masked = [&](uint8_t first, const std::string& text) {
+        std::vector<uint8_t> frame = {first, static_cast<uint8_t>(0x80 | text.size()),
+                                      mask[0], mask[1], mask[2], mask[3]};
+        for (size_t i = 0; i < text.size(); i++) {
+            frame.push_back(static_cast<uint8_t>(text[i]) ^ mask[i & 3]);
+        }
+        return frame;
+    };
+
+    WsFrameParser parser;
+    auto part1 = masked(0x01, "{\"type\":");       // Text, not final
+    auto ping = masked(0x89, "p");                 // Ping interleaved
+    auto part2 = masked(0x80, "\"subscribe\"}");   // Continuation, final
+
+    parser.append(part1.data(), part1.size());
+    parser.append(ping.data(), ping.size());
+    // Feed the last fragment byte by byte
+    for (uint8_t byte : part2) {
+        parser.append(&byte, 1);
+    }
+
+    WsMessage message;
+    ASSERT_TRUE(parser.next(message));
+    EXPECT_EQ(message.opcode, WsOpcode::Ping);
+    EXPECT_EQ(message.payload, "p");
+
+    ASSERT_TRUE(parser.next(message));
+    EXPECT_EQ(message.opcode, WsOpcode::Text);
+    EXPECT_EQ(message.payload, "{\"type\":\"subscribe\"}");
+
+    EXPECT_FALSE(parser.next(message));
+    EXPECT_FALSE(parser.failed());
+}
+
+TEST(WsFrameTest, ParserRejectsHugeContinuationLengths) {
+    const uint8_t mask[4] = {1, 2, 3, 4};
+    // Masked continuation with a 64-bit length of `declared` and no payload
+    auto continuation = [&](uint64_t declared) {
+        std::vector<uint8_t> frame = {0x80, 0x80 | 127};
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.push_back(static_cast<uint8_t>(declared >> shift));
+        }
+        frame.insert(frame.end(), mask, mask + 4);
+        return frame;
+    };
+    const std::vector<uint8_t> start = {0x01, 0x80 | 2, mask[0], mask[1], mask[2], mask[3],
+                                        static_cast<uint8_t>('{' ^ mask[0]), static_cast<uint8_t>('"' ^ mask[1])};
+
+    // Top bit clear, but length + fragment size wraps past 2^64
+    for (uint64_t declared : {~uint64_t{0} - 1, (uint64_t{1} << 63) - 1, (uint64_t{1} << 63) | 5}) {
+        WsFrameParser parser;
+        auto frame = continuation(declared);
+        parser.append(start.data(), start.size());
+        parser.append(frame.data(), frame.size());
+
+        WsMessage message;
+        EXPECT_FALSE(parser.next(message));
+        EXPECT_TRUE(parser.failed()) << declared;
+    }
+}
+
+TEST(WsFrameTest, ParserRejectsUnmaskedClientFrames) {
+    WsFrameParser parser;
+    auto frame = FramedMessage::text("hi");
+    parser.append(frame->header(), frame->headerSize());
+    parser.append(frame->payload(), frame->payloadSize());
+
+    WsMessage message;
+    EXPECT_FALSE(parser.next(message));
+    EXPECT_TRUE(parser.failed());
+}
@@ -0,0 +1,116 @@
+/**
+ * @file bench_common.h
+ * @brief Loopback client helpers shared by the bridge benchmarks
+ */
+
+#pragma once
+
+#include "kinect_xr/ws_frame.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kinect_xr {
+namespace bench {
+
+inline double cpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+inline uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline int connectWithRetry(int port) {
+    for (int attempt = 0; attempt < 200; attempt++) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+    return -1;
+}
+
+/**
+ * @brief Connect and complete a WebSocket handshake on loopback
+ * @param parser Receives any frame bytes that arrived with the response
+ * @return Socket fd, or -1 on failure
+ */
+inline int openWebSocket(int port, WsFrameParser& parser) {
+    int fd = connectWithRetry(port);
+    if (fd < 0) {
+        return -1;
+    }
+
+    std::string request =
+        "GET /kinect HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (::write(fd, request.data(), request.size()) != static_cast<ssize_t>(request.size())) {
+        ::close(fd);
+        return -1;
+    }
+
+    // Read the handshake response; anything after it is WebSocket data
+    std::string response;
+    char buffer[4096];
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            ::close(fd);
+            return -1;
+        }
+        response.append(buffer, n);
+    }
+    if (response.find(" 101 ") == std::string::npos) {
+        ::close(fd);
+        return -1;
+    }
+
+    size_t headerEnd = response.find("\r\n\r\n") + 4;
+    parser.append(reinterpret_cast<const uint8_t*>(response.data()) + headerEnd,
+                  response.size() - headerEnd);
+    return fd;
+}
+
+/**
+ * @brief Latency samples with simple percentile reporting
+ */
+struct LatencySamples {
+    std::vector<double> micros;
+
+    void add(uint64_t ns) { micros.push_back(ns / 1000.0); }
+
+    double percentile(double p) {
+        if (micros.empty()) return 0.0;
+        std::sort(micros.begin(), micros.end());
+        size_t index = static_cast<size_t>(p * (micros.size() - 1));
+        return micros[index];
+    }
+};
+
+}  // namespace bench
+}  // namespace kinect_xr
@@ -0,0 +1,254 @@
+/**
+ * @file broadcast_bench.cpp
+ * @brief Fan-out benchmark: IXWebSocket transport vs reactor transport
+ *
+ * Connects N loopback WebSocket clients (in a forked child process, so the
+ * server's CPU time is measured on its own), broadcasts M frames through the
+ * selected transport and reports delivered throughput and server CPU cost.
+ *
+ * Usage:
+ *   bridge_broadcast_bench                        # both transports, defaults
+ *   bridge_broadcast_bench --clients 32 --frames 300 --transport epoll
+ */
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/ws_frame.h"
+#include "bench_common.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kinect_xr;
+using bench::cpuSeconds;
+
+namespace {
+
+constexpr int MAX_CLIENTS = 1024;
+constexpr uint64_t SEND_WINDOW = 4;  // Frames in flight ahead of the slowest client
+
+struct SharedCounters {
+    std::atomic<uint64_t> received[MAX_CLIENTS];
+    std::atomic<int> connected;
+    std::atomic<int> failed;
+};
+
+struct Options {
+    int clients = 16;
+    int frames = 300;
+    size_t frameSize = RGB_FRAME_SIZE;
+    int ioThreads = 2;
+    int basePort = 9870;
+    std::vector<TransportKind> transports = {TransportKind::IXWebSocket, TransportKind::Reactor};
+};
+
+void runClient(int index, int port, int frames, SharedCounters* counters) {
+    std::vector<uint8_t> buffer(256 * 1024);
+    WsFrameParser parser(false, 64 << 20);
+    int fd = bench::openWebSocket(port, parser);
+    if (fd < 0) {
+        counters->failed++;
+        return;
+    }
+    counters->connected++;
+
+    uint64_t received = 0;
+    WsMessage message;
+    while (received < static_cast<uint64_t>(frames)) {
+        while (parser.next(message)) {
+            if (message.opcode == WsOpcode::Binary) {
+                counters->received[index] = ++received;
+            }
+        }
+        if (received >= static_cast<uint64_t>(frames)) break;
+
+        ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n <= 0 || parser.failed()) break;
+        parser.append(buffer.data(), static_cast<size_t>(n));
+    }
+
+    ::close(fd);
+}
+
+uint64_t slowestClient(SharedCounters* counters, int clients) {
+    uint64_t slowest = UINT64_MAX;
+    for (int i = 0; i < clients; i++) {
+        slowest = std::min<uint64_t>(slowest, counters->received[i].load());
+    }
+    return slowest;
+}
+
+bool runBenchmark(TransportKind kind, int port, const Options& options) {
+    auto* counters = static_cast<SharedCounters*>(mmap(nullptr, sizeof(SharedCounters),
+                                                       PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if (counters == MAP_FAILED) {
+        std::perror("mmap");
+        return false;
+    }
+    new (counters) SharedCounters();
+
+    // Fork the clients before any server thread exists
+    pid_t child = fork();
+    if (child == 0) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < options.clients; i++) {
+            threads.emplace_back(runClient, i, port, options.frames, counters);
+        }
+        for (auto& t : threads) t.join();
+        _exit(0);
+    }
+
+    auto transport = createTransport(kind, options.ioThreads);
+    std::mutex clientsMutex;
+    std::vector<ClientPtr> clients;
+
+    TransportCallbacks callbacks;
+    callbacks.onOpen = [&](const ClientPtr& client) {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clients.push_back(client);
+    };
+    callbacks.onMessage = [](const ClientPtr&, const std::string&) {};
+    callbacks.onClose = [](const ClientPtr&) {};
+
+    if (!transport->start(port, callbacks)) {
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+        munmap(counters, sizeof(SharedCounters));
+        return false;
+    }
+
+    // Wait for every client to complete the handshake
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    bool ready = false;
+    while (!ready && counters->failed == 0 && std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            ready = static_cast<int>(clients.size()) == options.clients &&
+                    counters->connected == options.clients;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!ready) {
+        std::cerr << "Clients failed to connect via " << transport->name() << std::endl;
+        transport->stop();
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+        munmap(counters, sizeof(SharedCounters));
+        return false;
+    }
+
+    std::vector<uint8_t> data(options.frameSize);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    double cpuStart = cpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (int f = 0; f < options.frames; f++) {
+        // Pace to the slowest client so queues stay bounded
+        while (static_cast<uint64_t>(f) > slowestClient(counters, options.clients) + SEND_WINDOW) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        auto frame = FramedMessage::binaryFrame(STREAM_TYPE_RGB, static_cast<uint32_t>(f),
+                                                data.data(), data.size());
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto& client : clients) {
+            client->sendFrame(frame);
+        }
+    }
+
+    while (slowestClient(counters, options.clients) < static_cast<uint64_t>(options.frames)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double cpu = cpuSeconds() - cpuStart;
+
+    transport->stop();
+    waitpid(child, nullptr, 0);
+
+    double deliveredMB = double(options.frameSize) * options.frames * options.clients / 1e6;
+    double deliveries = double(options.frames) * options.clients;
+
+    std::printf("%-9s %7d %7d %10zu %8.2f %10.1f %9.3f %12.1f\n",
+                transport->name(), options.clients, options.frames, options.frameSize, wall,
+                deliveredMB / wall, cpu, cpu * 1e6 / deliveries);
+
+    munmap(counters, sizeof(SharedCounters));
+    return true;
+}
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " [options]\n"
+              << "  --clients N         Concurrent clients (default: 16)\n"
+              << "  --frames N          Frames to broadcast (default: 300)\n"
+              << "  --size BYTES        Frame payload size (default: 921600, one RGB frame)\n"
+              << "  --transport T       ix, epoll or both (default: both)\n"
+              << "  --io-threads N      Reactor I/O threads (default: 2)\n"
+              << "  --port PORT         First port to use (default: 9870)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            options.clients = std::clamp(std::atoi(argv[++i]), 1, MAX_CLIENTS);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            options.frameSize = static_cast<size_t>(std::atol(argv[++i]));
+        } else if (std::strcmp(argv[i], "--io-threads") == 0 && i + 1 < argc) {
+            options.ioThreads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.basePort = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--transport") == 0 && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "ix") {
+                options.transports = {TransportKind::IXWebSocket};
+            } else if (name == "epoll") {
+                options.transports = {TransportKind::Reactor};
+            } else if (name != "both") {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::printf("%-9s %7s %7s %10s %8s %10s %9s %12s\n", "transport", "clients", "frames",
+                "bytes", "wall_s", "MB/s", "cpu_s", "cpu_us/send");
+
+    int port = options.basePort;
+    for (auto kind : options.transports) {
+        if (!runBenchmark(kind, port++, options)) {
+            std::cerr << "Benchmark failed to start" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file shm_latency_bench.cpp
+ * @brief Publish-to-consumer latency: shared-memory ring vs WebSocket
+ *
+ * A forked consumer process receives paced frames either from the
+ * shared-memory ring or over a loopback WebSocket and measures the time from
+ * publish to availability (the producer stamps steady_clock into the first
+ * 8 bytes of each frame).
+ *
+ * Usage:
+ *   bridge_shm_latency_bench
+ *   bridge_shm_latency_bench --frames 600 --size 921600 --transport epoll
+ */
+
+#include "kinect_xr/bridge_server.h"
+#include "kinect_xr/bridge_transport.h"
+#include "kinect_xr/shm_ring.h"
+#include "kinect_xr/ws_frame.h"
+#include "bench_common.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kinect_xr;
+
+namespace {
+
+struct Options {
+    int frames = 300;
+    size_t frameSize = DEPTH_FRAME_SIZE;
+    int intervalMs = 33;
+    int port = 9890;
+    TransportKind transport = TransportKind::Reactor;
+};
+
+void stamp(std::vector<uint8_t>& data) {
+    uint64_t now = bench::steadyNowNs();
+    std::memcpy(data.data(), &now, sizeof(now));
+}
+
+uint64_t readStamp(const uint8_t* data) {
+    uint64_t stamped;
+    std::memcpy(&stamped, data, sizeof(stamped));
+    return stamped;
+}
+
+void report(const char* path, bench::LatencySamples& samples, uint64_t dropped) {
+    std::printf("%-10s %7zu %7llu %10.1f %10.1f %10.1f\n", path, samples.micros.size(),
+                static_cast<unsigned long long>(dropped), samples.percentile(0.5),
+                samples.percentile(0.99), samples.percentile(1.0));
+    std::fflush(stdout);
+}
+
+// ============================================================================
+// Shared memory
+// ============================================================================
+
+void shmConsumer(const std::string& name, int frames) {
+    ShmRingReader reader;
+    for (int attempt = 0; attempt < 100 && !reader.open(name); attempt++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!reader.isOpen()) {
+        std::cerr << "Consumer could not open " << name << std::endl;
+        return;
+    }
+
+    bench::LatencySamples samples;
+    ShmFrameView view;
+    while (static_cast<int>(samples.micros.size()) < frames && reader.wait(2000)) {
+        while (reader.next(view)) {
+            uint64_t now = bench::steadyNowNs();
+            if (view.size >= sizeof(uint64_t) && reader.stillValid(view)) {
+                samples.add(now - readStamp(view.data));
+            }
+        }
+    }
+    report("shm", samples, reader.droppedFrames());
+}
+
+bool runShm(const Options& options) {
+    std::string name = "/kinect-xr-bench-" + std::to_string(getpid());
+    ShmRingWriter writer;
+    if (!writer.create(name, 8, static_cast<uint32_t>(options.frameSize))) {
+        return false;
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        shmConsumer(name, options.frames);
+        _exit(0);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<uint8_t> data(options.frameSize, 0x5A);
+    for (int f = 0; f < options.frames; f++) {
+        stamp(data);
+        writer.publish(STREAM_TYPE_DEPTH, static_cast<uint32_t>(f), data.data(), data.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.intervalMs));
+    }
+
+    waitpid(child, nullptr, 0);
+    return true;
+}
+
+// ============================================================================
+// WebSocket
+// ============================================================================
+
+void wsConsumer(int port, int frames) {
+    WsFrameParser parser(false, 64 << 20);
+    int fd = bench::openWebSocket(port, parser);
+    if (fd < 0) {
+        std::cerr << "Consumer could not connect" << std::endl;
+        return;
+    }
+
+    bench::LatencySamples samples;
+    std::vector<uint8_t> buffer(256 * 1024);
+    WsMessage message;
+    while (static_cast<int>(samples.micros.size()) < frames) {
+        while (parser.next(message)) {
+            if (message.opcode == WsOpcode::Binary &&
+                message.payload.size() >= FRAME_HEADER_SIZE + sizeof(uint64_t)) {
+                uint64_t now = bench::steadyNowNs();
+                samples.add(now - readStamp(reinterpret_cast<const uint8_t*>(
+                                      message.payload.data() + FRAME_HEADER_SIZE)));
+            }
+        }
+        if (static_cast<int>(samples.micros.size()) >= frames) break;
+
+        ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n <= 0 || parser.failed()) break;
+        parser.append(buffer.data(), static_cast<size_t>(n));
+    }
+
+    ::close(fd);
+    report("websocket", samples, 0);
+}
+
+bool runWebSocket(const Options& options) {
+    // Fork the consumer before any server thread exists
+    pid_t child = fork();
+    if (child == 0) {
+        wsConsumer(options.port, options.frames);
+        _exit(0);
+    }
+
+    auto transport = createTransport(options.transport);
+    std::atomic<bool> connected{false};
+    ClientPtr client;
+
+    TransportCallbacks callbacks;
+    callbacks.onOpen = [&](const ClientPtr& c) {
+        client = c;
+        connected = true;
+    };
+    callbacks.onMessage = [](const ClientPtr&, const std::string&) {};
+    callbacks.onClose = [](const ClientPtr&) {};
+
+    if (!transport->start(options.port, callbacks)) {
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!connected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!connected) {
+        transport->stop();
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+        return false;
+    }
+
+    std::vector<uint8_t> data(options.frameSize, 0x5A);
+    for (int f = 0; f < options.frames; f++) {
+        stamp(data);
+        client->sendFrame(FramedMessage::binaryFrame(STREAM_TYPE_DEPTH, static_cast<uint32_t>(f),
+                                                     data.data(), data.size()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.intervalMs));
+    }
+
+    waitpid(child, nullptr, 0);
+    transport->stop();
+    return true;
+}
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " [options]\n"
+              << "  --frames N          Frames to publish (default: 300)\n"
+              << "  --size BYTES        Frame size (default: 614400, one depth frame)\n"
+              << "  --interval-ms N     Publish interval (default: 33)\n"
+              << "  --transport T       WebSocket transport: ix or epoll (default: epoll)\n"
+              << "  --port PORT         WebSocket port (default: 9890)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            options.frameSize = std::max<size_t>(sizeof(uint64_t), std::atol(argv[++i]));
+        } else if (std::strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            options.intervalMs = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--transport") == 0 && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "ix") {
+                options.transport = TransportKind::IXWebSocket;
+            } else if (name == "epoll") {
+                options.transport = TransportKind::Reactor;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::printf("%-10s %7s %7s %10s %10s %10s\n", "path", "frames", "dropped", "p50_us",
+                "p99_us", "max_us");
+    std::fflush(stdout);
+
+    if (!runShm(options)) {
+        std::cerr << "Shared-memory benchmark failed" << std::endl;
+        return 1;
+    }
+    if (!runWebSocket(options)) {
+        std::cerr << "WebSocket benchmark failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -12,9 +12,37 @@
  *     ctx.putImageData(imageData, 0, 0);
  *   };
  *
- *   kinect.onDepthFrame = (depthArray, frameId) => {
- *     // depthArray is Uint16Array[307200] (640x480)
- *     // values are depth in mm (800-4000)
+ *   kinect.onDepthFrame = (depthArray, frameId, width, height) => {
+ *     // depthArray is Uint16Array[width * height], 640x480 unless adaptive
+ *     // delivery downscaled it; values are depth in mm (800-4000)
+ *   };
+ *
+ *   // Server-side back-projection: subscribe to 'pointcloud' instead of depth
+ *   kinect.setStreams(['pointcloud']);
+ *   kinect.setPointCloudOptions({ decimation: 4, format: 'int16', color: true });
+ *   kinect.onPointCloud = (cloud, frameId) => {
+ *     // cloud.positions: Int16Array (mm) or Uint16Array (float16 bits, metres),
+ *     // x, y, z per point; cloud.colors: Uint8Array r, g, b per point or null
+ *     positionAttribute.array.set(cloud.positions);
+ *   };
+ *
+ *   // Triangle mesh for occlusion: subscribe to 'mesh'
+ *   kinect.setMeshOptions({ step: 4, adaptive: true });
+ *   kinect.onMesh = (mesh, frameId) => {
+ *     // mesh.positions: Int16Array x, y, z in mm; mesh.indices: Uint16Array or Uint32Array
+ *   };
+ *
+ *   // Depth-keyed RGB: the bridge cuts out everything outside 0.5-1.5 m
+ *   kinect.setStreams(['keyed']);
+ *   kinect.setKeyOptions({ mode: 'range', minDepthMm: 500, maxDepthMm: 1500, feather: 2 });
+ *   kinect.onKeyedFrame = (imageData, frameId, info) => {
+ *     ctx.putImageData(imageData, 0, 0);  // Alpha is 0 where the scene was keyed out
+ *   };
+ *
+ *   // Silhouette outlines only: a few kilobytes per frame
+ *   kinect.setStreams(['contours']);
+ *   kinect.onContours = (contours, frameId) => {
+ *     // contours.polygons: [{points: Int16Array x, y in half pixels, hole: boolean}]
  *   };
  *
  *   await kinect.connect();
@@ -23,10 +51,68 @@
 // Protocol constants
 const STREAM_TYPE_RGB = 0x0001;
 const STREAM_TYPE_DEPTH = 0x0002;
+const STREAM_TYPE_POINTCLOUD = 0x0003;
+const STREAM_TYPE_MESH = 0x0004;
+const STREAM_TYPE_KEYED = 0x0005;
+const STREAM_TYPE_CONTOURS = 0x0006;
+const STREAM_TYPE_BUNDLE = 0x0007;
+const STREAM_TYPE_CONTROL = 0x0008;
+const FRAME_FLAG_HISTORY = 0x0001;
+const FRAME_FLAG_SCALE_MASK = 0x000C;
+const FRAME_FLAG_SCALE_SHIFT = 2;
+const FRAME_FLAG_PIXEL_FORMAT_MASK = 0x0030;
+const FRAME_FLAG_PIXEL_FORMAT_SHIFT = 4;
+const PIXEL_FORMAT_RGBA8888 = 1;
+const FRAME_FLAG_DEPTH_PACKING_MASK = 0x00C0;
+const FRAME_FLAG_DEPTH_PACKING_SHIFT = 6;
+const DEPTH_PACKING_BITS = [16, 12, 13];
+const DEPTH_FORMATS = ['uint16', 'packed12', 'packed13'];
+const FRAME_FLAG_TILES = 0x0100;
+const TILE_SIZE = 32;
+const TILE_COLUMNS = 20;
+const TILE_COUNT = 300;
+const TILE_HEADER_SIZE = 44;
 const FRAME_WIDTH = 640;
 const FRAME_HEIGHT = 480;
-const RGB_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 3;
 const DEPTH_FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 2;
+const POINT_CLOUD_HEADER_SIZE = 8;
+const POINT_CLOUD_FLAG_COLOR = 0x01;
+const POINT_FORMATS = ['int16', 'float16'];
+const MESH_HEADER_SIZE = 12;
+const MESH_FLAG_INDEX32 = 0x01;
+const KEY_HEADER_SIZE = 12;
+const KEY_FLAG_LEARNING = 0x01;
+const KEY_FORMATS = ['rgba', 'jpeg'];
+const CONTOUR_HEADER_SIZE = 8;
+const CONTOUR_FLAG_HOLE = 0x0001;
+const BUNDLE_HEADER_SIZE = 16;
+const CLOCK_WINDOW = 8;  // Exchanges the clock filter picks from, as on the bridge
+const CONTROL_SET_TILT = 0x0001;
+const CONTROL_SET_LED = 0x0002;
+const CONTROL_RESET = 0x0003;
+const CONTROL_GET_MOTOR_STATUS = 0x0004;
+const CONTROL_STATUS = 0x0005;
+const CONTROL_MOTOR_STATUS = 0x0101;
+const CONTROL_STATUS_REPLY = 0x0102;
+const CONTROL_ERROR = 0x01FF;
+const CONTROL_ANGLE_UNKNOWN = -32768;
+const CONTROL_MOTOR_FLAG_ACCEL = 0x01;
+const CONTROL_LED_STATES = {
+  off: 0, green: 1, red: 2, yellow: 3, blink_green: 4, blink_red_yellow: 6,
+};
+const CONTROL_TILT_STATUS = { 0: 'STOPPED', 1: 'LIMIT', 4: 'MOVING' };
+const CONTROL_ERROR_CODES = [
+  null, 'PROTOCOL_ERROR', 'DEVICE_NOT_CONNECTED', 'RATE_LIMITED', 'MOTOR_CONTROL_FAILED',
+  'LED_CONTROL_FAILED', 'MOTOR_STATUS_FAILED', 'INVALID_LED_STATE',
+];
+const BUNDLE_STREAM_NAMES = {
+  [STREAM_TYPE_RGB]: 'rgb',
+  [STREAM_TYPE_DEPTH]: 'depth',
+  [STREAM_TYPE_POINTCLOUD]: 'pointcloud',
+  [STREAM_TYPE_MESH]: 'mesh',
+  [STREAM_TYPE_KEYED]: 'keyed',
+  [STREAM_TYPE_CONTOURS]: 'contours',
+};
 
 /**
  * Kinect WebSocket client for browser
@@ -44,18 +130,31 @@ export class KinectClient {
 
     // User callbacks
     this.onRgbFrame = null;    // (imageData: ImageData, frameId: number) => void
-    this.onDepthFrame = null;  // (depth: Uint16Array, frameId: number) => void
+    this.onDepthFrame = null;  // (depth: Uint16Array, frameId: number, width: number, height: number) => void
+    this.onPointCloud = null;  // (cloud: {count, format, decimation, positions, colors}, frameId: number) => void
+    this.onMesh = null;        // (mesh: {vertexCount, indexCount, step, positions, indices}, frameId: number) => void
+    this.onKeyedFrame = null;  // (imageData: ImageData, frameId: number, info: {format, learning}) => void
+    this.onContours = null;    // (contours: {step, learning, polygons: [{points, hole}]}, frameId: number) => void
     this.onConnect = null;     // (capabilities: object) => void
     this.onDisconnect = null;  // () => void
     this.onError = null;       // (error: object) => void
     this.onStatus = null;      // (status: object) => void
+    this.onStats = null;       // (metrics: {name: [{labels, value | count, mean_us, p50_us, ...}]}) => void
     this.onMotorStatus = null; // (status: {angle, status, accelerometer?}) => void
     this.onMotorError = null;  // (error: {code, message}) => void
+    this.onHistoryFrame = null; // (stream: string, data: ImageData|Uint16Array, frameId: number) => void
+    this.onBundle = null;      // (frameId: number, streams: string[], captureTimeMs: number) => void, after the streams' callbacks
+    this.onClockSync = null;   // (clock: {offsetMs, rttMs, minRttMs, jitterMs, samples}) => void
 
     // Statistics
     this.stats = {
       rgbFrames: 0,
       depthFrames: 0,
+      pointCloudFrames: 0,
+      meshFrames: 0,
+      keyedFrames: 0,
+      contourFrames: 0,
+      bundles: 0,
       lastRgbFrameId: -1,
       lastDepthFrameId: -1,
       droppedRgbFrames: 0,
@@ -66,13 +165,56 @@ export class KinectClient {
     // Streams to subscribe to
     this._streams = ['rgb', 'depth'];
 
-    // Temporary buffer for RGB conversion
-    this._rgbaBuffer = new Uint8ClampedArray(FRAME_WIDTH * FRAME_HEIGHT * 4);
+    // Ask for the newest stored frame on subscribe (bridge --history)
+    this._catchUp = false;
+
+    // Let the bridge downscale frames when the link is slow
+    this._adaptive = false;
+
+    // Depth wire format: 'uint16', or bit-packed 'packed12' / 'packed13'
+    this._depthFormat = 'uint16';
+
+    // Receive each frame's streams together in one message
+    this._bundle = false;
+
+    // Send motor and status requests as binary records when the bridge supports it
+    this._binaryControl = false;
+    this._controlBuffer = new ArrayBuffer(16);
+
+    // Receive only changed 32x32 tiles and patch persistent buffers
+    this._tiles = false;
+    this._rgbTiles = null;    // ImageData
+    this._depthTiles = null;  // Uint16Array
+
+    // Options for the derived streams (null = server defaults)
+    this._pointCloud = null;
+    this._mesh = null;
+    this._key = null;
+    this._contours = null;
+
+    // Newest keyed frame delivered; JPEG frames decode asynchronously
+    this._lastKeyedFrameId = -1;
+
+    // Acknowledge every Nth frame with receive/render times (0 = off)
+    this._ackEvery = 0;
+    this._ackCount = 0;
+    this._lastAckedFrameId = -1;
+
+    // NTP-style exchanges with the bridge (0 = off)
+    this._syncIntervalMs = 0;
+    this._syncTimer = null;
+    this._syncId = 0;
+    this._syncPending = null;   // {id, t0}
+    this._syncPrevious = null;  // {id, t3} reported with the next request
+    this._clockSamples = [];    // Last CLOCK_WINDOW {offset, rtt}
+    this._clockCount = 0;
+    this._srtt = 0;
+    this._rttvar = 0;
   }
 
   /**
    * Set which streams to subscribe to
-   * @param {string[]} streams - Array of stream names ('rgb', 'depth')
+   * @param {string[]} streams - Array of stream names ('rgb', 'depth', 'pointcloud', 'mesh', 'keyed', 'contours')
    */
   setStreams(streams) {
     this._streams = streams;
@@ -81,6 +223,288 @@ export class KinectClient {
     }
   }
 
+  /**
+   * Request the newest stored frame of each stream whenever we subscribe,
+   * instead of waiting for the next live frame. Needs bridge --history.
+   * @param {boolean} enabled
+   */
+  setCatchUp(enabled) {
+    this._catchUp = enabled;
+  }
+
+  /**
+   * Accept reduced-resolution frames when the bridge measures a slow link.
+   * Without this the bridge only lowers the frame rate. Frame callbacks get
+   * the actual width and height (ImageData dimensions for RGB).
+   * @param {boolean} enabled
+   */
+  setAdaptive(enabled) {
+    this._adaptive = enabled;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Choose how depth travels. Packed formats are lossless within their
+   * range and cut depth bandwidth by 25% ('packed12', 0-4095 mm) or 19%
+   * ('packed13', 0-8191 mm); farther readings arrive as 0. onDepthFrame
+   * still receives a Uint16Array of millimetres.
+   * @param {string} format - 'uint16', 'packed12' or 'packed13'
+   */
+  setDepthFormat(format) {
+    if (!DEPTH_FORMATS.includes(format)) {
+      throw new Error(`Unknown depth format: ${format}`);
+    }
+    this._depthFormat = format;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Receive all subscribed streams of a frame in one message. The stream
+   * callbacks fire back to back for the same frame ID, then onBundle, so
+   * RGB and depth never have to be re-paired.
+   * @param {boolean} enabled
+   */
+  setBundled(enabled) {
+    this._bundle = enabled;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Send motor and status requests as compact binary records instead of
+   * JSON, for callers that steer the tilt or poll status at frame rate.
+   * Replies and motor status events then arrive binary too; the callbacks
+   * and promises see the same objects either way. Ignored if the bridge
+   * does not advertise binary control (capabilities.control).
+   * @param {boolean} enabled
+   */
+  setBinaryControl(enabled) {
+    this._binaryControl = enabled;
+  }
+
+  /**
+   * Estimate the offset between this clock and the bridge's, and the round
+   * trip, with NTP-style time.sync exchanges. The bridge sees the same
+   * samples: it corrects acks with the offset and adapts delivery to the
+   * round trip. Read the estimate with getClockEstimate() or onClockSync.
+   * Ignored if the bridge does not advertise capabilities.time_sync.
+   * @param {boolean} enabled
+   * @param {number} intervalMs - Time between exchanges once settled
+   */
+  setTimeSync(enabled, intervalMs = 2000) {
+    this._syncIntervalMs = enabled ? Math.max(100, intervalMs) : 0;
+    this._stopTimeSync();
+    if (this.connected) {
+      this._startTimeSync();
+    }
+  }
+
+  /**
+   * Current clock estimate. offsetMs is bridge time minus local time, so
+   * local Date.now() + offsetMs is the bridge's wall clock.
+   * @returns {{valid: boolean, offsetMs: number, rttMs: number, minRttMs: number, jitterMs: number, samples: number}}
+   */
+  getClockEstimate() {
+    if (this._clockSamples.length === 0) {
+      return { valid: false, offsetMs: 0, rttMs: 0, minRttMs: 0, jitterMs: 0, samples: 0 };
+    }
+    // The fastest recent exchange was delayed least, and least unevenly
+    const best = this._clockSamples.reduce((a, b) => (b.rtt < a.rtt ? b : a));
+    return {
+      valid: true,
+      offsetMs: best.offset,
+      rttMs: this._srtt,
+      minRttMs: best.rtt,
+      jitterMs: this._rttvar,
+      samples: this._clockCount
+    };
+  }
+
+  /**
+   * Convert a bridge wall-clock time (e.g. a bundle's captureTimeMs) to this clock
+   * @param {number} bridgeMs
+   * @returns {number}
+   */
+  fromBridgeTime(bridgeMs) {
+    return bridgeMs - this.getClockEstimate().offsetMs;
+  }
+
+  /**
+   * Report when frames arrive and when the next animation frame after their
+   * callbacks runs, so the bridge can measure capture-to-render latency
+   * (status.latency). Times are wall-clock, so the cross-clock spans are
+   * only as good as the two clocks agree. Ignored if the bridge does not
+   * advertise capabilities.latency.
+   * @param {boolean} enabled
+   * @param {number} every - Acknowledge one frame in this many
+   */
+  setLatencyAcks(enabled, every = 1) {
+    this._ackEvery = enabled ? Math.max(1, Math.floor(every)) : 0;
+    this._ackCount = 0;
+  }
+
+  /**
+   * Receive only the 32x32 tiles that changed since the previous frame.
+   * Mostly static scenes then cost a fraction of the bandwidth. onRgbFrame
+   * and onDepthFrame receive the same full-size ImageData / Uint16Array
+   * every time, patched in place, so copy it if you need to keep a frame.
+   * Not available with packed depth formats.
+   * @param {boolean} enabled
+   */
+  setTileUpdates(enabled) {
+    this._tiles = enabled;
+    this._rgbTiles = null;
+    this._depthTiles = null;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Configure the 'pointcloud' stream. The bridge back-projects depth and
+   * sends only valid points, ready to copy into a GPU vertex buffer.
+   * @param {object} options
+   * @param {number} [options.decimation=2] - Pixel step in x and y: 1, 2, 4 or 8
+   * @param {string} [options.format='int16'] - 'int16' (millimetres) or 'float16' (metres)
+   * @param {boolean} [options.color=false] - Include RGB per point
+   * @param {number} [options.minDepthMm] - Drop points nearer than this
+   * @param {number} [options.maxDepthMm] - Drop points farther than this
+   */
+  setPointCloudOptions(options) {
+    const pointcloud = {};
+    if (options.decimation !== undefined) pointcloud.decimation = options.decimation;
+    if (options.format !== undefined) pointcloud.format = options.format;
+    if (options.color !== undefined) pointcloud.color = options.color;
+    if (options.minDepthMm !== undefined) pointcloud.min_depth_mm = options.minDepthMm;
+    if (options.maxDepthMm !== undefined) pointcloud.max_depth_mm = options.maxDepthMm;
+    this._pointCloud = pointcloud;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Configure the 'mesh' stream. The bridge triangulates the depth grid,
+   * drops triangles across depth discontinuities and sends vertex and index
+   * buffers ready for a WebGL geometry.
+   * @param {object} options
+   * @param {number} [options.step=4] - Grid spacing in pixels: 1, 2, 4, 8 or 16
+   * @param {boolean} [options.adaptive=false] - Merge flat regions into larger cells
+   * @param {number} [options.discontinuity=0.02] - Max depth jump per pixel, relative to depth
+   * @param {number} [options.flatness=0.005] - Adaptive: max deviation from flat, relative to depth
+   * @param {number} [options.minDepthMm] - Treat nearer samples as holes
+   * @param {number} [options.maxDepthMm] - Treat farther samples as holes
+   */
+  setMeshOptions(options) {
+    const mesh = {};
+    if (options.step !== undefined) mesh.step = options.step;
+    if (options.adaptive !== undefined) mesh.adaptive = options.adaptive;
+    if (options.discontinuity !== undefined) mesh.discontinuity = options.discontinuity;
+    if (options.flatness !== undefined) mesh.flatness = options.flatness;
+    if (options.minDepthMm !== undefined) mesh.min_depth_mm = options.minDepthMm;
+    if (options.maxDepthMm !== undefined) mesh.max_depth_mm = options.maxDepthMm;
+    this._mesh = mesh;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Configure the 'keyed' stream. The bridge registers RGB to depth and
+   * sets alpha from depth, so the frame can be composited as is.
+   * @param {object} options
+   * @param {string} [options.mode='range'] - 'range' (keep minDepthMm-maxDepthMm) or
+   *   'background' (keep what is nearer than the learned background)
+   * @param {string} [options.format='rgba'] - 'rgba' (raw) or 'jpeg' (JPEG + deflated mask, ~10x smaller)
+   * @param {number} [options.minDepthMm=500] - Key out anything nearer
+   * @param {number} [options.maxDepthMm=1500] - Key out anything farther (0 = no limit; default in background mode)
+   * @param {number} [options.toleranceMm=100] - Background: how much nearer than the background counts
+   * @param {number} [options.feather=0] - Alpha blur radius in pixels, 0 to 8
+   * @param {number} [options.quality=80] - JPEG quality
+   */
+  setKeyOptions(options) {
+    const key = {};
+    if (options.mode !== undefined) key.mode = options.mode;
+    if (options.format !== undefined) key.format = options.format;
+    if (options.minDepthMm !== undefined) key.min_depth_mm = options.minDepthMm;
+    if (options.maxDepthMm !== undefined) key.max_depth_mm = options.maxDepthMm;
+    if (options.toleranceMm !== undefined) key.tolerance_mm = options.toleranceMm;
+    if (options.feather !== undefined) key.feather = options.feather;
+    if (options.quality !== undefined) key.quality = options.quality;
+    this._key = key;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Configure the 'contours' stream. The bridge keys depth like the 'keyed'
+   * stream, traces the silhouettes and simplifies them into polygons.
+   * @param {object} options
+   * @param {string} [options.mode='range'] - 'range' or 'background' (see setKeyOptions)
+   * @param {number} [options.step=2] - Mask grid spacing in pixels: 1, 2, 4 or 8
+   * @param {number} [options.epsilon=1.5] - Simplification tolerance in pixels (0-12.7)
+   * @param {number} [options.minArea=64] - Drop polygons smaller than this, in square pixels
+   * @param {number} [options.minDepthMm=500] - Nearer readings are outside
+   * @param {number} [options.maxDepthMm=1500] - Farther readings are outside (0 = no limit)
+   * @param {number} [options.toleranceMm=100] - Background: how much nearer than the background counts
+   */
+  setContourOptions(options) {
+    const contours = {};
+    if (options.mode !== undefined) contours.mode = options.mode;
+    if (options.step !== undefined) contours.step = options.step;
+    if (options.epsilon !== undefined) contours.epsilon = options.epsilon;
+    if (options.minArea !== undefined) contours.min_area = options.minArea;
+    if (options.minDepthMm !== undefined) contours.min_depth_mm = options.minDepthMm;
+    if (options.maxDepthMm !== undefined) contours.max_depth_mm = options.maxDepthMm;
+    if (options.toleranceMm !== undefined) contours.tolerance_mm = options.toleranceMm;
+    this._contours = contours;
+    if (this.connected) {
+      this._subscribe();
+    }
+  }
+
+  /**
+   * Relearn the static background used by the 'background' key and contour modes.
+   * Step out of view first: the bridge keeps the farthest depth it sees.
+   * @param {number} [frames=30] - Frames to learn from (1-300)
+   */
+  learnBackground(frames = 30) {
+    this._send({ type: 'key.learn', frames });
+  }
+
+  /**
+   * Fetch one frame from the bridge's history; it arrives via onHistoryFrame
+   * @param {string} stream - 'rgb' or 'depth'
+   * @param {object} [query] - {frameId} or {timestampMs} or {agoMs}; empty = newest
+   */
+  fetchHistory(stream, query = {}) {
+    const msg = { type: 'history.get', stream };
+    if (stream === 'rgb') msg.format = 'RGBA8888';
+    if (query.frameId !== undefined) msg.frame_id = query.frameId;
+    else if (query.timestampMs !== undefined) msg.timestamp_ms = query.timestampMs;
+    else if (query.agoMs !== undefined) msg.ago_ms = query.agoMs;
+    this._send(msg);
+  }
+
+  /**
+   * Replay a burst of recent frames, oldest first, via onHistoryFrame
+   * @param {string} stream - 'rgb' or 'depth'
+   * @param {object} [range] - {count} frames (default 30) or {seconds}
+   */
+  replayHistory(stream, range = {}) {
+    const msg = { type: 'history.replay', stream };
+    if (stream === 'rgb') msg.format = 'RGBA8888';
+    if (range.seconds !== undefined) msg.seconds = range.seconds;
+    else if (range.count !== undefined) msg.count = range.count;
+    this._send(msg);
+  }
+
   /**
    * Connect to the Kinect bridge server
    * @returns {Promise<object>} Resolves with capabilities on success
@@ -103,7 +527,9 @@ export class KinectClient {
         if (typeof event.data === 'string') {
           this._handleJsonMessage(event.data, resolve, reject);
         } else {
+          const receivedMs = performance.timeOrigin + performance.now();
           this._handleBinaryFrame(event.data);
+          this._ackFrame(event.data, receivedMs);
         }
       };
 
@@ -118,6 +544,7 @@ export class KinectClient {
       this.ws.onclose = () => {
         console.log('[KinectClient] Disconnected');
         this.connected = false;
+        this._stopTimeSync();
         if (this.onDisconnect) {
           this.onDisconnect();
         }
@@ -129,6 +556,7 @@ export class KinectClient {
    * Disconnect from the server
    */
   disconnect() {
+    this._stopTimeSync();
     if (this.ws) {
       this.ws.close();
       this.ws = null;
@@ -172,6 +600,25 @@ export class KinectClient {
     return this._sendMotorCommand({ type: 'motor.getStatus' });
   }
 
+  /**
+   * Ask for a status report; it arrives through onStatus. Binary control
+   * replies carry the counters and this client's own delivery only.
+   */
+  requestStatus() {
+    if (!this.connected || !this.ws) {
+      return;
+    }
+    this._sendControl({ type: 'status' });
+  }
+
+  /**
+   * Ask for the bridge metrics (the same registry GET /metrics serves); they
+   * arrive through onStats.
+   */
+  requestStats() {
+    this._send({ type: 'stats' });
+  }
+
   _sendMotorCommand(command) {
     return new Promise((resolve, reject) => {
       if (!this.connected || !this.ws) {
@@ -183,10 +630,79 @@ export class KinectClient {
       this._pendingMotorResolve = resolve;
       this._pendingMotorReject = reject;
 
-      this.ws.send(JSON.stringify(command));
+      this._sendControl(command);
     });
   }
 
+  _sendControl(command) {
+    const control = this.capabilities && this.capabilities.control;
+    if (!this._binaryControl || !control || !control.encodings.includes('binary')) {
+      this.ws.send(JSON.stringify(command));
+      return;
+    }
+
+    // 8-byte bridge header, then one record: type, length, value
+    const view = new DataView(this._controlBuffer);
+    view.setUint32(0, 0, true);
+    view.setUint16(4, STREAM_TYPE_CONTROL, true);
+    view.setUint16(6, 0, true);
+    let length = 0;
+    switch (command.type) {
+      case 'motor.setTilt':
+        view.setUint16(8, CONTROL_SET_TILT, true);
+        view.setInt16(12, Math.round(command.angle * 10), true);
+        length = 2;
+        break;
+      case 'motor.setLed':
+        if (!(command.state in CONTROL_LED_STATES)) {
+          // Let the bridge report the invalid state as usual
+          this.ws.send(JSON.stringify(command));
+          return;
+        }
+        view.setUint16(8, CONTROL_SET_LED, true);
+        view.setUint8(12, CONTROL_LED_STATES[command.state]);
+        length = 1;
+        break;
+      case 'motor.reset':
+        view.setUint16(8, CONTROL_RESET, true);
+        break;
+      case 'motor.getStatus':
+        view.setUint16(8, CONTROL_GET_MOTOR_STATUS, true);
+        break;
+      default:
+        view.setUint16(8, CONTROL_STATUS, true);
+        break;
+    }
+    view.setUint16(10, length, true);
+    this.ws.send(new Uint8Array(this._controlBuffer, 0, 12 + length));
+  }
+
+  _dispatchMotorStatus(msg) {
+    // Resolve pending motor command promise
+    if (this._pendingMotorResolve) {
+      this._pendingMotorResolve(msg);
+      this._pendingMotorResolve = null;
+      this._pendingMotorReject = null;
+    }
+    // Also call callback for streaming status updates
+    if (this.onMotorStatus) {
+      this.onMotorStatus(msg);
+    }
+  }
+
+  _dispatchMotorError(msg) {
+    console.error('[KinectClient] Motor error:', msg.code, msg.message);
+    // Reject pending motor command promise
+    if (this._pendingMotorReject) {
+      this._pendingMotorReject(new Error(`${msg.code}: ${msg.message}`));
+      this._pendingMotorResolve = null;
+      this._pendingMotorReject = null;
+    }
+    if (this.onMotorError) {
+      this.onMotorError(msg);
+    }
+  }
+
   /**
    * Get current statistics
    * @returns {object} Statistics object
@@ -202,6 +718,11 @@ export class KinectClient {
     this.stats = {
       rgbFrames: 0,
       depthFrames: 0,
+      pointCloudFrames: 0,
+      meshFrames: 0,
+      keyedFrames: 0,
+      contourFrames: 0,
+      bundles: 0,
       lastRgbFrameId: -1,
       lastDepthFrameId: -1,
       droppedRgbFrames: 0,
@@ -222,6 +743,7 @@ export class KinectClient {
           this.capabilities = msg.capabilities;
           this.connected = true;
           this._subscribe();
+          this._startTimeSync();
           if (this.onConnect) {
             this.onConnect(this.capabilities);
           }
@@ -236,6 +758,12 @@ export class KinectClient {
           }
           break;
 
+        case 'stats':
+          if (this.onStats) {
+            this.onStats(msg.metrics);
+          }
+          break;
+
         case 'error':
           console.error('[KinectClient] Server error:', msg.code, msg.message);
           if (this.onError) {
@@ -246,34 +774,28 @@ export class KinectClient {
           }
           break;
 
+        case 'history.replay':
+          console.log('[KinectClient] Replaying', msg.frames, msg.stream, 'frames');
+          break;
+
+        case 'key.learn':
+          console.log('[KinectClient] Learning key background from', msg.frames, 'frames');
+          break;
+
         case 'goodbye':
           console.log('[KinectClient] Server goodbye:', msg.reason);
           break;
 
         case 'motor.status':
-          // Resolve pending motor command promise
-          if (this._pendingMotorResolve) {
-            this._pendingMotorResolve(msg);
-            this._pendingMotorResolve = null;
-            this._pendingMotorReject = null;
-          }
-          // Also call callback for streaming status updates
-          if (this.onMotorStatus) {
-            this.onMotorStatus(msg);
-          }
+          this._dispatchMotorStatus(msg);
           break;
 
         case 'motor.error':
-          console.error('[KinectClient] Motor error:', msg.code, msg.message);
-          // Reject pending motor command promise
-          if (this._pendingMotorReject) {
-            this._pendingMotorReject(new Error(`${msg.code}: ${msg.message}`));
-            this._pendingMotorResolve = null;
-            this._pendingMotorReject = null;
-          }
-          if (this.onMotorError) {
-            this.onMotorError(msg);
-          }
+          this._dispatchMotorError(msg);
+          break;
+
+        case 'time.sync':
+          this._handleTimeSync(msg, performance.timeOrigin + performance.now());
           break;
 
         default:
@@ -284,7 +806,69 @@ export class KinectClient {
     }
   }
 
-  _handleBinaryFrame(buffer) {
+  _handleControlMessage(buffer) {
+    // Decoded into the same objects the JSON replies produce
+    const view = new DataView(buffer);
+    let offset = 8;
+    while (offset + 4 <= buffer.byteLength) {
+      const type = view.getUint16(offset, true);
+      const length = view.getUint16(offset + 2, true);
+      const value = offset + 4;
+      if (value + length > buffer.byteLength) {
+        break;
+      }
+      offset = value + length;
+
+      if (type === CONTROL_MOTOR_STATUS && length >= 4) {
+        const angle = view.getInt16(value, true);
+        const msg = {
+          type: 'motor.status',
+          status: CONTROL_TILT_STATUS[view.getUint8(value + 2)] || 'UNKNOWN',
+        };
+        if ((view.getUint8(value + 3) & CONTROL_MOTOR_FLAG_ACCEL) && length >= 10) {
+          msg.accelerometer = {
+            x: view.getInt16(value + 4, true) / 100,
+            y: view.getInt16(value + 6, true) / 100,
+            z: view.getInt16(value + 8, true) / 100,
+          };
+        }
+        if (angle !== CONTROL_ANGLE_UNKNOWN) {
+          msg.angle = angle / 10;
+        }
+        this._dispatchMotorStatus(msg);
+
+      } else if (type === CONTROL_STATUS_REPLY && length >= 32) {
+        if (this.onStatus) {
+          this.onStatus({
+            type: 'status',
+            frame_id: view.getUint32(value, true),
+            dropped_frames: view.getUint32(value + 4, true),
+            clients_connected: view.getUint16(value + 8, true),
+            kinect_connected: view.getUint8(value + 10) !== 0,
+            clients: [{
+              self: true,
+              scale: view.getUint8(value + 12),
+              frame_divider: view.getUint8(value + 13),
+              estimated_kbps: view.getUint32(value + 16, true),
+              queued_bytes: view.getUint32(value + 20, true),
+              queue_ms: view.getUint32(value + 24, true),
+              frames_skipped: view.getUint32(value + 28, true),
+            }],
+          });
+        }
+
+      } else if (type === CONTROL_ERROR && length >= 2) {
+        const code = view.getUint16(value, true);
+        this._dispatchMotorError({
+          type: 'motor.error',
+          code: CONTROL_ERROR_CODES[code] || 'PROTOCOL_ERROR',
+          message: new TextDecoder().decode(new Uint8Array(buffer, value + 2, length - 2)),
+        });
+      }
+    }
+  }
+
+  _handleBinaryFrame(buffer, inBundle = false) {
     if (buffer.byteLength < 8) {
       console.warn('[KinectClient] Binary frame too small:', buffer.byteLength);
       return;
@@ -293,33 +877,76 @@ export class KinectClient {
     const header = new DataView(buffer, 0, 8);
     const frameId = header.getUint32(0, true);
     const streamType = header.getUint16(4, true);
+    const flags = header.getUint16(6, true);
     const payloadSize = buffer.byteLength - 8;
+    const scaleShift = (flags & FRAME_FLAG_SCALE_MASK) >> FRAME_FLAG_SCALE_SHIFT;
+    const width = FRAME_WIDTH >> scaleShift;
+    const height = FRAME_HEIGHT >> scaleShift;
 
-    this.stats.bytesReceived += buffer.byteLength;
+    if (!inBundle) {
+      this.stats.bytesReceived += buffer.byteLength;
+    }
+
+    if (streamType === STREAM_TYPE_CONTROL) {
+      this._handleControlMessage(buffer);
+      return;
+    }
+
+    // History frames are out of band: no drop tracking, separate callback
+    if (flags & FRAME_FLAG_HISTORY) {
+      this._handleHistoryFrame(buffer, streamType, frameId, payloadSize);
+      return;
+    }
+
+    const tiled = (flags & FRAME_FLAG_TILES) !== 0;
 
-    if (streamType === STREAM_TYPE_RGB) {
-      if (payloadSize !== RGB_FRAME_SIZE) {
-        console.warn('[KinectClient] RGB frame wrong size:', payloadSize);
+    if (streamType === STREAM_TYPE_BUNDLE && !inBundle) {
+      this._handleBundle(buffer, frameId, payloadSize);
+
+    } else if (streamType === STREAM_TYPE_RGB) {
+      // The bridge sends RGBA8888 (rgb_format), ready for ImageData as is
+      const pixelFormat = (flags & FRAME_FLAG_PIXEL_FORMAT_MASK) >> FRAME_FLAG_PIXEL_FORMAT_SHIFT;
+      if (pixelFormat !== PIXEL_FORMAT_RGBA8888 || (!tiled && payloadSize !== width * height * 4)) {
+        console.warn('[KinectClient] RGB frame not RGBA8888 or wrong size:', payloadSize);
         return;
       }
 
-      // Track dropped frames
+      // Track dropped frames (frames skipped by adaptive delivery count too)
       if (this.stats.lastRgbFrameId >= 0 && frameId > this.stats.lastRgbFrameId + 1) {
         this.stats.droppedRgbFrames += frameId - this.stats.lastRgbFrameId - 1;
       }
       this.stats.lastRgbFrameId = frameId;
       this.stats.rgbFrames++;
 
+      let imageData;
+      if (this._tiles && scaleShift === 0) {
+        // Full frames overwrite the tile buffer, tile frames patch it
+        if (!this._rgbTiles) {
+          if (tiled && !this._coversFrame(buffer)) {
+            return;  // Nothing to patch yet
+          }
+          this._rgbTiles = new ImageData(FRAME_WIDTH, FRAME_HEIGHT);
+        }
+        if (!tiled) {
+          this._rgbTiles.data.set(new Uint8Array(buffer, 8));
+        } else if (!this._patchTiles(this._rgbTiles.data, buffer, 4)) {
+          return;
+        }
+        imageData = this._rgbTiles;
+      } else if (tiled) {
+        return;
+      } else {
+        imageData = new ImageData(new Uint8ClampedArray(buffer, 8), width, height);
+      }
+
       if (this.onRgbFrame) {
-        // Convert RGB888 to RGBA for ImageData
-        const rgb = new Uint8Array(buffer, 8);
-        this._convertRgbToRgba(rgb);
-        const imageData = new ImageData(this._rgbaBuffer, FRAME_WIDTH, FRAME_HEIGHT);
         this.onRgbFrame(imageData, frameId);
       }
 
     } else if (streamType === STREAM_TYPE_DEPTH) {
-      if (payloadSize !== DEPTH_FRAME_SIZE) {
+      const packing = (flags & FRAME_FLAG_DEPTH_PACKING_MASK) >> FRAME_FLAG_DEPTH_PACKING_SHIFT;
+      const bits = DEPTH_PACKING_BITS[packing];
+      if (!bits || (!tiled && payloadSize !== Math.ceil(width * height * bits / 8))) {
         console.warn('[KinectClient] Depth frame wrong size:', payloadSize);
         return;
       }
@@ -331,33 +958,453 @@ export class KinectClient {
       this.stats.lastDepthFrameId = frameId;
       this.stats.depthFrames++;
 
+      let depth;
+      if (this._tiles && scaleShift === 0 && bits === 16) {
+        if (!this._depthTiles) {
+          if (tiled && !this._coversFrame(buffer)) {
+            return;
+          }
+          this._depthTiles = new Uint16Array(FRAME_WIDTH * FRAME_HEIGHT);
+        }
+        const target = new Uint8Array(this._depthTiles.buffer);
+        if (!tiled) {
+          target.set(new Uint8Array(buffer, 8));
+        } else if (!this._patchTiles(target, buffer, 2)) {
+          return;
+        }
+        depth = this._depthTiles;
+      } else if (tiled) {
+        return;
+      } else {
+        depth = bits === 16
+          ? new Uint16Array(buffer, 8)
+          : this._unpackDepth(new Uint8Array(buffer, 8), width * height, bits);
+      }
+
       if (this.onDepthFrame) {
-        const depth = new Uint16Array(buffer, 8);
-        this.onDepthFrame(depth, frameId);
+        this.onDepthFrame(depth, frameId, width, height);
       }
 
+    } else if (streamType === STREAM_TYPE_POINTCLOUD) {
+      this._handlePointCloud(buffer, frameId, payloadSize);
+
+    } else if (streamType === STREAM_TYPE_MESH) {
+      this._handleMesh(buffer, frameId, payloadSize);
+
+    } else if (streamType === STREAM_TYPE_KEYED) {
+      this._handleKeyed(buffer, frameId, payloadSize);
+
+    } else if (streamType === STREAM_TYPE_CONTOURS) {
+      this._handleContours(buffer, frameId, payloadSize);
+
     } else {
       console.warn('[KinectClient] Unknown stream type:', streamType);
     }
   }
 
+  _handlePointCloud(buffer, frameId, payloadSize) {
+    if (payloadSize < POINT_CLOUD_HEADER_SIZE) {
+      console.warn('[KinectClient] Point cloud frame too small:', payloadSize);
+      return;
+    }
+
+    const header = new DataView(buffer, 8, POINT_CLOUD_HEADER_SIZE);
+    const count = header.getUint32(0, true);
+    const format = POINT_FORMATS[header.getUint8(4)];
+    const hasColor = (header.getUint8(6) & POINT_CLOUD_FLAG_COLOR) !== 0;
+    if (!format || payloadSize !== POINT_CLOUD_HEADER_SIZE + count * (hasColor ? 9 : 6)) {
+      console.warn('[KinectClient] Point cloud frame malformed:', payloadSize);
+      return;
+    }
+    this.stats.pointCloudFrames++;
+
+    if (this.onPointCloud) {
+      // Views into the received buffer: no per-point work on the main thread
+      const offset = 8 + POINT_CLOUD_HEADER_SIZE;
+      const positions = format === 'int16'
+        ? new Int16Array(buffer, offset, count * 3)
+        : new Uint16Array(buffer, offset, count * 3);
+      const colors = hasColor ? new Uint8Array(buffer, offset + count * 6, count * 3) : null;
+      this.onPointCloud({
+        count,
+        format,
+        decimation: header.getUint8(5),
+        positions,
+        colors,
+      }, frameId);
+    }
+  }
+
+  _handleMesh(buffer, frameId, payloadSize) {
+    if (payloadSize < MESH_HEADER_SIZE) {
+      console.warn('[KinectClient] Mesh frame too small:', payloadSize);
+      return;
+    }
+
+    const header = new DataView(buffer, 8, MESH_HEADER_SIZE);
+    const vertexCount = header.getUint32(0, true);
+    const indexCount = header.getUint32(4, true);
+    const index32 = (header.getUint8(8) & MESH_FLAG_INDEX32) !== 0;
+    const positionsOffset = 8 + MESH_HEADER_SIZE;
+    // 32-bit indices start on a 4-byte boundary
+    let indicesOffset = positionsOffset + vertexCount * 6;
+    if (index32) indicesOffset += indicesOffset % 4;
+    if (indicesOffset + indexCount * (index32 ? 4 : 2) !== buffer.byteLength) {
+      console.warn('[KinectClient] Mesh frame malformed:', payloadSize);
+      return;
+    }
+    this.stats.meshFrames++;
+
+    if (this.onMesh) {
+      this.onMesh({
+        vertexCount,
+        indexCount,
+        step: header.getUint8(9),
+        positions: new Int16Array(buffer, positionsOffset, vertexCount * 3),
+        indices: index32
+          ? new Uint32Array(buffer, indicesOffset, indexCount)
+          : new Uint16Array(buffer, indicesOffset, indexCount),
+      }, frameId);
+    }
+  }
+
+  _handleKeyed(buffer, frameId, payloadSize) {
+    if (payloadSize < KEY_HEADER_SIZE) {
+      console.warn('[KinectClient] Keyed frame too small:', payloadSize);
+      return;
+    }
+
+    const header = new DataView(buffer, 8, KEY_HEADER_SIZE);
+    const format = KEY_FORMATS[header.getUint8(0)];
+    const learning = (header.getUint8(1) & KEY_FLAG_LEARNING) !== 0;
+    const width = header.getUint16(2, true);
+    const height = header.getUint16(4, true);
+    const colorBytes = header.getUint32(8, true);
+    const colorOffset = 8 + KEY_HEADER_SIZE;
+    const sizeOk = format === 'rgba'
+      ? colorBytes === width * height * 4 && colorOffset + colorBytes === buffer.byteLength
+      : format === 'jpeg' && colorOffset + colorBytes < buffer.byteLength;
+    if (!sizeOk) {
+      console.warn('[KinectClient] Keyed frame malformed:', payloadSize);
+      return;
+    }
+    this.stats.keyedFrames++;
+
+    if (!this.onKeyedFrame) {
+      return;
+    }
+    const info = { format, learning };
+    if (format === 'rgba') {
+      // A view into the received buffer: no per-pixel work at all
+      this._lastKeyedFrameId = frameId;
+      const rgba = new Uint8ClampedArray(buffer, colorOffset, colorBytes);
+      this.onKeyedFrame(new ImageData(rgba, width, height), frameId, info);
+      return;
+    }
+    this._decodeKeyedJpeg(buffer, colorOffset, colorBytes, width, height)
+      .then((imageData) => {
+        // Decodes can finish out of order; never go back in time
+        if (frameId <= this._lastKeyedFrameId) return;
+        this._lastKeyedFrameId = frameId;
+        this.onKeyedFrame(imageData, frameId, info);
+      })
+      .catch((e) => console.warn('[KinectClient] Keyed frame decode failed:', e));
+  }
+
+  _handleContours(buffer, frameId, payloadSize) {
+    if (payloadSize < CONTOUR_HEADER_SIZE) {
+      console.warn('[KinectClient] Contours frame too small:', payloadSize);
+      return;
+    }
+
+    const view = new DataView(buffer);
+    const polygonCount = view.getUint16(8, true);
+    const totalPoints = view.getUint32(12, true);
+    if (8 + CONTOUR_HEADER_SIZE + polygonCount * 4 + totalPoints * 4 !== buffer.byteLength) {
+      console.warn('[KinectClient] Contours frame malformed:', payloadSize);
+      return;
+    }
+    this.stats.contourFrames++;
+
+    if (!this.onContours) {
+      return;
+    }
+    // Views into the received buffer, x and y interleaved in half pixels
+    const polygons = [];
+    let offset = 8 + CONTOUR_HEADER_SIZE;
+    for (let i = 0; i < polygonCount; i++) {
+      const count = view.getUint16(offset, true);
+      const hole = (view.getUint16(offset + 2, true) & CONTOUR_FLAG_HOLE) !== 0;
+      polygons.push({ points: new Int16Array(buffer, offset + 4, count * 2), hole });
+      offset += 4 + count * 4;
+    }
+    this.onContours({
+      step: view.getUint8(10),
+      learning: (view.getUint8(11) & KEY_FLAG_LEARNING) !== 0,
+      polygons,
+    }, frameId);
+  }
+
+  async _decodeKeyedJpeg(buffer, colorOffset, colorBytes, width, height) {
+    const jpeg = new Blob([new Uint8Array(buffer, colorOffset, colorBytes)], { type: 'image/jpeg' });
+    const deflated = new Blob([new Uint8Array(buffer, colorOffset + colorBytes)]);
+    const [bitmap, mask] = await Promise.all([
+      createImageBitmap(jpeg),
+      new Response(deflated.stream().pipeThrough(new DecompressionStream('deflate'))).arrayBuffer(),
+    ]);
+
+    if (!this._keyCanvas) {
+      this._keyCanvas = new OffscreenCanvas(width, height);
+      this._keyContext = this._keyCanvas.getContext('2d', { willReadFrequently: true });
+    }
+    this._keyContext.drawImage(bitmap, 0, 0);
+    bitmap.close();
+    const imageData = this._keyContext.getImageData(0, 0, width, height);
+    const alpha = new Uint8Array(mask);
+    for (let i = 0, j = 3; i < alpha.length; i++, j += 4) {
+      imageData.data[j] = alpha[i];
+    }
+    return imageData;
+  }
+
+  _handleBundle(buffer, frameId, payloadSize) {
+    // Header: part count, reserved, capture time; then (offset, size) per
+    // part from the start of the message; parts are ordinary frames
+    const view = new DataView(buffer, 8);
+    const count = payloadSize >= BUNDLE_HEADER_SIZE ? view.getUint16(0, true) : 0;
+    if (count === 0 || payloadSize < BUNDLE_HEADER_SIZE + count * 8) {
+      console.warn('[KinectClient] Bundle too small:', payloadSize);
+      return;
+    }
+    const captureTimeMs = Number(view.getBigUint64(8, true));
+
+    const parts = [];
+    for (let i = 0; i < count; i++) {
+      const offset = view.getUint32(BUNDLE_HEADER_SIZE + i * 8, true);
+      const size = view.getUint32(BUNDLE_HEADER_SIZE + i * 8 + 4, true);
+      if (size < 8 || offset + size > buffer.byteLength) {
+        console.warn('[KinectClient] Bundle part out of range:', offset, size);
+        return;
+      }
+      parts.push([offset, size]);
+    }
+
+    // Validate everything first, then deliver the streams together
+    this.stats.bundles++;
+    const streams = [];
+    for (const [offset, size] of parts) {
+      const part = buffer.slice(offset, offset + size);
+      streams.push(BUNDLE_STREAM_NAMES[new DataView(part).getUint16(4, true)]);
+      this._handleBinaryFrame(part, true);
+    }
+    if (this.onBundle) {
+      this.onBundle(frameId, streams, captureTimeMs);
+    }
+  }
+
+  _coversFrame(buffer) {
+    // The very first update of a stream sends every tile
+    return buffer.byteLength >= 8 + TILE_HEADER_SIZE &&
+      new DataView(buffer, 8 + 2, 2).getUint16(0, true) === TILE_COUNT;
+  }
+
+  _patchTiles(target, buffer, pixelSize) {
+    // Header: tile size, reserved, count, bitmap; then the listed tiles in order
+    const bytes = new Uint8Array(buffer, 8);
+    const count = bytes[2] | (bytes[3] << 8);
+    const rowBytes = TILE_SIZE * pixelSize;
+    if (bytes[0] !== TILE_SIZE || bytes.length !== TILE_HEADER_SIZE + count * TILE_SIZE * rowBytes) {
+      console.warn('[KinectClient] Tile frame wrong size:', bytes.length);
+      return false;
+    }
+    const stride = FRAME_WIDTH * pixelSize;
+    let offset = TILE_HEADER_SIZE;
+    for (let tile = 0; tile < TILE_COUNT; tile++) {
+      if (!(bytes[4 + (tile >> 3)] & (1 << (tile & 7)))) {
+        continue;
+      }
+      const v = Math.floor(tile / TILE_COLUMNS) * TILE_SIZE;
+      const u = (tile % TILE_COLUMNS) * TILE_SIZE;
+      let dst = (v * FRAME_WIDTH + u) * pixelSize;
+      for (let row = 0; row < TILE_SIZE; row++, dst += stride, offset += rowBytes) {
+        target.set(bytes.subarray(offset, offset + rowBytes), dst);
+      }
+    }
+    return true;
+  }
+
+  _unpackDepth(bytes, count, bits) {
+    // Little-endian bit stream: sample i is bits [i * bits, (i + 1) * bits)
+    const depth = new Uint16Array(count);
+    let i = 0;
+    if (bits === 12) {
+      // Two samples per three bytes
+      for (let j = 0; i + 1 < count; i += 2, j += 3) {
+        const middle = bytes[j + 1];
+        depth[i] = bytes[j] | ((middle & 0x0F) << 8);
+        depth[i + 1] = (middle >> 4) | (bytes[j + 2] << 4);
+      }
+    }
+    const mask = (1 << bits) - 1;
+    for (let bit = i * bits; i < count; i++, bit += bits) {
+      const j = bit >> 3;
+      // Reads past the end are undefined, which the shifts treat as 0
+      const window = bytes[j] | (bytes[j + 1] << 8) | (bytes[j + 2] << 16);
+      depth[i] = (window >> (bit & 7)) & mask;
+    }
+    return depth;
+  }
+
+  _handleHistoryFrame(buffer, streamType, frameId, payloadSize) {
+    if (!this.onHistoryFrame) {
+      return;
+    }
+    if (streamType === STREAM_TYPE_RGB && payloadSize === FRAME_WIDTH * FRAME_HEIGHT * 4) {
+      const imageData = new ImageData(new Uint8ClampedArray(buffer, 8), FRAME_WIDTH, FRAME_HEIGHT);
+      this.onHistoryFrame('rgb', imageData, frameId);
+    } else if (streamType === STREAM_TYPE_DEPTH && payloadSize === DEPTH_FRAME_SIZE) {
+      this.onHistoryFrame('depth', new Uint16Array(buffer, 8), frameId);
+    }
+  }
+
   _subscribe() {
     if (this.ws && this.ws.readyState === WebSocket.OPEN) {
-      this.ws.send(JSON.stringify({
+      const msg = {
         type: 'subscribe',
-        streams: this._streams
-      }));
+        streams: this._streams,
+        rgb_format: 'RGBA8888'
+      };
+      if (this._catchUp) {
+        msg.catch_up = true;
+      }
+      if (this._adaptive) {
+        msg.adaptive = true;
+      }
+      if (this._depthFormat !== 'uint16') {
+        msg.depth_format = this._depthFormat;
+      }
+      if (this._tiles) {
+        msg.tiles = true;
+      }
+      if (this._bundle) {
+        msg.bundle = true;
+      }
+      if (this._pointCloud && this._streams.includes('pointcloud')) {
+        msg.pointcloud = this._pointCloud;
+      }
+      if (this._mesh && this._streams.includes('mesh')) {
+        msg.mesh = this._mesh;
+      }
+      if (this._key && this._streams.includes('keyed')) {
+        msg.key = this._key;
+      }
+      if (this._contours && this._streams.includes('contours')) {
+        msg.contours = this._contours;
+      }
+      this.ws.send(JSON.stringify(msg));
       console.log('[KinectClient] Subscribed to:', this._streams.join(', '));
     }
   }
 
-  _convertRgbToRgba(rgb) {
-    // Convert RGB888 to RGBA8888 for canvas ImageData
-    for (let i = 0, j = 0; i < rgb.length; i += 3, j += 4) {
-      this._rgbaBuffer[j] = rgb[i];         // R
-      this._rgbaBuffer[j + 1] = rgb[i + 1]; // G
-      this._rgbaBuffer[j + 2] = rgb[i + 2]; // B
-      this._rgbaBuffer[j + 3] = 255;        // A
+  _startTimeSync() {
+    const sync = this.capabilities && this.capabilities.time_sync;
+    if (!this._syncIntervalMs || !sync || this._syncTimer) {
+      return;
+    }
+    // A quick burst fills the filter window, then the configured pace
+    let burst = Math.min(CLOCK_WINDOW, sync.window || CLOCK_WINDOW) / 2;
+    const tick = () => {
+      this._sendTimeSync();
+      this._syncTimer = setTimeout(tick, burst-- > 0 ? 250 : this._syncIntervalMs);
+    };
+    tick();
+  }
+
+  _stopTimeSync() {
+    clearTimeout(this._syncTimer);
+    this._syncTimer = null;
+    this._syncPending = null;
+    this._syncPrevious = null;
+  }
+
+  _sendTimeSync() {
+    const msg = { type: 'time.sync', id: ++this._syncId, t0: performance.timeOrigin + performance.now() };
+    if (this._syncPrevious) {
+      msg.prev_id = this._syncPrevious.id;
+      msg.prev_t3 = this._syncPrevious.t3;
+      this._syncPrevious = null;
+    }
+    this._syncPending = { id: msg.id, t0: msg.t0 };
+    this._send(msg);
+  }
+
+  _handleTimeSync(msg, t3) {
+    const pending = this._syncPending;
+    if (!pending || msg.id !== pending.id) {
+      return;  // Superseded by a newer request
+    }
+    this._syncPending = null;
+    this._syncPrevious = { id: msg.id, t3 };
+
+    const rtt = (t3 - pending.t0) - (msg.t2 - msg.t1);
+    if (rtt < 0 || msg.t2 < msg.t1) {
+      return;
+    }
+    const offset = ((msg.t1 - pending.t0) + (msg.t2 - t3)) / 2;
+    this._clockSamples.push({ offset, rtt });
+    if (this._clockSamples.length > CLOCK_WINDOW) {
+      this._clockSamples.shift();
+    }
+    // RFC 6298 smoothing, as on the bridge
+    if (this._clockCount++ === 0) {
+      this._srtt = rtt;
+      this._rttvar = rtt / 2;
+    } else {
+      this._rttvar += (Math.abs(this._srtt - rtt) - this._rttvar) / 4;
+      this._srtt += (rtt - this._srtt) / 8;
+    }
+    if (this.onClockSync) {
+      this.onClockSync(this.getClockEstimate());
+    }
+  }
+
+  _ackFrame(buffer, receivedMs) {
+    const latency = this.capabilities && this.capabilities.latency;
+    if (!this._ackEvery || !latency || !latency.ack || buffer.byteLength < 8) {
+      return;
+    }
+    const header = new DataView(buffer, 0, 8);
+    const frameId = header.getUint32(0, true);
+    const streamType = header.getUint16(4, true);
+    const flags = header.getUint16(6, true);
+    // Once per frame ID (unbundled streams share it); replays are not live
+    if (streamType === STREAM_TYPE_CONTROL || (flags & FRAME_FLAG_HISTORY) ||
+        frameId === this._lastAckedFrameId) {
+      return;
+    }
+    this._lastAckedFrameId = frameId;
+    if (this._ackCount++ % this._ackEvery !== 0) {
+      return;
+    }
+
+    const send = () => {
+      this._send({
+        type: 'ack',
+        frame_id: frameId,
+        received_ms: receivedMs,
+        rendered_ms: performance.timeOrigin + performance.now()
+      });
+    };
+    if (typeof requestAnimationFrame === 'function') {
+      requestAnimationFrame(send);
+    } else {
+      send();
+    }
+  }
+
+  _send(msg) {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.ws.send(JSON.stringify(msg));
     }
   }
 }
@@ -368,6 +1415,10 @@ export const KINECT = {
   HEIGHT: FRAME_HEIGHT,
   STREAM_RGB: 'rgb',
   STREAM_DEPTH: 'depth',
+  STREAM_POINTCLOUD: 'pointcloud',
+  STREAM_MESH: 'mesh',
+  STREAM_KEYED: 'keyed',
+  STREAM_CONTOURS: 'contours',
   MIN_DEPTH_MM: 800,
   MAX_DEPTH_MM: 4000,
   // Motor control